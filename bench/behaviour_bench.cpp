@@ -0,0 +1,104 @@
+// Measures the obstacle and neighbour helpers that behaviours call for every
+// drone on every step.
+#include <benchmark/benchmark.h>
+#include <box2d/box2d.h>
+
+#include <memory>
+#include <vector>
+
+#include "bench_common.h"
+#include "salsa/behaviours/behaviour.h"
+#include "salsa/behaviours/context.h"
+#include "salsa/core/runner.h"
+#include "salsa/core/sim.h"
+#include "salsa/utils/raycastcallback.h"
+#include "salsa/utils/spatial_grid.h"
+
+namespace {
+
+// Makes the protected helpers of `Behaviour` callable here.
+class Helpers final : public salsa::Behaviour {
+ public:
+  using Behaviour::avoidDrones;
+  using Behaviour::avoidObstacles;
+  using Behaviour::performRayCasting;
+
+  void execute(const std::vector<std::unique_ptr<salsa::Drone>> &,
+               salsa::Drone &) override {}
+};
+
+// A swarm on the benchmark map, stepped once so that it has a snapshot, with
+// a neighbour grid built over it the way `Sim::update` builds one.
+struct Swarm {
+  salsa::TestConfig config;
+  salsa::Sim sim;
+  salsa::SpatialGrid grid;
+
+  explicit Swarm(const int drones)
+      : config(bench::makeTestConfig("Flocking", drones, 0)), sim(config) {
+    salsa::Runner runner(sim);
+    runner.step();
+    runner.step();
+    const salsa::DroneSnapshot &snapshot = sim.snapshot();
+    grid.build(snapshot.x, snapshot.y,
+               sim.getDroneConfiguration()->droneDetectionRange);
+  }
+
+  salsa::behaviour::Context context() {
+    return salsa::behaviour::Context(sim.getDrones(), &grid, nullptr,
+                                     &sim.snapshot());
+  }
+};
+
+void BM_PerformRayCasting(benchmark::State &state) {
+  Swarm swarm(static_cast<int>(state.range(0)));
+  for (auto _ : state) {
+    for (const auto &drone : swarm.sim.getDrones()) {
+      salsa::RayCastCallback callback;
+      Helpers::performRayCasting(*drone, callback);
+      benchmark::DoNotOptimize(callback.obstaclePoints.data());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_AvoidDrones(benchmark::State &state) {
+  Swarm swarm(static_cast<int>(state.range(0)));
+  const salsa::behaviour::Context context = swarm.context();
+  for (auto _ : state) {
+    for (const auto &drone : swarm.sim.getDrones()) {
+      benchmark::DoNotOptimize(Helpers::avoidDrones(context, *drone));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_AvoidObstacles(benchmark::State &state) {
+  Swarm swarm(static_cast<int>(state.range(0)));
+  // The obstacle points are found once, so only the steering is measured.
+  std::vector<std::vector<b2Vec2>> points;
+  for (const auto &drone : swarm.sim.getDrones()) {
+    salsa::RayCastCallback callback;
+    Helpers::performRayCasting(*drone, callback);
+    points.push_back(std::move(callback.obstaclePoints));
+  }
+  const auto &drones = swarm.sim.getDrones();
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < drones.size(); i++) {
+      benchmark::DoNotOptimize(Helpers::avoidObstacles(points[i], *drones[i]));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+}  // namespace
+
+BENCHMARK(BM_PerformRayCasting)
+    ->Apply(bench::droneCounts)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_AvoidDrones)
+    ->Apply(bench::droneCounts)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_AvoidObstacles)
+    ->Apply(bench::droneCounts)
+    ->Unit(benchmark::kMicrosecond);
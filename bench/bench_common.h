@@ -0,0 +1,114 @@
+// Set-up shared by the salsa_bench benchmarks: a drone configuration, a
+// target type and the drone and target counts every benchmark is run over.
+#ifndef SALSA_BENCH_BENCH_COMMON_H
+#define SALSA_BENCH_BENCH_COMMON_H
+
+#include <benchmark/benchmark.h>
+#include <box2d/box2d.h>
+
+#include <string>
+
+#include "salsa/core/profile.h"
+#include "salsa/core/test_queue.h"
+#include "salsa/entity/drone.h"
+#include "salsa/entity/drone_configuration.h"
+#include "salsa/entity/target.h"
+#include "salsa/entity/target_factory.h"
+#include "salsa/utils/collision_manager.h"
+
+namespace bench {
+
+inline const std::string kDroneConfig = "bench";
+inline const std::string kTargetType = "BenchTarget";
+/// The testbed map the simulations run on, which has obstacles to avoid.
+inline const std::string kMap = "scatter";
+
+/// A plain target with a body and no sensor, so that creating and moving
+/// targets is measured without any one target type's extras.
+class BenchTarget final : public salsa::Target {
+ public:
+  BenchTarget(b2World *world, const b2Vec2 &position, const int id)
+      : Target(world, position, 1.0f) {
+    id_ = id;
+  }
+
+  std::string getType() const override { return kTargetType; }
+};
+
+/// Registers the drone configuration, target type and collision types used
+/// by the benchmarks. Safe to call from every benchmark.
+inline void registerTypes() {
+  static const bool registered = [] {
+    static salsa::DroneConfiguration config(kDroneConfig, 15.0f, 50.0f, 10.0f,
+                                            0.3f, 1.0f, 1.5f, 50.0f);
+    salsa::CollisionManager::registerType<salsa::Drone>(
+        {typeid(BenchTarget).name()});
+    salsa::CollisionManager::registerType<BenchTarget>(
+        {typeid(salsa::Drone).name()});
+    salsa::TargetFactory::registerTarget<BenchTarget>(kTargetType);
+    return true;
+  }();
+  benchmark::DoNotOptimize(registered);
+}
+
+/// A test of `behaviour` on the benchmark map. Layouts are seeded, so every
+/// run of a benchmark starts from the same drones and targets.
+inline salsa::TestConfig makeTestConfig(const std::string &behaviour,
+                                        const int drones, const int targets) {
+  registerTypes();
+  salsa::TestConfig config{behaviour,
+                           salsa::TestConfig::FloatParameters{},
+                           kDroneConfig,
+                           kMap,
+                           drones,
+                           targets,
+                           1.0e6f,
+                           kTargetType,
+                           ""};
+  config.layout_seed = 1;
+  config.seed = 1;
+  return config;
+}
+
+/// Reports the hardware events counted by a simulation as per-step counters
+/// of the benchmark, or says in its label why there are none.
+inline void reportCounters(benchmark::State &state,
+                           const salsa::StepCounters &counters) {
+  if (!counters.available) {
+    state.SetLabel("no hardware counters: " + counters.error);
+    return;
+  }
+  const double steps = static_cast<double>(counters.steps);
+  const auto report = [&](const std::string &phase,
+                          const salsa::CounterSample &sample) {
+    for (std::size_t i = 0; i < salsa::kHardwareEventCount; i++) {
+      const auto event = static_cast<salsa::HardwareEvent>(i);
+      state.counters[phase + "_" + salsa::PerfCounters::eventName(event)] =
+          static_cast<double>(sample[event]) / steps;
+    }
+    state.counters[phase + "_ipc"] = sample.ipc();
+  };
+  report("world", counters.world_step);
+  report("behaviours", counters.behaviours);
+}
+
+/// 10 to 10k drones against 100 to 100k targets.
+inline void droneAndTargetCounts(benchmark::internal::Benchmark *b) {
+  b->ArgNames({"drones", "targets"})
+      ->RangeMultiplier(10)
+      ->Ranges({{10, 10000}, {100, 100000}});
+}
+
+/// 10 to 10k drones.
+inline void droneCounts(benchmark::internal::Benchmark *b) {
+  b->ArgName("drones")->RangeMultiplier(10)->Range(10, 10000);
+}
+
+/// 100 to 100k targets.
+inline void targetCounts(benchmark::internal::Benchmark *b) {
+  b->ArgName("targets")->RangeMultiplier(10)->Range(100, 100000);
+}
+
+}  // namespace bench
+
+#endif  // SALSA_BENCH_BENCH_COMMON_H
@@ -0,0 +1,127 @@
+// Compares the flocking neighbour loop reading drone state through
+// Drone -> b2Body pointers against reading it from a DroneSnapshot.
+#include <benchmark/benchmark.h>
+#include <box2d/box2d.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include "salsa/behaviours/behaviour.h"
+#include "salsa/entity/drone.h"
+#include "salsa/entity/drone_configuration.h"
+#include "salsa/entity/drone_factory.h"
+#include "salsa/entity/drone_snapshot.h"
+#include "salsa/utils/spatial_grid.h"
+
+namespace {
+
+class IdleBehaviour final : public salsa::Behaviour {
+ public:
+  void execute(const std::vector<std::unique_ptr<salsa::Drone>> &,
+               salsa::Drone &) override {}
+};
+
+constexpr float kDetectionRange = 50.0f;
+constexpr float kSeparationDistance = 20.0f;
+// Roughly this many drones fall inside each drone's detection range.
+constexpr float kNeighbours = 20.0f;
+
+// A swarm spread over a square sized to give each drone about kNeighbours
+// neighbours, with the neighbour lists precomputed so that only the loop over
+// them is measured.
+struct Swarm {
+  b2World world{b2Vec2(0.0f, 0.0f)};
+  IdleBehaviour behaviour;
+  salsa::DroneConfiguration config{"bench", 15.0f, 50.0f, 10.0f, 0.3f,
+                                   1.0f,    1.5f,  kDetectionRange};
+  std::vector<std::unique_ptr<salsa::Drone>> drones;
+  std::vector<std::vector<int>> neighbours;
+  salsa::DroneSnapshot snapshot;
+
+  explicit Swarm(const int count) {
+    salsa::CollisionManager::registerType<salsa::Drone>({});
+    std::srand(1);
+    const float side = std::sqrt(static_cast<float>(count) * b2_pi *
+                                 kDetectionRange * kDetectionRange /
+                                 kNeighbours);
+    std::vector<b2Vec2> positions;
+    for (int i = 0; i < count; i++) {
+      const b2Vec2 position(side * std::rand() / RAND_MAX,
+                            side * std::rand() / RAND_MAX);
+      positions.push_back(position);
+      drones.push_back(salsa::DroneFactory::createDrone(&world, position,
+                                                        behaviour, config));
+      drones.back()->id(i);
+    }
+    salsa::SpatialGrid grid;
+    grid.build(positions, kDetectionRange);
+    neighbours.resize(count);
+    for (int i = 0; i < count; i++) {
+      grid.queryRadius(positions[i], kDetectionRange, neighbours[i]);
+    }
+  }
+};
+
+struct Accumulators {
+  b2Vec2 align{0.0f, 0.0f};
+  b2Vec2 centre{0.0f, 0.0f};
+  b2Vec2 separate{0.0f, 0.0f};
+};
+
+inline void accumulate(Accumulators &sums, const b2Vec2 &position,
+                       const b2Vec2 &other_position,
+                       const b2Vec2 &other_velocity) {
+  sums.align += other_velocity;
+  sums.centre += other_position;
+  const float distance = b2Distance(position, other_position);
+  if (distance < kSeparationDistance && distance > 0) {
+    b2Vec2 diff = position - other_position;
+    diff.Normalize();
+    diff.x /= distance;
+    diff.y /= distance;
+    sums.separate += diff;
+  }
+}
+
+void BM_FlockingPointerChasing(benchmark::State &state) {
+  Swarm swarm(static_cast<int>(state.range(0)));
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < swarm.drones.size(); i++) {
+      Accumulators sums;
+      const b2Vec2 position = swarm.drones[i]->position();
+      for (const int j : swarm.neighbours[i]) {
+        const b2Body *body = swarm.drones[j]->body();
+        accumulate(sums, position, body->GetPosition(),
+                   body->GetLinearVelocity());
+      }
+      benchmark::DoNotOptimize(sums);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_FlockingSnapshot(benchmark::State &state) {
+  Swarm swarm(static_cast<int>(state.range(0)));
+  for (auto _ : state) {
+    // Capturing the snapshot is part of the cost of using it.
+    swarm.snapshot.capture(swarm.drones);
+    const salsa::DroneSnapshot &snapshot = swarm.snapshot;
+    for (std::size_t i = 0; i < snapshot.size(); i++) {
+      Accumulators sums;
+      const b2Vec2 position = snapshot.position(i);
+      for (const int j : swarm.neighbours[i]) {
+        accumulate(sums, position, snapshot.position(j),
+                   snapshot.velocity(j));
+      }
+      benchmark::DoNotOptimize(sums);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+}  // namespace
+
+BENCHMARK(BM_FlockingPointerChasing)->RangeMultiplier(10)->Range(100, 10000);
+BENCHMARK(BM_FlockingSnapshot)->RangeMultiplier(10)->Range(100, 10000);
@@ -0,0 +1,52 @@
+// Measures loading maps and writing the result log.
+#include <benchmark/benchmark.h>
+#include <box2d/box2d.h>
+
+#include <string>
+
+#include "bench_common.h"
+#include "nlohmann/json.hpp"
+#include "salsa/core/data.h"
+#include "salsa/core/map.h"
+
+namespace {
+
+// Parses the map file, builds its world and the obstacle field over it.
+void BM_MapLoad(benchmark::State &state, const std::string &name) {
+  for (auto _ : state) {
+    salsa::map::Map map = salsa::map::load(name.c_str());
+    benchmark::DoNotOptimize(map.obstacle_field.get());
+    // The caller owns the world of a loaded map.
+    delete map.world;
+  }
+}
+
+// Logs one message for each drone, as a swarm that logs every drone does
+// once every log interval.
+void BM_LoggerUpdate(benchmark::State &state) {
+  salsa::Logger logger("bench/logger_update.log");
+  const nlohmann::json message = {{"time", 12.5f},
+                                  {"caller_type", "Drone"},
+                                  {"id", 7},
+                                  {"message", R"({"targets_found":3})"}};
+  for (auto _ : state) {
+    for (int64_t i = 0; i < state.range(0); i++) {
+      logger.update(message);
+    }
+  }
+  logger.flush();
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+}  // namespace
+
+BENCHMARK_CAPTURE(BM_MapLoad, scatter, std::string("scatter"))
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_MapLoad, tree_map, std::string("tree_map"))
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_MapLoad, polygons, std::string("polygons"))
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_LoggerUpdate)
+    ->Apply(bench::droneCounts)
+    ->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,38 @@
+// Measures spreading pheromone over a PheromoneGrid, which reads and writes
+// every cell of the grid once a step.
+#include <benchmark/benchmark.h>
+#include <box2d/box2d.h>
+
+#include <cstdint>
+
+#include "salsa/utils/pheromone_grid.h"
+
+namespace {
+
+// A square grid of the given side in cells, with pheromone in every cell, as
+// after a long run with diffusion on. Nothing decays, so the grid does not
+// empty however many times the benchmark runs.
+void BM_PheromoneDiffuse(benchmark::State &state) {
+  const int side = static_cast<int>(state.range(0));
+  salsa::PheromoneGrid grid(1.0f);
+  for (int y = 0; y < side; y++) {
+    for (int x = 0; x < side; x++) {
+      grid.deposit(b2Vec2(x + 0.5f, y + 0.5f), 1.0f + (x ^ y) % 7);
+    }
+  }
+  for (auto _ : state) {
+    grid.advance();
+    grid.diffuse(0.2f);
+    benchmark::ClobberMemory();
+  }
+  const int64_t cells = static_cast<int64_t>(grid.columns()) * grid.rows();
+  state.SetItemsProcessed(state.iterations() * cells);
+  state.counters["cells"] = static_cast<double>(cells);
+}
+
+}  // namespace
+
+BENCHMARK(BM_PheromoneDiffuse)
+    ->RangeMultiplier(4)
+    ->Range(64, 1024)
+    ->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,150 @@
+// Measures a simulation step for each of the testbed's behaviours, and the
+// target bookkeeping around it.
+#include <benchmark/benchmark.h>
+#include <box2d/box2d.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bench_common.h"
+#include "salsa/core/placement.h"
+#include "salsa/core/runner.h"
+#include "salsa/core/sim.h"
+#include "salsa/entity/target_factory.h"
+#include "salsa/entity/target_pool.h"
+
+namespace {
+
+// Measures `Sim::update` alone. The world and the clock are moved on between
+// iterations, outside the timing, so every update sees the swarm move.
+void BM_SimUpdate(benchmark::State &state, const std::string &behaviour) {
+  salsa::TestConfig config =
+      bench::makeTestConfig(behaviour, static_cast<int>(state.range(0)),
+                            static_cast<int>(state.range(1)));
+  salsa::Sim sim(config);
+  salsa::Runner runner(sim);
+  // The first update runs at time zero, where nothing happens, and the
+  // second is where behaviours set up their per-drone state.
+  runner.step();
+  runner.step();
+  for (auto _ : state) {
+    sim.update();
+    state.PauseTiming();
+    sim.stepWorld(salsa::Runner::kDefaultTimeStep, 8, 3);
+    sim.current_time() += salsa::Runner::kDefaultTimeStep;
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// A whole step, including the Box2D world, for comparison with the update.
+void BM_SimStep(benchmark::State &state, const std::string &behaviour) {
+  salsa::TestConfig config =
+      bench::makeTestConfig(behaviour, static_cast<int>(state.range(0)),
+                            static_cast<int>(state.range(1)));
+  salsa::Sim sim(config);
+  salsa::Runner runner(sim);
+  runner.step();
+  runner.step();
+  for (auto _ : state) {
+    runner.step();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// A whole step again, with the hardware events of its world step and
+// behaviour phase counted, to tell compute-bound phases from memory-bound
+// ones. Kept apart from `BM_SimStep`, as reading the counters takes time.
+void BM_SimStepCounters(benchmark::State &state,
+                        const std::string &behaviour) {
+  salsa::TestConfig config =
+      bench::makeTestConfig(behaviour, static_cast<int>(state.range(0)),
+                            static_cast<int>(state.range(1)));
+  config.hardware_counters = true;
+  salsa::Sim sim(config);
+  salsa::Runner runner(sim);
+  runner.step();
+  runner.step();
+  for (auto _ : state) {
+    runner.step();
+  }
+  bench::reportCounters(state, sim.counters());
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_CountFoundTargets(benchmark::State &state) {
+  salsa::TestConfig config =
+      bench::makeTestConfig("Flocking", 10, static_cast<int>(state.range(0)));
+  salsa::Sim sim(config);
+  const std::vector<salsa::Target *> &targets = sim.getTargets();
+  for (std::size_t i = 0; i < targets.size(); i += 2) {
+    targets[i]->setFound(true);
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(sim.countFoundTargets());
+  }
+}
+
+// What `Sim::createTargets` does: lays the targets out over the map, then
+// creates them in one block of a pool.
+void BM_CreateTargets(benchmark::State &state) {
+  bench::registerTypes();
+  b2World world(b2Vec2(0.0f, 0.0f));
+  salsa::LayoutSpec spec;
+  spec.map_name = bench::kMap;
+  spec.count = static_cast<std::size_t>(state.range(0));
+  spec.seed = 1;
+  spec.upper.Set(2000.0f, 2000.0f);
+  for (auto _ : state) {
+    salsa::TargetPool pool;
+    const std::vector<b2Vec2> positions = salsa::generateLayout(spec);
+    salsa::TargetFactory::createTargets(bench::kTargetType, pool, &world,
+                                        positions.data(), positions.size(), 0);
+    benchmark::DoNotOptimize(pool.size());
+    // Destroying the targets takes their bodies out of the world again.
+    state.PauseTiming();
+    pool.clear();
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+}  // namespace
+
+BENCHMARK_CAPTURE(BM_SimUpdate, flocking, std::string("Flocking"))
+    ->Apply(bench::droneAndTargetCounts)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_SimStep, flocking, std::string("Flocking"))
+    ->Apply(bench::droneAndTargetCounts)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_SimUpdate, pheromone_avoidance,
+                  std::string("Pheromone Avoidance"))
+    ->Apply(bench::droneAndTargetCounts)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_SimStep, pheromone_avoidance,
+                  std::string("Pheromone Avoidance"))
+    ->Apply(bench::droneAndTargetCounts)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_SimUpdate, uniform_random_walk,
+                  std::string("Uniform Random Walk"))
+    ->Apply(bench::droneAndTargetCounts)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_SimStep, uniform_random_walk,
+                  std::string("Uniform Random Walk"))
+    ->Apply(bench::droneAndTargetCounts)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_SimUpdate, dsp, std::string("DSPBehaviour"))
+    ->Apply(bench::droneAndTargetCounts)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_SimStep, dsp, std::string("DSPBehaviour"))
+    ->Apply(bench::droneAndTargetCounts)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(BM_SimStepCounters, flocking, std::string("Flocking"))
+    ->Apply(bench::droneAndTargetCounts)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK(BM_CountFoundTargets)->Apply(bench::targetCounts);
+BENCHMARK(BM_CreateTargets)
+    ->Apply(bench::targetCounts)
+    ->Unit(benchmark::kMicrosecond);
@@ -10,11 +10,14 @@
 #include <unordered_map>
 #include <vector>
 
+#include "salsa/behaviours/context.h"
 #include "salsa/behaviours/parameter.h"
 #include "salsa/utils/raycastcallback.h"
 namespace salsa {
 
 class Drone;
+class CheckpointReader;
+class CheckpointWriter;
 
 /// @brief Abstract base class for all salsa behaviours to inherit from.
 class Behaviour {
@@ -34,6 +37,54 @@ class Behaviour {
   virtual void execute(const std::vector<std::unique_ptr<Drone>> &drones,
                        Drone &currentDrone) = 0;
 
+  /// @brief Executes behaviour logic with access to the per-step simulation
+  /// context, which provides neighbourhood queries over the swarm.
+  ///
+  /// Behaviours that look up nearby drones should override this and use
+  /// `context` rather than scanning `drones`. The default implementation
+  /// forwards to `execute(drones, currentDrone)`.
+  ///
+  /// @param drones List of all drones in the simulation context.
+  /// @param currentDrone Reference to the drone currently executing this
+  /// behavior.
+  /// @param context The simulation context for the current time step.
+  virtual void execute(const std::vector<std::unique_ptr<Drone>> &drones,
+                       Drone &currentDrone,
+                       const behaviour::Context &context) {
+    execute(drones, currentDrone);
+  }
+
+  /// @brief Called by the `Sim` once per step, before `execute` runs for
+  /// any drone.
+  ///
+  /// Behaviours that keep state shared by the whole swarm, such as a field
+  /// the drones write to and read from, move it on a step here. It is
+  /// always called from one thread, so it may write that state freely. The
+  /// default does nothing.
+  ///
+  /// @param context The simulation context for the current time step.
+  virtual void beginStep(const behaviour::Context &context) {}
+
+  /// @brief Whether `execute` may run for several drones at the same time.
+  ///
+  /// The `Sim` only spreads the behaviour phase of a step across threads when
+  /// this returns true. Behaviours that opt in must only read shared state,
+  /// write their result through `Drone::commandVelocity`, and must not touch
+  /// the `b2World` other than through queries such as ray casts.
+  virtual bool supportsParallelExecution() const { return false; }
+
+  /// @brief Creates a new instance of this behaviour with the same parameter
+  /// values and none of its per-drone state.
+  ///
+  /// The `behaviour::Registry` uses this to make new instances of behaviours
+  /// that were registered as an instance rather than a factory. Behaviours
+  /// that keep per-drone state should override this or be registered with a
+  /// factory. The default returns null, in which case every `Sim` uses the
+  /// registered instance itself.
+  ///
+  /// @return The new instance, or null if the behaviour cannot be cloned.
+  virtual std::unique_ptr<Behaviour> clone() const { return nullptr; }
+
   /// @brief Retrieves a map of parameter names to their settings as described
   /// in `ParameterDefinition`. This is used in order to dynamically change
   /// behaviour parameters on the fly.
@@ -58,6 +109,50 @@ class Behaviour {
   /// context-specific cleanup.
   virtual void clean(const std::vector<std::unique_ptr<Drone>> &drones) {}
 
+  /// @brief Writes the state the behaviour keeps between steps to a
+  /// checkpoint.
+  ///
+  /// `Sim::saveCheckpoint` calls this between steps. Behaviours that keep
+  /// per-drone or other state from one step to the next should write all of
+  /// it, referring to drones by their index in `drones`, so that `loadState`
+  /// can carry on exactly where the behaviour left off. The default writes
+  /// nothing.
+  ///
+  /// @param drones List of all drones in the simulation.
+  /// @param out Receives the state.
+  virtual void saveState(const std::vector<std::unique_ptr<Drone>> &drones,
+                         CheckpointWriter &out) const {}
+
+  /// @brief Restores the state written by `saveState`.
+  ///
+  /// `Sim::loadCheckpoint` calls this on a cleaned behaviour, once the drones
+  /// themselves have been restored. The default reads nothing.
+  ///
+  /// @param drones List of all drones in the simulation, in the same order as
+  /// when the state was saved.
+  /// @param in The state written by `saveState`.
+  virtual void loadState(const std::vector<std::unique_ptr<Drone>> &drones,
+                         CheckpointReader &in) {}
+
+  /// @brief Reads the state written by `saveState` as `loadState` would,
+  /// throwing if it cannot, without changing anything.
+  ///
+  /// `Sim::loadCheckpoint` and `Sim::fork` call this before they restore
+  /// anything, so that state the behaviour cannot read leaves the simulation
+  /// as it was. The default reads the state into a copy made by `clone`, if
+  /// the behaviour has one. Behaviours whose `loadState` changes more than
+  /// the behaviour itself, such as by creating bodies in the world, must
+  /// override this to read their state without doing so.
+  ///
+  /// @param drones List of all drones in the simulation.
+  /// @param in The state written by `saveState`.
+  virtual void checkState(const std::vector<std::unique_ptr<Drone>> &drones,
+                          CheckpointReader &in) const {
+    if (const std::unique_ptr<Behaviour> trial = clone()) {
+      trial->loadState(drones, in);
+    }
+  }
+
   void setParameters(const std::unordered_map<std::string, float> &parameters);
 
   void setParameters(
@@ -78,6 +173,15 @@ class Behaviour {
   /// @return A vector indicating the direction to steer to avoid the drones.
   static b2Vec2 avoidDrones(const std::vector<b2Body *> &neighbours, const Drone &currentDrone);
 
+  /// @brief Calculates a vector to avoid drones in the vicinity, looking them
+  /// up through the simulation context instead of a list of bodies.
+  ///
+  /// @param context The simulation context for the current time step.
+  /// @param currentDrone Reference to the current drone.
+  /// @return A vector indicating the direction to steer to avoid the drones.
+  static b2Vec2 avoidDrones(const behaviour::Context &context,
+                            const Drone &currentDrone);
+
   /// @brief Calculates a vector to avoid nearby obstacles.
   ///
   /// @param obstaclePoints List of points representing obstacles.
@@ -98,6 +202,21 @@ class Behaviour {
   /// @param currentDrone Reference to the current drone.
   /// @param callback Raycast callback to handle detection results.
   static void performRayCasting(const Drone &currentDrone, RayCastCallback &callback);
+
+  /// @brief Finds obstacle points within the drone's obstacle view range.
+  ///
+  /// Uses the obstacle field in `context` when there is one that covers the
+  /// view range, which costs a fixed handful of lookups per drone. Otherwise
+  /// falls back to `performRayCasting`. Either way the result can be passed
+  /// straight to `avoidObstacles`.
+  ///
+  /// @param context The simulation context for the current time step.
+  /// @param currentDrone Reference to the current drone.
+  /// @param obstaclePoints Receives the obstacle points. The vector is
+  /// cleared first.
+  static void findObstaclePoints(const behaviour::Context &context,
+                                 const Drone &currentDrone,
+                                 std::vector<b2Vec2> &obstaclePoints);
 };
 
 // }  // namespace behaviours
@@ -0,0 +1,111 @@
+/// @file context.h
+/// @brief Contains the `Context` class, the per-step view of the simulation
+/// handed to behaviours.
+#ifndef SWARM_SIM_BEHAVIOURS_CONTEXT_H
+#define SWARM_SIM_BEHAVIOURS_CONTEXT_H
+
+#include <box2d/box2d.h>
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "salsa/entity/drone_snapshot.h"
+#include "salsa/utils/obstacle_field.h"
+#include "salsa/utils/rng.h"
+#include "salsa/utils/spatial_grid.h"
+
+namespace salsa {
+
+class Drone;
+
+namespace behaviour {
+
+/// @brief Read-only view of the simulation for a single time step.
+///
+/// The `Sim` builds a neighbour grid over the drone positions once per step
+/// and passes it to every behaviour through this class, so that neighbourhood
+/// lookups do not need to scan every drone in the swarm. When no grid is
+/// available, for example when a drone is updated on its own, queries fall
+/// back to a linear scan and return the same results.
+///
+/// The context also carries the obstacle field of the current map, if there
+/// is one, which behaviours can use in place of ray casting, and a
+/// structure-of-arrays snapshot of the swarm for behaviours that want to read
+/// neighbour state without going through each `Drone`.
+///
+/// Behaviours that need random numbers draw them from `rng`, which gives each
+/// drone a stream of its own, so a run is repeatable from its seed however
+/// many threads it uses.
+class Context {
+ private:
+  const std::vector<std::unique_ptr<Drone>> &drones_;
+  const SpatialGrid *neighbour_grid_;
+  const ObstacleField *obstacle_field_;
+  const DroneSnapshot *snapshot_;
+  Rng *drone_rngs_;
+
+ public:
+  /// @brief Creates a context over a set of drones.
+  /// @param drones All drones in the simulation.
+  /// @param neighbour_grid Grid built over the positions of `drones`, in the
+  /// same order. May be null, in which case queries scan every drone.
+  /// @param obstacle_field Distance field over the static obstacles of the
+  /// world. May be null.
+  /// @param snapshot Snapshot of `drones` taken at the start of the step, in
+  /// the same order. May be null.
+  /// @param drone_rngs One random number stream for each of `drones`, in the
+  /// same order. May be null, in which case `rng` falls back to a stream of
+  /// the calling thread that is seeded at random.
+  explicit Context(const std::vector<std::unique_ptr<Drone>> &drones,
+                   const SpatialGrid *neighbour_grid = nullptr,
+                   const ObstacleField *obstacle_field = nullptr,
+                   const DroneSnapshot *snapshot = nullptr,
+                   Rng *drone_rngs = nullptr)
+      : drones_(drones),
+        neighbour_grid_(neighbour_grid),
+        obstacle_field_(obstacle_field),
+        snapshot_(snapshot),
+        drone_rngs_(drone_rngs) {}
+
+  /// @brief Finds every drone within `radius` of `centre`.
+  /// @param centre The centre of the query.
+  /// @param radius The query radius.
+  /// @param out Receives the drones found, in the same order as they appear
+  /// in `drones()`. The vector is cleared first.
+  void queryRadius(const b2Vec2 &centre, float radius,
+                   std::vector<Drone *> &out) const;
+
+  /// @brief Finds every drone within `radius` of `centre`, returning their
+  /// indices into `drones()` and `snapshot()`.
+  /// @param centre The centre of the query.
+  /// @param radius The query radius.
+  /// @param out Receives the indices found, in ascending order. The vector is
+  /// cleared first.
+  void queryRadius(const b2Vec2 &centre, float radius,
+                   std::vector<int> &out) const;
+
+  /// @brief Finds the `k` drones closest to `centre`.
+  /// @param centre The centre of the query.
+  /// @param k The maximum number of drones to return.
+  /// @param out Receives the drones found, closest first. The vector is
+  /// cleared first.
+  void queryNearest(const b2Vec2 &centre, std::size_t k,
+                    std::vector<Drone *> &out) const;
+
+  /// @brief Returns the random number stream of `drone`.
+  ///
+  /// Only the thread running `drone` may draw from its stream, which is what
+  /// `Behaviour::execute` does when it draws for the drone it was given.
+  Rng &rng(const Drone &drone) const;
+
+  const std::vector<std::unique_ptr<Drone>> &drones() const { return drones_; }
+  const SpatialGrid *neighbour_grid() const { return neighbour_grid_; }
+  const ObstacleField *obstacle_field() const { return obstacle_field_; }
+  const DroneSnapshot *snapshot() const { return snapshot_; }
+};
+
+}  // namespace behaviour
+}  // namespace salsa
+
+#endif  // SWARM_SIM_BEHAVIOURS_CONTEXT_H
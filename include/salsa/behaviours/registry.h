@@ -3,7 +3,11 @@
 #ifndef SWARM_SIM_UTILS_BEHAVIOUR_REGISTRY_H
 #define SWARM_SIM_UTILS_BEHAVIOUR_REGISTRY_H
 
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -17,10 +21,29 @@ namespace behaviour {
 /// This class uses the Singleton design pattern to ensure that there
 /// is only one instance of the Registry throughout the application. It provides
 /// methods to add, retrieve, and list behaviours dynamically at runtime.
+///
+/// Each behaviour is registered with a factory. `create` uses it to build a
+/// fresh instance for every `Sim`, so that simulations never share per-drone
+/// state and can step at the same time without locking. The registry also
+/// keeps one prototype per name, whose parameter values are copied into
+/// every new instance. Editing the prototype's parameters therefore changes
+/// the defaults for simulations created afterwards.
 class Registry {
+ public:
+  /// @brief Creates a new instance of a behaviour.
+  using Factory = std::function<std::unique_ptr<Behaviour>()>;
+
  private:
-  std::unordered_map<std::string, std::unique_ptr<Behaviour>>
+  struct Entry {
+    Factory factory;  ///< Builds new instances, empty if there is none.
+    std::unique_ptr<Behaviour> prototype;  ///< Holds the default parameters.
+  };
+
+  std::unordered_map<std::string, Entry>
       behaviours_;  ///< Stores behaviours keyed by their names.
+  /// Guards `behaviours_`. Simulations set up on several threads at once
+  /// only ever take it shared.
+  mutable std::shared_mutex mutex_;
 
  public:
   /// @brief Returns the singleton instance of the Registry.
@@ -32,22 +55,101 @@ class Registry {
 
   /// @brief Adds a Behaviour instance to the registry.
   ///
+  /// New instances are made with `Behaviour::clone`. If the behaviour does
+  /// not support cloning, `create` returns null and simulations share this
+  /// instance instead.
+  ///
   /// @param name The name key under which the Behaviour will be stored.
   /// @param Behaviour Pointer to the Behaviour instance to be stored.
   bool add(const std::string &name, std::unique_ptr<Behaviour> Behaviour) {
-    behaviours_[name] = std::move(Behaviour);
+    std::unique_lock lock(mutex_);
+    behaviours_[name] = Entry{nullptr, std::move(Behaviour)};
+    return true;
+  }
+
+  /// @brief Adds a Behaviour factory to the registry.
+  ///
+  /// The factory is called once straight away to make the prototype, and
+  /// again by `create` for every new instance.
+  ///
+  /// @param name The name key under which the Behaviour will be stored.
+  /// @param factory Function returning a new instance of the Behaviour.
+  bool add(const std::string &name, Factory factory) {
+    std::unique_ptr<Behaviour> prototype = factory();
+    std::unique_lock lock(mutex_);
+    behaviours_[name] = Entry{std::move(factory), std::move(prototype)};
     return true;
   }
 
   /// @brief Retrieves a Behaviour by name.
   ///
+  /// This is the registered prototype. Simulations get their own instances
+  /// through `create`, so this is mainly useful for reading and editing the
+  /// default parameters.
+  ///
   /// @param name The name key of the Behaviour to retrieve.
   /// @return Pointer to the Behaviour, or nullptr if not found.
   Behaviour *behaviour(const std::string &name) {
-    if (behaviours_.find(name) != behaviours_.end()) {
-      return behaviours_[name].get();
+    std::shared_lock lock(mutex_);
+    const auto it = behaviours_.find(name);
+    return it != behaviours_.end() ? it->second.prototype.get() : nullptr;
+  }
+
+  /// @brief Creates a new instance of a Behaviour, with the prototype's
+  /// current parameter values.
+  ///
+  /// @param name The name key of the Behaviour to create.
+  /// @return The new instance, or nullptr if the name is not registered or
+  /// the behaviour can only be shared.
+  std::unique_ptr<Behaviour> create(const std::string &name) const {
+    std::shared_lock lock(mutex_);
+    const auto it = behaviours_.find(name);
+    if (it == behaviours_.end() || !it->second.prototype) {
+      return nullptr;
+    }
+    const Entry &entry = it->second;
+    if (!entry.factory) {
+      return entry.prototype->clone();
     }
-    return nullptr;
+    std::unique_ptr<Behaviour> instance = entry.factory();
+    if (instance) {
+      instance->setParameters(entry.prototype->getParameterValues());
+    }
+    return instance;
+  }
+
+  /// @brief Creates a new instance of a Behaviour and then applies
+  /// `parameters` to it. Values are copied, so nothing else is affected.
+  ///
+  /// @param name The name key of the Behaviour to create.
+  /// @param parameters Parameter values to apply, keyed by name. Unknown
+  /// names are ignored.
+  /// @return The new instance, or nullptr if `create(name)` would return
+  /// nullptr.
+  std::unique_ptr<Behaviour> create(
+      const std::string &name,
+      const std::unordered_map<std::string, float> &parameters) const {
+    std::unique_ptr<Behaviour> instance = create(name);
+    if (instance) {
+      instance->setParameters(parameters);
+    }
+    return instance;
+  }
+
+  /// @brief Returns true if `create` makes new instances of the Behaviour,
+  /// rather than it being shared by every simulation.
+  bool createsInstances(const std::string &name) const {
+    {
+      std::shared_lock lock(mutex_);
+      const auto it = behaviours_.find(name);
+      if (it == behaviours_.end()) {
+        return false;
+      }
+      if (it->second.factory) {
+        return true;
+      }
+    }
+    return create(name) != nullptr;
   }
 
   /// @brief Returns a list of all Behaviour names stored in the Registry.
@@ -55,6 +157,7 @@ class Registry {
   /// @return Vector of strings containing the names of all registered
   /// behaviours_.
   std::vector<std::string> behaviour_names() const {
+    std::shared_lock lock(mutex_);
     std::vector<std::string> names;
     for (const auto &pair : behaviours_) {
       names.push_back(pair.first);
@@ -65,7 +168,10 @@ class Registry {
   /// @brief Removes a Behaviour from the Registry.
   /// @param name The name of the Behaviour to remove.
   /// @return True if the Behaviour was removed, false if it was not found.
-  bool remove(const std::string &name) { return behaviours_.erase(name) > 0; }
+  bool remove(const std::string &name) {
+    std::unique_lock lock(mutex_);
+    return behaviours_.erase(name) > 0;
+  }
 
   /// @brief Prevent copy construction
   /// @param rhs The Registry instance intended to copy from
@@ -0,0 +1,162 @@
+/// @file b2_user_settings.h
+/// @brief Box2D settings for salsa, used in place of Box2D's defaults as
+/// Box2D is built with `B2_USER_SETTINGS`.
+///
+/// The settings are Box2D's own, except that every `b2Alloc` goes to the
+/// `WorldAllocator` of the calling thread, if it has one. This is how a `Sim`
+/// keeps track of the memory its world uses. The file is included by Box2D
+/// itself, which is built as C++11, so it keeps to C++11.
+#ifndef SWARM_BOX2D_USER_SETTINGS_H
+#define SWARM_BOX2D_USER_SETTINGS_H
+
+#include <stdarg.h>
+#include <stdint.h>
+
+#include <cstddef>
+
+// Tunable Constants
+
+/// You can use this to change the length scale used by your game.
+/// For example for inches you could use 39.4.
+#define b2_lengthUnitsPerMeter 1.0f
+
+/// The maximum number of vertices on a convex polygon. You cannot increase
+/// this too much because b2BlockAllocator has a maximum object size.
+#define b2_maxPolygonVertices 8
+
+// User data
+
+/// You can define this to inject whatever data you want in b2Body
+struct B2_API b2BodyUserData {
+  b2BodyUserData() { pointer = 0; }
+
+  /// For legacy compatibility
+  uintptr_t pointer;
+};
+
+/// You can define this to inject whatever data you want in b2Fixture
+struct B2_API b2FixtureUserData {
+  b2FixtureUserData() { pointer = 0; }
+
+  /// For legacy compatibility
+  uintptr_t pointer;
+};
+
+/// You can define this to inject whatever data you want in b2Joint
+struct B2_API b2JointUserData {
+  b2JointUserData() { pointer = 0; }
+
+  /// For legacy compatibility
+  uintptr_t pointer;
+};
+
+// Memory Allocation
+
+/// Default allocation functions
+B2_API void *b2Alloc_Default(int32 size);
+B2_API void b2Free_Default(void *mem);
+
+namespace salsa {
+
+/// @brief Where the Box2D allocations made on a thread go.
+///
+/// Set one for the current thread with `WorldAllocationScope`. Blocks are
+/// always given back to the allocator that made them, whichever thread frees
+/// them, so an allocator must outlive its blocks.
+class WorldAllocator {
+ public:
+  /// @brief Returns `bytes` bytes, aligned as `malloc` aligns them.
+  /// @param tag The tag of the scope the allocation was made in.
+  virtual void *allocate(std::size_t bytes, int32 tag) = 0;
+  /// @brief Takes back a block made by `allocate` with the same size and tag.
+  virtual void deallocate(void *block, std::size_t bytes, int32 tag) = 0;
+
+ protected:
+  ~WorldAllocator() = default;
+};
+
+/// @brief The header in front of every block handed to Box2D, recording
+/// where the block has to go back to.
+struct alignas(16) WorldAllocation {
+  WorldAllocator *allocator;  ///< Null for blocks from `b2Alloc_Default`.
+  int32 size;                 ///< Bytes asked for by Box2D.
+  int32 tag;
+};
+
+/// @brief The allocator and tag of the calling thread's Box2D allocations.
+struct WorldAllocationTarget {
+  WorldAllocator *allocator;
+  int32 tag;
+};
+
+inline WorldAllocationTarget &worldAllocationTarget() {
+  static thread_local WorldAllocationTarget target = {nullptr, 0};
+  return target;
+}
+
+/// @brief Sends the Box2D allocations made on this thread to `allocator`,
+/// tagged with `tag`, until the scope ends.
+class WorldAllocationScope {
+ public:
+  WorldAllocationScope(WorldAllocator *allocator, int32 tag)
+      : previous_(worldAllocationTarget()) {
+    worldAllocationTarget().allocator = allocator;
+    worldAllocationTarget().tag = tag;
+  }
+  ~WorldAllocationScope() { worldAllocationTarget() = previous_; }
+
+  WorldAllocationScope(const WorldAllocationScope &) = delete;
+  WorldAllocationScope &operator=(const WorldAllocationScope &) = delete;
+
+ private:
+  WorldAllocationTarget previous_;
+};
+
+}  // namespace salsa
+
+/// Implement this function to use your own memory allocator.
+inline void *b2Alloc(int32 size) {
+  const salsa::WorldAllocationTarget target = salsa::worldAllocationTarget();
+  const std::size_t bytes =
+      sizeof(salsa::WorldAllocation) + static_cast<std::size_t>(size);
+  void *block = target.allocator
+                    ? target.allocator->allocate(bytes, target.tag)
+                    : b2Alloc_Default(static_cast<int32>(bytes));
+  salsa::WorldAllocation *header =
+      static_cast<salsa::WorldAllocation *>(block);
+  header->allocator = target.allocator;
+  header->size = size;
+  header->tag = target.tag;
+  return header + 1;
+}
+
+/// If you implement b2Alloc, you should also implement this function.
+inline void b2Free(void *mem) {
+  if (!mem) {
+    return;
+  }
+  salsa::WorldAllocation *header =
+      static_cast<salsa::WorldAllocation *>(mem) - 1;
+  if (header->allocator) {
+    header->allocator->deallocate(
+        header,
+        sizeof(salsa::WorldAllocation) +
+            static_cast<std::size_t>(header->size),
+        header->tag);
+  } else {
+    b2Free_Default(header);
+  }
+}
+
+/// Default logging function
+B2_API void b2Log_Default(const char *string, va_list args);
+
+/// Implement this to use your own logging.
+inline void b2Log(const char *string, ...) {
+  va_list args;
+  va_start(args, string);
+  b2Log_Default(string, args);
+  va_end(args);
+}
+
+#endif  // SWARM_BOX2D_USER_SETTINGS_H
@@ -0,0 +1,141 @@
+/// @file checkpoint.h
+/// @brief Contains the `CheckpointWriter` and `CheckpointReader` classes,
+/// which write and read the compact binary files used by
+/// `Sim::saveCheckpoint` and `Sim::loadCheckpoint`.
+#ifndef SWARM_SIM_CORE_CHECKPOINT_H
+#define SWARM_SIM_CORE_CHECKPOINT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "salsa/utils/mapped_file.h"
+
+namespace salsa {
+
+/// @brief Header at the start of a checkpoint file. The payload written by a
+/// `CheckpointWriter` follows it.
+struct CheckpointFileHeader {
+  char magic[8];      ///< Always "SALSACKP".
+  uint32_t version;   ///< Format version, currently 2.
+  uint32_t reserved;  ///< Always zero.
+  uint64_t size;      ///< Size of the payload in bytes.
+  uint64_t checksum;  ///< FNV-1a hash of the payload.
+};
+
+/// @brief FNV-1a hash of `size` bytes, which is stable across platforms and
+/// runs, unlike `std::hash`.
+uint64_t checkpointChecksum(const void *data, std::size_t size);
+
+/// @brief Builds the payload of a checkpoint in memory.
+///
+/// Values are appended as their raw bytes, with no padding or tags, so the
+/// reader must read them back in the same order and with the same types.
+/// Strings and arrays are preceded by their length.
+class CheckpointWriter {
+ public:
+  template <typename T>
+  void write(const T &value) {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "Only trivially copyable values can be written directly");
+    append(&value, sizeof(T));
+  }
+
+  void write(const std::string &value) {
+    write<uint64_t>(value.size());
+    append(value.data(), value.size());
+  }
+
+  template <typename T>
+  void writeArray(const T *values, std::size_t count) {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "Only trivially copyable values can be written directly");
+    write<uint64_t>(count);
+    append(values, count * sizeof(T));
+  }
+
+  template <typename T>
+  void write(const std::vector<T> &values) {
+    writeArray(values.data(), values.size());
+  }
+
+  const std::vector<unsigned char> &data() const { return data_; }
+  std::size_t size() const { return data_.size(); }
+  void clear() { data_.clear(); }
+
+  /// @brief Writes the header and payload to `path`.
+  ///
+  /// The file is written under a temporary name and renamed into place, so a
+  /// crash while writing leaves any earlier checkpoint at `path` intact.
+  /// @throws std::runtime_error If the file cannot be written.
+  void save(const std::filesystem::path &path) const;
+
+ private:
+  std::vector<unsigned char> data_;
+
+  void append(const void *data, std::size_t size) {
+    const auto *bytes = static_cast<const unsigned char *>(data);
+    data_.insert(data_.end(), bytes, bytes + size);
+  }
+};
+
+/// @brief Reads back, in order, the values written by a `CheckpointWriter`.
+class CheckpointReader {
+ public:
+  /// @brief Reads a payload held in memory, which must outlive the reader.
+  CheckpointReader(const unsigned char *data, std::size_t size);
+
+  /// @brief Maps the checkpoint file at `path` and checks its header and
+  /// checksum.
+  /// @throws std::runtime_error If the file cannot be read, or is not a
+  /// complete checkpoint.
+  explicit CheckpointReader(const std::filesystem::path &path);
+
+  template <typename T>
+  T read() {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "Only trivially copyable values can be read directly");
+    T value;
+    std::memcpy(&value, take(sizeof(T)), sizeof(T));
+    return value;
+  }
+
+  std::string readString();
+
+  template <typename T>
+  std::vector<T> readVector() {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "Only trivially copyable values can be read directly");
+    const uint64_t count = read<uint64_t>();
+    if (count > remaining() / sizeof(T)) {
+      throw std::runtime_error("Checkpoint is truncated");
+    }
+    std::vector<T> values(count);
+    if (count > 0) {
+      std::memcpy(values.data(), take(count * sizeof(T)), count * sizeof(T));
+    }
+    return values;
+  }
+
+  /// @brief Number of payload bytes not read yet.
+  std::size_t remaining() const { return size_ - offset_; }
+
+ private:
+  MappedFile file_;
+  const unsigned char *data_ = nullptr;
+  std::size_t size_ = 0;
+  std::size_t offset_ = 0;
+
+  /// Returns the next `size` bytes and moves past them.
+  /// @throws std::runtime_error If fewer than `size` bytes are left.
+  const unsigned char *take(std::size_t size);
+};
+
+}  // namespace salsa
+
+#endif  // SWARM_SIM_CORE_CHECKPOINT_H
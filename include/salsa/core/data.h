@@ -6,7 +6,9 @@
 
 #include <box2d/box2d.h>
 
+#include <filesystem>
 #include <memory>
+#include <string>
 
 #include "nlohmann/json.hpp"
 #include "spdlog/async.h"
@@ -27,37 +29,51 @@ class Observer {
   virtual void update(const nlohmann::json& message) = 0;
 };
 
-/// @brief Singleton Logger class for asynchronous simulation logging.
+/// @brief Logger class for simulation data.
+///
+/// Each `Sim` owns its own `Logger`, so simulations running on different
+/// threads never share a file. Messages are written on the thread that calls
+/// `update`, which is the thread stepping the simulation, and the file is
+/// flushed when the logger is destroyed.
 class Logger final : public Observer {
  private:
-  static std::shared_ptr<spdlog::logger>
-      logger_;  ///< Static logger shared across instances.
-
-  /// @brief Private constructor for the Logger class.
-  Logger();
+  std::shared_ptr<spdlog::logger> logger_;  ///< Writes to the current file.
+  std::string log_file_;                    ///< The current file.
 
   /// @brief Initialise or re-initialize the logger with a specified file sink
-  /// @param log_file The file to output log data to
-  static void init_logger(const std::string& log_file);
+  /// @param log_file The file to output log data to, relative to the testbed
+  /// results directory.
+  void init_logger(const std::string& log_file);
 
  public:
+  /// @brief Creates a logger that writes into `log_file`.
+  /// @param log_file The file to output log data to, relative to the testbed
+  /// results directory.
+  explicit Logger(const std::string& log_file = "default_log.log");
+
   // Delete copy constructor and assignment operator
   Logger(const Logger&) = delete;
   Logger& operator=(const Logger&) = delete;
 
-  /// @brief Destructor for Logger class. Shuts down the logger.
+  /// @brief Destructor for Logger class. Flushes the current file.
   ~Logger() override;
 
-  /// @brief Get the singleton instance of the logger
-  /// @return Reference to the singleton instance of the logger
-  static Logger& getInstance();
-
-  /// @brief Switches the file to log into. Closes the current file and logger
-  /// and creates a new logger, with its output set to the new file.
+  /// @brief Switches the file to log into. Flushes and closes the current
+  /// file and starts writing to the new one.
   ///
   /// Internally, just calls `init_logger` with the new log file.
   /// @param new_log_file
-  static void switch_log_file(const std::string& new_log_file);
+  void switch_log_file(const std::string& new_log_file);
+
+  /// @brief Writes any buffered messages to the file.
+  void flush();
+
+  /// @brief Resolves a file name relative to the testbed results directory,
+  /// which is where every log and trajectory file is written.
+  static std::filesystem::path results_path(const std::string& file);
+
+  /// @brief Returns the file currently being logged into.
+  const std::string& log_file() const { return log_file_; }
 
   /// @brief Update the log with a new message.
   ///
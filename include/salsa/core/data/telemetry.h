@@ -0,0 +1,120 @@
+/// @file telemetry.h
+/// @brief Contains the `TelemetrySink` class, which takes typed drone samples
+/// from the simulation thread and writes them out on a background thread.
+#ifndef SWARM_SIM_CORE_DATA_TELEMETRY_H
+#define SWARM_SIM_CORE_DATA_TELEMETRY_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "salsa/core/data.h"
+#include "salsa/core/data/trajectory.h"
+#include "salsa/utils/spsc_ring.h"
+
+namespace salsa {
+
+/// @brief Moves drone samples off the simulation thread and into a
+/// trajectory file.
+///
+/// `record` copies a `TrajectoryRecord` into a preallocated lock-free ring
+/// and returns; a writer thread owned by the sink drains the ring into a
+/// `TrajectoryWriter`. Once the sink is open, recording a sample does no heap
+/// allocation and no I/O on the calling thread. If the writer falls so far
+/// behind that the ring fills up, `record` waits for space rather than
+/// dropping samples.
+///
+/// Only one thread may call `record` at a time, which for a `Sim` is the
+/// thread stepping it.
+class TelemetrySink {
+ public:
+  /// Default number of samples the ring holds.
+  static constexpr std::size_t kDefaultCapacity = 1 << 16;
+
+  /// @brief Creates a closed sink.
+  /// @param capacity Number of samples the ring holds, rounded up to a power
+  /// of two.
+  explicit TelemetrySink(std::size_t capacity = kDefaultCapacity);
+
+  /// @brief Closes the sink. See `close`.
+  ~TelemetrySink();
+
+  TelemetrySink(const TelemetrySink &) = delete;
+  TelemetrySink &operator=(const TelemetrySink &) = delete;
+
+  /// @brief Opens `path` (see `TrajectoryWriter::open`) and starts the writer
+  /// thread. A sink that is already open is closed first.
+  /// @throws std::runtime_error If the file cannot be opened.
+  void open(const std::string &path, const std::string &metadata);
+
+  /// @brief Queues one sample to be written. Does nothing if the sink is not
+  /// open.
+  void record(const TrajectoryRecord &sample) {
+    if (!open_) {
+      return;
+    }
+    if (!ring_.try_push(sample)) {
+      waitToPush(sample);
+    }
+  }
+
+  /// @brief Writes out every queued sample, stops the writer thread and
+  /// closes the file. Does nothing if the sink is not open.
+  void close();
+
+  bool is_open() const { return open_; }
+
+  /// @brief Whether every sample written so far reached the file. See
+  /// `TrajectoryWriter::good`. Only read it once the sink is closed, as the
+  /// writer thread owns the file until then.
+  bool good() const { return writer_.good(); }
+
+  /// @brief Sends every sample to `observer` as well, as the json message
+  /// `Entity::notifyAll` would have built for it.
+  ///
+  /// This is the old observer path kept as an opt-in adapter: the messages
+  /// are built on the writer thread, so they do not slow the simulation, but
+  /// they allocate for every sample. `observer` is only ever called from the
+  /// writer thread. Observers may be added at any time.
+  void addObserver(std::shared_ptr<Observer> observer);
+
+  /// @brief Number of samples the writer thread has passed to the file so
+  /// far.
+  uint64_t records_written() const {
+    return written_.load(std::memory_order_acquire);
+  }
+
+  /// @brief Number of times `record` found the ring full and had to wait for
+  /// the writer.
+  uint64_t stalls() const { return stalls_; }
+
+ private:
+  /// Most samples the writer takes from the ring at once.
+  static constexpr std::size_t kBatchSize = 1024;
+
+  SpscRing<TrajectoryRecord> ring_;
+  TrajectoryWriter writer_;
+  std::thread thread_;
+  std::atomic<bool> stopping_{false};
+  bool open_ = false;
+  std::atomic<uint64_t> written_{0};
+  uint64_t stalls_ = 0;
+
+  std::mutex observers_mutex_;
+  std::vector<std::shared_ptr<Observer>> observers_;
+
+  void waitToPush(const TrajectoryRecord &sample);
+  void writerLoop();
+  /// Writes everything currently in the ring. Returns the number written.
+  std::size_t drain(TrajectoryRecord *batch);
+  void notifyObservers(const TrajectoryRecord *batch, std::size_t count);
+};
+
+}  // namespace salsa
+
+#endif  // SWARM_SIM_CORE_DATA_TELEMETRY_H
@@ -0,0 +1,164 @@
+/// @file trajectory.h
+/// @brief Contains the binary trajectory file format, with the
+/// `TrajectoryWriter` that produces it and the memory-mapped
+/// `TrajectoryReader` that reads it back.
+#ifndef SWARM_SIM_CORE_DATA_TRAJECTORY_H
+#define SWARM_SIM_CORE_DATA_TRAJECTORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "salsa/utils/mapped_file.h"
+
+namespace salsa {
+
+struct DroneSnapshot;
+
+/// @brief One sample of one drone. Records are written back to back, so a
+/// trajectory file is an array of these after its header.
+struct TrajectoryRecord {
+  float time;  ///< Simulation time of the sample.
+  int32_t id;  ///< Drone identifier.
+  float x;     ///< Position x.
+  float y;     ///< Position y.
+  float vx;    ///< Linear velocity x.
+  float vy;    ///< Linear velocity y.
+};
+
+static_assert(sizeof(TrajectoryRecord) == 24,
+              "TrajectoryRecord is part of the file format");
+static_assert(std::is_trivially_copyable<TrajectoryRecord>::value,
+              "TrajectoryRecord is written with a raw copy");
+
+/// @brief Fixed-size header at the start of every trajectory file.
+///
+/// The header is followed by `metadata_size` bytes of JSON describing the run
+/// (the same fields as the first line of `result.log`), then padding up to
+/// `records_offset`, then the records. All values are little-endian, which
+/// is the byte order of every platform the simulator builds on.
+struct TrajectoryFileHeader {
+  char magic[8];            ///< Always `kTrajectoryMagic`.
+  uint32_t version;         ///< Format version, `kTrajectoryVersion`.
+  uint32_t record_size;     ///< `sizeof(TrajectoryRecord)`.
+  uint64_t metadata_size;   ///< Length of the JSON metadata in bytes.
+  uint64_t records_offset;  ///< Offset of the first record, 8-byte aligned.
+};
+
+static_assert(sizeof(TrajectoryFileHeader) == 32,
+              "TrajectoryFileHeader is part of the file format");
+
+constexpr char kTrajectoryMagic[8] = {'S', 'A', 'L', 'S', 'A', 'T', 'R', 'J'};
+constexpr uint32_t kTrajectoryVersion = 1;
+
+/// @brief Writes drone samples to a trajectory file.
+///
+/// Records are buffered and written in blocks. Writing a sample is a copy
+/// into the buffer, with no formatting or allocation.
+class TrajectoryWriter {
+ public:
+  /// Number of records buffered before they are written to the file.
+  static constexpr std::size_t kBufferRecords = 4096;
+
+  TrajectoryWriter() = default;
+
+  /// @brief Creates a writer and opens `path`. See `open`.
+  TrajectoryWriter(const std::string &path, const std::string &metadata);
+
+  /// @brief Closes the file, writing out anything still buffered.
+  ~TrajectoryWriter();
+
+  TrajectoryWriter(const TrajectoryWriter &) = delete;
+  TrajectoryWriter &operator=(const TrajectoryWriter &) = delete;
+
+  /// @brief Creates (or truncates) `path` and writes the header. Any file
+  /// that was already open is closed first. Missing parent directories are
+  /// created.
+  /// @param path The file to write.
+  /// @param metadata JSON describing the run, stored after the header.
+  /// @throws std::runtime_error If the file cannot be opened, or its header
+  /// cannot be written.
+  void open(const std::string &path, const std::string &metadata);
+
+  /// @brief Appends one record.
+  void write(const TrajectoryRecord &record) {
+    buffer_.push_back(record);
+    if (buffer_.size() >= kBufferRecords) {
+      flush();
+    }
+  }
+
+  /// @brief Appends one record per drone in `snapshot`, all at `time`.
+  void write(float time, const DroneSnapshot &snapshot);
+
+  /// @brief Writes any buffered records to the file. A failed write is
+  /// reported by `good`.
+  void flush();
+
+  /// @brief Flushes and closes the file. Does nothing if it is not open.
+  void close();
+
+  bool is_open() const { return file_ != nullptr; }
+
+  /// @brief Whether every record since the file was opened reached it, and
+  /// the file was closed cleanly. Still answers after `close`, until the
+  /// next `open`. A file written by a writer that is not good may be cut
+  /// short, such as when the disk filled up.
+  bool good() const { return !failed_; }
+
+  /// @brief Number of records written since the file was opened, including
+  /// those still buffered.
+  uint64_t records_written() const { return written_ + buffer_.size(); }
+
+ private:
+  std::FILE *file_ = nullptr;
+  std::vector<TrajectoryRecord> buffer_;
+  uint64_t written_ = 0;
+  bool failed_ = false;
+};
+
+/// @brief Read-only, memory-mapped view of a trajectory file.
+///
+/// The records are used in place, straight from the mapping, so opening a
+/// file costs the same whatever its size and pages are only read as they are
+/// touched.
+class TrajectoryReader {
+ public:
+  /// @brief Maps `path` and checks its header.
+  /// @throws std::runtime_error If the file cannot be mapped or is not a
+  /// trajectory file this version understands.
+  explicit TrajectoryReader(const std::string &path);
+
+  TrajectoryReader(const TrajectoryReader &) = delete;
+  TrajectoryReader &operator=(const TrajectoryReader &) = delete;
+
+  const TrajectoryFileHeader &header() const { return *header_; }
+
+  /// @brief The JSON metadata stored with the run.
+  std::string metadata() const;
+
+  /// @brief Number of complete records in the file.
+  std::size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  const TrajectoryRecord *records() const { return records_; }
+  const TrajectoryRecord *begin() const { return records_; }
+  const TrajectoryRecord *end() const { return records_ + size_; }
+  const TrajectoryRecord &operator[](std::size_t i) const {
+    return records_[i];
+  }
+
+ private:
+  MappedFile file_;
+  const unsigned char *data_ = nullptr;
+  const TrajectoryFileHeader *header_ = nullptr;
+  const TrajectoryRecord *records_ = nullptr;
+  std::size_t size_ = 0;
+};
+
+}  // namespace salsa
+
+#endif  // SWARM_SIM_CORE_DATA_TRAJECTORY_H
@@ -8,10 +8,12 @@
 #include <exception>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <string>
 
 #include "logger.h"
 #include "nlohmann/json.hpp"
+#include "salsa/utils/obstacle_field.h"
 #if defined(_WIN32)
 #include <windows.h>
 #elif defined(__linux__)
@@ -29,6 +31,8 @@ struct Map {
   float height;
   b2Vec2 drone_spawn_point;
   b2World *world;
+  /// Distance field over the static obstacles in `world`, built on load.
+  std::shared_ptr<const ObstacleField> obstacle_field;
 };
 
 /// @brief Gets the absolute path to the executable, on WIN32, Linux, and Apple
@@ -37,10 +41,20 @@ struct Map {
 std::filesystem::path getExecutablePath();
 
 /// @brief Loads a map from a JSON file. The map must be stored in
-/// `testbed/maps`
+/// `testbed/maps`. An `ObstacleField` is built from the static bodies of the
+/// map once they have been created.
 /// @param new_map_name The map name of the json file, excluding .json
+/// @param world The world to create the map's bodies in. If null, a new
+/// world is made, which the caller must delete.
 /// @return A struct created from parsing the JSON file.
-Map load(const char *new_map_name);
+Map load(const char *new_map_name, b2World *world = nullptr);
+
+/// @brief Copies a body, with its fixtures, into another world. User data is
+/// not copied.
+/// @param body The body to copy.
+/// @param world The world to create the copy in.
+/// @return The copy.
+b2Body *copyBody(const b2Body &body, b2World &world);
 
 /// @brief Loads all maps from the `testbed/maps` directory.
 void loadAll();
@@ -0,0 +1,241 @@
+/// @file memory.h
+/// @brief Contains the `MemoryAccount` class, which counts the Box2D memory
+/// of a `Sim`, the `WorldArena` it may take that memory from, and the
+/// `MemoryReport` built from it.
+#ifndef SWARM_SIM_CORE_MEMORY_H
+#define SWARM_SIM_CORE_MEMORY_H
+
+#include <box2d/box2d.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+
+namespace salsa {
+
+/// @brief What a Box2D allocation was made for, going by the part of the
+/// simulation that asked Box2D for it.
+///
+/// Box2D hands out bodies, fixtures and contacts from blocks of its own, so
+/// a block is put down to whatever first needed it, even if it goes on to
+/// hold other things.
+enum class MemoryCategory : int32 {
+  Map,      ///< The world itself and the map's static bodies.
+  Drones,   ///< Drone bodies and fixtures.
+  Targets,  ///< Target bodies and fixtures.
+  Step,     ///< Contacts, islands and the broad phase, grown while stepping.
+  Other,    ///< Anything else, such as restoring a checkpoint.
+};
+
+constexpr std::size_t kMemoryCategoryCount =
+    static_cast<std::size_t>(MemoryCategory::Other) + 1;
+
+/// @brief Bytes in use, now and at most, for one category.
+struct MemoryUsage {
+  std::size_t bytes = 0;       ///< Bytes in use now.
+  std::size_t peak_bytes = 0;  ///< Most bytes in use at once.
+  std::size_t blocks = 0;      ///< Blocks in use now.
+};
+
+/// @brief Memory for one Box2D world, taken from the system in large chunks
+/// and given back all at once.
+///
+/// Blocks are cut from the current chunk one after another. A freed block is
+/// kept on a free list for its size class and handed out again for the next
+/// block of that class, so a world that frees and allocates the same sizes
+/// over and over, as Box2D's island solver does every step once its stack is
+/// full, does not grow. There are eight size classes to each doubling, so a
+/// block is at most an eighth bigger than asked for.
+///
+/// Nothing goes back to the system until `release`, which frees the chunks
+/// without looking at the blocks in them. An arena is not thread safe: it
+/// belongs to one simulation, whose world is only changed by one thread at
+/// a time, so simulations on different threads never wait for each other.
+class WorldArena {
+ public:
+  /// Size of the first chunk. Each chunk after it is twice the size of the
+  /// one before, up to `kMaxChunkBytes`.
+  static constexpr std::size_t kFirstChunkBytes = 64 * 1024;
+  static constexpr std::size_t kMaxChunkBytes = 4 * 1024 * 1024;
+
+  WorldArena() = default;
+  ~WorldArena() { release(); }
+
+  WorldArena(const WorldArena &) = delete;
+  WorldArena &operator=(const WorldArena &) = delete;
+
+  /// @brief Returns a block of at least `bytes` bytes, aligned as `malloc`
+  /// aligns them.
+  void *allocate(std::size_t bytes);
+  /// @brief Keeps a block for reuse. `bytes` is the size it was asked for
+  /// with.
+  void deallocate(void *block, std::size_t bytes);
+  /// @brief Gives every chunk back to the system, which ends every block.
+  void release();
+
+  /// @brief Bytes taken from the system.
+  std::size_t reservedBytes() const { return reserved_bytes_; }
+  std::size_t chunkCount() const { return chunks_.size(); }
+
+  /// @brief Bytes set aside for a block of `bytes` bytes: the top of its
+  /// size class.
+  static std::size_t classBytes(std::size_t bytes);
+
+ private:
+  struct FreeBlock {
+    FreeBlock *next;
+  };
+
+  std::vector<void *> chunks_;
+  char *cursor_ = nullptr;  ///< Start of the unused part of the last chunk.
+  char *end_ = nullptr;
+  std::size_t next_chunk_bytes_ = kFirstChunkBytes;
+  std::size_t reserved_bytes_ = 0;
+  /// Freed blocks of each size class.
+  std::vector<FreeBlock *> free_lists_;
+
+  void *allocateChunk(std::size_t bytes);
+  static std::size_t classIndex(std::size_t class_bytes);
+};
+
+/// @brief Where a `MemoryAccount` gets its memory from.
+enum class MemoryBacking {
+  Heap,   ///< `malloc`, block by block.
+  Arena,  ///< A `WorldArena` of the account's own.
+};
+
+class MemoryAccount;
+
+/// @brief Gives up the owner's hold on a `MemoryAccount`.
+struct MemoryAccountRelease {
+  void operator()(MemoryAccount *account) const;
+};
+
+/// @brief Counts the Box2D memory allocated for a simulation, by category.
+///
+/// Box2D allocates through `b2Alloc`, which goes to the `WorldAllocator` of
+/// the calling thread (see `b2_user_settings.h`). A `Sim` makes its account
+/// that allocator, with a `WorldAllocationScope`, whenever it works on its
+/// world, so the count covers exactly the memory of that world. Counts may be
+/// read from any thread.
+///
+/// Blocks still in use keep the account alive, so a world may outlive the
+/// simulation that accounted for it. The account is deleted once its owner
+/// has let it go and the last of its blocks has been freed.
+///
+/// An account backed by an arena can also `release` every block at once,
+/// which is how a simulation frees a world it owns without taking it apart
+/// body by body.
+class MemoryAccount final : public WorldAllocator {
+ public:
+  using Handle = std::unique_ptr<MemoryAccount, MemoryAccountRelease>;
+
+  /// @brief Creates an account, held by the returned handle.
+  static Handle create(MemoryBacking backing = MemoryBacking::Heap);
+
+  void *allocate(std::size_t bytes, int32 tag) override;
+  void deallocate(void *block, std::size_t bytes, int32 tag) override;
+
+  MemoryUsage usage(MemoryCategory category) const;
+  /// @brief Every category together. The peak is the most in use at once,
+  /// not the sum of the categories' peaks.
+  MemoryUsage total() const;
+
+  /// @brief Starts the peaks again from what is in use now.
+  void resetPeaks();
+
+  MemoryBacking backing() const {
+    return arena_ ? MemoryBacking::Arena : MemoryBacking::Heap;
+  }
+  /// @brief Frees every block at once, if the account is backed by an arena,
+  /// and counts them as freed. Nothing may use or free the blocks after
+  /// this. Does nothing for an account backed by the heap.
+  void release();
+  /// @brief Bytes the arena has taken from the system, or zero without one.
+  /// Read it from the thread that works on the simulation.
+  std::size_t reservedBytes() const;
+
+  /// @brief Sends the Box2D allocations made on this thread to `account`,
+  /// under `category`, until the scope ends. A null account leaves them
+  /// uncounted.
+  static WorldAllocationScope scope(MemoryAccount *account,
+                                    MemoryCategory category);
+
+ private:
+  friend struct MemoryAccountRelease;
+
+  struct Counter {
+    std::atomic<std::size_t> bytes{0};
+    std::atomic<std::size_t> peak_bytes{0};
+    std::atomic<std::size_t> blocks{0};
+
+    void add(std::size_t amount);
+    void remove(std::size_t amount);
+  };
+
+  std::array<Counter, kMemoryCategoryCount> categories_;
+  Counter total_;
+  /// One for the owner and one for each block in use.
+  std::atomic<std::size_t> references_{1};
+  /// Where the blocks come from, or null to take them from `malloc`.
+  std::unique_ptr<WorldArena> arena_;
+
+  explicit MemoryAccount(MemoryBacking backing);
+  ~MemoryAccount() = default;
+  void unreference();
+};
+
+/// @brief How much memory a simulation uses, and how much of it goes with
+/// each drone, each target and the map.
+///
+/// Box2D memory is measured through the simulation's `MemoryAccount`. The
+/// memory of salsa's own containers (drones, the target pool, the obstacle
+/// field, the per-step snapshot and grids) is counted from their sizes and
+/// capacities, which leaves out small allocations inside the entities, such
+/// as a behaviour's per-drone state.
+struct MemoryReport {
+  int drones = 0;
+  int targets = 0;
+  /// Box2D memory in each category.
+  std::array<MemoryUsage, kMemoryCategoryCount> box2d{};
+  /// Box2D memory over every category.
+  MemoryUsage box2d_total;
+  std::size_t drone_bytes = 0;   ///< Drones and their per-step state.
+  std::size_t target_bytes = 0;  ///< Targets, their pool and store.
+  std::size_t map_bytes = 0;     ///< The obstacle field.
+  /// Bytes the world's arena has taken from the system, which is what its
+  /// Box2D memory really costs. Zero if the world is not in an arena.
+  std::size_t arena_bytes = 0;
+
+  /// @brief Everything in use now.
+  std::size_t bytes() const;
+  /// @brief Everything in use at the Box2D peak: the Box2D peak and the
+  /// containers as they are now.
+  std::size_t peakBytes() const;
+
+  /// @brief Box2D and container memory of the drones, over their number.
+  double bytesPerDrone() const;
+  /// @brief Box2D and container memory of the targets, over their number.
+  double bytesPerTarget() const;
+  /// @brief Box2D and container memory of the map.
+  std::size_t mapBytes() const;
+  /// @brief Box2D memory grown while stepping, such as contacts.
+  std::size_t stepBytes() const;
+
+  /// @brief A guess at the memory of a simulation of the same map with
+  /// `drones` drones and `targets` targets, from this one's figures.
+  std::size_t estimate(int drones, int targets) const;
+
+  nlohmann::json toJson() const;
+
+  static const char *categoryName(MemoryCategory category);
+};
+
+}  // namespace salsa
+
+#endif  // SWARM_SIM_CORE_MEMORY_H
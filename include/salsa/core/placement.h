@@ -0,0 +1,164 @@
+/// @file placement.h
+/// @brief Contains the placement subsystem, which lays out drones and targets
+/// as arrays of positions, and the `LayoutCache` that keeps layouts on disk so
+/// that repeated tests can reuse them.
+#ifndef SWARM_SIM_CORE_PLACEMENT_H
+#define SWARM_SIM_CORE_PLACEMENT_H
+
+#include <box2d/box2d.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "salsa/utils/mapped_file.h"
+
+namespace salsa {
+
+/// @brief How the points of a layout are spread over its region.
+enum class Placement {
+  /// Independent, uniformly random points.
+  Uniform,
+  /// One uniformly random point in each cell of a grid over the region, so
+  /// that no part of the region is left empty by chance.
+  Stratified,
+  /// Random points no closer to each other than a minimum distance.
+  PoissonDisk,
+  /// Points scattered normally around a number of random centres.
+  Clustered,
+  /// Uniformly random points in the largest circle that fits the region.
+  Disc,
+};
+
+/// @brief Name of a placement, as used in test configurations: "uniform",
+/// "stratified", "poisson", "clustered" or "disc".
+std::string placementName(Placement placement);
+
+/// @brief The placement with the given name.
+/// @throws std::invalid_argument If no placement has that name.
+Placement placementFromName(const std::string &name);
+
+/// @brief Everything that determines a layout. Two equal specs always give
+/// the same points, whichever standard library the simulator is built with.
+struct LayoutSpec {
+  Placement placement = Placement::Uniform;
+  uint64_t seed = 0;
+  /// Map the layout is for. Only used to tell layouts apart in the cache.
+  std::string map_name;
+  std::size_t count = 0;
+  /// Corners of the region the points are placed in.
+  b2Vec2 lower{0.0f, 0.0f};
+  b2Vec2 upper{0.0f, 0.0f};
+  /// Smallest distance between two points of a `PoissonDisk` layout. Zero
+  /// picks one from the area of the region and the number of points.
+  float min_distance = 0.0f;
+  /// Number of clusters in a `Clustered` layout. Zero picks one from the
+  /// number of points.
+  int clusters = 0;
+  /// Standard deviation of the distance of a point from its cluster centre.
+  /// Zero picks one from the size of the region.
+  float cluster_radius = 0.0f;
+
+  /// @brief Hash of every field, used to name and check cache files.
+  uint64_t key() const;
+};
+
+/// @brief Generates the points of a layout.
+/// @return `spec.count` points inside the region of `spec`.
+std::vector<b2Vec2> generateLayout(const LayoutSpec &spec);
+
+/// @brief An immutable array of positions, either generated in memory or
+/// read in place from a memory-mapped cache file.
+class Layout {
+ public:
+  Layout() = default;
+  explicit Layout(std::vector<b2Vec2> points);
+  /// @brief Uses `count` points stored at `offset` bytes into `file`.
+  Layout(MappedFile file, std::size_t offset, std::size_t count);
+
+  Layout(Layout &&other) noexcept;
+  Layout &operator=(Layout &&other) noexcept;
+  Layout(const Layout &) = delete;
+  Layout &operator=(const Layout &) = delete;
+
+  const b2Vec2 *data() const { return points_; }
+  std::size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  const b2Vec2 *begin() const { return points_; }
+  const b2Vec2 *end() const { return points_ + size_; }
+  const b2Vec2 &operator[](std::size_t i) const { return points_[i]; }
+
+  /// @brief True if the points are read from a cache file.
+  bool mapped() const { return !file_.empty(); }
+
+ private:
+  std::vector<b2Vec2> owned_;
+  MappedFile file_;
+  const b2Vec2 *points_ = nullptr;
+  std::size_t size_ = 0;
+};
+
+/// @brief Header at the start of a layout cache file. The points follow it
+/// as packed pairs of floats.
+struct LayoutFileHeader {
+  char magic[8];          ///< Always "SALSALYT".
+  uint32_t version;       ///< Format version, currently 1.
+  uint32_t point_size;    ///< Size of one point in bytes.
+  uint64_t key;           ///< `LayoutSpec::key` of the layout.
+  uint64_t count;         ///< Number of points.
+};
+
+/// @brief Generates layouts once and keeps them, in memory and in files.
+///
+/// `get` looks a layout up in memory first, then in the cache directory, and
+/// only generates it if neither has it. A generated layout is written to the
+/// directory, under a name made from its map, placement, count, seed and
+/// key, so later tests and later runs map the file instead of generating the
+/// layout again. Files are written to a temporary name and renamed into
+/// place, so several simulations, or several processes, may share one
+/// directory. `get` may be called from any thread.
+class LayoutCache {
+ public:
+  /// @brief Creates a cache that keeps its files in `directory`, which is
+  /// created when the first file is written.
+  explicit LayoutCache(std::filesystem::path directory);
+
+  /// @brief The cache shared by every simulation, which keeps its files in
+  /// `testbed/layouts`.
+  static LayoutCache &shared();
+
+  /// @brief The layout for `spec`.
+  /// @return The layout, which stays valid for as long as it is held, even
+  /// if the cache is cleared.
+  std::shared_ptr<const Layout> get(const LayoutSpec &spec);
+
+  /// @brief The file the layout for `spec` is kept in.
+  std::filesystem::path pathFor(const LayoutSpec &spec) const;
+
+  /// @brief Forgets every layout held in memory. Files are kept.
+  void clear();
+
+  const std::filesystem::path &directory() const { return directory_; }
+
+  /// @brief Number of layouts that have had to be generated.
+  uint64_t generated() const;
+
+ private:
+  std::filesystem::path directory_;
+  mutable std::mutex mutex_;
+  std::unordered_map<uint64_t, std::shared_ptr<const Layout>> layouts_;
+  uint64_t generated_ = 0;
+
+  /// Maps the cache file for `spec`. Returns null if there is no usable one.
+  std::shared_ptr<const Layout> load(const LayoutSpec &spec) const;
+  void store(const LayoutSpec &spec, const std::vector<b2Vec2> &points) const;
+};
+
+}  // namespace salsa
+
+#endif  // SWARM_SIM_CORE_PLACEMENT_H
@@ -0,0 +1,162 @@
+/// @file profile.h
+/// @brief Contains the `StepProfile` class, which keeps the time a `Sim`
+/// spends in each phase of a step, and the `TimedContactListener` used to
+/// time contact callbacks.
+#ifndef SWARM_SIM_CORE_PROFILE_H
+#define SWARM_SIM_CORE_PROFILE_H
+
+#include <box2d/box2d.h>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+#include "salsa/utils/perf_counters.h"
+
+namespace salsa {
+
+class StepTracer;
+
+/// @brief A part of a simulation step that is timed on its own.
+enum class StepPhase {
+  WorldStep,   ///< All of `b2World::Step`.
+  Collide,     ///< Box2D narrow phase, part of `WorldStep`.
+  Solve,       ///< Box2D island solver, part of `WorldStep`.
+  SolveTOI,    ///< Box2D continuous collision, part of `WorldStep`.
+  Broadphase,  ///< Box2D broad phase, part of `WorldStep`.
+  Contacts,    ///< Contact listener callbacks, part of `WorldStep`.
+  Behaviours,  ///< Snapshot, neighbour grid, behaviours and their commands.
+  Targets,     ///< Target detection and accounting.
+  Observers,   ///< Telemetry and observer messages.
+  Update,      ///< All of `Sim::update`.
+};
+
+constexpr std::size_t kStepPhaseCount =
+    static_cast<std::size_t>(StepPhase::Update) + 1;
+
+using ProfileClock = std::chrono::steady_clock;
+
+/// @brief Milliseconds between two readings of the profile clock.
+inline float elapsedMs(const ProfileClock::time_point start,
+                       const ProfileClock::time_point end) {
+  return std::chrono::duration<float, std::milli>(end - start).count();
+}
+
+/// @brief Summary of the time spent in one phase.
+struct PhaseStats {
+  uint64_t samples = 0;   ///< Steps recorded since the profile was cleared.
+  double total_ms = 0.0;  ///< Time over every step recorded.
+  float mean_ms = 0.0f;   ///< Mean time over every step recorded.
+  float max_ms = 0.0f;    ///< Longest time over every step recorded.
+  float p50_ms = 0.0f;    ///< Median over the recent window of steps.
+  float p95_ms = 0.0f;    ///< 95th percentile over the recent window.
+  float p99_ms = 0.0f;    ///< 99th percentile over the recent window.
+};
+
+/// @brief The time a simulation spends in each phase of its steps.
+///
+/// Each phase gets one sample per step. Totals, means and maxima cover every
+/// step since the profile was last cleared; percentiles cover the most
+/// recent `window()` steps, so they follow changes over a long test.
+/// Recording a sample does not allocate once the window has filled.
+class StepProfile {
+ public:
+  static constexpr std::size_t kDefaultWindow = 1024;
+
+  /// @param window Number of recent steps percentiles are taken over.
+  explicit StepProfile(std::size_t window = kDefaultWindow);
+
+  /// @brief Adds the time one step spent in `phase`.
+  void record(StepPhase phase, float ms);
+
+  /// @brief Adds every phase of `b2World::Step` from Box2D's own profile of
+  /// the last step.
+  void recordWorld(const b2Profile &profile);
+
+  /// @brief Forgets every sample.
+  void clear();
+
+  PhaseStats stats(StepPhase phase) const;
+
+  /// @brief Number of steps recorded, counted by `StepPhase::Update`.
+  uint64_t steps() const;
+  std::size_t window() const { return window_; }
+
+  /// @brief Every phase's statistics, keyed by phase name.
+  nlohmann::json toJson() const;
+
+  /// @brief A table of every phase's statistics, one row per phase, for
+  /// printing.
+  std::string table() const;
+
+  static const char *phaseName(StepPhase phase);
+
+ private:
+  struct Series {
+    std::vector<float> recent;  ///< Ring of the most recent samples.
+    std::size_t next = 0;       ///< Where the next sample goes in `recent`.
+    uint64_t samples = 0;
+    double total_ms = 0.0;
+    float max_ms = 0.0f;
+  };
+
+  std::size_t window_;
+  std::array<Series, kStepPhaseCount> series_;
+};
+
+/// @brief Hardware events counted in the world step and the behaviour phase
+/// of a simulation's steps.
+///
+/// The behaviour phase is counted on every thread that runs behaviours, so
+/// with several threads it adds up the work of all of them.
+struct StepCounters {
+  bool available = false;  ///< Whether the stepping thread has counters.
+  std::string error;       ///< Why they are not available, if not.
+  uint64_t steps = 0;      ///< Steps counted.
+  CounterSample world_step;
+  CounterSample behaviours;
+
+  /// @brief Both phases, keyed by phase and event name, with the number of
+  /// steps and instructions per cycle.
+  nlohmann::json toJson() const;
+
+  /// @brief A table of both phases, one row per phase, for printing, or a
+  /// line saying why there are no counters.
+  std::string table() const;
+};
+
+/// @brief Forwards contact callbacks to another listener, adding up the time
+/// they take.
+///
+/// A `Sim` puts this in front of its contact listener, so that the time
+/// spent in collision and detection handlers can be told apart from the rest
+/// of the world step. With a tracer set, every begin and end of contact is
+/// also recorded as a span of its own.
+class TimedContactListener final : public b2ContactListener {
+ public:
+  void setListener(b2ContactListener *listener) { listener_ = listener; }
+  b2ContactListener *listener() const { return listener_; }
+  void setTracer(StepTracer *tracer) { tracer_ = tracer; }
+
+  /// @brief Returns the time spent in callbacks since the last call, in
+  /// milliseconds.
+  float takeElapsedMs();
+
+  void BeginContact(b2Contact *contact) override;
+  void EndContact(b2Contact *contact) override;
+  void PreSolve(b2Contact *contact, const b2Manifold *old_manifold) override;
+  void PostSolve(b2Contact *contact, const b2ContactImpulse *impulse) override;
+
+ private:
+  b2ContactListener *listener_ = nullptr;
+  StepTracer *tracer_ = nullptr;
+  ProfileClock::duration elapsed_{};
+};
+
+}  // namespace salsa
+
+#endif  // SWARM_SIM_CORE_PROFILE_H
@@ -0,0 +1,104 @@
+/// @file runner.h
+/// @brief Contains the `Runner` class, which drives a `Sim` through the fixed
+/// time step loop without any rendering.
+#ifndef SWARM_SIM_CORE_RUNNER_H
+#define SWARM_SIM_CORE_RUNNER_H
+
+#include <functional>
+#include <vector>
+
+#include "salsa/core/sim.h"
+
+namespace salsa {
+
+/// @brief Owns the fixed time step loop for a simulation.
+///
+/// Each step advances the `b2World`, updates the `Sim`, advances the
+/// simulation clock and then calls the registered step callbacks. The loop
+/// runs as fast as possible until the time limit is reached, a stop condition
+/// returns true, or `stop` is called.
+///
+/// @code
+/// salsa::Runner runner(sim);
+/// runner.setTimeLimit(600.0f).addStopCondition(
+///     [](salsa::Sim &sim) { return sim.countFoundTargets() >= 100; });
+/// auto result = runner.run();
+/// @endcode
+class Runner {
+ public:
+  /// @brief Called after every step.
+  using StepCallback = std::function<void(Sim &)>;
+  /// @brief Checked after every step. Returning true ends the run.
+  using StopCondition = std::function<bool(Sim &)>;
+
+  /// @brief Summary of a call to `run`.
+  struct Result {
+    int steps = 0;                ///< Number of steps taken.
+    float sim_time = 0.0f;        ///< Simulation time at the end of the run.
+    double wall_time_ms = 0.0;    ///< Wall clock time spent in the loop.
+    bool stopped_early = false;   ///< True if the time limit was not reached.
+
+    /// @brief Real time factor: wall clock time divided by simulated time.
+    /// Values below one mean the simulation ran faster than real time.
+    double rtf() const {
+      return sim_time > 0.0f ? wall_time_ms / (sim_time * 1000.0) : 0.0;
+    }
+  };
+
+  static constexpr float kDefaultTimeStep = 1.0f / 60.0f;
+  static constexpr int kDefaultVelocityIterations = 8;
+  static constexpr int kDefaultPositionIterations = 3;
+
+  /// @brief Creates a runner for a simulation. The time limit defaults to
+  /// the simulation's own.
+  /// @param sim The simulation to drive. Must outlive the runner.
+  explicit Runner(Sim &sim);
+
+  /// @name Loop settings
+  ///@{
+  Runner &setTimeStep(float time_step);
+  Runner &setVelocityIterations(int iterations);
+  Runner &setPositionIterations(int iterations);
+  /// @brief Sets the simulation time at which `run` returns. A negative value
+  /// removes the limit, in which case a stop condition or `stop` must end the
+  /// run.
+  Runner &setTimeLimit(float time_limit);
+  Runner &addStopCondition(StopCondition condition);
+  Runner &onStep(StepCallback callback);
+  ///@}
+
+  /// @brief Advances the simulation by a single step, ignoring the time
+  /// limit and stop conditions.
+  void step();
+
+  /// @brief Steps the simulation until the time limit is reached, a stop
+  /// condition holds or `stop` is called.
+  /// @return A summary of the run.
+  Result run();
+
+  /// @brief Asks a running `run` to return after the current step. Safe to
+  /// call from a step callback.
+  void stop() { stop_requested_ = true; }
+
+  float time_step() const { return time_step_; }
+  int velocity_iterations() const { return velocity_iterations_; }
+  int position_iterations() const { return position_iterations_; }
+  float time_limit() const { return time_limit_; }
+  Sim &sim() { return sim_; }
+
+ private:
+  Sim &sim_;
+  float time_step_ = kDefaultTimeStep;
+  int velocity_iterations_ = kDefaultVelocityIterations;
+  int position_iterations_ = kDefaultPositionIterations;
+  float time_limit_;
+  bool stop_requested_ = false;
+  std::vector<StopCondition> stop_conditions_;
+  std::vector<StepCallback> step_callbacks_;
+
+  bool shouldStop();
+};
+
+}  // namespace salsa
+
+#endif  // SWARM_SIM_CORE_RUNNER_H
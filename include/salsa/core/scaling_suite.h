@@ -0,0 +1,170 @@
+/// @file scaling_suite.h
+/// @brief Contains the `ScalingSweep` of tests that shows how the simulation
+/// scales, the `ScalingReport` of what they measured, and its comparison
+/// against a baseline report.
+#ifndef SWARM_SIM_CORE_SCALING_SUITE_H
+#define SWARM_SIM_CORE_SCALING_SUITE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+#include "salsa/core/profile.h"
+#include "salsa/core/test_executor.h"
+#include "salsa/core/test_queue.h"
+
+namespace salsa {
+
+/// @brief The tests of a scaling suite: every behaviour on every map, with
+/// every number of drones and every number of targets.
+///
+/// Every test is seeded with `seed`, for its drones and its target layout
+/// alike, so two runs of the same sweep simulate exactly the same thing and
+/// differ only in how long they take.
+///
+/// @code
+/// salsa::ScalingSweep sweep;
+/// sweep.behaviours = {"Flocking"};
+/// sweep.drone_config_name = "Small";
+/// salsa::TestExecutor executor(1);
+/// const salsa::ScalingReport report = salsa::runScalingSweep(sweep, executor);
+/// report.save("scaling_report.json");
+/// @endcode
+struct ScalingSweep {
+  /// Behaviours to run. Empty for every registered behaviour.
+  std::vector<std::string> behaviours;
+  std::vector<std::string> maps = {"tree_map"};
+  std::vector<int> drone_counts = {10, 100, 1000, 10000};
+  std::vector<int> target_counts = {100, 1000, 10000, 100000};
+  float time_limit = 10.0f;  ///< Simulated seconds of each test.
+  int64_t seed = 1;
+  std::string drone_config_name;
+  std::string target_type = "null";
+  std::string contact_listener_name;
+  bool use_target_store = true;
+  int num_threads = 1;
+
+  /// @brief The tests of the sweep, grouped by behaviour, then map, then
+  /// number of targets, with the number of drones changing fastest.
+  std::vector<TestConfig> tests() const;
+
+  nlohmann::json toJson() const;
+  /// @brief Reads a sweep. Keys that are left out keep their defaults.
+  static ScalingSweep fromJson(const nlohmann::json &j);
+};
+
+/// @brief What one test of a scaling suite measured.
+struct ScalingCase {
+  std::string behaviour;
+  std::string map;
+  int drones = 0;
+  int targets = 0;
+  double rtf = 0.0;  ///< See `Runner::Result::rtf`.
+  double wall_time_ms = 0.0;
+  uint64_t steps = 0;
+  PhaseStats world;   ///< Time of `b2World::Step`.
+  PhaseStats update;  ///< Time of `Sim::update`.
+  std::size_t peak_bytes = 0;  ///< See `MemoryReport::peakBytes`.
+  double bytes_per_drone = 0.0;
+  double bytes_per_target = 0.0;
+  std::string error;  ///< Why the test failed, empty if it ran.
+
+  static ScalingCase fromResult(const TestExecutor::Result &result);
+
+  /// @brief Names the test, such as "Flocking/tree_map/100x1000" for 100
+  /// drones and 1000 targets, the same way in every run of a sweep.
+  std::string key() const;
+  bool ok() const { return error.empty(); }
+
+  nlohmann::json toJson() const;
+  static ScalingCase fromJson(const nlohmann::json &j);
+};
+
+/// @brief How much worse than its baseline a measurement may get before it
+/// counts as a regression. The same margin the other way counts as an
+/// improvement.
+struct ScalingTolerance {
+  double time = 0.10;    ///< Fraction the RTF and step times may grow by.
+  double memory = 0.05;  ///< Fraction the peak memory may grow by.
+  /// Step times closer than this, and RTFs closer than `min_rtf`, are never
+  /// counted, as small tests take too little time to measure that finely.
+  double min_step_ms = 0.05;
+  double min_rtf = 0.002;
+};
+
+/// @brief A measurement that moved beyond the tolerance.
+struct ScalingChange {
+  std::string key;     ///< The test, see `ScalingCase::key`.
+  std::string metric;  ///< Such as "rtf" or "update_p95_ms".
+  double baseline = 0.0;
+  double current = 0.0;
+
+  /// @brief The change as a fraction of the baseline, positive for growth.
+  double change() const;
+};
+
+/// @brief The differences between a report and its baseline.
+struct ScalingComparison {
+  ScalingTolerance tolerance;
+  std::vector<ScalingChange> regressions;
+  std::vector<ScalingChange> improvements;
+  /// Tests in the baseline that are missing from the report, or failed.
+  std::vector<std::string> missing;
+  /// Tests in the report that the baseline does not have.
+  std::vector<std::string> added;
+  /// Settings of the sweep that differ from the baseline's, other than the
+  /// numbers of drones and targets, such as "seed: 1 -> 2". Timings taken
+  /// with different settings do not measure the same thing.
+  std::vector<std::string> settings;
+
+  /// @brief Whether the sweeps had the same settings, nothing regressed and
+  /// every baseline test ran.
+  bool passed() const {
+    return settings.empty() && regressions.empty() && missing.empty();
+  }
+
+  /// @brief A table of the settings that differ, the regressions and
+  /// improvements, then the tests that are missing or new, for printing.
+  std::string table() const;
+  nlohmann::json toJson() const;
+};
+
+/// @brief Everything a run of a `ScalingSweep` measured.
+struct ScalingReport {
+  ScalingSweep sweep;
+  std::vector<ScalingCase> cases;  ///< In the order of `ScalingSweep::tests`.
+
+  /// @brief Compares the report with an earlier one of the same sweep. Only
+  /// tests in both are compared, by `ScalingCase::key`. The sweeps may cover
+  /// different numbers of drones and targets, but any other setting that
+  /// differs is listed and fails the comparison.
+  ScalingComparison compare(const ScalingReport &baseline,
+                            const ScalingTolerance &tolerance = {}) const;
+
+  /// @brief A table of every test's RTF, step times and memory, one row per
+  /// test, for printing.
+  std::string table() const;
+
+  nlohmann::json toJson() const;
+  static ScalingReport fromJson(const nlohmann::json &j);
+
+  /// @brief Writes the report as JSON.
+  /// @return Whether the file could be written.
+  bool save(const std::filesystem::path &path) const;
+  /// @brief Reads a report written by `save`.
+  /// @throws std::runtime_error If the file cannot be read or parsed.
+  static ScalingReport load(const std::filesystem::path &path);
+};
+
+/// @brief Runs every test of `sweep` on `executor`, and reports what they
+/// measured. A test that fails is reported with its error. For steady
+/// timings, the executor should run one test at a time.
+ScalingReport runScalingSweep(const ScalingSweep &sweep,
+                              TestExecutor &executor);
+
+}  // namespace salsa
+
+#endif  // SWARM_SIM_CORE_SCALING_SUITE_H
@@ -8,16 +8,30 @@
 #include <box2d/box2d.h>
 
 #include <sstream>
+#include <utility>
 #include <variant>
 
 #include "salsa/behaviours/behaviour.h"
 #include "salsa/behaviours/registry.h"
+#include "salsa/core/checkpoint.h"
+#include "salsa/core/data/telemetry.h"
+#include "salsa/core/memory.h"
+#include "salsa/core/placement.h"
+#include "salsa/core/profile.h"
+#include "salsa/core/trace.h"
 #include "salsa/entity/drone.h"
 #include "salsa/entity/drone_configuration.h"
 #include "salsa/entity/drone_factory.h"
+#include "salsa/entity/drone_snapshot.h"
+#include "salsa/entity/found_targets.h"
 #include "salsa/entity/target.h"
 #include "salsa/entity/target_factory.h"
+#include "salsa/entity/target_pool.h"
+#include "salsa/entity/target_store.h"
 #include "salsa/utils/base_contact_listener.h"
+#include "salsa/utils/rng.h"
+#include "salsa/utils/spatial_grid.h"
+#include "salsa/utils/thread_pool.h"
 #include "test_queue.h"
 namespace salsa {
 
@@ -34,11 +48,35 @@ struct DroneParameters {
 
 /// @brief The main class for the simulation.
 class Sim {
+ public:
+  enum class SpawnType { CIRCULAR, RANDOM };
+
  private:
+  /// Counts the Box2D memory allocated for this simulation's world, and
+  /// holds the arena of a world the simulation owns. Declared first, so that
+  /// it outlives everything in the world.
+  MemoryAccount::Handle memory_ = MemoryAccount::create(MemoryBacking::Arena);
+  /// World the simulation made for itself, from a map or by `fork`, which
+  /// lives in `memory_`'s arena. It is never taken apart body by body:
+  /// `releaseWorld` frees the arena, and the world with it, in one go.
+  b2World* owned_world_ = nullptr;
   map::Map map_;    ///< The map of the simulation environment
-  b2World* world_;  ///< The Box2D world for the simulation
+  b2World* world_ = nullptr;  ///< The Box2D world for the simulation
+  /// The bodies of the map, as opposed to those of drones and targets.
+  std::vector<const b2Body*> map_bodies_;
   salsa::BaseContactListener*
       contact_listener_{};  ///< The contact listener for the simulation
+  /// Sits between the world and `contact_listener_`, timing its callbacks.
+  TimedContactListener contact_timer_;
+  /// Time spent in each phase of the steps of the current test.
+  StepProfile profile_;
+  /// Timeline of the most recent steps, when tracing is enabled.
+  std::unique_ptr<StepTracer> tracer_;
+  /// Whether hardware events are counted, and what has been counted.
+  bool count_hardware_ = false;
+  StepCounters counters_;
+  /// Events counted by each worker of the thread pool in the current step.
+  std::vector<CounterSample> worker_counters_;
 
   /// @name Simulation properties
   /// These properties originate from the test configuration and are used to
@@ -55,6 +93,7 @@ class Sim {
   bool is_stack_test_ = false;
   int num_time_steps_ = 0;
   std::string current_log_file_;
+  std::string current_trajectory_file_;
   ///@}
 
   /// @name Drone properties
@@ -66,12 +105,24 @@ class Sim {
   std::unordered_map<std::string, salsa::DroneConfiguration>
       all_drone_configurations_;
   /// The current drone configuration.
-  salsa::DroneConfiguration* drone_configuration_;
+  salsa::DroneConfiguration* drone_configuration_ = nullptr;
   /// The list of drones in the simulation.
   std::vector<std::unique_ptr<salsa::Drone>> drones_;
   int num_drones_;   ///< The number of drones in the simulation
   float max_speed_{};  ///< The maximum speed of the drones
   float max_force_{};  ///< The maximum force of the drones
+  /// Structure-of-arrays copy of the drones, taken at the start of every
+  /// step.
+  DroneSnapshot snapshot_;
+  /// Grid over the drone positions, rebuilt at the start of every step.
+  SpatialGrid neighbour_grid_;
+  ///@}
+
+  /// @name Threading
+  ///@{
+  int num_threads_ = 1;  ///< Requested thread count, zero for one per core
+  /// Pool used for the behaviour phase, null when running on one thread.
+  std::unique_ptr<ThreadPool> thread_pool_;
   ///@}
 
   /// @name Target properties
@@ -80,11 +131,24 @@ class Sim {
   /// This is used to determine the type of target to create.
   std::string target_type_;
 
-  /// The list of targets in the simulation.
-  std::vector<std::shared_ptr<Target>> targets_;
+  /// The targets in the simulation. Each target's id is its index.
+  TargetPool target_pool_;
   /// The list of targets found in the current time step.
   std::vector<Target*> targets_found_this_step_;
+  /// Which targets have been found, indexed by target id.
+  FoundTargets found_targets_;
   float num_targets_;  ///< The number of targets in the simulation
+  /// Whether targets are kept in `target_store_` instead of Box2D.
+  bool use_target_store_ = false;
+  /// Static targets and their grid, used when `use_target_store_` is set.
+  TargetStore target_store_;
+  /// How targets are spread over the map.
+  Placement target_placement_ = Placement::Uniform;
+  /// Seed of the drone and target layouts. Layouts with a seed come from
+  /// the shared `LayoutCache`; a negative seed draws new layouts every time.
+  int64_t layout_seed_ = -1;
+  /// Layout the targets were last placed from.
+  std::shared_ptr<const Layout> target_layout_;
   ///@}
 
   // Obstacles in the environment
@@ -93,6 +157,9 @@ class Sim {
 
   // Behaviour management
   salsa::Behaviour* behaviour_{};
+  /// This simulation's own copy of the current behaviour, if it could be
+  /// cloned. `behaviour_` points at it.
+  std::unique_ptr<salsa::Behaviour> owned_behaviour_;
   std::string current_behaviour_name_;
   float camera_view_range_{};
 
@@ -101,18 +168,79 @@ class Sim {
   bool draw_targets_ = false;
   bool draw_drones_ = false;
 
+  /// @name Random numbers
+  /// Every random draw in the simulation comes from `seed_`.
+  ///@{
+  uint64_t seed_ = Rng::randomSeed();
+  /// Stream for spawn positions and starting velocities.
+  Rng rng_{seed_};
+  /// One stream per drone, indexed like `drones_`, handed to behaviours
+  /// through the context. Streams for new drones are added at the next step.
+  std::vector<Rng> drone_rngs_;
+  ///@}
+
   // Logging
-  Logger& logger_ = Logger::getInstance();
+  std::shared_ptr<Logger> logger_;
   std::chrono::steady_clock::time_point last_log_time;
   std::vector<std::shared_ptr<Observer>> observers_;
   int log_interval_ = 50;  // time steps between logs
+  /// Drone positions and velocities, sampled every `log_interval_` steps and
+  /// written to the trajectory file on a background thread.
+  TelemetrySink telemetry_;
   // Private methods for internal use
   void createBounds();
+  void captureDroneState();
+  void computeDroneCommands(const behaviour::Context& context);
   void applyCurrentBehaviour()const;
-  void createDronesCircular(Behaviour& behaviour,
-                            const DroneConfiguration& configuration);
-  void createDronesRandom(Behaviour& behaviour,
-                          const DroneConfiguration& configuration);
+  void releaseOwnedBehaviour();
+  void untrackTargets();
+  /// Hands the world's contacts to `contact_listener_`, through
+  /// `contact_timer_`.
+  void attachContactListener();
+  /// Restarts every random number stream from `seed`.
+  void seedRandom(uint64_t seed);
+  /// Gives every drone a stream, and drops those of drones that are gone.
+  void matchDroneRngs();
+  b2Vec2 randomDroneVelocity(const DroneConfiguration& configuration);
+  /// Where drones are spawned, without a seed.
+  LayoutSpec droneSpawnSpec(const DroneConfiguration& configuration,
+                            SpawnType mode = SpawnType::CIRCULAR) const;
+  /// Where targets are placed, without a seed.
+  LayoutSpec targetSpec() const;
+  /// Fills in the seed of `spec` and returns its layout.
+  std::shared_ptr<const Layout> layout(LayoutSpec spec);
+  /// Creates one drone at each of `count` positions, with random velocities.
+  void createDrones(const b2Vec2* positions, std::size_t count,
+                    Behaviour& behaviour,
+                    const DroneConfiguration& configuration);
+  /// Creates a target at each of `positions` past the targets already in
+  /// the pool, which are taken to stand at the positions before them.
+  void createTargetsAt(const std::shared_ptr<const Layout>& positions);
+  /// Tracks the found state of every target in the pool from scratch, and
+  /// indexes them in the target store if it is used.
+  void trackTargets();
+  void destroyTargets();
+  /// Replaces the world, and everything in it, with that of a map.
+  void loadMap(const std::string& name);
+  /// Replaces the world with an empty one of the simulation's own, in an
+  /// arena of its own.
+  b2World* createWorld(const b2Vec2& gravity);
+  /// Destroys the drones, targets and obstacles, and the world too if the
+  /// simulation owns it. An owned world is freed with its arena, so its
+  /// bodies are let go of rather than destroyed one at a time.
+  void releaseWorld();
+  /// Starts a new log and trajectory file, headed by the simulation settings.
+  void startLog();
+  /// Puts the simulation back to time zero, keeping its world.
+  void restart();
+  void respawnDrones();
+  void respawnTargets();
+  /// Writes and reads the state held in a checkpoint.
+  void writeState(CheckpointWriter& out) const;
+  void readState(CheckpointReader& in);
+
+  /// Creates an empty simulation, to be set up by `fork`.
+  Sim();
 
  public:
   // Constructors and Destructor
@@ -122,22 +250,189 @@ class Sim {
   Sim(salsa::TestConfig& config);
   ~Sim();
 
-  enum class SpawnType { CIRCULAR, RANDOM };
-
   /// @name Simulation Control
   /// These functions control the simulation.
   ///@{
   /// @brief Runs the simulation for a single time step.
+  ///
+  /// The step runs in two phases. First every drone's behaviour reads the
+  /// swarm as it was at the start of the step and records a velocity command,
+  /// spread across the thread pool when the behaviour supports it. Then the
+  /// commands are applied to the drone bodies in order on the calling thread.
+  /// The result does not depend on the number of threads.
   void update();
 
+  /// @brief Steps the Box2D world, counting the hardware events the step
+  /// takes if hardware counters are on.
+  void stepWorld(float time_step, int velocity_iterations,
+                 int position_iterations);
+
+  /// @brief Returns the snapshot of the drones taken at the start of the
+  /// current step. Indices match `getDrones()`.
+  const DroneSnapshot& snapshot() const;
+
+  /// @brief The time spent in each phase of the steps taken since the
+  /// simulation was last reset.
+  ///
+  /// The world step and its Box2D phases come from `b2World::GetProfile`,
+  /// read by `update` after the step that precedes it, and the contact phase
+  /// from timing the contact listener's callbacks. When the test's log is
+  /// finished (see `finishLog`), the profile is written as `profile.json`
+  /// next to `result.log`.
+  const StepProfile& profile() const;
+
+  /// @brief Starts keeping a timeline of the last `steps` steps.
+  ///
+  /// Each step's timeline has the world step and its Box2D phases, every
+  /// begin and end of contact, the target, snapshot and behaviour phases
+  /// with one span per batch of drones on each worker thread, and the
+  /// telemetry and log messages. When the test's log is finished, the
+  /// timeline is written as `trace.json` next to `result.log`, in the Chrome
+  /// trace event format. Tracing is off by default, and is turned on for a
+  /// test by `TestConfig::trace_steps`.
+  void enableTracing(std::size_t steps = StepTracer::kDefaultSteps);
+  void disableTracing();
+
+  /// @brief The timeline of recent steps, or null if tracing is off.
+  const StepTracer* tracer() const;
+
+  /// @brief Turns counting of CPU cycles, instructions, last level cache
+  /// misses and branch misses in the world step (see `stepWorld`) and the
+  /// behaviour phase of `update` on or off.
+  ///
+  /// Events are read through Linux `perf_event_open` for each thread that
+  /// does the work (see `PerfCounters`). Where the counters cannot be read,
+  /// the simulation runs as usual and `counters()` says why. Counting is off
+  /// by default, and is turned on for a test by
+  /// `TestConfig::hardware_counters`. When the test's log is finished, the
+  /// counts are added to `profile.json`.
+  void setHardwareCounters(bool enabled);
+  bool hardwareCountersEnabled() const;
+
+  /// @brief The hardware events counted since the simulation was last reset.
+  const StepCounters& counters() const;
+
+  /// @brief How much memory the simulation uses, and how much of it goes
+  /// with each drone, each target and the map.
+  ///
+  /// Box2D memory is counted through the simulation's `MemoryAccount` for
+  /// everything Box2D allocates while the simulation works on its world.
+  /// Peaks are taken since the simulation was last reset. When the test's
+  /// log is finished, the report is added to `profile.json`.
+  MemoryReport memoryReport() const;
+
+  /// @brief Sends the Box2D allocations made on this thread to the
+  /// simulation's memory until the scope ends.
+  ///
+  /// The simulation does this itself whenever it works on its world. Code
+  /// that steps or changes `getWorld()` directly, such as the testbed's
+  /// drawing modes, should hold one too: memory Box2D allocates for an owned
+  /// world outside such a scope is not freed with the world's arena.
+  WorldAllocationScope memoryScope(
+      MemoryCategory category = MemoryCategory::Step) const;
+
+  /// @brief Whether the world is the simulation's own, made for its map or
+  /// by `fork`, rather than one it was given. An owned world goes with the
+  /// simulation, and must not be deleted by anyone else.
+  bool ownsWorld() const;
+
+  /// @brief Sets the number of threads used for the behaviour phase of
+  /// `update`.
+  /// @param count The number of threads, including the calling thread. Zero
+  /// uses one thread per core.
+  void setThreadCount(int count);
+  int getThreadCount() const;
+
   /// @brief Resets the simulation to its initial state.
+  ///
+  /// The world and its static geometry are kept. The behaviour is cleaned
+  /// with `Behaviour::clean`, and the drones and targets are put back to the
+  /// start with new layouts: existing drones and targets are moved into
+  /// place, and only the difference in count is created or destroyed.
   void reset();
 
+  /// @brief Resets the simulation, drawing the layouts (unless they have a
+  /// layout seed), the starting velocities and the drones' random number
+  /// streams from `seed`. Two resets with the same seed run the same way.
+  void reset(uint64_t seed);
+
+  /// @brief The seed the simulation was last set up or reset with.
+  uint64_t getSeed() const;
+
+  /// @brief Sets the simulation up for the test `config`, as if it had been
+  /// constructed from it, but reusing what it can.
+  ///
+  /// The map is only loaded if it is not the map already in use, so tests on
+  /// the same map share one world and its static geometry. The behaviour is
+  /// replaced, the previous one being cleaned with `Behaviour::clean`.
+  /// Drones and targets are reset as by `reset`, and only rebuilt if the
+  /// drone configuration, target type or target store setting change. A new
+  /// log and trajectory file are started; the old ones are finished first.
+  /// @throws std::invalid_argument If the behaviour or placement is unknown.
+  void reconfigure(const TestConfig& config);
+
+  /// @brief Writes out everything logged so far, closes the trajectory
+  /// file and writes the step profile, so all of them can be read before the
+  /// simulation is destroyed or reconfigured.
+  void finishLog();
+
+  /// @brief Writes the state of the simulation to a checkpoint file.
+  ///
+  /// The checkpoint holds the simulation clock, the random number streams,
+  /// every drone's transform and velocity, every target's position and found
+  /// state, and whatever the behaviour writes in `Behaviour::saveState`. The
+  /// map and settings are not saved: a checkpoint is loaded into a
+  /// simulation set up for the same test. Call it between steps.
+  /// @param path The file to write, replaced as a whole once it is complete.
+  /// @throws std::runtime_error If the file cannot be written.
+  void saveCheckpoint(const std::string& path) const;
+
+  /// @brief Makes an independent copy of the simulation, which carries on
+  /// from the same state.
+  ///
+  /// The copy gets a world of its own, holding copies of the map's bodies,
+  /// and is set up with the simulation's current settings and behaviour
+  /// parameters. The drones, targets, random number generator and behaviour
+  /// state are then copied across as by `saveCheckpoint` and
+  /// `loadCheckpoint`, but in memory. Both simulations step exactly the same
+  /// from then on, until one of them is changed, so a shared warm-up can be
+  /// run once and then branched into variants. The copy writes a log and
+  /// trajectory file of its own, and may be stepped on another thread.
+  /// @return The copy, which owns its world.
+  /// @throws std::logic_error If the simulation was not set up from a
+  /// `TestConfig`, in which case its world cannot be rebuilt.
+  std::unique_ptr<Sim> fork() const;
+
+  /// @brief Carries on from a checkpoint written by `saveCheckpoint`.
+  ///
+  /// The simulation must be set up for the same test, with the same
+  /// behaviour and numbers of drones and targets. Contacts, and targets in
+  /// view of the target store, that were ongoing at the checkpoint are found
+  /// again without being reported, so nothing is detected twice. A restored
+  /// run steps exactly as the original did, except that Box2D's warm starting
+  /// of contacts between solid bodies that touch at the checkpoint starts
+  /// from zero.
+  /// @throws std::runtime_error If the file is not a complete checkpoint or
+  /// was saved by a different kind of simulation, in which case the
+  /// simulation is left untouched. If the behaviour cannot read its state,
+  /// the simulation is left untouched too, or restarted if the behaviour
+  /// cannot check its state before loading it, see `Behaviour::checkState`.
+  void loadCheckpoint(const std::string& path);
+
   /// @brief Adds an observer to the simulation.
   /// @param observer The observer to add.
   void addObserver(std::shared_ptr<Observer> observer) {
     observers_.push_back(observer);
   }
+
+  /// @brief Sends every drone sample to `observer` as a json message, as well
+  /// as to the trajectory file. This allocates for every sample, so only use
+  /// it when something needs the messages. See `TelemetrySink::addObserver`.
+  /// @param observer The observer to add. It is called from the telemetry
+  /// writer thread.
+  void addTelemetryObserver(std::shared_ptr<Observer> observer) {
+    telemetry_.addObserver(std::move(observer));
+  }
   ///@}
 
   /// @name Behaviour Functions
@@ -147,15 +442,27 @@ class Sim {
   static void addBehaviour(const std::string& name,
                     std::unique_ptr<salsa::Behaviour> behaviour);
 
+  /// @brief Adds a behaviour to the simulation, as a factory that makes a new
+  /// instance for every simulation that uses it.
+  static void addBehaviour(const std::string& name,
+                           behaviour::Registry::Factory factory);
+
   /// @brief Sets the current behaviour of the simulation.
-  /// @param behaviour A pointer to the behaviour to set.
+  /// @param behaviour A pointer to the behaviour to set. The caller keeps
+  /// ownership.
   void setCurrentBehaviour(Behaviour* behaviour);
 
   /// @brief Sets the current behaviour of the simulation by name.]
-  /// The function will search the Behaviour Registry for a behaviour matching
-  /// that name, and then set the current behaviour to that.
+  /// The function asks the Behaviour Registry for a new instance of the
+  /// behaviour with that name, so that per-drone state is never shared with
+  /// another simulation. Behaviours that the registry can only share are used
+  /// directly.
   /// @param name The name of the behaviour to set.
   void setCurrentBehaviour(const std::string& name);
+
+  /// @brief Returns true if the current behaviour is this simulation's own
+  /// instance rather than one shared through the registry.
+  bool ownsBehaviour() const;
   ///@}
 
   /// @name Drone Functions
@@ -196,9 +503,9 @@ class Sim {
 
   /// @brief Creates multiple target objects within the simulation.
   ///
-  /// This method generates a specified number of targets at random positions
-  /// within the given borders. Each target is initialized through the
-  /// TargetFactory and added to the simulation's target list.
+  /// This method lays out the targets over the map with the target placement
+  /// and layout seed, then creates all of them in one block of the target
+  /// pool through the TargetFactory.
   ///
   /// @tparam Params Variadic template parameters to pass to the target factory.
   /// @param params Parameters required for creating a target, passed variably.
@@ -222,16 +529,41 @@ class Sim {
   /// @param count The number of targets to create.
   void setTargetCount(int count);
 
-  /// @brief Get a vector of all targets in the simulation.
-  /// @return A vector of shared pointers to all targets in the simulation.
-  std::vector<std::shared_ptr<Target>>& getTargets();
+  /// @brief Sets how the targets created from now on are spread over the
+  /// map.
+  void setTargetPlacement(Placement placement);
+  Placement getTargetPlacement() const;
+
+  /// @brief Sets the seed of the drone and target layouts created from now
+  /// on. Layouts with the same seed, map, placement and count are generated
+  /// once and then mapped from the `LayoutCache`; a negative seed draws new
+  /// layouts every time, which are not cached.
+  void setLayoutSeed(int64_t seed);
+  int64_t getLayoutSeed() const;
+
+  /// @brief Every target in the simulation, indexed by target id. The
+  /// targets are owned by the simulation and destroyed with it.
+  const std::vector<Target*>& getTargets() const;
+  /// @brief The pool that owns the simulation's targets.
+  TargetPool& target_pool();
+  /// @brief Keeps the targets created from now on in a `TargetStore`, with
+  /// no Box2D bodies, and detects them with a grid query every step.
+  void setUseTargetStore(bool use_target_store);
+  bool usesTargetStore() const;
+  const TargetStore& target_store() const;
 
   /// @brief Get a vector of all targets found precisely in this simulation
   /// step.
-  /// @return A vector of normal pointers to all targets in the simulation
+  /// @return A vector of normal pointers to the targets that were first
+  /// found in this step.
   std::vector<Target*>& getTargetsFoundThisStep();
 
-  /// @brief Multi-threaded function to get the number of targets found.
+  /// @brief Ids of the targets first found in this step. Cheaper than
+  /// `getTargetsFoundThisStep` when only the ids are needed.
+  const std::vector<int>& getTargetIdsFoundThisStep() const;
+
+  /// @brief Get the number of targets found. Kept up to date as targets are
+  /// found, so this does not visit any target.
   /// @return The number of targets in the simulation with `isFound()` as true.
   int countFoundTargets();
   ///@}
@@ -250,6 +582,10 @@ class Sim {
   const float& current_time() const;
   float& time_limit();
   std::string& getCurrentLogFile();
+  /// @brief Returns the trajectory file drone samples are written to,
+  /// relative to the testbed results directory. Empty unless the simulation
+  /// was created from a `TestConfig`.
+  std::string& getCurrentTrajectoryFile();
   b2World* getWorld()const;
   void setWorld(b2World* world);
   map::Map getMap();
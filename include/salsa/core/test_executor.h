@@ -0,0 +1,233 @@
+/// @file test_executor.h
+/// @brief Contains the `TestExecutor` class, which runs a batch of test
+/// configurations as independent simulations on a pool of worker threads.
+#ifndef SWARM_SIM_CORE_TEST_EXECUTOR_H
+#define SWARM_SIM_CORE_TEST_EXECUTOR_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "salsa/core/runner.h"
+#include "salsa/core/sim.h"
+#include "salsa/core/test_queue.h"
+
+namespace salsa {
+
+/// @brief Runs several `TestConfig`s at once, each in its own `Sim`.
+///
+/// Every test gets its own `b2World` (loaded from its map), its own instance
+/// of the behaviour, its own log file and its own random number generator, so
+/// the simulations share nothing while they step. At most
+/// `max_concurrent()` tests run at a time. Results come back in the order the
+/// tests were given, whatever order they finish in.
+///
+/// Tests whose behaviour the registry can only share (see
+/// `behaviour::Registry::create`) are run one at a time, alongside any other
+/// tests.
+///
+/// A `Sim` whose test has finished is kept and reconfigured for a later test
+/// (see `Sim::reconfigure`), preferably one on the same map, so a queue of
+/// tests on one map loads the map and builds its world once per worker
+/// rather than once per test.
+///
+/// With a checkpoint interval set, each test saves a checkpoint (see
+/// `Sim::saveCheckpoint`) every so many seconds of simulated time, and a test
+/// that finds its checkpoint when it starts, left by an earlier run that did
+/// not finish, carries on from it instead of starting again.
+///
+/// With a memory budget set, a test only starts once the memory it is
+/// expected to need fits in the budget alongside the tests already running.
+/// The estimate comes from the `MemoryReport` of the last test to finish on
+/// the same map, scaled to the new test's drones and targets. A test on a
+/// map that no test has finished on yet is taken to need the whole budget,
+/// so it runs on its own. A test always starts if nothing else is running.
+///
+/// @code
+/// salsa::TestExecutor executor(4);
+/// executor.onProgress([](const salsa::TestExecutor::Progress &progress) {
+///   std::cout << progress.index << ": " << progress.sim_time << "s\n";
+/// });
+/// for (const auto &result : executor.runQueue()) {
+///   std::cout << result.config.behaviour_name << " " << result.run.rtf();
+/// }
+/// @endcode
+class TestExecutor {
+ public:
+  /// @brief Progress of a single test, reported while it runs.
+  struct Progress {
+    std::size_t index;         ///< Position of the test in the batch.
+    std::size_t total;         ///< Number of tests in the batch.
+    const TestConfig &config;  ///< The test being run.
+    float sim_time;            ///< Simulation time reached so far.
+    bool finished;             ///< True for the last report of the test.
+
+    /// @brief Fraction of the time limit reached, between zero and one.
+    float fraction() const {
+      return config.time_limit > 0.0f
+                 ? std::min(sim_time / config.time_limit, 1.0f)
+                 : 0.0f;
+    }
+  };
+
+  /// @brief Outcome of a single test.
+  struct Result {
+    std::size_t index = 0;   ///< Position of the test in the batch.
+    TestConfig config;       ///< The test that was run.
+    Runner::Result run;      ///< Summary of the run loop.
+    int targets_found = 0;   ///< Targets found by the end of the run.
+    std::string log_file;    ///< Log file written by the simulation.
+    /// Simulation time the test was resumed at from a checkpoint, zero if it
+    /// ran from the start.
+    float resumed_at = 0.0f;
+    /// Time spent in each phase of the test's steps. See `Sim::profile`.
+    StepProfile profile;
+    /// Hardware events counted in the test's steps, if the test asked for
+    /// them. See `Sim::counters`.
+    StepCounters counters;
+    /// Memory the test's simulation used. See `Sim::memoryReport`.
+    MemoryReport memory;
+    std::string error;       ///< Why the test failed, empty on success.
+
+    bool ok() const { return error.empty(); }
+  };
+
+  /// @brief Called with the progress of a test. Calls are never made
+  /// concurrently, so the callback needs no locking of its own.
+  using ProgressCallback = std::function<void(const Progress &)>;
+  /// @brief Called on the worker thread once a test's `Sim` and `Runner` are
+  /// set up, before the run starts. Use it to add stop conditions or step
+  /// callbacks. Calls may be made concurrently for different tests. The `Sim`
+  /// may have run earlier tests, so anything added to it here is added again
+  /// for every test it runs.
+  using SetupCallback = std::function<void(Sim &, Runner &)>;
+
+  static constexpr double kDefaultProgressIntervalMs = 1000.0;
+
+  /// @brief Creates an executor.
+  /// @param max_concurrent Maximum number of tests to run at once. Zero uses
+  /// one per hardware thread.
+  explicit TestExecutor(int max_concurrent = 0);
+
+  /// @name Settings
+  ///@{
+  TestExecutor &setMaxConcurrent(int max_concurrent);
+  /// @brief Sets the wall clock time between progress reports for a test.
+  /// The first and last reports are always made.
+  TestExecutor &setProgressInterval(double interval_ms);
+  TestExecutor &onProgress(ProgressCallback callback);
+  TestExecutor &onSetup(SetupCallback callback);
+  /// @brief Sets the simulated time between checkpoints of a test. Zero, the
+  /// default, turns checkpoints off, and with them resuming.
+  TestExecutor &setCheckpointInterval(float interval);
+  /// @brief Sets the directory checkpoints are kept in. Defaults to
+  /// `testbed/checkpoints`.
+  TestExecutor &setCheckpointDirectory(std::filesystem::path directory);
+  /// @brief Sets the bytes the tests running at once may use between them.
+  /// Zero, the default, leaves the number of tests running at once to
+  /// `max_concurrent()` alone.
+  TestExecutor &setMemoryBudget(std::size_t bytes);
+  ///@}
+
+  /// @brief The checkpoint file of the test at `index` in a batch. The name
+  /// is made from the test's settings, so a test never resumes from the
+  /// checkpoint of another. The number of threads is left out, as it does
+  /// not change the result.
+  std::filesystem::path checkpointPath(std::size_t index,
+                                       const TestConfig &config) const;
+
+  /// @brief Runs every test and waits for them all to finish.
+  ///
+  /// A test that throws does not stop the others; its `Result::error` holds
+  /// the message instead.
+  /// @param tests The tests to run.
+  /// @return One result per test, in the same order as `tests`.
+  std::vector<Result> run(const std::vector<TestConfig> &tests);
+
+  /// @brief Runs simulations that are already set up, such as the forks
+  /// made by `Sim::fork`, until their time limits, and waits for them all to
+  /// finish.
+  ///
+  /// Each simulation carries on from where it is, and is left as it ends up,
+  /// so it can be looked at afterwards. Checkpoints are not used.
+  /// @param sims The simulations to run.
+  /// @return One result per simulation, in the same order as `sims`.
+  std::vector<Result> runSims(const std::vector<std::unique_ptr<Sim>> &sims);
+
+  /// @brief Empties the `TestQueue` and runs every test that was in it.
+  /// @return One result per test, in queue order.
+  std::vector<Result> runQueue();
+
+  int max_concurrent() const { return max_concurrent_; }
+  std::size_t memory_budget() const { return memory_budget_; }
+
+  /// @brief The memory a test is expected to need, from the tests that have
+  /// finished so far. Zero if nothing is known about its map.
+  std::size_t estimateMemory(const TestConfig &config);
+
+ private:
+  int max_concurrent_;
+  double progress_interval_ms_ = kDefaultProgressIntervalMs;
+  ProgressCallback progress_callback_;
+  SetupCallback setup_callback_;
+  float checkpoint_interval_ = 0.0f;
+  std::filesystem::path checkpoint_directory_;
+  std::size_t memory_budget_ = 0;
+
+  std::mutex progress_mutex_;  ///< Serialises calls to `progress_callback_`.
+  /// Held for the whole run of a test whose behaviour is shared.
+  std::mutex shared_behaviour_mutex_;
+
+  std::mutex memory_mutex_;
+  std::condition_variable memory_condition_;
+  /// Memory expected to be in use by the tests running now, and how many
+  /// of them there are.
+  std::size_t memory_reserved_ = 0;
+  std::size_t memory_holders_ = 0;
+  /// The memory of the last test to finish on each map.
+  std::unordered_map<std::string, MemoryReport> memory_by_map_;
+
+  /// Waits until `config` fits in the memory budget, and returns the memory
+  /// set aside for it.
+  std::size_t reserveMemory(const TestConfig &config);
+  /// Gives back what `reserveMemory` set aside, learning from `result` if
+  /// the test succeeded.
+  void releaseMemory(std::size_t reserved, const Result &result);
+
+  std::mutex idle_mutex_;
+  /// Simulations whose tests have finished, waiting to be reconfigured.
+  std::vector<std::unique_ptr<Sim>> idle_sims_;
+
+  /// Returns a simulation set up for `config`, reusing an idle one if there
+  /// is one.
+  std::unique_ptr<Sim> acquireSim(TestConfig &config);
+  void releaseSim(std::unique_ptr<Sim> sim);
+
+  /// Restores `sim` from `checkpoint` if there is a usable one there.
+  /// Returns the simulation time it was resumed at, or zero.
+  float resume(Sim &sim, const std::filesystem::path &checkpoint) const;
+  /// Has `runner` save a checkpoint to `checkpoint` at every multiple of the
+  /// checkpoint interval.
+  void addCheckpoints(Runner &runner,
+                      const std::filesystem::path &checkpoint) const;
+
+  Result runTest(std::size_t index, std::size_t total,
+                 const TestConfig &config);
+  /// Runs `sim` until its time limit, filling in `result`, whose index and
+  /// config must already be set. Checkpoints are saved to `checkpoint`, and
+  /// resumed from, unless it is empty.
+  void runSim(Sim &sim, std::size_t total,
+              const std::filesystem::path &checkpoint, Result &result);
+  void reportProgress(const Progress &progress);
+};
+
+}  // namespace salsa
+
+#endif  // SWARM_SIM_CORE_TEST_EXECUTOR_H
@@ -6,6 +6,7 @@
 
 #include <box2d/box2d.h>
 
+#include <cstdint>
 #include <queue>
 #include <stdexcept>
 #include <variant>
@@ -35,6 +36,30 @@ struct TestConfig {
   std::string target_type = "null";
   std::string contact_listener_name;
   bool keep = true;
+  /// Number of threads used for the behaviour phase of each step. Zero uses
+  /// one thread per core.
+  int num_threads = 1;
+  /// Keep targets in a `TargetStore` instead of giving each one a Box2D
+  /// body. Much faster for large numbers of static targets.
+  bool use_target_store = false;
+  /// How targets are spread over the map: "uniform", "stratified",
+  /// "poisson" or "clustered".
+  std::string target_placement = "uniform";
+  /// Seed of the drone and target layouts. Tests with the same map, counts,
+  /// placement and seed share one cached layout; a negative seed draws new
+  /// layouts for every test.
+  int64_t layout_seed = -1;
+  /// Seed of every random draw in the test: the layouts when `layout_seed`
+  /// is negative, the starting velocities, and the random number stream of
+  /// each drone. A negative seed draws a new one, which is written to the
+  /// log so the test can be repeated.
+  int64_t seed = -1;
+  /// Number of recent steps kept in a timeline of the test, written as
+  /// `trace.json` next to its log. Zero turns tracing off.
+  int trace_steps = 0;
+  /// Count hardware events in the world step and behaviour phase of the
+  /// test, where the system allows it.
+  bool hardware_counters = false;
   // FUTURE: std::function<void()> drone_setup;
   // FUTURE: std::function<void()> target_setup;
 };
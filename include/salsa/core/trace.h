@@ -0,0 +1,111 @@
+/// @file trace.h
+/// @brief Contains the `StepTracer` class, which keeps a timeline of the most
+/// recent steps of a `Sim` and writes it in the Chrome trace event format.
+#ifndef SWARM_SIM_CORE_TRACE_H
+#define SWARM_SIM_CORE_TRACE_H
+
+#include <box2d/box2d.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+#include "salsa/core/profile.h"
+
+namespace salsa {
+
+/// @brief One span of time on the timeline of a step.
+struct TraceEvent {
+  /// What the span covers. Must outlive the tracer, so it is always a string
+  /// literal.
+  const char *name = "";
+  uint64_t step = 0;        ///< The step the span belongs to.
+  int64_t start_ns = 0;     ///< Start, from when the tracer was created.
+  int64_t duration_ns = 0;  ///< Length of the span.
+  /// Thread the span ran on: 0 for the thread stepping the simulation, and
+  /// the worker index for behaviour batches on the thread pool.
+  uint32_t thread = 0;
+  /// Number of items the span covers, such as drones in a batch, or -1.
+  int32_t count = -1;
+};
+
+/// @brief A timeline of the phases of the most recent steps of a simulation.
+///
+/// Where `StepProfile` sums phases up, the tracer keeps every span, so a
+/// single slow step can be taken apart: which batch of drones held the
+/// behaviour phase up, or which contacts the world step spent its time in.
+/// Only the last `capacity()` steps are kept, in a ring of per-step event
+/// lists that are reused once full, so memory stays bounded over a test of
+/// any length. A step with more than `maxEventsPerStep()` spans keeps the
+/// first ones and counts the rest in `dropped()`.
+///
+/// Spans may be recorded from several threads at once. The result opens in
+/// `chrome://tracing` or the Perfetto UI.
+class StepTracer {
+ public:
+  static constexpr std::size_t kDefaultSteps = 256;
+  static constexpr std::size_t kDefaultMaxEventsPerStep = 4096;
+
+  /// @param steps Number of recent steps kept.
+  /// @param max_events_per_step Number of spans kept for each step.
+  explicit StepTracer(std::size_t steps = kDefaultSteps,
+                      std::size_t max_events_per_step =
+                          kDefaultMaxEventsPerStep);
+
+  /// @brief Adds a span to the current step.
+  /// @param name A string literal naming the span.
+  void record(const char *name, uint32_t thread, ProfileClock::time_point start,
+              ProfileClock::time_point end, int32_t count = -1);
+
+  /// @brief Adds the world step that ended at `end`, and its Box2D phases,
+  /// from Box2D's own profile of the step.
+  ///
+  /// Box2D only keeps how long each phase took, so the phases are laid end to
+  /// end in the order `b2World::Step` runs them, with the broad phase at the
+  /// end of the solver, where Box2D updates it.
+  void recordWorld(const b2Profile &profile, ProfileClock::time_point end);
+
+  /// @brief Closes the current step, making room for the next one by
+  /// forgetting the oldest step if the ring is full.
+  void endStep();
+
+  /// @brief Forgets every step, and starts counting steps from zero again.
+  void clear();
+
+  /// @brief The spans of the steps kept, oldest step first.
+  std::vector<TraceEvent> events() const;
+
+  /// @brief Number of steps ended since the tracer was created or cleared.
+  uint64_t steps() const;
+  std::size_t capacity() const { return steps_.size(); }
+  std::size_t maxEventsPerStep() const { return max_events_per_step_; }
+  /// @brief Number of spans left out of full steps still kept.
+  std::size_t dropped() const;
+
+  /// @brief The steps kept as a Chrome trace: an object with a
+  /// `traceEvents` array of complete ("X") events, in microseconds.
+  nlohmann::json toJson() const;
+
+  /// @brief Writes `toJson()` to `path`.
+  /// @return Whether the file could be written.
+  bool write(const std::filesystem::path &path) const;
+
+ private:
+  struct Step {
+    std::vector<TraceEvent> events;
+    std::size_t dropped = 0;
+  };
+
+  mutable std::mutex mutex_;
+  ProfileClock::time_point origin_ = ProfileClock::now();
+  std::size_t max_events_per_step_;
+  std::vector<Step> steps_;
+  uint64_t step_ = 0;  ///< The step being recorded, in `steps_[step_ % n]`.
+};
+
+}  // namespace salsa
+
+#endif  // SWARM_SIM_CORE_TRACE_H
@@ -28,6 +28,8 @@ class Drone : public Entity {
       targets_found_;       ///< List of targets detected by the drone
   b2Fixture *view_sensor_{};  ///< Sensor fixture for target detection
   Behaviour *behaviour_;    ///< Current behavior governing the drone's actions
+  b2Vec2 velocity_command_{};  ///< Velocity requested by the behaviour
+  bool has_velocity_command_ = false;  ///< Whether a command is pending
 
   /// @name Phsyical and Sensor attributes
   ///@{
@@ -46,8 +48,18 @@ class Drone : public Entity {
   /// @param position Initial position of the drone.
   /// @param behaviour Behaviour assigned to control the drone.
   /// @param config Configuration settings of the drone.
+  /// The drone starts with a random velocity drawn from a generator local to
+  /// the calling thread.
   Drone(b2World *world, const b2Vec2 &position, Behaviour &behaviour,
         const DroneConfiguration &config);
+  /// @brief Constructor to create a drone with a given starting velocity.
+  /// @param world Pointer to the b2World where the drone operates.
+  /// @param position Initial position of the drone.
+  /// @param behaviour Behaviour assigned to control the drone.
+  /// @param config Configuration settings of the drone.
+  /// @param initial_velocity Linear velocity the drone starts with.
+  Drone(b2World *world, const b2Vec2 &position, Behaviour &behaviour,
+        const DroneConfiguration &config, const b2Vec2 &initial_velocity);
   /// @brief Destructor for Drone.
   virtual ~Drone();
 
@@ -57,9 +69,54 @@ class Drone : public Entity {
   /// @param drones List of all drones in the simulation for interaction.
   void update(const std::vector<std::unique_ptr<Drone>> &drones);
 
+  /// @brief Updates drone's state and behavior execution for a simulation step.
+  /// @param drones List of all drones in the simulation for interaction.
+  /// @param context Per-step simulation context passed on to the behaviour.
+  void update(const std::vector<std::unique_ptr<Drone>> &drones,
+              const behaviour::Context &context);
+
+  /// @brief First phase of an update. Runs the behaviour, which reads the
+  /// state of the swarm and records a velocity command without touching the
+  /// drone's body. Safe to call for several drones at once if the behaviour
+  /// supports parallel execution.
+  /// @param drones List of all drones in the simulation for interaction.
+  /// @param context Per-step simulation context passed on to the behaviour.
+  void computeCommand(const std::vector<std::unique_ptr<Drone>> &drones,
+                      const behaviour::Context &context);
+
+  /// @brief Second phase of an update. Applies the pending velocity command,
+  /// if any, to the drone's body. Must not run concurrently with any other
+  /// access to the world.
+  void applyCommand();
+
+  /// @brief Requests a new velocity for the drone. Behaviours call this
+  /// instead of setting the body velocity directly, so that every drone in a
+  /// step sees the same snapshot of the swarm. The command is applied to the
+  /// body by `applyCommand`.
+  /// @param velocity The new linear velocity.
+  void commandVelocity(const b2Vec2 &velocity) {
+    velocity_command_ = velocity;
+    has_velocity_command_ = true;
+  }
+
   /// @brief Clears the list of targets found by the drone.
   void clearLists();
 
+  /// @brief Puts the drone back to the state it was created in, at a new
+  /// position and with a new velocity, keeping its body and fixtures.
+  /// @param position The position to move the drone to.
+  /// @param velocity The linear velocity the drone starts again with.
+  void respawn(const b2Vec2 &position, const b2Vec2 &velocity);
+
+  /// @brief Puts the drone's body into an exact state, as saved in a
+  /// checkpoint, and forgets anything pending from the current step.
+  /// @param position The position of the body.
+  /// @param angle The angle of the body in radians.
+  /// @param velocity The linear velocity of the body.
+  /// @param angular_velocity The angular velocity of the body.
+  void restore(const b2Vec2 &position, float angle, const b2Vec2 &velocity,
+               float angular_velocity);
+
   /// @brief Updates the view sensor of the drone.
   void updateSensorRange();
 
@@ -5,7 +5,9 @@
 
 #include <box2d/box2d.h>
 
+#include <cstddef>
 #include <memory>
+#include <vector>
 
 #include "drone.h"
 #include "drone_configuration.h"
@@ -26,6 +28,46 @@ class DroneFactory {
                                             const DroneConfiguration &config) {
     return std::make_unique<Drone>(world, position, behaviour, config);
   }
+
+  /// @brief Creates a drone with the given parameters and starting velocity
+  /// @param world The Box2D world in which the drone will exist
+  /// @param position The position to create the drone in.
+  /// @param behaviour The initial behaviour the drone exhibits.
+  /// @param config The configuration settings for the drone
+  /// @param initial_velocity The linear velocity the drone starts with.
+  /// @return a unique pointer to the created drone
+  static std::unique_ptr<Drone> createDrone(b2World *world,
+                                            const b2Vec2 &position,
+                                            Behaviour &behaviour,
+                                            const DroneConfiguration &config,
+                                            const b2Vec2 &initial_velocity) {
+    return std::make_unique<Drone>(world, position, behaviour, config,
+                                   initial_velocity);
+  }
+
+  /// @brief Creates one drone per position, such as the points of a
+  /// `Layout`, with ids numbered on from `first_id`.
+  /// @param world The Box2D world in which the drones will exist
+  /// @param positions The position of each drone.
+  /// @param velocities The starting velocity of each drone.
+  /// @param count The number of drones to create.
+  /// @param behaviour The initial behaviour the drones exhibit.
+  /// @param config The configuration settings for the drones
+  /// @param first_id The id of the first drone.
+  /// @return the created drones, in the order of their positions
+  static std::vector<std::unique_ptr<Drone>> createDrones(
+      b2World *world, const b2Vec2 *positions, const b2Vec2 *velocities,
+      std::size_t count, Behaviour &behaviour, const DroneConfiguration &config,
+      int first_id = 0) {
+    std::vector<std::unique_ptr<Drone>> drones;
+    drones.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+      drones.push_back(std::make_unique<Drone>(world, positions[i], behaviour,
+                                               config, velocities[i]));
+      drones.back()->id(first_id + static_cast<int>(i));
+    }
+    return drones;
+  }
 };
 
 }  // namespace salsa
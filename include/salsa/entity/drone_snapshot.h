@@ -0,0 +1,56 @@
+/// @file drone_snapshot.h
+/// @brief Contains the `DroneSnapshot` struct, a structure-of-arrays copy of
+/// the swarm state taken once per simulation step.
+#ifndef SWARM_SIM_DRONES_DRONE_SNAPSHOT_H
+#define SWARM_SIM_DRONES_DRONE_SNAPSHOT_H
+
+#include <box2d/box2d.h>
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace salsa {
+
+class Drone;
+
+/// @brief Structure-of-arrays copy of the state of every drone at the start of
+/// a simulation step.
+///
+/// Reading a neighbour through `Drone` means following the `unique_ptr`, the
+/// `Drone` and then its `b2Body` before reaching the position. The snapshot
+/// lays the same values out in contiguous arrays, indexed in the same order as
+/// the drone list, so that behaviour kernels can stream through them.
+///
+/// The snapshot is only valid for the step it was captured in.
+struct DroneSnapshot {
+  std::vector<float> x;          ///< Position x, in world units.
+  std::vector<float> y;          ///< Position y, in world units.
+  std::vector<float> vx;         ///< Linear velocity x.
+  std::vector<float> vy;         ///< Linear velocity y.
+  std::vector<int> id;           ///< Drone identifier.
+  std::vector<float> max_speed;  ///< Maximum speed of the drone.
+  std::vector<float> max_force;  ///< Maximum steering force of the drone.
+
+  /// @brief Copies the current state of every drone into the arrays.
+  /// Capacity is kept between calls, so this does not allocate once the
+  /// arrays have grown to fit the swarm.
+  /// @param drones The drones to capture.
+  void capture(const std::vector<std::unique_ptr<Drone>> &drones);
+
+  /// @brief Empties every array.
+  void clear();
+
+  /// @brief Bytes reserved by the arrays.
+  std::size_t bytes() const;
+
+  std::size_t size() const { return x.size(); }
+  bool empty() const { return x.empty(); }
+
+  b2Vec2 position(std::size_t i) const { return b2Vec2(x[i], y[i]); }
+  b2Vec2 velocity(std::size_t i) const { return b2Vec2(vx[i], vy[i]); }
+};
+
+}  // namespace salsa
+
+#endif  // SWARM_SIM_DRONES_DRONE_SNAPSHOT_H
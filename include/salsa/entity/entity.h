@@ -24,8 +24,15 @@ namespace salsa {
 /// and color, and the ability to log events and notify observers.
 class Entity {
  protected:
-  b2Body *body_;    ///< Pointer to the Box2D body associated with this entity.
-  b2World *world_;  ///< Pointer to the Box2D world in which this entity exists.
+  /// Pointer to the Box2D body associated with this entity, or null for an
+  /// entity created without a world.
+  b2Body *body_ = nullptr;
+  /// Pointer to the Box2D world in which this entity exists.
+  b2World *world_ = nullptr;
+  b2Vec2 position_{};  ///< Position of an entity that has no body.
+  /// Fixture user data pointing back at this entity. Owned by the entity, so
+  /// it lives exactly as long as the fixtures that refer to it.
+  UserData user_data_{this};
   int id_{};          ///< Numeric identifier for the entity.
   float radius_;    ///< Radius of the entity, used for collision and rendering.
   b2Color color_;   ///< Color of the entity, used for rendering.
@@ -39,7 +46,11 @@ class Entity {
 
  public:
   /// @brief Constructor for initializing an entity in the world.
-  /// @param world Pointer to the b2World.
+  ///
+  /// If `world` is null, no body is created and the entity stays at
+  /// `position`. Static targets kept in a `TargetStore` are made this way.
+  /// @param world Pointer to the b2World, or null for an entity without a
+  /// body.
   /// @param position Initial position of the entity.
   /// @param is_static Flag indicating if the entity is static.
   /// @param radius Radius of the entity.
@@ -57,6 +68,16 @@ class Entity {
     }
   }
 
+  /// @brief Forgets the entity's body without destroying it, for when the
+  /// whole world is about to be freed at once. The entity is left without a
+  /// body, where it last was.
+  void abandonBody() {
+    if (body_) {
+      position_ = body_->GetPosition();
+      body_ = nullptr;
+    }
+  }
+
   /// @brief Adds an observer to the list of entity observers.
   /// @param observer Shared pointer to the observer to add.
   void addObserver(std::shared_ptr<Observer> observer) {
@@ -73,7 +94,16 @@ class Entity {
   float radius() const { return radius_; }
   void radius(float new_radius) { radius_ = new_radius; }
 
-  b2Vec2 position() const { return body_->GetPosition(); }
+  b2Vec2 position() const {
+    return body_ ? body_->GetPosition() : position_;
+  }
+  /// @brief Moves the entity, and its body if it has one, keeping its angle.
+  void position(const b2Vec2 &new_position) {
+    position_ = new_position;
+    if (body_) {
+      body_->SetTransform(new_position, body_->GetAngle());
+    }
+  }
 
   int id() const { return id_; }
   void id(int new_id) { id_ = new_id; }
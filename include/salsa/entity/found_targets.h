@@ -0,0 +1,110 @@
+/// @file found_targets.h
+/// @brief Contains the `FoundTargets` class, which keeps track of which
+/// targets in a simulation have been found.
+#ifndef SWARM_ENTITY_FOUND_TARGETS_H
+#define SWARM_ENTITY_FOUND_TARGETS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace salsa {
+
+/// @brief Found state of every target in a simulation, indexed by target id.
+///
+/// Found flags are kept as a dense bitset, next to a running count that is
+/// updated only when a flag changes, so the number of found targets is known
+/// without visiting any target. Targets that flip to found are also appended
+/// to a list, once each per step however often they flip, which `beginStep`
+/// hands over as the targets found during the last step. Both lists are
+/// reserved to the number of targets up front, so marking targets and
+/// starting steps do not allocate.
+///
+/// Marking is done by one thread at a time (the one stepping the
+/// simulation); `count` may be read from any thread.
+class FoundTargets {
+ public:
+  /// @brief Forgets every found target and resizes for `target_count`
+  /// targets, with ids from zero to `target_count - 1`.
+  void reset(std::size_t target_count);
+
+  /// @brief Marks a target found.
+  /// @return True if the target was not already found. Ids out of range are
+  /// ignored.
+  bool markFound(int id) {
+    if (!inRange(id)) {
+      return false;
+    }
+    uint64_t &word = words_[id >> 6];
+    const uint64_t bit = uint64_t{1} << (id & 63);
+    if (word & bit) {
+      return false;
+    }
+    word |= bit;
+    count_.fetch_add(1, std::memory_order_relaxed);
+    uint64_t &listed = listed_words_[id >> 6];
+    if (!(listed & bit)) {
+      listed |= bit;
+      found_since_step_.push_back(id);
+    }
+    return true;
+  }
+
+  /// @brief Marks a target not found.
+  /// @return True if the target was found. Ids out of range are ignored.
+  bool markNotFound(int id) {
+    if (!inRange(id)) {
+      return false;
+    }
+    uint64_t &word = words_[id >> 6];
+    const uint64_t bit = uint64_t{1} << (id & 63);
+    if (!(word & bit)) {
+      return false;
+    }
+    word &= ~bit;
+    count_.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  bool isFound(int id) const {
+    return inRange(id) && (words_[id >> 6] >> (id & 63)) & 1;
+  }
+
+  /// @brief Number of targets currently found.
+  int count() const { return count_.load(std::memory_order_relaxed); }
+
+  std::size_t size() const { return size_; }
+
+  /// @brief Starts a new step. The targets marked found since the previous
+  /// call, and still found, become `found_this_step`.
+  void beginStep();
+
+  /// @brief Forgets which targets were found during the last step and since,
+  /// keeping every target's found state. Used when the found state is
+  /// restored rather than discovered.
+  void clearSteps();
+
+  /// @brief Ids of the targets first found during the last step, in the
+  /// order they were found.
+  const std::vector<int> &found_this_step() const { return found_this_step_; }
+
+ private:
+  std::size_t size_ = 0;
+  std::vector<uint64_t> words_;
+  /// Targets in `found_since_step_`, so none is listed twice.
+  std::vector<uint64_t> listed_words_;
+  std::atomic<int> count_{0};
+  /// Targets found since `beginStep` was last called.
+  std::vector<int> found_since_step_;
+  /// Targets found in the step before that.
+  std::vector<int> found_this_step_;
+
+  bool inRange(int id) const {
+    return id >= 0 && static_cast<std::size_t>(id) < size_;
+  }
+};
+
+}  // namespace salsa
+
+#endif  // SWARM_ENTITY_FOUND_TARGETS_H
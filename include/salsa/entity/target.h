@@ -11,6 +11,8 @@
 
 namespace salsa {
 
+class FoundTargets;
+
 /// @class Target
 /// @brief Represents a target object in the simulation environment.
 ///
@@ -19,6 +21,8 @@ namespace salsa {
 class Target : public Entity {
  protected:
   bool found_ = false;
+  /// Where changes to `found_` are recorded, if anywhere.
+  FoundTargets *found_targets_ = nullptr;
 
  public:
   /// @brief Constructor for the Target.
@@ -30,7 +34,16 @@ class Target : public Entity {
   virtual std::string getType() const = 0;
 
   bool isFound() const { return found_; }
-  void setFound(bool found) { found_ = found; }
+
+  /// @brief Marks the target found or not found. If the target is tracked by
+  /// a `FoundTargets`, it is updated as well.
+  void setFound(bool found);
+
+  /// @brief Records changes to the found state of this target in
+  /// `found_targets`, under the target's id. Pass null to stop.
+  void trackFoundIn(FoundTargets *found_targets) {
+    found_targets_ = found_targets;
+  }
 };
 
 }  // namespace salsa
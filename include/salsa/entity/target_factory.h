@@ -5,13 +5,16 @@
 #define SWARM_ENTITY_TARGET_FACTORY_H
 
 #include <any>
+#include <cstddef>
 #include <functional>
 #include <iostream>
 #include <map>
 #include <memory>
 #include <tuple>
 #include <typeinfo>
+#include <vector>
 
+#include "salsa/entity/target_pool.h"
 #include "salsa/utils/object_types.h"
 #include "target.h"
 
@@ -27,6 +30,23 @@ class TargetFactory {
   using TargetCreateFunc = std::function<std::shared_ptr<Target>(
       b2World*, const b2Vec2&, int, std::any)>;
   static std::map<std::string, TargetCreateFunc> registry;
+  using TargetBulkCreateFunc = std::function<TargetHandle(
+      TargetPool&, b2World*, const b2Vec2*, std::size_t, int,
+      const std::any&)>;
+  static std::map<std::string, TargetBulkCreateFunc> bulk_registry;
+
+  /// Constructs one target of type `T` per position in a single block of
+  /// `pool`, passing `extraArgs` after the world, position and id.
+  template <typename T, typename Tuple>
+  static TargetHandle createBlock(TargetPool& pool, b2World* world,
+                                  const b2Vec2* positions, std::size_t count,
+                                  int firstId, const Tuple& extraArgs) {
+    return pool.createMany<T>(count, [&](std::size_t i) {
+      return std::tuple_cat(
+          std::make_tuple(world, positions[i], firstId + static_cast<int>(i)),
+          extraArgs);
+    });
+  }
 
  public:
   /// Registers a target type with the factory.
@@ -50,6 +70,13 @@ class TargetFactory {
         return nullptr;
       }
     };
+    bulk_registry[name] = [fixedArgsTuple = std::make_tuple(fixedArgs...)](
+                              TargetPool& pool, b2World* world,
+                              const b2Vec2* positions, std::size_t count,
+                              int firstId, const std::any&) -> TargetHandle {
+      return createBlock<T>(pool, world, positions, count, firstId,
+                            fixedArgsTuple);
+    };
   }
   /// Registers a target type with additional parameters to be unpacked during
   /// creation.
@@ -72,6 +99,58 @@ class TargetFactory {
         return nullptr;
       }
     };
+    bulk_registry[name] = [](TargetPool& pool, b2World* world,
+                             const b2Vec2* positions, std::size_t count,
+                             int firstId,
+                             const std::any& packedArgs) -> TargetHandle {
+      try {
+        return createBlock<T>(pool, world, positions, count, firstId,
+                              std::any_cast<std::tuple<Args...>>(packedArgs));
+      } catch (const std::bad_any_cast& e) {
+        std::cerr << "Bad any_cast in factory creation: " << e.what() << '\n';
+        return {};
+      }
+    };
+  }
+
+  /// Creates one target of a registered type per position, all in a single
+  /// block of `pool`.
+  /// @param type The type identifier of the targets.
+  /// @param pool The pool to create the targets in.
+  /// @param world Pointer to the physics world where the targets exist, or
+  /// null for targets without a body.
+  /// @param positions The position of each target, such as the points of a
+  /// `Layout`.
+  /// @param count The number of targets to create.
+  /// @param firstId The identifier of the first target. The rest are
+  /// numbered on from it.
+  /// @param packedArgs Any additional arguments required for creating the
+  /// targets.
+  /// @return Handle of the first target created, which is invalid if the type
+  /// is not registered or no targets were created.
+  static TargetHandle createTargets(const std::string& type, TargetPool& pool,
+                                    b2World* world, const b2Vec2* positions,
+                                    std::size_t count, int firstId,
+                                    const std::any& packedArgs = std::any()) {
+    const auto it = bulk_registry.find(type);
+    if (it == bulk_registry.end()) {
+      std::cerr << "Target type " << type << " not found in registry.\n";
+      return {};
+    }
+    return it->second(pool, world, positions, count, firstId, packedArgs);
+  }
+
+  /// Creates one target of a registered type per position, all in a single
+  /// block of `pool`.
+  /// @see createTargets(const std::string&, TargetPool&, b2World*, const
+  /// b2Vec2*, std::size_t, int, const std::any&)
+  static TargetHandle createTargets(const std::string& type, TargetPool& pool,
+                                    b2World* world,
+                                    const std::vector<b2Vec2>& positions,
+                                    int firstId,
+                                    const std::any& packedArgs = std::any()) {
+    return createTargets(type, pool, world, positions.data(), positions.size(),
+                         firstId, packedArgs);
   }
 
   /// Creates a target of a registered type.
@@ -0,0 +1,163 @@
+/// @file target_pool.h
+/// @brief Contains the `TargetPool` class, which owns the targets of a
+/// simulation in contiguous blocks.
+#ifndef SWARM_ENTITY_TARGET_POOL_H
+#define SWARM_ENTITY_TARGET_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "salsa/entity/target.h"
+
+namespace salsa {
+
+/// @brief Stable reference to a target in a `TargetPool`.
+///
+/// A handle stays valid, and keeps referring to the same target, until the
+/// pool is cleared or destroyed.
+struct TargetHandle {
+  static constexpr uint32_t kInvalid = std::numeric_limits<uint32_t>::max();
+
+  uint32_t index = kInvalid;  ///< Position of the target in the pool.
+
+  bool valid() const { return index != kInvalid; }
+  bool operator==(const TargetHandle &other) const {
+    return index == other.index;
+  }
+  bool operator!=(const TargetHandle &other) const {
+    return index != other.index;
+  }
+};
+
+/// @brief Owns the targets of one simulation.
+///
+/// Targets are constructed in blocks: `createMany` makes one allocation for
+/// all of the targets it constructs, which sit next to each other in memory.
+/// Targets never move once constructed, so raw pointers and handles to them
+/// stay valid until `clear` destroys every target and releases every block
+/// at once, or `truncate` destroys them from the end.
+///
+/// @code
+/// salsa::TargetPool pool;
+/// const auto first = pool.createMany<Tree>(positions.size(), [&](size_t i) {
+///   return std::make_tuple(world, positions[i], static_cast<int>(i));
+/// });
+/// Target *tree = pool.get(first);
+/// @endcode
+class TargetPool {
+ public:
+  TargetPool() = default;
+  ~TargetPool() { clear(); }
+
+  TargetPool(const TargetPool &) = delete;
+  TargetPool &operator=(const TargetPool &) = delete;
+
+  /// @brief Constructs `count` targets of type `T` in a single block.
+  /// @param count Number of targets to construct.
+  /// @param args_at Called with the index of each target in the block, from
+  /// zero, and returns a tuple of the arguments for its constructor.
+  /// @return Handle of the first target. The rest follow it in order, so the
+  /// i-th target's handle has index `first.index + i`. Invalid if `count` is
+  /// zero.
+  template <typename T, typename ArgsAt>
+  TargetHandle createMany(std::size_t count, ArgsAt &&args_at) {
+    static_assert(std::is_base_of<Target, T>::value,
+                  "TargetPool only holds targets");
+    if (count == 0) {
+      return {};
+    }
+    Block block;
+    block.data = ::operator new(count * sizeof(T),
+                                std::align_val_t(alignof(T)));
+    block.bytes = count * sizeof(T);
+    block.alignment = alignof(T);
+    block.destroy = [](void *data, const std::size_t begin,
+                       const std::size_t end) {
+      T *items = static_cast<T *>(data);
+      for (std::size_t i = end; i > begin; --i) {
+        items[i - 1].~T();
+      }
+    };
+
+    const TargetHandle first{static_cast<uint32_t>(targets_.size())};
+    blocks_.reserve(blocks_.size() + 1);
+    targets_.reserve(targets_.size() + count);
+    T *items = static_cast<T *>(block.data);
+    try {
+      for (; block.count < count; ++block.count) {
+        T *item = std::apply(
+            [&](auto &&...args) {
+              return new (items + block.count)
+                  T(std::forward<decltype(args)>(args)...);
+            },
+            args_at(block.count));
+        targets_.push_back(item);
+      }
+    } catch (...) {
+      targets_.resize(first.index);
+      release(block);
+      throw;
+    }
+    blocks_.push_back(block);
+    return first;
+  }
+
+  /// @brief Constructs a single target of type `T`.
+  /// @return Handle of the new target.
+  template <typename T, typename... Args>
+  TargetHandle create(Args &&...args) {
+    auto packed = std::forward_as_tuple(std::forward<Args>(args)...);
+    return createMany<T>(1, [&](std::size_t) { return std::move(packed); });
+  }
+
+  /// @brief Destroys every target and releases all of their memory.
+  void clear();
+
+  /// @brief Destroys every target after the first `count`, newest first,
+  /// leaving the rest where they are. Blocks left empty are released; a
+  /// block that still holds earlier targets keeps its memory until `clear`.
+  void truncate(std::size_t count);
+
+  Target *get(TargetHandle handle) const {
+    return handle.index < targets_.size() ? targets_[handle.index] : nullptr;
+  }
+  Target *operator[](std::size_t index) const { return targets_[index]; }
+
+  /// @brief Every target in the pool, in the order they were created.
+  const std::vector<Target *> &targets() const { return targets_; }
+
+  std::size_t size() const { return targets_.size(); }
+  bool empty() const { return targets_.empty(); }
+
+  /// @brief Number of blocks, which is the number of allocations made for
+  /// targets.
+  std::size_t block_count() const { return blocks_.size(); }
+
+  /// @brief Bytes of the blocks and of the list of targets.
+  std::size_t bytes() const;
+
+ private:
+  struct Block {
+    void *data = nullptr;
+    std::size_t count = 0;  ///< Targets constructed in the block.
+    std::size_t bytes = 0;
+    std::size_t alignment = 0;
+    /// Destroys the targets from `begin` up to `end` in the block.
+    void (*destroy)(void *data, std::size_t begin, std::size_t end) = nullptr;
+  };
+
+  std::vector<Block> blocks_;
+  std::vector<Target *> targets_;
+
+  static void release(Block &block);
+};
+
+}  // namespace salsa
+
+#endif  // SWARM_ENTITY_TARGET_POOL_H
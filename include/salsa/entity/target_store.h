@@ -0,0 +1,95 @@
+/// @file target_store.h
+/// @brief Contains the `TargetStore` class, which keeps static targets out of
+/// Box2D and detects them with a grid query instead of sensor contacts.
+#ifndef SWARM_ENTITY_TARGET_STORE_H
+#define SWARM_ENTITY_TARGET_STORE_H
+
+#include <box2d/box2d.h>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "salsa/entity/drone.h"
+#include "salsa/entity/target.h"
+#include "salsa/utils/base_contact_listener.h"
+#include "salsa/utils/spatial_grid.h"
+
+namespace salsa {
+
+/// @brief Flat store of static targets, indexed by a `SpatialGrid`.
+///
+/// Every target in the store is a Box2D-free `Target` (created with a null
+/// world), so tens of thousands of them add nothing to the broadphase.
+/// Instead, `detect` queries the grid around each drone once per step, with
+/// the drone's camera view range as the radius.
+///
+/// Detection keeps the semantics of a sensor contact: a drone detects a
+/// target once when the target comes into view, not on every step it stays
+/// in view, and again if it leaves and comes back. For each detection the
+/// contact listener's detection handler for the target type is called (see
+/// `BaseContactListener::addDetectionHandler`). Without one, the target is
+/// marked found with `Target::setFound` and passed to
+/// `Drone::addTargetFound`, as a typical collision handler would.
+class TargetStore {
+ public:
+  /// @brief Indexes `targets`, replacing anything already in the store.
+  /// @param targets The targets to index, such as those of a `TargetPool`.
+  /// They must not move, and must outlive the store or the next call to
+  /// `build` or `clear`.
+  /// @param cell_size Edge length of a grid cell. Detection is cheapest when
+  /// this is close to the drones' camera view range.
+  void build(const std::vector<Target *> &targets, float cell_size);
+
+  /// @brief Detects the targets that have come into view of each drone since
+  /// the previous call.
+  /// @param drones The drones doing the detecting. A drone is matched with
+  /// its state from the previous call by its position in the vector.
+  /// @param listener The listener whose detection handlers are called. May be
+  /// null, in which case every detection is handled the default way.
+  void detect(const std::vector<std::unique_ptr<Drone>> &drones,
+              const BaseContactListener *listener);
+
+  /// @brief Records which targets are in view of each drone, as `detect`
+  /// does, without detecting any of them. Used to carry on from a restored
+  /// state, in which the targets in view have already been detected.
+  void observe(const std::vector<std::unique_ptr<Drone>> &drones);
+
+  /// @brief Removes every target, and forgets which targets were in view.
+  void clear();
+
+  std::size_t size() const { return targets_.size(); }
+  bool empty() const { return targets_.empty(); }
+  /// @brief Bytes reserved by the store, its grid and what is in view.
+  std::size_t bytes() const;
+  const std::vector<Target *> &targets() const { return targets_; }
+
+ private:
+  std::vector<Target *> targets_;
+  std::vector<b2Vec2> positions_;
+  std::vector<float> radii_;
+  float max_radius_ = 0.0f;
+  SpatialGrid grid_;
+
+  /// Distinct target type names, and the index of each target's type, so
+  /// the handler lookup does not have to name the type on every detection.
+  std::vector<std::string> type_names_;
+  std::vector<int> target_types_;
+
+  /// Targets in view of each drone at the previous call, in ascending order.
+  std::vector<std::vector<int>> in_view_;
+  /// Scratch buffer for the targets in view of the current drone.
+  std::vector<int> query_;
+
+  /// Updates `in_view_`, and detects the targets that came into view if
+  /// `report` is set.
+  void scan(const std::vector<std::unique_ptr<Drone>> &drones,
+            const BaseContactListener *listener, bool report);
+  void onDetected(Drone &drone, int target,
+                  const BaseContactListener *listener);
+};
+
+}  // namespace salsa
+
+#endif  // SWARM_ENTITY_TARGET_STORE_H
@@ -5,20 +5,42 @@
 #include <spdlog/spdlog.h>
 
 #include "salsa/behaviours/behaviour.h"
+#include "salsa/behaviours/context.h"
 #include "salsa/behaviours/parameter.h"
 #include "salsa/behaviours/registry.h"
+#include "salsa/core/checkpoint.h"
 #include "salsa/core/data.h"
+#include "salsa/core/data/telemetry.h"
+#include "salsa/core/data/trajectory.h"
 #include "salsa/core/logger.h"
 #include "salsa/core/map.h"
+#include "salsa/core/memory.h"
+#include "salsa/core/placement.h"
+#include "salsa/core/profile.h"
+#include "salsa/core/runner.h"
+#include "salsa/core/scaling_suite.h"
 #include "salsa/core/sim.h"
+#include "salsa/core/test_executor.h"
 #include "salsa/core/test_queue.h"
+#include "salsa/core/trace.h"
 #include "salsa/entity/drone.h"
 #include "salsa/entity/drone_configuration.h"
 #include "salsa/entity/drone_factory.h"
+#include "salsa/entity/drone_snapshot.h"
 #include "salsa/entity/entity.h"
+#include "salsa/entity/found_targets.h"
 #include "salsa/entity/target.h"
+#include "salsa/entity/target_pool.h"
+#include "salsa/entity/target_store.h"
 #include "salsa/utils/base_contact_listener.h"
 #include "salsa/utils/collision_manager.h"
+#include "salsa/utils/mapped_file.h"
 #include "salsa/utils/object_types.h"
+#include "salsa/utils/obstacle_field.h"
+#include "salsa/utils/perf_counters.h"
+#include "salsa/utils/pheromone_grid.h"
 #include "salsa/utils/raycastcallback.h"
+#include "salsa/utils/rng.h"
+#include "salsa/utils/spatial_grid.h"
+#include "salsa/utils/spsc_ring.h"
 #endif  // SWARM_SIM_CORE_SIMULATION_H
\ No newline at end of file
@@ -13,6 +13,9 @@
 
 namespace salsa {
 
+class Drone;
+class Target;
+
 /// @class BaseContactListener
 /// @brief Extends the Box2D contact listener to handle collision events between
 /// registered types.
@@ -26,6 +29,10 @@ class BaseContactListener : public b2ContactListener {
            std::function<void(b2Fixture *, b2Fixture *)>>
       collision_handlers_;
 
+  /// @brief Maps target types to their detection handlers.
+  std::map<std::string, std::function<void(Drone &, Target &)>, std::less<>>
+      detection_handlers_;
+
   std::string name_;
   static std::vector<BaseContactListener *> registry_;
 
@@ -44,6 +51,28 @@ class BaseContactListener : public b2ContactListener {
       std::string type1, std::string type2,
       const std::function<void(b2Fixture*, b2Fixture*)> &handler);
 
+  /// @brief Called when a drone detects a target that has no Box2D body.
+  ///
+  /// Targets kept in a `TargetStore` are found by a grid query instead of a
+  /// sensor contact, so there are no fixtures to hand to a collision handler.
+  /// A detection handler is called instead, at the point a contact would
+  /// have begun: once each time the target comes into the drone's camera
+  /// view range.
+  using DetectionHandler = std::function<void(Drone &, Target &)>;
+
+  /// @brief Registers a detection handler for a target type.
+  /// @param target_type Name of the target type, as used for collision
+  /// handlers.
+  /// @param handler The function to call when a drone detects a target of
+  /// `target_type`.
+  void addDetectionHandler(std::string target_type,
+                           const DetectionHandler &handler);
+
+  /// @brief Finds the detection handler for a target type.
+  /// @return The handler, or null if none is registered.
+  const DetectionHandler *detectionHandler(
+      const std::string &target_type) const;
+
   /// @brief Called when two fixtures begin to touch.
   /// @param contact The contact point information about the collision.
   void BeginContact(b2Contact *contact) override;
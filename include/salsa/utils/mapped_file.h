@@ -0,0 +1,51 @@
+/// @file mapped_file.h
+/// @brief Contains the `MappedFile` class, a read-only memory mapping of a
+/// whole file.
+#ifndef SWARM_UTILS_MAPPED_FILE_H
+#define SWARM_UTILS_MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+namespace salsa {
+
+/// @brief Maps a file into memory for reading, on POSIX and Windows.
+///
+/// Pages are loaded by the operating system as they are touched, so opening
+/// even a large file costs almost nothing, and several processes mapping the
+/// same file share one copy of it in the page cache. The mapping is released
+/// when the object is destroyed.
+class MappedFile {
+ public:
+  /// @brief Creates an empty object that maps nothing.
+  MappedFile() = default;
+
+  /// @brief Maps the whole of `path`.
+  /// @throws std::runtime_error If the file cannot be opened or mapped.
+  explicit MappedFile(const std::string &path);
+  ~MappedFile();
+
+  MappedFile(MappedFile &&other) noexcept;
+  MappedFile &operator=(MappedFile &&other) noexcept;
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  /// @brief Start of the mapping. Null for an empty file or object.
+  const unsigned char *data() const { return data_; }
+  std::size_t size() const { return length_; }
+  bool empty() const { return length_ == 0; }
+
+ private:
+  const unsigned char *data_ = nullptr;
+  std::size_t length_ = 0;
+#if defined(_WIN32)
+  void *file_handle_ = nullptr;
+  void *mapping_handle_ = nullptr;
+#endif
+
+  void release();
+};
+
+}  // namespace salsa
+
+#endif  // SWARM_UTILS_MAPPED_FILE_H
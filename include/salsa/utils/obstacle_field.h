@@ -0,0 +1,121 @@
+/// @file obstacle_field.h
+/// @brief Contains the `ObstacleField` class, a precomputed distance field over
+/// the static obstacles of a world.
+#ifndef SWARM_SIM_UTILS_OBSTACLE_FIELD_H
+#define SWARM_SIM_UTILS_OBSTACLE_FIELD_H
+
+#include <box2d/box2d.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace salsa {
+
+/// @brief Signed distance and nearest-obstacle grid rasterised from the static
+/// fixtures of a `b2World`.
+///
+/// Every obstacle is broken down into primitives (the edges of polygons,
+/// edges, chains, and circles), and each grid cell records the primitive
+/// closest to its centre along with the signed distance to it. Distances are
+/// negative inside polygons and circles. Only cells within `max_distance` of
+/// an obstacle are filled in, so the cost of building the field scales with
+/// the length of the obstacle boundaries rather than the size of the map.
+///
+/// Queries look up a fixed number of cells and then compute the exact closest
+/// point on the primitives found, so they cost the same no matter how many
+/// bodies are in the world. The field only considers the fixtures that
+/// `RayCastCallback` treats as obstacles: non-sensor fixtures on static
+/// bodies with category bits `0x0001`.
+class ObstacleField {
+ private:
+  /// A segment from `a` to `b` swept by `radius`. Circles are stored as a
+  /// segment of zero length.
+  struct Primitive {
+    b2Vec2 a;
+    b2Vec2 b;
+    float radius;
+  };
+
+  std::vector<Primitive> primitives_;
+  float max_distance_ = 0.0f;
+  float cell_size_ = 1.0f;
+  float inv_cell_size_ = 1.0f;
+  b2Vec2 origin_{0.0f, 0.0f};
+  int columns_ = 0;
+  int rows_ = 0;
+  /// Signed distance from each cell centre to the nearest obstacle.
+  std::vector<float> distances_;
+  /// Index of the nearest primitive for each cell, or -1 if there is none
+  /// within `max_distance_`.
+  std::vector<int32_t> nearest_;
+
+  void addFixture(const b2Fixture &fixture, const b2Transform &transform);
+  void rasterise();
+  void markInterior(const b2Fixture &fixture);
+  int cellIndex(const b2Vec2 &point) const;
+  b2Vec2 cellCentre(int x, int y) const;
+  static b2Vec2 closestPoint(const Primitive &primitive, const b2Vec2 &point);
+
+ public:
+  /// @brief Default distance, in world units, out to which obstacles are
+  /// recorded.
+  static constexpr float kDefaultMaxDistance = 128.0f;
+  /// @brief Upper bound on the number of cells, used to pick a cell size when
+  /// none is given.
+  static constexpr int kMaxCells = 1 << 20;
+  /// @brief Smallest cell size picked automatically.
+  static constexpr float kMinCellSize = 2.0f;
+  /// @brief Number of cells sampled by `queryPoints`.
+  static constexpr int kQuerySamples = 9;
+
+  ObstacleField() = default;
+
+  /// @brief Builds the field from the static obstacles in a world.
+  /// @param world The world to read obstacles from.
+  /// @param max_distance Obstacles further than this from a cell are not
+  /// recorded for it.
+  /// @param cell_size Edge length of a cell. Zero picks the smallest size,
+  /// no less than `kMinCellSize`, that keeps the grid within `kMaxCells`.
+  explicit ObstacleField(const b2World &world,
+                         float max_distance = kDefaultMaxDistance,
+                         float cell_size = 0.0f);
+
+  /// @brief Returns the signed distance from `point` to the nearest obstacle,
+  /// as sampled at the centre of the cell containing it. Points with no
+  /// obstacle within `max_distance` return `max_distance`.
+  float signedDistance(const b2Vec2 &point) const;
+
+  /// @brief Finds the closest point on the nearest obstacle to `point`.
+  /// @param point The query point.
+  /// @param out Receives the closest obstacle point.
+  /// @return False if there is no obstacle within `max_distance` of the cell
+  /// containing `point`.
+  bool nearestPoint(const b2Vec2 &point, b2Vec2 &out) const;
+
+  /// @brief Finds obstacle points around `point`, as a replacement for
+  /// casting rays in every direction.
+  ///
+  /// Samples the cell containing `point` and eight cells half of `range`
+  /// away from it, one in each of the directions `performRayCasting` uses.
+  /// For each distinct obstacle primitive found, the closest point on it to
+  /// `point` is returned if it lies within `range`.
+  ///
+  /// @param point The query point, usually a drone position.
+  /// @param range The view range. Should be no more than `max_distance`.
+  /// @param out Receives the obstacle points. The vector is cleared first.
+  void queryPoints(const b2Vec2 &point, float range,
+                   std::vector<b2Vec2> &out) const;
+
+  /// @brief Returns true if the field holds no obstacles.
+  bool empty() const { return primitives_.empty(); }
+  /// @brief Bytes reserved by the field's grid and obstacles.
+  std::size_t bytes() const;
+  float max_distance() const { return max_distance_; }
+  float cell_size() const { return cell_size_; }
+  int columns() const { return columns_; }
+  int rows() const { return rows_; }
+};
+
+}  // namespace salsa
+
+#endif  // SWARM_SIM_UTILS_OBSTACLE_FIELD_H
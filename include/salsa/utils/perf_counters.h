@@ -0,0 +1,116 @@
+/// @file perf_counters.h
+/// @brief Contains the `PerfCounters` class, which reads the CPU's hardware
+/// event counters for the calling thread through Linux `perf_event_open`.
+#ifndef SWARM_UTILS_PERF_COUNTERS_H
+#define SWARM_UTILS_PERF_COUNTERS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace salsa {
+
+/// @brief A hardware event counted by `PerfCounters`.
+enum class HardwareEvent {
+  Cycles,        ///< CPU cycles.
+  Instructions,  ///< Instructions retired.
+  CacheMisses,   ///< Last level cache misses.
+  BranchMisses,  ///< Mispredicted branches.
+};
+
+constexpr std::size_t kHardwareEventCount =
+    static_cast<std::size_t>(HardwareEvent::BranchMisses) + 1;
+
+/// @brief A count of each hardware event.
+struct CounterSample {
+  std::array<uint64_t, kHardwareEventCount> values{};
+
+  uint64_t operator[](const HardwareEvent event) const {
+    return values[static_cast<std::size_t>(event)];
+  }
+  uint64_t &operator[](const HardwareEvent event) {
+    return values[static_cast<std::size_t>(event)];
+  }
+
+  CounterSample &operator+=(const CounterSample &other) {
+    for (std::size_t i = 0; i < kHardwareEventCount; i++) {
+      values[i] += other.values[i];
+    }
+    return *this;
+  }
+
+  /// @brief The events counted between two readings, `this` being the later
+  /// one.
+  CounterSample operator-(const CounterSample &earlier) const {
+    CounterSample difference;
+    for (std::size_t i = 0; i < kHardwareEventCount; i++) {
+      difference.values[i] =
+          values[i] > earlier.values[i] ? values[i] - earlier.values[i] : 0;
+    }
+    return difference;
+  }
+
+  /// @brief Instructions per cycle, or zero if no cycles were counted.
+  double ipc() const {
+    const uint64_t cycles = (*this)[HardwareEvent::Cycles];
+    const uint64_t instructions = (*this)[HardwareEvent::Instructions];
+    return cycles > 0 ? static_cast<double>(instructions) /
+                            static_cast<double>(cycles)
+                      : 0.0;
+  }
+};
+
+/// @brief Counts hardware events on the thread that created it.
+///
+/// The events are opened as one `perf_event_open` group, so they are always
+/// counted over the same stretch of time, and a reading costs a single
+/// system call. Only user space is counted, which most systems allow without
+/// special permission. If the kernel has more groups to count than the CPU
+/// has counters, the counts are scaled up from the time the group was
+/// actually counting.
+///
+/// Where the counters cannot be opened, such as off Linux, in a container
+/// without perf permission, or on a virtual machine without a virtual PMU,
+/// `available()` is false, `error()` says why, and every reading is zero.
+/// Events the CPU does not have read as zero, see `counts`.
+class PerfCounters {
+ public:
+  /// @brief Opens the counters for the calling thread.
+  PerfCounters();
+  ~PerfCounters();
+
+  PerfCounters(const PerfCounters &) = delete;
+  PerfCounters &operator=(const PerfCounters &) = delete;
+
+  bool available() const { return available_; }
+  /// @brief Why the counters are not available, or empty if they are.
+  const std::string &error() const { return error_; }
+  /// @brief Whether `event` is counted by this CPU.
+  bool counts(HardwareEvent event) const;
+
+  /// @brief The events counted on this thread since the counters were
+  /// opened. Only meaningful on the thread that opened them.
+  CounterSample read() const;
+
+  /// @brief The counters of the calling thread, opened the first time each
+  /// thread asks for them and kept until it exits.
+  static PerfCounters &forThisThread();
+
+  /// @brief A short name for `event`, such as "llc_misses".
+  static const char *eventName(HardwareEvent event);
+
+ private:
+  bool available_ = false;
+  std::string error_;
+  /// File descriptor of each event, -1 if it is not counted. The cycles
+  /// counter leads the group.
+  std::array<int, kHardwareEventCount> fds_;
+  /// Where each counted event comes in a reading of the group.
+  std::array<int, kHardwareEventCount> slots_;
+  std::size_t counted_ = 0;
+};
+
+}  // namespace salsa
+
+#endif  // SWARM_UTILS_PERF_COUNTERS_H
@@ -0,0 +1,128 @@
+/// @file pheromone_grid.h
+/// @brief Contains the `PheromoneGrid` class, a decaying grid of pheromone
+/// that drones lay down and read back, for stigmergy between them.
+#ifndef SWARM_SIM_UTILS_PHEROMONE_GRID_H
+#define SWARM_SIM_UTILS_PHEROMONE_GRID_H
+
+#include <box2d/box2d.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace salsa {
+
+class CheckpointReader;
+class CheckpointWriter;
+
+/// @brief Pheromone over a uniform grid, decaying exponentially with time.
+///
+/// Each cell keeps the pheromone it held when it was last written, and the
+/// time it was written at. Pheromone is decayed when a cell is read or
+/// written rather than on every tick of the clock, so advancing the clock
+/// costs nothing, a deposit touches one cell, and a query only reads the
+/// cells it covers, however much pheromone is laid elsewhere.
+///
+/// The grid starts empty and grows to cover the cells deposited in, up to
+/// `kMaxCells`. Cells are indexed from the world origin, so growing the grid
+/// never moves pheromone from one cell to another.
+class PheromoneGrid {
+ private:
+  float cell_size_ = 1.0f;
+  float inv_cell_size_ = 1.0f;
+  /// Natural log of the fraction of pheromone left after one unit of time.
+  float log_keep_ = 0.0f;
+  float time_ = 0.0f;
+  /// Cell coordinates of the first column and row.
+  int min_x_ = 0;
+  int min_y_ = 0;
+  int columns_ = 0;
+  int rows_ = 0;
+  /// Pheromone of each cell as of its stamp, row by row.
+  std::vector<float> values_;
+  /// Time each cell was last written at.
+  std::vector<float> stamps_;
+  /// Scratch buffer for `diffuse`.
+  std::vector<float> scratch_;
+
+  bool cellOf(const b2Vec2 &point, int &x, int &y) const;
+  bool grow(int x, int y);
+  float valueAt(std::size_t index) const;
+
+ public:
+  /// @brief Upper bound on the number of cells. Deposits that would grow the
+  /// grid beyond it are dropped.
+  static constexpr int kMaxCells = 1 << 22;
+  /// @brief Fewest cells the grid grows by on a side, so a drone crossing
+  /// into new ground does not regrow the grid on every step.
+  static constexpr int kGrowCells = 16;
+
+  /// @brief Creates an empty grid.
+  /// @param cell_size Edge length of a cell. Queries are cheapest when it is
+  /// a small fraction of the most common query radius.
+  /// @param decay Fraction of pheromone lost per unit of time, from zero to
+  /// just under one.
+  explicit PheromoneGrid(float cell_size = 1.0f, float decay = 0.0f);
+
+  /// @brief Empties the grid and starts its clock again from zero, with a new
+  /// cell size. The decay is kept.
+  void reset(float cell_size);
+  /// @brief Empties the grid and starts its clock again from zero.
+  void clear();
+
+  /// @brief Sets the fraction of pheromone lost per unit of time. Changing it
+  /// applies to the time since each cell was last written, too.
+  void setDecay(float decay);
+  /// @brief Moves the clock on by `dt`.
+  void advance(float dt = 1.0f) { time_ += dt; }
+  float time() const { return time_; }
+
+  /// @brief Adds pheromone to the cell containing `point`.
+  /// @return False if the grid could not grow to cover the point, in which
+  /// case nothing is laid.
+  bool deposit(const b2Vec2 &point, float amount);
+
+  /// @brief Returns the pheromone in the cell containing `point` now.
+  float sample(const b2Vec2 &point) const;
+
+  /// @brief Sums the pull of the pheromone around `centre`.
+  ///
+  /// Every cell whose centre is within `radius` of `centre` pulls towards
+  /// itself with its pheromone over its distance from `centre`, as a point of
+  /// pheromone there would. The cell containing `centre` is left out, as it
+  /// gives no direction.
+  ///
+  /// @return The summed pull, pointing up the gradient. Zero if no pheromone
+  /// is in range.
+  b2Vec2 gradient(const b2Vec2 &centre, float radius) const;
+
+  /// @brief Spreads pheromone to neighbouring cells: each cell keeps `1 -
+  /// rate` of its pheromone and gives a quarter of the rest to each of the
+  /// cells beside it. Pheromone given past the edge of the grid is lost.
+  ///
+  /// Unlike the other operations this reads every cell, so it is best done
+  /// once per step or less. The rows are swept four cells at a time with
+  /// SSE2 or NEON, or one at a time where neither is available. Pheromone
+  /// spread too thin to be held as a normal float is dropped, as denormal
+  /// floats would slow every later sweep.
+  /// @param rate From zero, which does nothing, to one.
+  void diffuse(float rate);
+
+  /// @brief Writes the cells and clock to a checkpoint.
+  void save(CheckpointWriter &out) const;
+  /// @brief Restores the cells and clock written by `save`.
+  /// @throws std::runtime_error If the grid in the checkpoint is malformed.
+  void load(CheckpointReader &in);
+
+  /// @brief Returns true if nothing has been laid since the grid was created
+  /// or emptied.
+  bool empty() const { return values_.empty(); }
+  /// @brief Bytes reserved by the grid.
+  std::size_t bytes() const;
+  float cell_size() const { return cell_size_; }
+  int columns() const { return columns_; }
+  int rows() const { return rows_; }
+};
+
+}  // namespace salsa
+
+#endif  // SWARM_SIM_UTILS_PHEROMONE_GRID_H
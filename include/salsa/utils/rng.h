@@ -0,0 +1,126 @@
+/// @file rng.h
+/// @brief Contains the `Rng` class, the counter-based random number generator
+/// that every random draw in a simulation comes from.
+#ifndef SWARM_SIM_UTILS_RNG_H
+#define SWARM_SIM_UTILS_RNG_H
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+
+namespace salsa {
+
+/// @brief Small, fast random number generator keyed by a seed and a stream
+/// number.
+///
+/// The n-th number of a stream is a hash of its key and of n, in the spirit
+/// of Philox, so streams are independent of one another: a simulation gives
+/// each drone a stream of its own, and the numbers a drone draws do not
+/// depend on which thread runs it or on what the other drones draw. The whole
+/// state is three words, so it can be copied or written to a checkpoint as
+/// it is.
+///
+/// Meets the requirements of a uniform random bit generator, so it can be
+/// used with the distributions of `<random>`. Those distributions are not
+/// specified exactly, so they give different numbers with different standard
+/// libraries; a simulation draws with `uniform`, `below` and `normal` instead,
+/// which give the same numbers everywhere.
+class Rng {
+ public:
+  using result_type = uint64_t;
+
+  /// @brief Creates stream `stream` of `seed`. Every pair of seed and stream
+  /// gives a different sequence.
+  explicit Rng(const uint64_t seed = 0, const uint64_t stream = 0)
+      : key0_(mix(seed)), key1_(mix(key0_ ^ mix(stream + kIncrement))) {}
+
+  /// @brief Draws a seed from `std::random_device`, for runs that are not
+  /// meant to be repeated.
+  static uint64_t randomSeed() {
+    std::random_device device;
+    return (static_cast<uint64_t>(device()) << 32) ^ device();
+  }
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+
+  /// @brief Returns the next number of the stream.
+  result_type operator()() { return at(counter_++); }
+
+  /// @brief Returns the number at position `counter` of the stream, without
+  /// moving the stream on.
+  result_type at(const uint64_t counter) const {
+    return mix(mix(counter ^ key0_) + key1_);
+  }
+
+  /// @brief Returns a float in [0, 1).
+  float uniform() {
+    return static_cast<float>((*this)() >> 40) * (1.0f / 16777216.0f);
+  }
+
+  /// @brief Returns a float in [lo, hi).
+  float uniform(const float lo, const float hi) {
+    return lo + (hi - lo) * uniform();
+  }
+
+  /// @brief Returns an integer in [0, bound), or zero if `bound` is zero.
+  uint64_t below(const uint64_t bound) {
+    if (bound == 0) {
+      return 0;
+    }
+    // Values under the threshold are drawn again, so that every result is
+    // equally likely.
+    const uint64_t threshold = (0 - bound) % bound;
+    uint64_t value = (*this)();
+    while (value < threshold) {
+      value = (*this)();
+    }
+    return value % bound;
+  }
+
+  /// @brief Returns a normally distributed float, by the Box-Muller
+  /// transform of two draws.
+  float normal(const float mean = 0.0f, const float stddev = 1.0f) {
+    // In (0, 1], so the log is finite.
+    const double u1 = 1.0 - static_cast<double>((*this)() >> 11) * 0x1.0p-53;
+    const double u2 = static_cast<double>((*this)() >> 11) * 0x1.0p-53;
+    const double z = std::sqrt(-2.0 * std::log(u1)) *
+                     std::cos(6.283185307179586 * u2);
+    return mean + stddev * static_cast<float>(z);
+  }
+
+  /// @brief Number of values drawn from the stream so far.
+  uint64_t counter() const { return counter_; }
+
+  /// @brief Skips `count` values ahead.
+  void discard(const uint64_t count) { counter_ += count; }
+
+  bool operator==(const Rng &other) const {
+    return key0_ == other.key0_ && key1_ == other.key1_ &&
+           counter_ == other.counter_;
+  }
+  bool operator!=(const Rng &other) const { return !(*this == other); }
+
+ private:
+  static constexpr uint64_t kIncrement = 0x9e3779b97f4a7c15ull;
+
+  uint64_t key0_;
+  uint64_t key1_;
+  uint64_t counter_ = 0;
+
+  /// The SplitMix64 finaliser, a bijection with good avalanche, so no two
+  /// counters of a stream give the same number.
+  static uint64_t mix(uint64_t x) {
+    x += kIncrement;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+  }
+};
+
+}  // namespace salsa
+
+#endif  // SWARM_SIM_UTILS_RNG_H
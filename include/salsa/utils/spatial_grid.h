@@ -0,0 +1,126 @@
+/// @file spatial_grid.h
+/// @brief Contains the `SpatialGrid` class, a uniform grid used to answer
+/// neighbourhood queries over a set of points.
+#ifndef SWARM_SIM_UTILS_SPATIAL_GRID_H
+#define SWARM_SIM_UTILS_SPATIAL_GRID_H
+
+#include <box2d/box2d.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace salsa {
+
+/// @brief Uniform grid over a set of points, rebuilt from scratch each time
+/// the points move.
+///
+/// Points are bucketed into square cells using a counting sort, so building
+/// the grid is O(N) and performs no allocations once the internal buffers
+/// have grown to fit. Queries only visit the cells overlapping the query
+/// region, which keeps neighbourhood lookups proportional to the local
+/// density rather than the total number of points.
+///
+/// Indices returned by queries refer to the position of the point in the
+/// vector passed to `build`.
+class SpatialGrid {
+ private:
+  float cell_size_ = 1.0f;
+  float inv_cell_size_ = 1.0f;
+  b2Vec2 origin_{0.0f, 0.0f};
+  int columns_ = 0;
+  int rows_ = 0;
+
+  /// Offset of the first point of each cell in `indices_`, plus one trailing
+  /// entry so that `cell_start_[c + 1] - cell_start_[c]` is the cell size.
+  std::vector<int> cell_start_;
+  /// Point indices, ordered by cell and then by original index.
+  std::vector<int> indices_;
+  /// Point positions, stored in the same order as `indices_`.
+  std::vector<b2Vec2> positions_;
+  /// Scratch buffer holding the cell of every point during a build.
+  std::vector<int> point_cells_;
+
+  int cellX(float x) const;
+  int cellY(float y) const;
+
+  template <typename PositionAt>
+  void buildFrom(int count, PositionAt position_at, float cell_size);
+
+ public:
+  /// @brief Upper bound on the number of cells per point. If the requested
+  /// cell size would produce more cells than this, the cell size is grown so
+  /// that sparse swarms spread over a large map do not allocate huge grids.
+  static constexpr int kMaxCellsPerPoint = 4;
+
+  /// @brief Rebuilds the grid from a set of points.
+  /// @param positions The points to index.
+  /// @param cell_size The edge length of a cell. Queries are cheapest when
+  /// this is close to the most common query radius.
+  void build(const std::vector<b2Vec2> &positions, float cell_size);
+
+  /// @brief Rebuilds the grid from points stored as separate coordinate
+  /// arrays, such as those of a `DroneSnapshot`.
+  /// @param xs The x coordinates of the points.
+  /// @param ys The y coordinates of the points, the same length as `xs`.
+  /// @param cell_size The edge length of a cell.
+  void build(const std::vector<float> &xs, const std::vector<float> &ys,
+             float cell_size);
+
+  /// @brief Finds every point within `radius` of `centre`.
+  /// @param centre The centre of the query.
+  /// @param radius The query radius. Points exactly at this distance are
+  /// included.
+  /// @param out Receives the indices of the points found, in ascending order.
+  /// The vector is cleared first.
+  void queryRadius(const b2Vec2 &centre, float radius,
+                   std::vector<int> &out) const;
+
+  /// @brief Finds the `k` points closest to `centre`.
+  /// @param centre The centre of the query.
+  /// @param k The maximum number of points to return.
+  /// @param out Receives the indices of the points found, closest first. The
+  /// vector is cleared first.
+  void queryNearest(const b2Vec2 &centre, std::size_t k,
+                    std::vector<int> &out) const;
+
+  /// @brief Calls `fn(index, position)` for every point within `radius` of
+  /// `centre`. Points are visited cell by cell, not in index order.
+  template <typename Fn>
+  void forEachInRadius(const b2Vec2 &centre, float radius, Fn &&fn) const {
+    if (indices_.empty()) {
+      return;
+    }
+    const float radius_squared = radius * radius;
+    const int min_x = cellX(centre.x - radius);
+    const int max_x = cellX(centre.x + radius);
+    const int min_y = cellY(centre.y - radius);
+    const int max_y = cellY(centre.y + radius);
+    for (int y = min_y; y <= max_y; ++y) {
+      const int row = y * columns_;
+      for (int x = min_x; x <= max_x; ++x) {
+        const int cell = row + x;
+        for (int i = cell_start_[cell]; i < cell_start_[cell + 1]; ++i) {
+          if (b2DistanceSquared(positions_[i], centre) <= radius_squared) {
+            fn(indices_[i], positions_[i]);
+          }
+        }
+      }
+    }
+  }
+
+  /// @brief Removes all points from the grid.
+  void clear();
+
+  /// @brief Bytes reserved by the grid's arrays.
+  std::size_t bytes() const;
+
+  std::size_t size() const { return indices_.size(); }
+  bool empty() const { return indices_.empty(); }
+  float cell_size() const { return cell_size_; }
+  int columns() const { return columns_; }
+  int rows() const { return rows_; }
+};
+
+}  // namespace salsa
+
+#endif  // SWARM_SIM_UTILS_SPATIAL_GRID_H
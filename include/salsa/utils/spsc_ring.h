@@ -0,0 +1,118 @@
+/// @file spsc_ring.h
+/// @brief Contains the `SpscRing` class, a fixed-capacity lock-free queue
+/// between one producer thread and one consumer thread.
+#ifndef SWARM_SIM_UTILS_SPSC_RING_H
+#define SWARM_SIM_UTILS_SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+namespace salsa {
+
+/// @brief Bounded single-producer, single-consumer ring buffer.
+///
+/// All storage is allocated by the constructor, so pushing and popping never
+/// allocate. Exactly one thread may push and exactly one (other) thread may
+/// pop; the two only share a pair of atomic indices, each on its own cache
+/// line so they do not contend.
+///
+/// @tparam T Element type. Elements are copied in and out, so it should be
+/// cheap to copy.
+template <typename T>
+class SpscRing {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "SpscRing copies elements without running destructors");
+
+ public:
+  /// @brief Creates a ring that holds at least `capacity` elements. The
+  /// capacity is rounded up to a power of two.
+  explicit SpscRing(std::size_t capacity)
+      : capacity_(roundUp(capacity)),
+        mask_(capacity_ - 1),
+        slots_(new T[capacity_]) {}
+
+  SpscRing(const SpscRing &) = delete;
+  SpscRing &operator=(const SpscRing &) = delete;
+
+  /// @brief Appends `value`. Producer thread only.
+  /// @return False, leaving the ring unchanged, if it is full.
+  bool try_push(const T &value) {
+    const std::size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - cached_head_ == capacity_) {
+      cached_head_ = head_.load(std::memory_order_acquire);
+      if (tail - cached_head_ == capacity_) {
+        return false;
+      }
+    }
+    slots_[tail & mask_] = value;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// @brief Takes the oldest element. Consumer thread only.
+  /// @return False, leaving `value` unchanged, if the ring is empty.
+  bool try_pop(T &value) { return pop(&value, 1) == 1; }
+
+  /// @brief Takes up to `max_count` of the oldest elements. Consumer thread
+  /// only.
+  /// @param out Where to copy the elements to.
+  /// @param max_count Most elements to take.
+  /// @return Number of elements taken.
+  std::size_t pop(T *out, const std::size_t max_count) {
+    const std::size_t head = head_.load(std::memory_order_relaxed);
+    if (cached_tail_ - head < max_count) {
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+    }
+    std::size_t count = cached_tail_ - head;
+    if (count > max_count) {
+      count = max_count;
+    }
+    for (std::size_t i = 0; i < count; i++) {
+      out[i] = slots_[(head + i) & mask_];
+    }
+    head_.store(head + count, std::memory_order_release);
+    return count;
+  }
+
+  /// @brief Number of elements in the ring. Only exact when neither thread
+  /// is using it.
+  std::size_t size() const {
+    return tail_.load(std::memory_order_acquire) -
+           head_.load(std::memory_order_acquire);
+  }
+  bool empty() const { return size() == 0; }
+  std::size_t capacity() const { return capacity_; }
+
+ private:
+  static constexpr std::size_t kCacheLine = 64;
+
+  static std::size_t roundUp(const std::size_t capacity) {
+    std::size_t rounded = 1;
+    while (rounded < capacity) {
+      rounded <<= 1;
+    }
+    return rounded;
+  }
+
+  const std::size_t capacity_;
+  const std::size_t mask_;
+  const std::unique_ptr<T[]> slots_;
+
+  // Each side's index shares a cache line with that side's copy of the
+  // other index, which it refreshes only when it looks full (or empty).
+
+  /// Next slot to pop, written by the consumer.
+  alignas(kCacheLine) std::atomic<std::size_t> head_{0};
+  /// Consumer's last view of `tail_`.
+  std::size_t cached_tail_ = 0;
+  /// Next slot to push, written by the producer.
+  alignas(kCacheLine) std::atomic<std::size_t> tail_{0};
+  /// Producer's last view of `head_`.
+  std::size_t cached_head_ = 0;
+};
+
+}  // namespace salsa
+
+#endif  // SWARM_SIM_UTILS_SPSC_RING_H
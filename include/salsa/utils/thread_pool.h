@@ -0,0 +1,99 @@
+/// @file thread_pool.h
+/// @brief Contains the `ThreadPool` class, a fixed-size pool of worker threads
+/// used to spread per-drone work across cores.
+#ifndef SWARM_SIM_UTILS_THREAD_POOL_H
+#define SWARM_SIM_UTILS_THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace salsa {
+
+/// @brief Fixed-size thread pool that runs data-parallel loops with work
+/// stealing.
+///
+/// `parallelFor` splits the index range into chunks and hands each worker a
+/// contiguous block of them. A worker takes chunks from the front of its own
+/// queue and, once that runs dry, steals from the back of the other queues,
+/// so an uneven load (for example drones bunched in one corner of the map)
+/// still keeps every core busy. The calling thread takes part as worker 0.
+class ThreadPool {
+ public:
+  /// @brief A loop body over a chunk: called with the chunk's first index,
+  /// one past its last, and the index of the worker running it.
+  using ChunkFunction =
+      std::function<void(std::size_t, std::size_t, std::size_t)>;
+
+ private:
+  using Range = std::pair<std::size_t, std::size_t>;
+
+  struct WorkQueue {
+    std::mutex mutex;
+    std::deque<Range> chunks;
+  };
+
+  std::size_t thread_count_;
+  std::vector<std::unique_ptr<WorkQueue>> queues_;
+  std::vector<std::thread> threads_;
+
+  std::mutex mutex_;
+  std::condition_variable start_condition_;
+  std::condition_variable done_condition_;
+  std::size_t generation_ = 0;
+  std::size_t active_workers_ = 0;
+  bool stopping_ = false;
+
+  const ChunkFunction *job_ = nullptr;
+  std::exception_ptr error_;
+
+  void workerLoop(std::size_t index);
+  void runChunks(std::size_t index);
+  bool takeChunk(std::size_t index, Range &chunk);
+
+ public:
+  /// @brief Creates a pool with `thread_count` workers, including the thread
+  /// that calls `parallelFor`.
+  /// @param thread_count Number of workers. Zero picks one per hardware
+  /// thread.
+  explicit ThreadPool(std::size_t thread_count);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  /// @brief Calls `fn(i)` for every `i` in `[0, count)` and waits for all
+  /// calls to finish.
+  ///
+  /// Calls for different indices may run concurrently and in any order. If
+  /// any call throws, the remaining chunks still run and the first exception
+  /// is rethrown on the calling thread.
+  void parallelFor(std::size_t count,
+                   const std::function<void(std::size_t)> &fn);
+
+  /// @brief Like `parallelFor`, but calls `fn(begin, end, worker)` once for
+  /// each chunk `[begin, end)` of `[0, count)`, and waits for all calls to
+  /// finish.
+  ///
+  /// `worker` is in `[0, size())`, worker 0 being the calling thread, so
+  /// callers can keep per-worker state or see how the range was split.
+  void parallelForChunks(std::size_t count, const ChunkFunction &fn);
+
+  /// @brief Returns the number of workers, including the calling thread.
+  std::size_t size() const { return thread_count_; }
+
+  /// @brief Resolves a requested thread count, mapping zero to the number of
+  /// hardware threads.
+  static std::size_t resolveThreadCount(std::size_t requested);
+};
+
+}  // namespace salsa
+
+#endif  // SWARM_SIM_UTILS_THREAD_POOL_H
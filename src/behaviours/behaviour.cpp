@@ -89,6 +89,21 @@ b2Vec2 Behaviour::avoidDrones(const std::vector<b2Body *> &neighbours,
   return steering;
 }
 
+b2Vec2 Behaviour::avoidDrones(const behaviour::Context &context,
+                              const Drone &currentDrone) {
+  // Only drones inside the camera view range contribute, so there is no need
+  // to look any further than that.
+  thread_local std::vector<Drone *> nearby;
+  thread_local std::vector<b2Body *> neighbours;
+  context.queryRadius(currentDrone.position(),
+                      currentDrone.camera_view_range(), nearby);
+  neighbours.clear();
+  for (const auto *drone : nearby) {
+    neighbours.push_back(drone->body());
+  }
+  return avoidDrones(neighbours, currentDrone);
+}
+
 b2Vec2 Behaviour::avoidObstacles(const std::vector<b2Vec2> &obstaclePoints,
                                  const Drone &currentDrone) {
   b2Vec2 steering(0, 0);
@@ -133,6 +148,20 @@ void Behaviour::performRayCasting(const Drone &currentDrone,
   }
 }
 
+void Behaviour::findObstaclePoints(const behaviour::Context &context,
+                                   const Drone &currentDrone,
+                                   std::vector<b2Vec2> &obstaclePoints) {
+  const ObstacleField *field = context.obstacle_field();
+  const float range = currentDrone.obstacle_view_range();
+  if (field && range <= field->max_distance()) {
+    field->queryPoints(currentDrone.position(), range, obstaclePoints);
+    return;
+  }
+  RayCastCallback callback;
+  performRayCasting(currentDrone, callback);
+  obstaclePoints = std::move(callback.obstaclePoints);
+}
+
 b2Vec2 Behaviour::steerTo(const b2Vec2 target, const Drone &currentDrone) {
   const b2Vec2 position = currentDrone.position();
   b2Vec2 desired = target - position;
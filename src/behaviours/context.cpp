@@ -0,0 +1,96 @@
+#include "salsa/behaviours/context.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "salsa/entity/drone.h"
+
+namespace salsa::behaviour {
+
+namespace {
+// Scratch space for grid queries, so that repeated queries from the same
+// thread do not allocate.
+thread_local std::vector<int> query_indices;
+}  // namespace
+
+Rng &Context::rng(const Drone &drone) const {
+  if (drone_rngs_) {
+    // Drones made by a `Sim` have their index as their id.
+    const auto id = static_cast<std::size_t>(drone.id());
+    if (id < drones_.size() && drones_[id].get() == &drone) {
+      return drone_rngs_[id];
+    }
+    const auto it = std::find_if(
+        drones_.begin(), drones_.end(),
+        [&](const auto &other) { return other.get() == &drone; });
+    if (it != drones_.end()) {
+      return drone_rngs_[it - drones_.begin()];
+    }
+  }
+  thread_local Rng fallback(Rng::randomSeed());
+  return fallback;
+}
+
+void Context::queryRadius(const b2Vec2 &centre, const float radius,
+                          std::vector<Drone *> &out) const {
+  out.clear();
+  if (neighbour_grid_) {
+    neighbour_grid_->queryRadius(centre, radius, query_indices);
+    out.reserve(query_indices.size());
+    for (const int index : query_indices) {
+      out.push_back(drones_[index].get());
+    }
+    return;
+  }
+
+  const float radius_squared = radius * radius;
+  for (const auto &drone : drones_) {
+    if (b2DistanceSquared(drone->position(), centre) <= radius_squared) {
+      out.push_back(drone.get());
+    }
+  }
+}
+
+void Context::queryRadius(const b2Vec2 &centre, const float radius,
+                          std::vector<int> &out) const {
+  if (neighbour_grid_) {
+    neighbour_grid_->queryRadius(centre, radius, out);
+    return;
+  }
+
+  out.clear();
+  const float radius_squared = radius * radius;
+  for (int i = 0; i < static_cast<int>(drones_.size()); ++i) {
+    if (b2DistanceSquared(drones_[i]->position(), centre) <= radius_squared) {
+      out.push_back(i);
+    }
+  }
+}
+
+void Context::queryNearest(const b2Vec2 &centre, const std::size_t k,
+                           std::vector<Drone *> &out) const {
+  out.clear();
+  if (neighbour_grid_) {
+    neighbour_grid_->queryNearest(centre, k, query_indices);
+    out.reserve(query_indices.size());
+    for (const int index : query_indices) {
+      out.push_back(drones_[index].get());
+    }
+    return;
+  }
+
+  std::vector<std::pair<float, int>> candidates;
+  candidates.reserve(drones_.size());
+  for (int i = 0; i < static_cast<int>(drones_.size()); ++i) {
+    candidates.emplace_back(b2DistanceSquared(drones_[i]->position(), centre),
+                            i);
+  }
+  const std::size_t found = std::min(k, candidates.size());
+  std::partial_sort(candidates.begin(), candidates.begin() + found,
+                    candidates.end());
+  for (std::size_t i = 0; i < found; ++i) {
+    out.push_back(drones_[candidates[i].second].get());
+  }
+}
+
+}  // namespace salsa::behaviour
@@ -0,0 +1,93 @@
+#include "salsa/core/checkpoint.h"
+
+#include <cstdio>
+#include <random>
+
+namespace salsa {
+
+namespace {
+constexpr char kCheckpointMagic[8] = {'S', 'A', 'L', 'S', 'A', 'C', 'K', 'P'};
+constexpr uint32_t kCheckpointVersion = 2;
+}  // namespace
+
+uint64_t checkpointChecksum(const void *data, const std::size_t size) {
+  const auto *bytes = static_cast<const unsigned char *>(data);
+  uint64_t hash = 14695981039346656037ull;
+  for (std::size_t i = 0; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+void CheckpointWriter::save(const std::filesystem::path &path) const {
+  std::error_code error;
+  if (path.has_parent_path()) {
+    std::filesystem::create_directories(path.parent_path(), error);
+  }
+  std::filesystem::path temporary = path;
+  temporary += ".tmp" + std::to_string(std::random_device{}());
+
+  std::FILE *file = std::fopen(temporary.string().c_str(), "wb");
+  if (!file) {
+    throw std::runtime_error("Could not write checkpoint: " + path.string());
+  }
+  CheckpointFileHeader header{};
+  std::memcpy(header.magic, kCheckpointMagic, sizeof(header.magic));
+  header.version = kCheckpointVersion;
+  header.size = data_.size();
+  header.checksum = checkpointChecksum(data_.data(), data_.size());
+  const bool written =
+      std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+      std::fwrite(data_.data(), 1, data_.size(), file) == data_.size();
+  const bool closed = std::fclose(file) == 0;
+  if (written && closed) {
+    std::filesystem::rename(temporary, path, error);
+  }
+  if (!written || !closed || error) {
+    std::filesystem::remove(temporary, error);
+    throw std::runtime_error("Could not write checkpoint: " + path.string());
+  }
+}
+
+CheckpointReader::CheckpointReader(const unsigned char *data,
+                                   const std::size_t size)
+    : data_(data), size_(size) {}
+
+CheckpointReader::CheckpointReader(const std::filesystem::path &path)
+    : file_(path.string()) {
+  CheckpointFileHeader header{};
+  if (file_.size() < sizeof(header)) {
+    throw std::runtime_error("Not a checkpoint: " + path.string());
+  }
+  std::memcpy(&header, file_.data(), sizeof(header));
+  if (std::memcmp(header.magic, kCheckpointMagic, sizeof(header.magic)) !=
+          0 ||
+      header.version != kCheckpointVersion) {
+    throw std::runtime_error("Not a checkpoint: " + path.string());
+  }
+  data_ = file_.data() + sizeof(header);
+  size_ = file_.size() - sizeof(header);
+  if (header.size != size_ ||
+      header.checksum != checkpointChecksum(data_, size_)) {
+    throw std::runtime_error("Checkpoint is incomplete or corrupt: " +
+                             path.string());
+  }
+}
+
+std::string CheckpointReader::readString() {
+  const uint64_t length = read<uint64_t>();
+  const auto *characters = reinterpret_cast<const char *>(take(length));
+  return {characters, characters + length};
+}
+
+const unsigned char *CheckpointReader::take(const std::size_t size) {
+  if (size > remaining()) {
+    throw std::runtime_error("Checkpoint is truncated");
+  }
+  const unsigned char *bytes = data_ + offset_;
+  offset_ += size;
+  return bytes;
+}
+
+}  // namespace salsa
@@ -1,48 +1,60 @@
 #include "salsa/core/data.h"
 
+#include <random>
+
 #include "salsa/core/map.h"
+#include "salsa/utils/rng.h"
 using namespace salsa;
 
 std::string salsa::generateRandomString(const int length) {
   const std::string characters =
       "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789";
+  // Each thread draws from its own engine, so concurrent simulations do not
+  // contend on a shared generator.
+  thread_local Rng engine(Rng::randomSeed());
+  std::uniform_int_distribution<std::size_t> pick(0, characters.size() - 1);
   std::string randomString;
 
   for (int i = 0; i < length; ++i) {
-    randomString += characters[rand() % characters.size()];
+    randomString += characters[pick(engine)];
   }
 
   return randomString;
 }
 
-std::shared_ptr<spdlog::logger> Logger::logger_ = nullptr;
-
-Logger::Logger() { init_logger("default_log.log"); }
+Logger::Logger(const std::string& log_file) { init_logger(log_file); }
 
-Logger::~Logger() { spdlog::shutdown(); }
+Logger::~Logger() { flush(); }
 
-Logger& Logger::getInstance() {
-  static Logger instance;
-  return instance;
+std::filesystem::path Logger::results_path(const std::string& file) {
+  return salsa::map::getExecutablePath() / ".." / ".." / "testbed" /
+         "results" / file;
 }
 
 void Logger::init_logger(const std::string& log_file) {
-  const std::filesystem::path log_path = salsa::map::getExecutablePath() / ".." /
-                                   ".." / "testbed" / "results" / log_file;
-  spdlog::drop("async_logger");
-  spdlog::init_thread_pool(8192,
-                           1);  // Queue with 8192 slots and 1 background thread
-  logger_ = spdlog::basic_logger_mt<spdlog::async_factory>("async_logger",
-                                                           log_path.string());
+  const std::filesystem::path log_path = results_path(log_file);
+  flush();
+  // Only the owning simulation writes to this logger, so it needs neither a
+  // locking sink nor a background thread. The logger is not registered with
+  // spdlog, so any number of them can exist at once.
+  auto sink =
+      std::make_shared<spdlog::sinks::basic_file_sink_st>(log_path.string());
+  logger_ = std::make_shared<spdlog::logger>("salsa_sim", std::move(sink));
   logger_->set_pattern("%v");
-  spdlog::set_level(spdlog::level::info);
-  spdlog::flush_every(std::chrono::seconds(3));
+  logger_->set_level(spdlog::level::info);
+  log_file_ = log_file;
 }
 
 void Logger::switch_log_file(const std::string& new_log_file) {
   init_logger(new_log_file);
 }
 
+void Logger::flush() {
+  if (logger_) {
+    logger_->flush();
+  }
+}
+
 void Logger::update(const nlohmann::json& message) {
   float time = message["time"];
   std::string caller_info = message["caller_type"];
@@ -0,0 +1,98 @@
+#include "salsa/core/data/telemetry.h"
+
+#include <chrono>
+
+namespace salsa {
+
+namespace {
+// How long the writer sleeps when it finds the ring empty. Samples arrive in
+// bursts once per log interval, so there is no need to poll any faster.
+constexpr std::chrono::milliseconds kIdleSleep{1};
+}  // namespace
+
+TelemetrySink::TelemetrySink(const std::size_t capacity) : ring_(capacity) {}
+
+TelemetrySink::~TelemetrySink() { close(); }
+
+void TelemetrySink::open(const std::string &path,
+                         const std::string &metadata) {
+  close();
+  writer_.open(path, metadata);
+  written_.store(0, std::memory_order_release);
+  stalls_ = 0;
+  stopping_.store(false, std::memory_order_release);
+  thread_ = std::thread(&TelemetrySink::writerLoop, this);
+  open_ = true;
+}
+
+void TelemetrySink::close() {
+  if (!open_) {
+    return;
+  }
+  open_ = false;
+  stopping_.store(true, std::memory_order_release);
+  thread_.join();
+  writer_.close();
+}
+
+void TelemetrySink::addObserver(std::shared_ptr<Observer> observer) {
+  std::lock_guard<std::mutex> lock(observers_mutex_);
+  observers_.push_back(std::move(observer));
+}
+
+void TelemetrySink::waitToPush(const TrajectoryRecord &sample) {
+  stalls_++;
+  while (!ring_.try_push(sample)) {
+    std::this_thread::yield();
+  }
+}
+
+void TelemetrySink::writerLoop() {
+  // Owned by the writer thread, so draining never allocates.
+  std::unique_ptr<TrajectoryRecord[]> batch(new TrajectoryRecord[kBatchSize]);
+  while (!stopping_.load(std::memory_order_acquire)) {
+    if (drain(batch.get()) == 0) {
+      std::this_thread::sleep_for(kIdleSleep);
+    }
+  }
+  // The producer has stopped, so whatever is left is the last of it.
+  drain(batch.get());
+}
+
+std::size_t TelemetrySink::drain(TrajectoryRecord *batch) {
+  std::size_t total = 0;
+  std::size_t count;
+  while ((count = ring_.pop(batch, kBatchSize)) > 0) {
+    for (std::size_t i = 0; i < count; i++) {
+      writer_.write(batch[i]);
+    }
+    notifyObservers(batch, count);
+    total += count;
+    written_.fetch_add(count, std::memory_order_release);
+  }
+  return total;
+}
+
+void TelemetrySink::notifyObservers(const TrajectoryRecord *batch,
+                                    const std::size_t count) {
+  std::lock_guard<std::mutex> lock(observers_mutex_);
+  if (observers_.empty()) {
+    return;
+  }
+  for (std::size_t i = 0; i < count; i++) {
+    const TrajectoryRecord &sample = batch[i];
+    const nlohmann::json sample_message = {
+        {"position", {sample.x, sample.y}},
+        {"velocity", {sample.vx, sample.vy}}};
+    nlohmann::json message;
+    message["message"] = sample_message.dump();
+    message["time"] = sample.time;
+    message["id"] = sample.id;
+    message["caller_type"] = "salsa::Drone";
+    for (const auto &observer : observers_) {
+      observer->update(message);
+    }
+  }
+}
+
+}  // namespace salsa
@@ -0,0 +1,122 @@
+#include "salsa/core/data/trajectory.h"
+
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+#include "salsa/entity/drone_snapshot.h"
+
+namespace salsa {
+
+namespace {
+// Records start on this boundary, so that a mapping of the file can be read
+// as an array of records.
+constexpr uint64_t kRecordAlignment = 8;
+}  // namespace
+
+TrajectoryWriter::TrajectoryWriter(const std::string &path,
+                                   const std::string &metadata) {
+  open(path, metadata);
+}
+
+TrajectoryWriter::~TrajectoryWriter() { close(); }
+
+void TrajectoryWriter::open(const std::string &path,
+                            const std::string &metadata) {
+  close();
+  const std::filesystem::path file_path(path);
+  if (file_path.has_parent_path()) {
+    std::filesystem::create_directories(file_path.parent_path());
+  }
+  file_ = std::fopen(path.c_str(), "wb");
+  if (!file_) {
+    throw std::runtime_error("Could not open trajectory file: " + path);
+  }
+
+  TrajectoryFileHeader header{};
+  std::memcpy(header.magic, kTrajectoryMagic, sizeof(header.magic));
+  header.version = kTrajectoryVersion;
+  header.record_size = sizeof(TrajectoryRecord);
+  header.metadata_size = metadata.size();
+  const uint64_t unpadded = sizeof(header) + metadata.size();
+  header.records_offset = (unpadded + kRecordAlignment - 1) /
+                          kRecordAlignment * kRecordAlignment;
+
+  const char padding[kRecordAlignment] = {};
+  const std::size_t padding_size = header.records_offset - unpadded;
+  if (std::fwrite(&header, sizeof(header), 1, file_) != 1 ||
+      std::fwrite(metadata.data(), 1, metadata.size(), file_) !=
+          metadata.size() ||
+      std::fwrite(padding, 1, padding_size, file_) != padding_size) {
+    std::fclose(file_);
+    file_ = nullptr;
+    throw std::runtime_error("Could not write trajectory file: " + path);
+  }
+
+  buffer_.clear();
+  buffer_.reserve(kBufferRecords);
+  written_ = 0;
+  failed_ = false;
+}
+
+void TrajectoryWriter::write(const float time, const DroneSnapshot &snapshot) {
+  for (std::size_t i = 0; i < snapshot.size(); ++i) {
+    write({time, snapshot.id[i], snapshot.x[i], snapshot.y[i], snapshot.vx[i],
+           snapshot.vy[i]});
+  }
+}
+
+void TrajectoryWriter::flush() {
+  if (!file_ || buffer_.empty()) {
+    return;
+  }
+  if (std::fwrite(buffer_.data(), sizeof(TrajectoryRecord), buffer_.size(),
+                  file_) != buffer_.size()) {
+    failed_ = true;
+  }
+  written_ += buffer_.size();
+  buffer_.clear();
+}
+
+void TrajectoryWriter::close() {
+  if (!file_) {
+    return;
+  }
+  flush();
+  // The last of the records may only reach the disk here.
+  if (std::fclose(file_) != 0) {
+    failed_ = true;
+  }
+  file_ = nullptr;
+}
+
+TrajectoryReader::TrajectoryReader(const std::string &path) : file_(path) {
+  data_ = file_.data();
+  const std::size_t length = file_.size();
+  if (!data_ || length < sizeof(TrajectoryFileHeader)) {
+    throw std::runtime_error("Not a trajectory file: " + path);
+  }
+  header_ = reinterpret_cast<const TrajectoryFileHeader *>(data_);
+  if (std::memcmp(header_->magic, kTrajectoryMagic, sizeof(header_->magic)) !=
+          0 ||
+      header_->version != kTrajectoryVersion ||
+      header_->record_size != sizeof(TrajectoryRecord) ||
+      header_->records_offset % kRecordAlignment != 0 ||
+      header_->records_offset > length ||
+      sizeof(TrajectoryFileHeader) + header_->metadata_size >
+          header_->records_offset) {
+    throw std::runtime_error("Unsupported trajectory file: " + path);
+  }
+  records_ =
+      reinterpret_cast<const TrajectoryRecord *>(data_ + header_->records_offset);
+  // A run that was cut short may end part way through a record.
+  size_ = (length - header_->records_offset) / sizeof(TrajectoryRecord);
+}
+
+std::string TrajectoryReader::metadata() const {
+  return std::string(
+      reinterpret_cast<const char *>(data_ + sizeof(TrajectoryFileHeader)),
+      header_->metadata_size);
+}
+
+}  // namespace salsa
@@ -1,5 +1,7 @@
 #include "salsa/core/map.h"
 
+#include <mutex>
+
 namespace fs = std::filesystem;
 
 using namespace salsa;
@@ -8,6 +10,8 @@ using salsa::map::Map;
 
 /// @brief Registry of all loaded maps
 static std::vector<Map> registry;
+/// @brief Guards `registry`, as simulations may load maps from several threads.
+static std::mutex registry_mutex;
 
 fs::path salsa::map::getExecutablePath() {
 #if defined(_WIN32)
@@ -38,7 +42,7 @@ fs::path salsa::map::getExecutablePath() {
 #endif
 }
 
-Map map::load(const char *new_map_name) {
+Map map::load(const char *new_map_name, b2World *world) {
   std::filesystem::path exec_path = getExecutablePath();
   salsa::logger::get()->info("Executable path: {}", exec_path.string());
   std::filesystem::path file_path = exec_path / ".." / ".." / "testbed" /
@@ -46,12 +50,15 @@ Map map::load(const char *new_map_name) {
                                     (std::string(new_map_name) + ".json");
   salsa::logger::get()->info("Loading map from: {}", file_path.string());
 
-  auto *world = new b2World(b2Vec2(0.0f, 0.0f));
   Map new_map;
   std::ifstream file(file_path);
   if (!file.is_open()) {
     throw std::runtime_error("Could not open file at: " + file_path.string());
   }
+  const bool owns_world = world == nullptr;
+  if (owns_world) {
+    world = new b2World(b2Vec2(0.0f, 0.0f));
+  }
 
   nlohmann::json map;
   file >> map;
@@ -111,12 +118,55 @@ Map map::load(const char *new_map_name) {
     }
   }
   new_map.world = world;
-  registry.push_back(new_map);
+  new_map.obstacle_field = std::make_shared<const ObstacleField>(*world);
+  {
+    // A world of the caller's may be gone before the registry is, so it is
+    // left out.
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    registry.push_back(new_map);
+    if (!owns_world) {
+      registry.back().world = nullptr;
+    }
+  }
   return new_map;
 }
 
+b2Body *map::copyBody(const b2Body &body, b2World &world) {
+  b2BodyDef body_def;
+  body_def.type = body.GetType();
+  body_def.position = body.GetPosition();
+  body_def.angle = body.GetAngle();
+  body_def.linearVelocity = body.GetLinearVelocity();
+  body_def.angularVelocity = body.GetAngularVelocity();
+  body_def.linearDamping = body.GetLinearDamping();
+  body_def.angularDamping = body.GetAngularDamping();
+  body_def.allowSleep = body.IsSleepingAllowed();
+  body_def.awake = body.IsAwake();
+  body_def.fixedRotation = body.IsFixedRotation();
+  body_def.bullet = body.IsBullet();
+  body_def.enabled = body.IsEnabled();
+  body_def.gravityScale = body.GetGravityScale();
+  b2Body *copy = world.CreateBody(&body_def);
+
+  for (const b2Fixture *fixture = body.GetFixtureList(); fixture;
+       fixture = fixture->GetNext()) {
+    b2FixtureDef fixture_def;
+    // The world keeps its own clone of the shape.
+    fixture_def.shape = fixture->GetShape();
+    fixture_def.density = fixture->GetDensity();
+    fixture_def.friction = fixture->GetFriction();
+    fixture_def.restitution = fixture->GetRestitution();
+    fixture_def.isSensor = fixture->IsSensor();
+    fixture_def.filter = fixture->GetFilterData();
+    copy->CreateFixture(&fixture_def);
+  }
+  return copy;
+}
+
 void setNames() {
-  for (auto & [name, width, height, drone_spawn_point, world] : registry) {
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  for (auto & [name, width, height, drone_spawn_point, world, obstacle_field] :
+       registry) {
     name = "Map";
   }
 }
@@ -0,0 +1,283 @@
+#include "salsa/core/memory.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+namespace salsa {
+
+void MemoryAccountRelease::operator()(MemoryAccount *account) const {
+  account->unreference();
+}
+
+namespace {
+constexpr std::size_t kAlignment = alignof(std::max_align_t);
+constexpr std::size_t kClassesPerDoubling = 8;
+/// Blocks up to this size are rounded to the alignment alone.
+constexpr std::size_t kSmallBlockBytes = kAlignment * kClassesPerDoubling;
+
+std::size_t floorLog2(std::size_t value) {
+  std::size_t log = 0;
+  while (value >>= 1) {
+    log++;
+  }
+  return log;
+}
+}  // namespace
+
+std::size_t WorldArena::classBytes(const std::size_t bytes) {
+  if (bytes <= kSmallBlockBytes) {
+    return bytes <= kAlignment ? kAlignment
+                               : (bytes + kAlignment - 1) & ~(kAlignment - 1);
+  }
+  // Eight classes between each power of two and the next.
+  const std::size_t step =
+      (std::size_t{1} << floorLog2(bytes - 1)) / kClassesPerDoubling;
+  return (bytes + step - 1) & ~(step - 1);
+}
+
+std::size_t WorldArena::classIndex(const std::size_t class_bytes) {
+  if (class_bytes <= kSmallBlockBytes) {
+    return class_bytes / kAlignment - 1;
+  }
+  const std::size_t log = floorLog2(class_bytes - 1);
+  const std::size_t step = (std::size_t{1} << log) / kClassesPerDoubling;
+  return kClassesPerDoubling +
+         (log - floorLog2(kSmallBlockBytes)) * kClassesPerDoubling +
+         class_bytes / step - kClassesPerDoubling - 1;
+}
+
+void *WorldArena::allocate(const std::size_t bytes) {
+  const std::size_t size = classBytes(bytes);
+  const std::size_t index = classIndex(size);
+  if (index < free_lists_.size() && free_lists_[index]) {
+    FreeBlock *block = free_lists_[index];
+    free_lists_[index] = block->next;
+    return block;
+  }
+  if (size > next_chunk_bytes_ / 2) {
+    // A block this big gets a chunk to itself, leaving the current chunk to
+    // the blocks after it.
+    return allocateChunk(size);
+  }
+  if (static_cast<std::size_t>(end_ - cursor_) < size) {
+    cursor_ = static_cast<char *>(allocateChunk(next_chunk_bytes_));
+    end_ = cursor_ + next_chunk_bytes_;
+    next_chunk_bytes_ = std::min(next_chunk_bytes_ * 2, kMaxChunkBytes);
+  }
+  void *block = cursor_;
+  cursor_ += size;
+  return block;
+}
+
+void WorldArena::deallocate(void *block, const std::size_t bytes) {
+  const std::size_t index = classIndex(classBytes(bytes));
+  if (index >= free_lists_.size()) {
+    free_lists_.resize(index + 1, nullptr);
+  }
+  free_lists_[index] = new (block) FreeBlock{free_lists_[index]};
+}
+
+void WorldArena::release() {
+  for (void *chunk : chunks_) {
+    std::free(chunk);
+  }
+  chunks_.clear();
+  free_lists_.clear();
+  cursor_ = nullptr;
+  end_ = nullptr;
+  next_chunk_bytes_ = kFirstChunkBytes;
+  reserved_bytes_ = 0;
+}
+
+void *WorldArena::allocateChunk(const std::size_t bytes) {
+  chunks_.reserve(chunks_.size() + 1);
+  void *chunk = std::malloc(bytes);
+  if (!chunk) {
+    throw std::bad_alloc();
+  }
+  chunks_.push_back(chunk);
+  reserved_bytes_ += bytes;
+  return chunk;
+}
+
+MemoryAccount::MemoryAccount(const MemoryBacking backing) {
+  if (backing == MemoryBacking::Arena) {
+    arena_ = std::make_unique<WorldArena>();
+  }
+}
+
+MemoryAccount::Handle MemoryAccount::create(const MemoryBacking backing) {
+  return Handle(new MemoryAccount(backing));
+}
+
+void MemoryAccount::Counter::add(const std::size_t amount) {
+  const std::size_t bytes = (this->bytes += amount);
+  blocks++;
+  std::size_t peak = peak_bytes.load(std::memory_order_relaxed);
+  while (bytes > peak && !peak_bytes.compare_exchange_weak(peak, bytes)) {
+  }
+}
+
+void MemoryAccount::Counter::remove(const std::size_t amount) {
+  bytes -= amount;
+  blocks--;
+}
+
+void *MemoryAccount::allocate(const std::size_t bytes, const int32 tag) {
+  void *block = arena_ ? arena_->allocate(bytes) : std::malloc(bytes);
+  if (!block) {
+    throw std::bad_alloc();
+  }
+  references_++;
+  categories_[static_cast<std::size_t>(tag)].add(bytes);
+  total_.add(bytes);
+  return block;
+}
+
+void MemoryAccount::deallocate(void *block, const std::size_t bytes,
+                               const int32 tag) {
+  if (arena_) {
+    arena_->deallocate(block, bytes);
+  } else {
+    std::free(block);
+  }
+  categories_[static_cast<std::size_t>(tag)].remove(bytes);
+  total_.remove(bytes);
+  unreference();
+}
+
+void MemoryAccount::unreference() {
+  if (--references_ == 0) {
+    delete this;
+  }
+}
+
+MemoryUsage MemoryAccount::usage(const MemoryCategory category) const {
+  const Counter &counter = categories_[static_cast<std::size_t>(category)];
+  return {counter.bytes.load(), counter.peak_bytes.load(),
+          counter.blocks.load()};
+}
+
+MemoryUsage MemoryAccount::total() const {
+  return {total_.bytes.load(), total_.peak_bytes.load(),
+          total_.blocks.load()};
+}
+
+void MemoryAccount::resetPeaks() {
+  for (Counter &counter : categories_) {
+    counter.peak_bytes = counter.bytes.load();
+  }
+  total_.peak_bytes = total_.bytes.load();
+}
+
+void MemoryAccount::release() {
+  if (!arena_) {
+    return;
+  }
+  arena_->release();
+  for (Counter &counter : categories_) {
+    counter.bytes = 0;
+    counter.blocks = 0;
+  }
+  total_.bytes = 0;
+  // The owner's reference is all that is left.
+  references_ -= total_.blocks.exchange(0);
+}
+
+std::size_t MemoryAccount::reservedBytes() const {
+  return arena_ ? arena_->reservedBytes() : 0;
+}
+
+WorldAllocationScope MemoryAccount::scope(MemoryAccount *account,
+                                          const MemoryCategory category) {
+  return WorldAllocationScope(account, static_cast<int32>(category));
+}
+
+std::size_t MemoryReport::bytes() const {
+  return box2d_total.bytes + drone_bytes + target_bytes + map_bytes;
+}
+
+std::size_t MemoryReport::peakBytes() const {
+  return box2d_total.peak_bytes + drone_bytes + target_bytes + map_bytes;
+}
+
+double MemoryReport::bytesPerDrone() const {
+  if (drones <= 0) {
+    return 0.0;
+  }
+  const std::size_t bytes =
+      box2d[static_cast<std::size_t>(MemoryCategory::Drones)].bytes +
+      drone_bytes;
+  return static_cast<double>(bytes) / drones;
+}
+
+double MemoryReport::bytesPerTarget() const {
+  if (targets <= 0) {
+    return 0.0;
+  }
+  const std::size_t bytes =
+      box2d[static_cast<std::size_t>(MemoryCategory::Targets)].bytes +
+      target_bytes;
+  return static_cast<double>(bytes) / targets;
+}
+
+std::size_t MemoryReport::mapBytes() const {
+  return box2d[static_cast<std::size_t>(MemoryCategory::Map)].bytes +
+         map_bytes;
+}
+
+std::size_t MemoryReport::stepBytes() const {
+  return box2d[static_cast<std::size_t>(MemoryCategory::Step)].bytes;
+}
+
+std::size_t MemoryReport::estimate(const int drones, const int targets) const {
+  // What stepping grows depends on how crowded the world is, so it is scaled
+  // with the drones, which make most of the contacts.
+  const double step_per_drone =
+      this->drones > 0 ? static_cast<double>(stepBytes()) / this->drones : 0.0;
+  return mapBytes() +
+         static_cast<std::size_t>((bytesPerDrone() + step_per_drone) * drones +
+                                  bytesPerTarget() * targets);
+}
+
+nlohmann::json MemoryReport::toJson() const {
+  nlohmann::json categories;
+  for (std::size_t i = 0; i < kMemoryCategoryCount; i++) {
+    categories[categoryName(static_cast<MemoryCategory>(i))] = {
+        {"bytes", box2d[i].bytes},
+        {"peak_bytes", box2d[i].peak_bytes},
+        {"blocks", box2d[i].blocks}};
+  }
+  return {{"drones", drones},
+          {"targets", targets},
+          {"bytes", bytes()},
+          {"peak_bytes", peakBytes()},
+          {"bytes_per_drone", bytesPerDrone()},
+          {"bytes_per_target", bytesPerTarget()},
+          {"map_bytes", mapBytes()},
+          {"step_bytes", stepBytes()},
+          {"box2d", categories},
+          {"drone_bytes", drone_bytes},
+          {"target_bytes", target_bytes},
+          {"obstacle_field_bytes", map_bytes},
+          {"arena_bytes", arena_bytes}};
+}
+
+const char *MemoryReport::categoryName(const MemoryCategory category) {
+  switch (category) {
+    case MemoryCategory::Map:
+      return "map";
+    case MemoryCategory::Drones:
+      return "drones";
+    case MemoryCategory::Targets:
+      return "targets";
+    case MemoryCategory::Step:
+      return "step";
+    case MemoryCategory::Other:
+      return "other";
+  }
+  return "unknown";
+}
+
+}  // namespace salsa
@@ -0,0 +1,436 @@
+#include "salsa/core/placement.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#include "salsa/core/logger.h"
+#include "salsa/core/map.h"
+#include "salsa/utils/rng.h"
+
+namespace salsa {
+
+namespace {
+constexpr char kLayoutMagic[8] = {'S', 'A', 'L', 'S', 'A', 'L', 'Y', 'T'};
+constexpr uint32_t kLayoutVersion = 2;
+
+// Poisson-disk layouts are generated by dart throwing, which is given this
+// many attempts per point before the rest are placed uniformly.
+constexpr std::size_t kPoissonAttemptsPerPoint = 64;
+// Default spacing of a Poisson-disk layout, as a fraction of the spacing of a
+// square grid of the same number of points. Dart throwing jams at about
+// twice this density, so the layout fills without many rejections.
+constexpr float kPoissonSpacing = 0.6f;
+
+static_assert(sizeof(LayoutFileHeader) == 32,
+              "LayoutFileHeader is part of the file format");
+static_assert(sizeof(b2Vec2) == 2 * sizeof(float),
+              "Layout files store points as pairs of floats");
+
+struct Region {
+  b2Vec2 lower;
+  float width;
+  float height;
+};
+
+std::vector<b2Vec2> uniform(const Region &region, std::size_t count,
+                            Rng &rng) {
+  std::vector<b2Vec2> points;
+  points.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    const float x = rng.uniform();
+    const float y = rng.uniform();
+    points.emplace_back(region.lower.x + x * region.width,
+                        region.lower.y + y * region.height);
+  }
+  return points;
+}
+
+std::vector<b2Vec2> stratified(const Region &region, std::size_t count,
+                               Rng &rng) {
+  // Cells as close to square as the region allows, with at least one cell
+  // per point.
+  const float aspect =
+      region.height > 0.0f ? region.width / region.height : 1.0f;
+  const std::size_t columns = std::max<std::size_t>(
+      1, static_cast<std::size_t>(std::ceil(std::sqrt(count * aspect))));
+  const std::size_t rows = (count + columns - 1) / columns;
+  const float cell_width = region.width / columns;
+  const float cell_height = region.height / rows;
+
+  // With more cells than points, a random subset of the cells is used. They
+  // are kept in grid order, so neighbouring points stay close in memory.
+  std::vector<std::size_t> cells(columns * rows);
+  std::iota(cells.begin(), cells.end(), 0);
+  if (cells.size() > count) {
+    // Fisher-Yates, written out because std::shuffle differs between
+    // standard libraries.
+    for (std::size_t i = cells.size() - 1; i > 0; --i) {
+      std::swap(cells[i], cells[rng.below(i + 1)]);
+    }
+    cells.resize(count);
+    std::sort(cells.begin(), cells.end());
+  }
+
+  std::vector<b2Vec2> points;
+  points.reserve(count);
+  for (const std::size_t cell : cells) {
+    const float x = (cell % columns + rng.uniform()) * cell_width;
+    const float y = (cell / columns + rng.uniform()) * cell_height;
+    points.emplace_back(region.lower.x + x, region.lower.y + y);
+  }
+  return points;
+}
+
+std::vector<b2Vec2> poissonDisk(const Region &region, std::size_t count,
+                                float min_distance, Rng &rng) {
+  const float area = region.width * region.height;
+  if (min_distance <= 0.0f) {
+    min_distance = kPoissonSpacing * std::sqrt(area / count);
+  }
+  std::vector<b2Vec2> points;
+  points.reserve(count);
+  if (min_distance <= 0.0f) {
+    return uniform(region, count, rng);
+  }
+
+  // A cell is small enough that it can hold at most one point, so the
+  // neighbours of a candidate are in the 5x5 block of cells around it.
+  const float cell_size = min_distance / std::sqrt(2.0f);
+  const int columns =
+      std::max(1, static_cast<int>(std::ceil(region.width / cell_size)));
+  const int rows =
+      std::max(1, static_cast<int>(std::ceil(region.height / cell_size)));
+  std::vector<int> grid(static_cast<std::size_t>(columns) * rows, -1);
+  const float min_distance_squared = min_distance * min_distance;
+
+  const std::size_t attempts = kPoissonAttemptsPerPoint * count;
+  for (std::size_t attempt = 0; attempt < attempts && points.size() < count;
+       ++attempt) {
+    const b2Vec2 candidate(region.lower.x + rng.uniform() * region.width,
+                           region.lower.y + rng.uniform() * region.height);
+    const int column = std::min(
+        columns - 1,
+        static_cast<int>((candidate.x - region.lower.x) / cell_size));
+    const int row = std::min(
+        rows - 1, static_cast<int>((candidate.y - region.lower.y) / cell_size));
+    bool clear = true;
+    const int last_row = std::min(rows - 1, row + 2);
+    const int last_column = std::min(columns - 1, column + 2);
+    for (int y = std::max(0, row - 2); clear && y <= last_row; ++y) {
+      for (int x = std::max(0, column - 2); x <= last_column; ++x) {
+        const int other = grid[static_cast<std::size_t>(y) * columns + x];
+        if (other >= 0 && b2DistanceSquared(points[other], candidate) <
+                              min_distance_squared) {
+          clear = false;
+          break;
+        }
+      }
+    }
+    if (clear) {
+      grid[static_cast<std::size_t>(row) * columns + column] =
+          static_cast<int>(points.size());
+      points.push_back(candidate);
+    }
+  }
+
+  if (points.size() < count) {
+    logger::get()->warn(
+        "Only {} of {} points fit {} apart; placing the rest uniformly",
+        points.size(), count, min_distance);
+    const std::vector<b2Vec2> rest =
+        uniform(region, count - points.size(), rng);
+    points.insert(points.end(), rest.begin(), rest.end());
+  }
+  return points;
+}
+
+std::vector<b2Vec2> clustered(const Region &region, std::size_t count,
+                              int clusters, float cluster_radius, Rng &rng) {
+  if (clusters <= 0) {
+    clusters = std::max(
+        1, static_cast<int>(std::lround(std::sqrt(static_cast<float>(count)) /
+                                        2.0f)));
+  }
+  if (cluster_radius <= 0.0f) {
+    cluster_radius = 0.05f * std::min(region.width, region.height);
+  }
+  const std::vector<b2Vec2> centres =
+      uniform(region, static_cast<std::size_t>(clusters), rng);
+
+  const b2Vec2 upper(region.lower.x + region.width,
+                     region.lower.y + region.height);
+  std::vector<b2Vec2> points;
+  points.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    const b2Vec2 &centre = centres[rng.below(clusters)];
+    // Points that land outside the region are drawn again a few times before
+    // being pulled back inside it, so clusters at the edge are not flattened
+    // against it.
+    b2Vec2 point;
+    for (int attempt = 0; attempt < 8; ++attempt) {
+      const float x = rng.normal(0.0f, cluster_radius);
+      const float y = rng.normal(0.0f, cluster_radius);
+      point.Set(centre.x + x, centre.y + y);
+      if (point.x >= region.lower.x && point.x <= upper.x &&
+          point.y >= region.lower.y && point.y <= upper.y) {
+        break;
+      }
+    }
+    points.emplace_back(std::clamp(point.x, region.lower.x, upper.x),
+                        std::clamp(point.y, region.lower.y, upper.y));
+  }
+  return points;
+}
+
+std::vector<b2Vec2> disc(const Region &region, std::size_t count, Rng &rng) {
+  const b2Vec2 centre(region.lower.x + region.width / 2,
+                      region.lower.y + region.height / 2);
+  const float radius = std::min(region.width, region.height) / 2;
+  std::vector<b2Vec2> points;
+  points.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    const float theta = rng.uniform() * 2.0f * b2_pi;
+    // The square root spreads points evenly over the area of the disc,
+    // rather than bunching them at its centre.
+    const float r = std::sqrt(rng.uniform()) * radius;
+    points.emplace_back(centre.x + r * std::cos(theta),
+                        centre.y + r * std::sin(theta));
+  }
+  return points;
+}
+
+// FNV-1a, which is stable across platforms and runs, unlike std::hash.
+class Hasher {
+ public:
+  template <typename T>
+  void add(const T &value) {
+    add(&value, sizeof(value));
+  }
+  void add(const std::string &value) {
+    add(value.size());
+    add(value.data(), value.size());
+  }
+  uint64_t value() const { return hash_; }
+
+ private:
+  uint64_t hash_ = 14695981039346656037ull;
+
+  void add(const void *data, std::size_t size) {
+    const auto *bytes = static_cast<const unsigned char *>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+      hash_ ^= bytes[i];
+      hash_ *= 1099511628211ull;
+    }
+  }
+};
+}  // namespace
+
+std::string placementName(const Placement placement) {
+  switch (placement) {
+    case Placement::Uniform:
+      return "uniform";
+    case Placement::Stratified:
+      return "stratified";
+    case Placement::PoissonDisk:
+      return "poisson";
+    case Placement::Clustered:
+      return "clustered";
+    case Placement::Disc:
+      return "disc";
+  }
+  return "uniform";
+}
+
+Placement placementFromName(const std::string &name) {
+  for (const Placement placement :
+       {Placement::Uniform, Placement::Stratified, Placement::PoissonDisk,
+        Placement::Clustered, Placement::Disc}) {
+    if (placementName(placement) == name) {
+      return placement;
+    }
+  }
+  throw std::invalid_argument("No placement named " + name);
+}
+
+uint64_t LayoutSpec::key() const {
+  Hasher hasher;
+  hasher.add(static_cast<int32_t>(placement));
+  hasher.add(seed);
+  hasher.add(map_name);
+  hasher.add(static_cast<uint64_t>(count));
+  hasher.add(lower.x);
+  hasher.add(lower.y);
+  hasher.add(upper.x);
+  hasher.add(upper.y);
+  hasher.add(min_distance);
+  hasher.add(static_cast<int32_t>(clusters));
+  hasher.add(cluster_radius);
+  return hasher.value();
+}
+
+std::vector<b2Vec2> generateLayout(const LayoutSpec &spec) {
+  if (spec.count == 0) {
+    return {};
+  }
+  const Region region{spec.lower, std::max(0.0f, spec.upper.x - spec.lower.x),
+                      std::max(0.0f, spec.upper.y - spec.lower.y)};
+  Rng rng(spec.seed);
+  switch (spec.placement) {
+    case Placement::Stratified:
+      return stratified(region, spec.count, rng);
+    case Placement::PoissonDisk:
+      return poissonDisk(region, spec.count, spec.min_distance, rng);
+    case Placement::Clustered:
+      return clustered(region, spec.count, spec.clusters, spec.cluster_radius,
+                       rng);
+    case Placement::Disc:
+      return disc(region, spec.count, rng);
+    case Placement::Uniform:
+    default:
+      return uniform(region, spec.count, rng);
+  }
+}
+
+Layout::Layout(std::vector<b2Vec2> points)
+    : owned_(std::move(points)), points_(owned_.data()), size_(owned_.size()) {}
+
+Layout::Layout(MappedFile file, const std::size_t offset,
+               const std::size_t count)
+    : file_(std::move(file)),
+      points_(reinterpret_cast<const b2Vec2 *>(file_.data() + offset)),
+      size_(count) {}
+
+Layout::Layout(Layout &&other) noexcept
+    : owned_(std::move(other.owned_)),
+      file_(std::move(other.file_)),
+      points_(std::exchange(other.points_, nullptr)),
+      size_(std::exchange(other.size_, 0)) {}
+
+Layout &Layout::operator=(Layout &&other) noexcept {
+  owned_ = std::move(other.owned_);
+  file_ = std::move(other.file_);
+  points_ = std::exchange(other.points_, nullptr);
+  size_ = std::exchange(other.size_, 0);
+  return *this;
+}
+
+LayoutCache::LayoutCache(std::filesystem::path directory)
+    : directory_(std::move(directory)) {}
+
+LayoutCache &LayoutCache::shared() {
+  static LayoutCache cache(map::getExecutablePath() / ".." / ".." /
+                           "testbed" / "layouts");
+  return cache;
+}
+
+std::shared_ptr<const Layout> LayoutCache::get(const LayoutSpec &spec) {
+  const uint64_t key = spec.key();
+  // Held throughout, so that simulations set up together wait for one
+  // another instead of generating the same layout twice.
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto it = layouts_.find(key);
+  if (it != layouts_.end()) {
+    return it->second;
+  }
+  std::shared_ptr<const Layout> layout = load(spec);
+  if (!layout) {
+    std::vector<b2Vec2> points = generateLayout(spec);
+    ++generated_;
+    store(spec, points);
+    layout = std::make_shared<const Layout>(std::move(points));
+  }
+  layouts_.emplace(key, layout);
+  return layout;
+}
+
+std::filesystem::path LayoutCache::pathFor(const LayoutSpec &spec) const {
+  char key[17];
+  std::snprintf(key, sizeof(key), "%016llx",
+                static_cast<unsigned long long>(spec.key()));
+  const std::string map_name = spec.map_name.empty() ? "none" : spec.map_name;
+  return directory_ / (map_name + "_" + placementName(spec.placement) + "_" +
+                       std::to_string(spec.count) + "_" +
+                       std::to_string(spec.seed) + "_" + key + ".lyt");
+}
+
+void LayoutCache::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  layouts_.clear();
+}
+
+uint64_t LayoutCache::generated() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return generated_;
+}
+
+std::shared_ptr<const Layout> LayoutCache::load(const LayoutSpec &spec) const {
+  const std::filesystem::path path = pathFor(spec);
+  std::error_code error;
+  if (!std::filesystem::exists(path, error)) {
+    return nullptr;
+  }
+  MappedFile file;
+  try {
+    file = MappedFile(path.string());
+  } catch (const std::runtime_error &) {
+    return nullptr;
+  }
+  if (file.size() < sizeof(LayoutFileHeader)) {
+    return nullptr;
+  }
+  LayoutFileHeader header;
+  std::memcpy(&header, file.data(), sizeof(header));
+  if (std::memcmp(header.magic, kLayoutMagic, sizeof(header.magic)) != 0 ||
+      header.version != kLayoutVersion || header.point_size != sizeof(b2Vec2) ||
+      header.key != spec.key() || header.count != spec.count ||
+      file.size() < sizeof(header) + spec.count * sizeof(b2Vec2)) {
+    logger::get()->warn("Ignoring stale layout file {}", path.string());
+    return nullptr;
+  }
+  return std::make_shared<const Layout>(std::move(file), sizeof(header),
+                                        spec.count);
+}
+
+void LayoutCache::store(const LayoutSpec &spec,
+                        const std::vector<b2Vec2> &points) const {
+  const std::filesystem::path path = pathFor(spec);
+  std::error_code error;
+  std::filesystem::create_directories(directory_, error);
+  // Another process may be writing the same layout, so each writer uses its
+  // own temporary file and the last rename wins with identical contents.
+  std::filesystem::path temporary = path;
+  temporary += ".tmp" + std::to_string(std::random_device{}());
+
+  std::FILE *file = std::fopen(temporary.string().c_str(), "wb");
+  if (!file) {
+    logger::get()->warn("Could not write layout file {}", path.string());
+    return;
+  }
+  LayoutFileHeader header{};
+  std::memcpy(header.magic, kLayoutMagic, sizeof(header.magic));
+  header.version = kLayoutVersion;
+  header.point_size = sizeof(b2Vec2);
+  header.key = spec.key();
+  header.count = points.size();
+  const bool written =
+      std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+      std::fwrite(points.data(), sizeof(b2Vec2), points.size(), file) ==
+          points.size();
+  const bool closed = std::fclose(file) == 0;
+  if (written && closed) {
+    std::filesystem::rename(temporary, path, error);
+  }
+  if (!written || !closed || error) {
+    logger::get()->warn("Could not write layout file {}", path.string());
+    std::filesystem::remove(temporary, error);
+  }
+}
+
+}  // namespace salsa
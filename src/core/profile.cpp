@@ -0,0 +1,215 @@
+#include "salsa/core/profile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include "salsa/core/trace.h"
+
+namespace salsa {
+
+namespace {
+// Nearest-rank percentile of sorted samples.
+float percentile(const std::vector<float> &sorted, const float fraction) {
+  if (sorted.empty()) {
+    return 0.0f;
+  }
+  const auto rank = static_cast<std::size_t>(
+      std::ceil(fraction * static_cast<float>(sorted.size())));
+  return sorted[std::min(std::max<std::size_t>(rank, 1), sorted.size()) - 1];
+}
+}  // namespace
+
+StepProfile::StepProfile(const std::size_t window)
+    : window_(std::max<std::size_t>(window, 1)) {}
+
+void StepProfile::record(const StepPhase phase, const float ms) {
+  Series &series = series_[static_cast<std::size_t>(phase)];
+  if (series.recent.size() < window_) {
+    series.recent.push_back(ms);
+  } else {
+    series.recent[series.next] = ms;
+  }
+  series.next = (series.next + 1) % window_;
+  series.samples++;
+  series.total_ms += ms;
+  series.max_ms = std::max(series.max_ms, ms);
+}
+
+void StepProfile::recordWorld(const b2Profile &profile) {
+  record(StepPhase::WorldStep, profile.step);
+  record(StepPhase::Collide, profile.collide);
+  record(StepPhase::Solve, profile.solve);
+  record(StepPhase::SolveTOI, profile.solveTOI);
+  record(StepPhase::Broadphase, profile.broadphase);
+}
+
+void StepProfile::clear() {
+  for (Series &series : series_) {
+    series = Series();
+  }
+}
+
+PhaseStats StepProfile::stats(const StepPhase phase) const {
+  const Series &series = series_[static_cast<std::size_t>(phase)];
+  PhaseStats stats;
+  stats.samples = series.samples;
+  stats.total_ms = series.total_ms;
+  stats.max_ms = series.max_ms;
+  if (series.samples > 0) {
+    stats.mean_ms = static_cast<float>(series.total_ms /
+                                       static_cast<double>(series.samples));
+  }
+  std::vector<float> sorted = series.recent;
+  std::sort(sorted.begin(), sorted.end());
+  stats.p50_ms = percentile(sorted, 0.50f);
+  stats.p95_ms = percentile(sorted, 0.95f);
+  stats.p99_ms = percentile(sorted, 0.99f);
+  return stats;
+}
+
+uint64_t StepProfile::steps() const {
+  return series_[static_cast<std::size_t>(StepPhase::Update)].samples;
+}
+
+nlohmann::json StepProfile::toJson() const {
+  nlohmann::json phases;
+  for (std::size_t i = 0; i < kStepPhaseCount; i++) {
+    const auto phase = static_cast<StepPhase>(i);
+    const PhaseStats s = stats(phase);
+    phases[phaseName(phase)] = {{"samples", s.samples}, {"total_ms", s.total_ms},
+                                {"mean_ms", s.mean_ms}, {"max_ms", s.max_ms},
+                                {"p50_ms", s.p50_ms},   {"p95_ms", s.p95_ms},
+                                {"p99_ms", s.p99_ms}};
+  }
+  return {{"steps", steps()}, {"window", window_}, {"phases", phases}};
+}
+
+std::string StepProfile::table() const {
+  char line[128];
+  std::snprintf(line, sizeof(line), "%-12s %10s %10s %10s %10s %12s\n",
+                "phase", "p50 ms", "p95 ms", "p99 ms", "max ms", "total ms");
+  std::string table = line;
+  for (std::size_t i = 0; i < kStepPhaseCount; i++) {
+    const auto phase = static_cast<StepPhase>(i);
+    const PhaseStats s = stats(phase);
+    std::snprintf(line, sizeof(line),
+                  "%-12s %10.3f %10.3f %10.3f %10.3f %12.1f\n",
+                  phaseName(phase), s.p50_ms, s.p95_ms, s.p99_ms, s.max_ms,
+                  s.total_ms);
+    table += line;
+  }
+  return table;
+}
+
+const char *StepProfile::phaseName(const StepPhase phase) {
+  switch (phase) {
+    case StepPhase::WorldStep:
+      return "world_step";
+    case StepPhase::Collide:
+      return "collide";
+    case StepPhase::Solve:
+      return "solve";
+    case StepPhase::SolveTOI:
+      return "solve_toi";
+    case StepPhase::Broadphase:
+      return "broadphase";
+    case StepPhase::Contacts:
+      return "contacts";
+    case StepPhase::Behaviours:
+      return "behaviours";
+    case StepPhase::Targets:
+      return "targets";
+    case StepPhase::Observers:
+      return "observers";
+    case StepPhase::Update:
+      return "update";
+  }
+  return "unknown";
+}
+
+nlohmann::json StepCounters::toJson() const {
+  if (!available) {
+    return {{"available", false}, {"error", error}};
+  }
+  const auto phase = [](const CounterSample &sample) {
+    nlohmann::json json;
+    for (std::size_t i = 0; i < kHardwareEventCount; i++) {
+      json[PerfCounters::eventName(static_cast<HardwareEvent>(i))] =
+          sample.values[i];
+    }
+    json["ipc"] = sample.ipc();
+    return json;
+  };
+  return {{"available", true},
+          {"steps", steps},
+          {"world_step", phase(world_step)},
+          {"behaviours", phase(behaviours)}};
+}
+
+std::string StepCounters::table() const {
+  if (!available) {
+    return "Hardware counters unavailable: " + error + "\n";
+  }
+  char line[128];
+  std::snprintf(line, sizeof(line), "%-12s %14s %14s %6s %12s %12s\n",
+                "phase", "cycles", "instructions", "ipc", "llc misses",
+                "br misses");
+  std::string table = line;
+  const auto row = [&](const char *name, const CounterSample &sample) {
+    std::snprintf(
+        line, sizeof(line), "%-12s %14llu %14llu %6.2f %12llu %12llu\n", name,
+        static_cast<unsigned long long>(sample[HardwareEvent::Cycles]),
+        static_cast<unsigned long long>(sample[HardwareEvent::Instructions]),
+        sample.ipc(),
+        static_cast<unsigned long long>(sample[HardwareEvent::CacheMisses]),
+        static_cast<unsigned long long>(sample[HardwareEvent::BranchMisses]));
+    table += line;
+  };
+  row("world_step", world_step);
+  row("behaviours", behaviours);
+  return table;
+}
+
+float TimedContactListener::takeElapsedMs() {
+  const float ms =
+      std::chrono::duration<float, std::milli>(elapsed_).count();
+  elapsed_ = ProfileClock::duration::zero();
+  return ms;
+}
+
+void TimedContactListener::BeginContact(b2Contact *contact) {
+  const auto start = ProfileClock::now();
+  listener_->BeginContact(contact);
+  const auto end = ProfileClock::now();
+  elapsed_ += end - start;
+  if (tracer_) {
+    tracer_->record("begin_contact", 0, start, end);
+  }
+}
+
+void TimedContactListener::EndContact(b2Contact *contact) {
+  const auto start = ProfileClock::now();
+  listener_->EndContact(contact);
+  const auto end = ProfileClock::now();
+  elapsed_ += end - start;
+  if (tracer_) {
+    tracer_->record("end_contact", 0, start, end);
+  }
+}
+
+void TimedContactListener::PreSolve(b2Contact *contact,
+                                    const b2Manifold *old_manifold) {
+  const auto start = ProfileClock::now();
+  listener_->PreSolve(contact, old_manifold);
+  elapsed_ += ProfileClock::now() - start;
+}
+
+void TimedContactListener::PostSolve(b2Contact *contact,
+                                     const b2ContactImpulse *impulse) {
+  const auto start = ProfileClock::now();
+  listener_->PostSolve(contact, impulse);
+  elapsed_ += ProfileClock::now() - start;
+}
+
+}  // namespace salsa
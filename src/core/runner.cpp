@@ -0,0 +1,83 @@
+#include "salsa/core/runner.h"
+
+#include <chrono>
+#include <utility>
+
+namespace salsa {
+
+Runner::Runner(Sim &sim) : sim_(sim), time_limit_(sim.time_limit()) {}
+
+Runner &Runner::setTimeStep(const float time_step) {
+  time_step_ = time_step;
+  return *this;
+}
+
+Runner &Runner::setVelocityIterations(const int iterations) {
+  velocity_iterations_ = iterations;
+  return *this;
+}
+
+Runner &Runner::setPositionIterations(const int iterations) {
+  position_iterations_ = iterations;
+  return *this;
+}
+
+Runner &Runner::setTimeLimit(const float time_limit) {
+  time_limit_ = time_limit;
+  return *this;
+}
+
+Runner &Runner::addStopCondition(StopCondition condition) {
+  stop_conditions_.push_back(std::move(condition));
+  return *this;
+}
+
+Runner &Runner::onStep(StepCallback callback) {
+  step_callbacks_.push_back(std::move(callback));
+  return *this;
+}
+
+void Runner::step() {
+  sim_.stepWorld(time_step_, velocity_iterations_, position_iterations_);
+  sim_.update();
+  sim_.current_time() += time_step_;
+  for (const auto &callback : step_callbacks_) {
+    callback(sim_);
+  }
+}
+
+bool Runner::shouldStop() {
+  if (stop_requested_) {
+    return true;
+  }
+  for (const auto &condition : stop_conditions_) {
+    if (condition(sim_)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+Runner::Result Runner::run() {
+  Result result;
+  stop_requested_ = false;
+  const auto start = std::chrono::steady_clock::now();
+
+  while (time_limit_ < 0.0f || sim_.current_time() < time_limit_) {
+    step();
+    result.steps++;
+    if (shouldStop()) {
+      result.stopped_early =
+          time_limit_ < 0.0f || sim_.current_time() < time_limit_;
+      break;
+    }
+  }
+
+  const std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+  result.wall_time_ms = elapsed.count();
+  result.sim_time = sim_.current_time();
+  return result;
+}
+
+}  // namespace salsa
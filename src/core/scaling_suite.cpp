@@ -0,0 +1,402 @@
+#include "salsa/core/scaling_suite.h"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "salsa/behaviours/registry.h"
+
+namespace salsa {
+
+namespace {
+nlohmann::json statsToJson(const PhaseStats &stats) {
+  return {{"samples", stats.samples}, {"total_ms", stats.total_ms},
+          {"mean_ms", stats.mean_ms}, {"max_ms", stats.max_ms},
+          {"p50_ms", stats.p50_ms},   {"p95_ms", stats.p95_ms},
+          {"p99_ms", stats.p99_ms}};
+}
+
+PhaseStats statsFromJson(const nlohmann::json &j) {
+  PhaseStats stats;
+  stats.samples = j.value("samples", uint64_t{0});
+  stats.total_ms = j.value("total_ms", 0.0);
+  stats.mean_ms = j.value("mean_ms", 0.0f);
+  stats.max_ms = j.value("max_ms", 0.0f);
+  stats.p50_ms = j.value("p50_ms", 0.0f);
+  stats.p95_ms = j.value("p95_ms", 0.0f);
+  stats.p99_ms = j.value("p99_ms", 0.0f);
+  return stats;
+}
+
+enum class MetricKind { Rtf, StepTime, Memory };
+
+/// A measurement compared against the baseline. Every one of them is better
+/// the lower it is.
+struct Metric {
+  const char *name;
+  MetricKind kind;
+  double (*read)(const ScalingCase &);
+};
+
+constexpr Metric kMetrics[] = {
+    {"rtf", MetricKind::Rtf, [](const ScalingCase &c) { return c.rtf; }},
+    {"world_p50_ms", MetricKind::StepTime,
+     [](const ScalingCase &c) { return double{c.world.p50_ms}; }},
+    {"world_p95_ms", MetricKind::StepTime,
+     [](const ScalingCase &c) { return double{c.world.p95_ms}; }},
+    {"update_p50_ms", MetricKind::StepTime,
+     [](const ScalingCase &c) { return double{c.update.p50_ms}; }},
+    {"update_p95_ms", MetricKind::StepTime,
+     [](const ScalingCase &c) { return double{c.update.p95_ms}; }},
+    {"peak_bytes", MetricKind::Memory,
+     [](const ScalingCase &c) { return static_cast<double>(c.peak_bytes); }},
+};
+
+template <typename T>
+void readIfPresent(const nlohmann::json &j, const char *key, T &value) {
+  if (j.contains(key)) {
+    j.at(key).get_to(value);
+  }
+}
+}  // namespace
+
+std::vector<TestConfig> ScalingSweep::tests() const {
+  const std::vector<std::string> names =
+      behaviours.empty() ? behaviour::Registry::get().behaviour_names()
+                         : behaviours;
+  std::vector<TestConfig> tests;
+  tests.reserve(names.size() * maps.size() * target_counts.size() *
+                drone_counts.size());
+  for (const std::string &name : names) {
+    for (const std::string &map : maps) {
+      for (const int targets : target_counts) {
+        for (const int drones : drone_counts) {
+          TestConfig config{name,
+                            TestConfig::FloatParameters{},
+                            drone_config_name,
+                            map,
+                            drones,
+                            targets,
+                            time_limit,
+                            target_type,
+                            contact_listener_name};
+          config.num_threads = num_threads;
+          config.use_target_store = use_target_store;
+          config.layout_seed = seed;
+          config.seed = seed;
+          tests.push_back(config);
+        }
+      }
+    }
+  }
+  return tests;
+}
+
+nlohmann::json ScalingSweep::toJson() const {
+  return {{"behaviours", behaviours},
+          {"maps", maps},
+          {"drone_counts", drone_counts},
+          {"target_counts", target_counts},
+          {"time_limit", time_limit},
+          {"seed", seed},
+          {"drone_config_name", drone_config_name},
+          {"target_type", target_type},
+          {"contact_listener_name", contact_listener_name},
+          {"use_target_store", use_target_store},
+          {"num_threads", num_threads}};
+}
+
+ScalingSweep ScalingSweep::fromJson(const nlohmann::json &j) {
+  ScalingSweep sweep;
+  readIfPresent(j, "behaviours", sweep.behaviours);
+  readIfPresent(j, "maps", sweep.maps);
+  readIfPresent(j, "drone_counts", sweep.drone_counts);
+  readIfPresent(j, "target_counts", sweep.target_counts);
+  readIfPresent(j, "time_limit", sweep.time_limit);
+  readIfPresent(j, "seed", sweep.seed);
+  readIfPresent(j, "drone_config_name", sweep.drone_config_name);
+  readIfPresent(j, "target_type", sweep.target_type);
+  readIfPresent(j, "contact_listener_name", sweep.contact_listener_name);
+  readIfPresent(j, "use_target_store", sweep.use_target_store);
+  readIfPresent(j, "num_threads", sweep.num_threads);
+  return sweep;
+}
+
+ScalingCase ScalingCase::fromResult(const TestExecutor::Result &result) {
+  ScalingCase c;
+  c.behaviour = result.config.behaviour_name;
+  c.map = result.config.map_name;
+  c.drones = result.config.num_drones;
+  c.targets = result.config.num_targets;
+  c.error = result.error;
+  if (!result.ok()) {
+    return c;
+  }
+  c.rtf = result.run.rtf();
+  c.wall_time_ms = result.run.wall_time_ms;
+  c.steps = result.profile.steps();
+  c.world = result.profile.stats(StepPhase::WorldStep);
+  c.update = result.profile.stats(StepPhase::Update);
+  c.peak_bytes = result.memory.peakBytes();
+  c.bytes_per_drone = result.memory.bytesPerDrone();
+  c.bytes_per_target = result.memory.bytesPerTarget();
+  return c;
+}
+
+std::string ScalingCase::key() const {
+  return behaviour + "/" + map + "/" + std::to_string(drones) + "x" +
+         std::to_string(targets);
+}
+
+nlohmann::json ScalingCase::toJson() const {
+  return {{"key", key()},
+          {"behaviour", behaviour},
+          {"map", map},
+          {"drones", drones},
+          {"targets", targets},
+          {"rtf", rtf},
+          {"wall_time_ms", wall_time_ms},
+          {"steps", steps},
+          {"world", statsToJson(world)},
+          {"update", statsToJson(update)},
+          {"memory",
+           {{"peak_bytes", peak_bytes},
+            {"bytes_per_drone", bytes_per_drone},
+            {"bytes_per_target", bytes_per_target}}},
+          {"error", error}};
+}
+
+ScalingCase ScalingCase::fromJson(const nlohmann::json &j) {
+  ScalingCase c;
+  j.at("behaviour").get_to(c.behaviour);
+  j.at("map").get_to(c.map);
+  j.at("drones").get_to(c.drones);
+  j.at("targets").get_to(c.targets);
+  readIfPresent(j, "rtf", c.rtf);
+  readIfPresent(j, "wall_time_ms", c.wall_time_ms);
+  readIfPresent(j, "steps", c.steps);
+  if (j.contains("world")) {
+    c.world = statsFromJson(j.at("world"));
+  }
+  if (j.contains("update")) {
+    c.update = statsFromJson(j.at("update"));
+  }
+  if (j.contains("memory")) {
+    const nlohmann::json &memory = j.at("memory");
+    readIfPresent(memory, "peak_bytes", c.peak_bytes);
+    readIfPresent(memory, "bytes_per_drone", c.bytes_per_drone);
+    readIfPresent(memory, "bytes_per_target", c.bytes_per_target);
+  }
+  readIfPresent(j, "error", c.error);
+  return c;
+}
+
+double ScalingChange::change() const {
+  return baseline != 0.0 ? (current - baseline) / baseline : 0.0;
+}
+
+std::string ScalingComparison::table() const {
+  char line[160];
+  std::string table;
+  for (const std::string &setting : settings) {
+    table += "Sweep setting differs: " + setting + "\n";
+  }
+  const auto rows = [&](const char *title,
+                        const std::vector<ScalingChange> &changes) {
+    if (changes.empty()) {
+      return;
+    }
+    std::snprintf(line, sizeof(line), "%s:\n%-36s %-14s %14s %14s %8s\n",
+                  title, "test", "metric", "baseline", "current", "change");
+    table += line;
+    for (const ScalingChange &change : changes) {
+      std::snprintf(line, sizeof(line), "%-36s %-14s %14.4f %14.4f %+7.1f%%\n",
+                    change.key.c_str(), change.metric.c_str(), change.baseline,
+                    change.current, 100.0 * change.change());
+      table += line;
+    }
+  };
+  rows("Regressions", regressions);
+  rows("Improvements", improvements);
+  for (const std::string &key : missing) {
+    table += "Missing or failed: " + key + "\n";
+  }
+  for (const std::string &key : added) {
+    table += "Not in the baseline: " + key + "\n";
+  }
+  if (table.empty()) {
+    table = "No changes beyond the tolerance\n";
+  }
+  return table;
+}
+
+nlohmann::json ScalingComparison::toJson() const {
+  const auto changes = [](const std::vector<ScalingChange> &list) {
+    nlohmann::json array = nlohmann::json::array();
+    for (const ScalingChange &change : list) {
+      array.push_back({{"key", change.key},
+                       {"metric", change.metric},
+                       {"baseline", change.baseline},
+                       {"current", change.current},
+                       {"change", change.change()}});
+    }
+    return array;
+  };
+  return {{"passed", passed()},
+          {"tolerance",
+           {{"time", tolerance.time},
+            {"memory", tolerance.memory},
+            {"min_step_ms", tolerance.min_step_ms},
+            {"min_rtf", tolerance.min_rtf}}},
+          {"regressions", changes(regressions)},
+          {"improvements", changes(improvements)},
+          {"missing", missing},
+          {"added", added},
+          {"settings", settings}};
+}
+
+ScalingComparison ScalingReport::compare(
+    const ScalingReport &baseline, const ScalingTolerance &tolerance) const {
+  ScalingComparison comparison;
+  comparison.tolerance = tolerance;
+  // Read from the JSON of the sweeps, so that settings added later are
+  // compared too.
+  const nlohmann::json settings = sweep.toJson();
+  const nlohmann::json baseline_settings = baseline.sweep.toJson();
+  for (const auto &[name, value] : settings.items()) {
+    if (name == "drone_counts" || name == "target_counts") {
+      continue;
+    }
+    const nlohmann::json was = baseline_settings.value(name, nlohmann::json());
+    if (was != value) {
+      comparison.settings.push_back(name + ": " + was.dump() + " -> " +
+                                    value.dump());
+    }
+  }
+  std::unordered_map<std::string, const ScalingCase *> current;
+  for (const ScalingCase &c : cases) {
+    current[c.key()] = &c;
+  }
+  std::unordered_map<std::string, bool> in_baseline;
+  for (const ScalingCase &before : baseline.cases) {
+    const std::string key = before.key();
+    in_baseline[key] = true;
+    if (!before.ok()) {
+      continue;
+    }
+    const auto it = current.find(key);
+    if (it == current.end() || !it->second->ok()) {
+      comparison.missing.push_back(key);
+      continue;
+    }
+    const ScalingCase &after = *it->second;
+    for (const Metric &metric : kMetrics) {
+      const double was = metric.read(before);
+      const double now = metric.read(after);
+      double fraction = tolerance.time;
+      double floor = 0.0;
+      switch (metric.kind) {
+        case MetricKind::Rtf:
+          floor = tolerance.min_rtf;
+          break;
+        case MetricKind::StepTime:
+          floor = tolerance.min_step_ms;
+          break;
+        case MetricKind::Memory:
+          fraction = tolerance.memory;
+          break;
+      }
+      if (std::abs(now - was) <= floor) {
+        continue;
+      }
+      if (now > was * (1.0 + fraction)) {
+        comparison.regressions.push_back({key, metric.name, was, now});
+      } else if (now < was * (1.0 - fraction)) {
+        comparison.improvements.push_back({key, metric.name, was, now});
+      }
+    }
+  }
+  for (const ScalingCase &c : cases) {
+    if (in_baseline.find(c.key()) == in_baseline.end()) {
+      comparison.added.push_back(c.key());
+    }
+  }
+  return comparison;
+}
+
+std::string ScalingReport::table() const {
+  char line[192];
+  std::snprintf(line, sizeof(line),
+                "%-36s %9s %10s %10s %10s %10s %10s %10s\n", "test", "rtf",
+                "world p50", "world p95", "update p50", "update p95",
+                "update p99", "peak MB");
+  std::string table = line;
+  for (const ScalingCase &c : cases) {
+    if (!c.ok()) {
+      table += c.key() + " failed: " + c.error + "\n";
+      continue;
+    }
+    std::snprintf(line, sizeof(line),
+                  "%-36s %9.4f %10.3f %10.3f %10.3f %10.3f %10.3f %10.1f\n",
+                  c.key().c_str(), c.rtf, c.world.p50_ms, c.world.p95_ms,
+                  c.update.p50_ms, c.update.p95_ms, c.update.p99_ms,
+                  static_cast<double>(c.peak_bytes) / (1024.0 * 1024.0));
+    table += line;
+  }
+  return table;
+}
+
+nlohmann::json ScalingReport::toJson() const {
+  nlohmann::json list = nlohmann::json::array();
+  for (const ScalingCase &c : cases) {
+    list.push_back(c.toJson());
+  }
+  return {{"sweep", sweep.toJson()}, {"cases", list}};
+}
+
+ScalingReport ScalingReport::fromJson(const nlohmann::json &j) {
+  ScalingReport report;
+  if (j.contains("sweep")) {
+    report.sweep = ScalingSweep::fromJson(j.at("sweep"));
+  }
+  for (const nlohmann::json &c : j.at("cases")) {
+    report.cases.push_back(ScalingCase::fromJson(c));
+  }
+  return report;
+}
+
+bool ScalingReport::save(const std::filesystem::path &path) const {
+  std::ofstream file(path);
+  if (!file.is_open()) {
+    return false;
+  }
+  file << toJson().dump(2);
+  return static_cast<bool>(file);
+}
+
+ScalingReport ScalingReport::load(const std::filesystem::path &path) {
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    throw std::runtime_error("Could not open scaling report " +
+                             path.string());
+  }
+  try {
+    return fromJson(nlohmann::json::parse(file));
+  } catch (const nlohmann::json::exception &e) {
+    throw std::runtime_error(path.string() + ": " + e.what());
+  }
+}
+
+ScalingReport runScalingSweep(const ScalingSweep &sweep,
+                              TestExecutor &executor) {
+  ScalingReport report;
+  report.sweep = sweep;
+  for (const TestExecutor::Result &result : executor.run(sweep.tests())) {
+    report.cases.push_back(ScalingCase::fromResult(result));
+  }
+  return report;
+}
+
+}  // namespace salsa
@@ -1,16 +1,25 @@
 #include "salsa/core/sim.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <ctime>
 #include <execution>
+#include <fstream>
+#include <new>
+#include <random>
+#include <stdexcept>
 
 #include "salsa/behaviours/registry.h"
+#include "salsa/core/checkpoint.h"
 #include "salsa/utils/base_contact_listener.h"
 namespace salsa {
 
 Sim::Sim(b2World *world, const int drone_count, const int target_count,
          DroneConfiguration *config, const float border_width,
          const float border_height, const float time_limit)
-    : world_(world),
+    : memory_(MemoryAccount::create(MemoryBacking::Heap)),
+      world_(world),
       border_height_(border_height),
       border_width_(border_width),
       time_limit_(time_limit),
@@ -20,59 +29,169 @@ Sim::Sim(b2World *world, const int drone_count, const int target_count,
   const b2Vec2 gravity(0.0f, 0.0f);
   world_->SetGravity(gravity);
 
-  salsa::Logger::switch_log_file("test.log");
+  logger_ = std::make_shared<Logger>("test.log");
   createBounds();
   drone_spawn_position_ = b2Vec2(border_width_ / 2, border_height_ / 2);
 
   createDrones(*behaviour_, *drone_configuration_, SpawnType::CIRCULAR);
 }
 
-Sim::Sim(TestConfig &config)
-    : map_name_(config.map_name),
-      num_drones_(config.num_drones),
-      num_targets_(config.num_targets),
-      drone_configuration_(DroneConfiguration::getDroneConfigurationByName(
-          config.drone_config_name)),
-      time_limit_(config.time_limit),
-      target_type_(config.target_type),
-      contact_listener_(
-          BaseContactListener::getListenerByName(config.contact_listener_name)),
-      test_config_(config) {
+Sim::Sim() = default;
+
+Sim::Sim(TestConfig &config) : test_config_(config) {
   logger::get()->info("Sim Initialised");
   is_stack_test_ = true;
-  // Load map
-  map_ = salsa::map::load(map_name_.c_str());
-  world_ = map_.world;
+  reconfigure(config);
+}
+
+void Sim::reconfigure(const TestConfig &config) {
+  // The old behaviour is cleaned while its drones still exist.
+  test_config_ = config;
+  current_behaviour_name_ = config.behaviour_name;
+  setCurrentBehaviour(current_behaviour_name_);
+  if (!behaviour_) {
+    throw std::invalid_argument("No behaviour registered with the name " +
+                                current_behaviour_name_);
+  }
+  // Parameters are copied into the behaviour by value, so the test
+  // configuration and the registry are left untouched.
+  auto visitor = [&](auto &&arg) {
+    behaviour_->setParameters(Behaviour::convertParametersToFloat(arg));
+  };
+  std::visit(visitor, config.parameters);
+
+  if (!world_ || config.map_name != map_name_) {
+    loadMap(config.map_name);
+  }
+  is_stack_test_ = true;
+
+  // Drones are only rebuilt if their fixtures would change, and targets if
+  // they would be of another kind.
+  DroneConfiguration *drone_configuration =
+      DroneConfiguration::getDroneConfigurationByName(config.drone_config_name);
+  if (drone_configuration != drone_configuration_) {
+    drones_.clear();
+  }
+  drone_configuration_ = drone_configuration;
+  if (config.target_type != target_type_ ||
+      config.use_target_store != use_target_store_) {
+    destroyTargets();
+  }
+  target_type_ = config.target_type;
+  use_target_store_ = config.use_target_store;
+  target_placement_ = placementFromName(config.target_placement);
+  layout_seed_ = config.layout_seed;
+  seedRandom(config.seed >= 0 ? static_cast<uint64_t>(config.seed)
+                              : Rng::randomSeed());
+  num_drones_ = config.num_drones;
+  num_targets_ = config.num_targets;
+  time_limit_ = config.time_limit;
+  setThreadCount(config.num_threads);
+  if (config.trace_steps > 0) {
+    enableTracing(static_cast<std::size_t>(config.trace_steps));
+  } else {
+    disableTracing();
+  }
+  setHardwareCounters(config.hardware_counters);
+
+  contact_listener_ =
+      BaseContactListener::getListenerByName(config.contact_listener_name);
+  attachContactListener();
+
+  startLog();
+  restart();
+}
+
+void Sim::loadMap(const std::string &name) {
+  // Everything in the old world goes with it.
+  createWorld(b2Vec2(0.0f, 0.0f));
+  const auto memory = MemoryAccount::scope(memory_.get(), MemoryCategory::Map);
+  map_name_ = name;
+  map_ = salsa::map::load(map_name_.c_str(), world_);
+  for (const b2Body *body = world_->GetBodyList(); body;
+       body = body->GetNext()) {
+    map_bodies_.push_back(body);
+  }
   border_width_ = map_.width;
   border_height_ = map_.height;
   drone_spawn_position_ = map_.drone_spawn_point;
-  b2Vec2 gravity(0.0f, 0.0f);
-  world_->SetGravity(gravity);
-  current_behaviour_name_ = config.behaviour_name;
+}
+
+b2World *Sim::createWorld(const b2Vec2 &gravity) {
+  releaseWorld();
+  if (memory_->backing() != MemoryBacking::Arena) {
+    memory_ = MemoryAccount::create(MemoryBacking::Arena);
+  }
+  // The world itself is in the arena too, so that it goes with everything
+  // in it.
+  void *storage = memory_->allocate(sizeof(b2World),
+                                    static_cast<int32>(MemoryCategory::Map));
+  const auto memory = MemoryAccount::scope(memory_.get(), MemoryCategory::Map);
+  owned_world_ = new (storage) b2World(gravity);
+  world_ = owned_world_;
+  return owned_world_;
+}
+
+void Sim::releaseWorld() {
+  if (owned_world_) {
+    // The bodies are freed with the arena, so nothing is destroyed one at a
+    // time, and no contact ends.
+    for (const auto &drone : drones_) {
+      drone->abandonBody();
+    }
+    for (Target *target : target_pool_.targets()) {
+      target->abandonBody();
+    }
+  } else {
+    for (const auto &obstacle : obstacles_) {
+      world_->DestroyBody(obstacle);
+    }
+  }
+  drones_.clear();
+  destroyTargets();
+  obstacles_.clear();
+  map_bodies_.clear();
+  if (owned_world_) {
+    owned_world_ = nullptr;
+    world_ = nullptr;
+    map_.world = nullptr;
+    memory_->release();
+  }
+}
+
+void Sim::startLog() {
   auto now = std::chrono::system_clock::now();
   auto time_t = std::chrono::system_clock::to_time_t(now);
-  auto tm = *std::localtime(&time_t);
+  // std::localtime returns shared storage, which is not safe when several
+  // simulations are set up at once.
+  std::tm tm{};
+#if defined(_WIN32)
+  localtime_s(&tm, &time_t);
+#else
+  localtime_r(&time_t, &tm);
+#endif
   auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(
                           now.time_since_epoch()) %
                       1000;
 
+  // Simulations started within the same millisecond, for example by the
+  // `TestExecutor`, are told apart by a sequence number.
+  static std::atomic<int> sequence{0};
+
   std::ostringstream oss;
   oss << std::put_time(&tm, "%Y-%m-%d_%H-%M-%S") << "." << std::setw(3)
-      << milliseconds.count() << "_" << current_behaviour_name_.c_str()
-      << "/result.log";
+      << milliseconds.count() << "_" << current_behaviour_name_.c_str() << "_"
+      << sequence++ << "/result.log";
   current_log_file_ = oss.str();
-  salsa::Logger::switch_log_file(current_log_file_);
+  // Replacing the logger of the previous test flushes its file.
+  observers_.erase(std::remove(observers_.begin(), observers_.end(), logger_),
+                   observers_.end());
+  logger_ = std::make_shared<Logger>(current_log_file_);
+  addObserver(logger_);
 
-  world_->SetContactListener(contact_listener_);
-  addObserver(std::shared_ptr<Logger>(&logger_, [](auto *) {}));
-
-  auto behaviour_pointer =
-      behaviour::Registry::get().behaviour(current_behaviour_name_);
-  auto visitor = [&](auto &&arg) { behaviour_pointer->setParameters(arg); };
-  std::visit(visitor, config.parameters);
   nlohmann::json old_message;
   std::unordered_map<std::string, behaviour::Parameter *> params =
-      behaviour_pointer->getParameters();
+      behaviour_->getParameters();
   for (const auto &[key, value] : params) {
     old_message[key] = value->value();
   }
@@ -83,10 +202,13 @@ Sim::Sim(TestConfig &config)
   old_message["num_targets"] = num_targets_;
   old_message["time_limit"] = time_limit_;
   old_message["target_type"] = target_type_;
+  old_message["target_placement"] = placementName(target_placement_);
+  old_message["layout_seed"] = layout_seed_;
+  old_message["seed"] = seed_;
   old_message["border_dimensions"] = {border_width_, border_height_};
 
   nlohmann::json message;
-  message["time"] = current_time_;
+  message["time"] = 0.0f;
   message["message"] = old_message.dump();
   message["id"] = 0;
   message["caller_type"] = "Sim";
@@ -95,38 +217,357 @@ Sim::Sim(TestConfig &config)
     observer->update(message);
   }
 
-  createDrones(*behaviour_, *drone_configuration_, SpawnType::CIRCULAR);
-  createTargets();
+  // Drone samples go to a binary file next to the log, which is far smaller
+  // and quicker to load than a line of text per sample.
+  current_trajectory_file_ =
+      current_log_file_.substr(0, current_log_file_.rfind('.')) + ".trj";
+  telemetry_.open(Logger::results_path(current_trajectory_file_).string(),
+                  old_message.dump());
+}
+
+void Sim::finishLog() {
+  const auto flush_start = ProfileClock::now();
+  const bool trajectory_open = telemetry_.is_open();
+  telemetry_.close();
+  if (trajectory_open && !telemetry_.good()) {
+    logger::get()->error("Could not write all of the trajectory to {}",
+                         current_trajectory_file_);
+  }
+  if (logger_) {
+    logger_->flush();
+  }
+  if (tracer_) {
+    tracer_->record("flush_log", 0, flush_start, ProfileClock::now());
+  }
+  if (!current_log_file_.empty() && profile_.steps() > 0) {
+    const std::filesystem::path path =
+        Logger::results_path(current_log_file_).parent_path() / "profile.json";
+    nlohmann::json profile = profile_.toJson();
+    profile["memory"] = memoryReport().toJson();
+    if (count_hardware_) {
+      profile["counters"] = counters_.toJson();
+    }
+    if (std::ofstream file(path); file.is_open()) {
+      file << profile.dump(2);
+    } else {
+      logger::get()->warn("Could not write the step profile to {}",
+                          path.string());
+    }
+  }
+  if (!current_log_file_.empty() && tracer_ && tracer_->steps() > 0) {
+    const std::filesystem::path path =
+        Logger::results_path(current_log_file_).parent_path() / "trace.json";
+    if (!tracer_->write(path)) {
+      logger::get()->warn("Could not write the step trace to {}",
+                          path.string());
+    }
+  }
+}
+
+namespace {
+struct DroneState {
+  int32_t id;
+  b2Vec2 position;
+  float angle;
+  b2Vec2 velocity;
+  float angular_velocity;
+};
+}  // namespace
+
+std::unique_ptr<Sim> Sim::fork() const {
+  if (!is_stack_test_) {
+    throw std::logic_error(
+        "Only a simulation set up from a TestConfig can be forked");
+  }
+  CheckpointWriter state;
+  writeState(state);
+
+  // The copy is set up for the test as it stands now, rather than as it was
+  // first configured.
+  TestConfig config = test_config_;
+  config.behaviour_name = current_behaviour_name_;
+  config.map_name = map_name_;
+  config.num_drones = static_cast<int>(drones_.size());
+  config.num_targets = static_cast<int>(target_pool_.size());
+  config.target_type = target_type_;
+  config.use_target_store = use_target_store_;
+  config.target_placement = placementName(target_placement_);
+  config.layout_seed = layout_seed_;
+  config.seed = static_cast<int64_t>(seed_);
+  config.time_limit = time_limit_;
+  config.num_threads = num_threads_;
+
+  // Copying the map's bodies is much cheaper than loading the map again, and
+  // the obstacle field of the same geometry can be shared.
+  std::unique_ptr<Sim> copy(new Sim());
+  copy->createWorld(world_->GetGravity());
+  const auto memory =
+      MemoryAccount::scope(copy->memory_.get(), MemoryCategory::Map);
+  // A world lists its newest body first, so copying from last to first
+  // keeps the bodies in the same order.
+  copy->map_bodies_.resize(map_bodies_.size());
+  for (std::size_t i = map_bodies_.size(); i-- > 0;) {
+    copy->map_bodies_[i] = map::copyBody(*map_bodies_[i], *copy->world_);
+  }
+  copy->map_ = map_;
+  copy->map_.world = copy->world_;
+  copy->map_name_ = map_name_;
+  copy->border_width_ = border_width_;
+  copy->border_height_ = border_height_;
+  copy->drone_spawn_position_ = drone_spawn_position_;
+  copy->reconfigure(config);
+  copy->behaviour_->setParameters(behaviour_->getParameterValues());
+
+  CheckpointReader in(state.data().data(), state.size());
+  copy->readState(in);
+  return copy;
+}
+
+void Sim::saveCheckpoint(const std::string &path) const {
+  CheckpointWriter out;
+  writeState(out);
+  out.save(path);
+}
+
+void Sim::loadCheckpoint(const std::string &path) {
+  CheckpointReader in{std::filesystem::path(path)};
+  try {
+    readState(in);
+  } catch (const std::runtime_error &e) {
+    throw std::runtime_error(path + ": " + e.what());
+  }
+  logger::get()->info("Restored checkpoint {} at {}s", path, current_time_);
+}
+
+void Sim::writeState(CheckpointWriter &out) const {
+  out.write(current_behaviour_name_);
+  out.write(current_time_);
+  out.write(num_time_steps_);
+
+  out.write(seed_);
+  out.write(rng_);
+  out.write(drone_rngs_);
+
+  out.write<uint64_t>(drones_.size());
+  for (const auto &drone : drones_) {
+    const b2Body *body = drone->body();
+    out.write<int32_t>(drone->id());
+    out.write(body->GetPosition());
+    out.write(body->GetAngle());
+    out.write(body->GetLinearVelocity());
+    out.write(body->GetAngularVelocity());
+  }
+
+  const std::vector<Target *> &targets = target_pool_.targets();
+  std::vector<b2Vec2> positions;
+  positions.reserve(targets.size());
+  std::vector<uint64_t> found((targets.size() + 63) / 64, 0);
+  for (std::size_t i = 0; i < targets.size(); i++) {
+    positions.push_back(targets[i]->position());
+    if (targets[i]->isFound()) {
+      found[i >> 6] |= uint64_t{1} << (i & 63);
+    }
+  }
+  out.write(positions);
+  out.write(found);
+
+  // Kept as a block of its own, so a behaviour that misreads its state
+  // cannot throw the rest of the checkpoint off.
+  CheckpointWriter behaviour_state;
+  if (behaviour_) {
+    behaviour_->saveState(drones_, behaviour_state);
+  }
+  out.write(behaviour_state.data());
+}
+
+void Sim::readState(CheckpointReader &in) {
+  const auto memory =
+      MemoryAccount::scope(memory_.get(), MemoryCategory::Other);
+  const std::string behaviour_name = in.readString();
+  const auto time = in.read<float>();
+  const auto time_steps = in.read<int>();
+  const auto seed = in.read<uint64_t>();
+  const auto rng = in.read<Rng>();
+  auto drone_rngs = in.readVector<Rng>();
+
+  const auto drone_count = in.read<uint64_t>();
+  if (behaviour_name != current_behaviour_name_ ||
+      drone_count != drones_.size() || drone_rngs.size() > drone_count) {
+    throw std::runtime_error("Checkpoint is of " +
+                             std::to_string(drone_count) + " drones running " +
+                             behaviour_name + ", not " +
+                             std::to_string(drones_.size()) + " running " +
+                             current_behaviour_name_);
+  }
+  std::vector<DroneState> drone_states(drone_count);
+  for (std::size_t i = 0; i < drone_states.size(); i++) {
+    DroneState &state = drone_states[i];
+    state.id = in.read<int32_t>();
+    state.position = in.read<b2Vec2>();
+    state.angle = in.read<float>();
+    state.velocity = in.read<b2Vec2>();
+    state.angular_velocity = in.read<float>();
+    if (state.id != drones_[i]->id()) {
+      throw std::runtime_error("Checkpoint has its drones in another order");
+    }
+  }
+
+  const auto positions = in.readVector<b2Vec2>();
+  const auto found = in.readVector<uint64_t>();
+  if (positions.size() != target_pool_.size() ||
+      found.size() != (positions.size() + 63) / 64) {
+    throw std::runtime_error("Checkpoint is of " +
+                             std::to_string(positions.size()) +
+                             " targets, not " +
+                             std::to_string(target_pool_.size()));
+  }
+  const auto behaviour_state = in.readVector<unsigned char>();
+  // The behaviour checks its block first, so that a block it cannot read is
+  // found before anything is changed.
+  if (behaviour_) {
+    CheckpointReader state(behaviour_state.data(), behaviour_state.size());
+    behaviour_->checkState(drones_, state);
+  }
+
+  // Everything has been read, so nothing is changed unless all of it can be
+  // restored. Only a behaviour that cannot check its state without loading
+  // it is read after the rest has changed, and the simulation restarts if it
+  // fails.
+  current_time_ = time;
+  num_time_steps_ = time_steps;
+  seed_ = seed;
+  rng_ = rng;
+  drone_rngs_ = std::move(drone_rngs);
+
+  for (std::size_t i = 0; i < drones_.size(); i++) {
+    const DroneState &state = drone_states[i];
+    drones_[i]->restore(state.position, state.angle, state.velocity,
+                        state.angular_velocity);
+  }
+
+  const std::vector<Target *> &targets = target_pool_.targets();
+  for (std::size_t i = 0; i < targets.size(); i++) {
+    targets[i]->setFound(false);
+    targets[i]->position(positions[i]);
+  }
+  // The targets may no longer be where their layout put them.
+  target_layout_.reset();
+  trackTargets();
+  for (std::size_t i = 0; i < targets.size(); i++) {
+    if ((found[i >> 6] >> (i & 63)) & 1) {
+      targets[i]->setFound(true);
+    }
+  }
+  found_targets_.clearSteps();
+  targets_found_this_step_.clear();
+
+  if (behaviour_) {
+    behaviour_->clean(drones_);
+    CheckpointReader state(behaviour_state.data(), behaviour_state.size());
+    try {
+      behaviour_->loadState(drones_, state);
+    } catch (...) {
+      restart();
+      throw;
+    }
+  }
+
+  // A step of no time finds the contacts that were ongoing at the
+  // checkpoint, without solving anything. With the listener detached, they
+  // are not reported as new.
+  world_->SetContactListener(nullptr);
+  world_->Step(0.0f, 1, 1);
+  attachContactListener();
+  if (use_target_store_) {
+    target_store_.observe(drones_);
+  }
 }
 
 Sim::~Sim() {
-  for (const auto &obstacle : obstacles_) {
-    world_->DestroyBody(obstacle);
+  // A world given to the simulation outlives it, so it is given back the
+  // listener itself rather than the timer in front of it.
+  if (world_ && !owned_world_ && contact_listener_) {
+    world_->SetContactListener(contact_listener_);
   }
+  releaseOwnedBehaviour();
+  releaseWorld();
 }
 
 void Sim::update() {
   if (current_time_ <= time_limit_ && current_time_ > 0.0) {
+    const auto memory =
+        MemoryAccount::scope(memory_.get(), MemoryCategory::Step);
+    const auto update_start = ProfileClock::now();
+    // The world was stepped just before this update.
+    profile_.recordWorld(world_->GetProfile());
+    profile_.record(StepPhase::Contacts, contact_timer_.takeElapsedMs());
+    if (tracer_) {
+      tracer_->recordWorld(world_->GetProfile(), update_start);
+    }
+
     num_time_steps_++;
+    if (use_target_store_) {
+      target_store_.detect(drones_, contact_listener_);
+    }
+    // Targets found by the contacts of the last world step, and by the
+    // store just now.
+    found_targets_.beginStep();
     targets_found_this_step_.clear();
+    for (const int id : found_targets_.found_this_step()) {
+      targets_found_this_step_.push_back(target_pool_[id]);
+    }
+    const auto behaviours_start = ProfileClock::now();
+    profile_.record(StepPhase::Targets,
+                    elapsedMs(update_start, behaviours_start));
+
+    const PerfCounters *counters =
+        count_hardware_ ? &PerfCounters::forThisThread() : nullptr;
+    const CounterSample counters_start =
+        counters ? counters->read() : CounterSample();
+    captureDroneState();
+    matchDroneRngs();
+    const behaviour::Context context(drones_, &neighbour_grid_,
+                                     map_.obstacle_field.get(), &snapshot_,
+                                     drone_rngs_.data());
+    const auto commands_start = ProfileClock::now();
+    if (behaviour_) {
+      behaviour_->beginStep(context);
+    }
+    computeDroneCommands(context);
+    const auto apply_start = ProfileClock::now();
     for (const auto &drone : drones_) {
-      drone->update(drones_);
-      targets_found_this_step_.insert(targets_found_this_step_.end(),
-                                      drone->targets_found().begin(),
-                                      drone->targets_found().end());
+      drone->applyCommand();
       drone->clearLists();
-      // Data logging
-      b2Vec2 position = drone->position();
-      b2Vec2 velocity = drone->velocity();
-      if (num_time_steps_ >= log_interval_) {
-        drone->notifyAll(current_time_,
-                         {{"position", {position.x, position.y}},
-                          {"velocity", {velocity.x, velocity.y}}});
+    }
+    if (counters) {
+      // Workers other than this thread counted their own batches.
+      counters_.behaviours += counters->read() - counters_start;
+    }
+    const auto observers_start = ProfileClock::now();
+    profile_.record(StepPhase::Behaviours,
+                    elapsedMs(behaviours_start, observers_start));
+    if (tracer_) {
+      tracer_->record("targets", 0, update_start, behaviours_start);
+      tracer_->record("snapshot", 0, behaviours_start, commands_start);
+      tracer_->record("behaviours", 0, commands_start, apply_start,
+                      static_cast<int32_t>(drones_.size()));
+      tracer_->record("apply_commands", 0, apply_start, observers_start);
+    }
+
+    // Data logging
+    if (num_time_steps_ >= log_interval_ && telemetry_.is_open()) {
+      for (const auto &drone : drones_) {
+        const b2Vec2 position = drone->position();
+        const b2Vec2 velocity = drone->velocity();
+        telemetry_.record({current_time_, drone->id(), position.x, position.y,
+                           velocity.x, velocity.y});
       }
     }
-    int targets_found = countFoundTargets();
-    const nlohmann::json old_message = {{"targets_found", targets_found}};
-    if (num_time_steps_ >= log_interval_) {
+    const auto messages_start = ProfileClock::now();
+    const bool logged = num_time_steps_ >= log_interval_;
+    if (logged) {
+      const nlohmann::json old_message = {
+          {"targets_found", countFoundTargets()}};
       nlohmann::json message;
       message["time"] = current_time_;
       message["message"] = old_message.dump();
@@ -138,16 +579,219 @@ void Sim::update() {
       }
       num_time_steps_ = 0;
     }
+    const auto update_end = ProfileClock::now();
+    profile_.record(StepPhase::Observers,
+                    elapsedMs(observers_start, update_end));
+    profile_.record(StepPhase::Update, elapsedMs(update_start, update_end));
+    if (tracer_) {
+      if (logged) {
+        tracer_->record("telemetry", 0, observers_start, messages_start,
+                        static_cast<int32_t>(drones_.size()));
+        tracer_->record("log", 0, messages_start, update_end);
+      }
+      tracer_->record("update", 0, update_start, update_end);
+      tracer_->endStep();
+    }
   }
 }
 
-void Sim::reset() {
+void Sim::captureDroneState() {
+  snapshot_.capture(drones_);
+  // Most neighbourhood queries use the drone detection range, so size the
+  // cells to match it.
+  constexpr float min_cell_size = 1.0f;
+  float cell_size = min_cell_size;
+  if (drone_configuration_) {
+    cell_size =
+        std::max(drone_configuration_->droneDetectionRange, min_cell_size);
+  }
+  neighbour_grid_.build(snapshot_.x, snapshot_.y, cell_size);
+}
+
+void Sim::computeDroneCommands(const behaviour::Context &context) {
+  // Behaviours that keep shared per-drone state, or create bodies, have to
+  // run one drone at a time.
+  const bool parallel =
+      thread_pool_ &&
+      std::all_of(drones_.begin(), drones_.end(), [](const auto &drone) {
+        return !drone->behaviour() ||
+               drone->behaviour()->supportsParallelExecution();
+      });
+  if (!parallel) {
+    const auto start = ProfileClock::now();
+    for (const auto &drone : drones_) {
+      drone->computeCommand(drones_, context);
+    }
+    if (tracer_) {
+      tracer_->record("behaviour_batch", 0, start, ProfileClock::now(),
+                      static_cast<int32_t>(drones_.size()));
+    }
+    return;
+  }
+  if (!tracer_ && !count_hardware_) {
+    thread_pool_->parallelFor(drones_.size(), [&](const std::size_t i) {
+      drones_[i]->computeCommand(drones_, context);
+    });
+    return;
+  }
+  // Traced, each chunk of drones shows up as a batch on its worker's row.
+  // Counted, the workers count their own chunks, as only worker 0 is the
+  // thread counting the rest of the step.
+  worker_counters_.assign(thread_pool_->size(), CounterSample());
+  thread_pool_->parallelForChunks(
+      drones_.size(), [&](const std::size_t begin, const std::size_t end,
+                          const std::size_t worker) {
+        const PerfCounters *counters = count_hardware_ && worker > 0
+                                     ? &PerfCounters::forThisThread()
+                                     : nullptr;
+        const CounterSample counters_start =
+            counters ? counters->read() : CounterSample();
+        const auto start = ProfileClock::now();
+        for (std::size_t i = begin; i < end; i++) {
+          drones_[i]->computeCommand(drones_, context);
+        }
+        if (tracer_) {
+          tracer_->record("behaviour_batch", static_cast<uint32_t>(worker),
+                          start, ProfileClock::now(),
+                          static_cast<int32_t>(end - begin));
+        }
+        if (counters) {
+          worker_counters_[worker] += counters->read() - counters_start;
+        }
+      });
+  for (const CounterSample &sample : worker_counters_) {
+    counters_.behaviours += sample;
+  }
+}
+
+void Sim::setThreadCount(const int count) {
+  num_threads_ = std::max(count, 0);
+  const std::size_t threads = ThreadPool::resolveThreadCount(num_threads_);
+  if (threads <= 1) {
+    thread_pool_.reset();
+  } else if (!thread_pool_ || thread_pool_->size() != threads) {
+    thread_pool_ = std::make_unique<ThreadPool>(threads);
+  }
+}
+
+int Sim::getThreadCount() const { return num_threads_; }
+
+const DroneSnapshot &Sim::snapshot() const { return snapshot_; }
+
+void Sim::reset() { restart(); }
+
+void Sim::reset(const uint64_t seed) {
+  seedRandom(seed);
+  restart();
+}
+
+uint64_t Sim::getSeed() const { return seed_; }
+
+void Sim::seedRandom(const uint64_t seed) {
+  seed_ = seed;
+  rng_ = Rng(seed);
+  drone_rngs_.clear();
+}
+
+void Sim::matchDroneRngs() {
+  // Stream zero is `rng_`, so drone i draws from stream i + 1.
+  drone_rngs_.resize(std::min(drone_rngs_.size(), drones_.size()));
+  while (drone_rngs_.size() < drones_.size()) {
+    drone_rngs_.emplace_back(seed_, drone_rngs_.size() + 1);
+  }
+}
+
+void Sim::restart() {
+  const auto memory =
+      MemoryAccount::scope(memory_.get(), MemoryCategory::Other);
+  memory_->resetPeaks();
   current_time_ = 0.0;
+  num_time_steps_ = 0;
+  profile_.clear();
+  if (tracer_) {
+    tracer_->clear();
+  }
+  counters_.steps = 0;
+  counters_.world_step = CounterSample();
+  counters_.behaviours = CounterSample();
   b2Vec2 gravity(0.0f, 0.0f);
   world_->SetGravity(gravity);
-  drones_.clear();
-  targets_.clear();
-  createDrones(*behaviour_, *drone_configuration_, SpawnType::CIRCULAR);
+  if (behaviour_) {
+    behaviour_->clean(drones_);
+  }
+  respawnDrones();
+  // Simulations built without a test configuration only have the targets
+  // they were given.
+  if (is_stack_test_ || !target_pool_.empty()) {
+    respawnTargets();
+  }
+  targets_found_this_step_.clear();
+}
+
+void Sim::respawnDrones() {
+  const auto memory =
+      MemoryAccount::scope(memory_.get(), MemoryCategory::Drones);
+  const std::shared_ptr<const Layout> positions =
+      layout(droneSpawnSpec(*drone_configuration_));
+  // Drones that are kept are moved back into place; only the difference in
+  // count is created or destroyed.
+  const std::size_t kept = std::min(drones_.size(), positions->size());
+  drones_.resize(kept);
+  for (std::size_t i = 0; i < kept; i++) {
+    drones_[i]->respawn((*positions)[i],
+                        randomDroneVelocity(*drone_configuration_));
+    drones_[i]->behaviour() = behaviour_;
+  }
+  createDrones(positions->data() + kept, positions->size() - kept,
+               *behaviour_, *drone_configuration_);
+  for (const auto &drone : drones_) {
+    drone->color(b2Color(0.7f, 0.5f, 0.5f));
+  }
+}
+
+void Sim::respawnTargets() {
+  const auto memory =
+      MemoryAccount::scope(memory_.get(), MemoryCategory::Targets);
+  const std::shared_ptr<const Layout> positions = layout(targetSpec());
+  // Targets that are kept are moved into place; only the difference in
+  // count is created or destroyed.
+  const std::size_t kept = std::min(target_pool_.size(), positions->size());
+  if (target_pool_.size() > kept) {
+    // The store refers to the targets about to go. It is rebuilt below.
+    target_store_.clear();
+    target_pool_.truncate(kept);
+  }
+  const std::vector<Target *> &targets = target_pool_.targets();
+  // The same cached layout puts every target back where it already is.
+  if (positions != target_layout_) {
+    for (std::size_t i = 0; i < kept; i++) {
+      targets[i]->position((*positions)[i]);
+    }
+  }
+  for (Target *target : targets) {
+    target->setFound(false);
+  }
+  if (positions->size() > kept) {
+    createTargetsAt(positions);
+  } else {
+    target_layout_ = positions;
+    trackTargets();
+  }
+}
+
+void Sim::destroyTargets() {
+  target_store_.clear();
+  untrackTargets();
+  target_pool_.clear();
+  target_layout_.reset();
+  found_targets_.reset(0);
+  targets_found_this_step_.clear();
+}
+
+void Sim::untrackTargets() {
+  for (Target *target : target_pool_.targets()) {
+    target->trackFoundIn(nullptr);
+  }
 }
 
 void Sim::applyCurrentBehaviour()const {
@@ -161,77 +805,125 @@ void Sim::addBehaviour(const std::string &name,
   salsa::behaviour::Registry::get().add(name, std::move(behaviour));
 }
 
+void Sim::addBehaviour(const std::string &name,
+                       behaviour::Registry::Factory factory) {
+  salsa::behaviour::Registry::get().add(name, std::move(factory));
+}
+
 void Sim::setCurrentBehaviour(const std::string &name) {
   current_behaviour_name_ = name;
-  behaviour_ = behaviour::Registry::get().behaviour(name);
+  std::unique_ptr<Behaviour> instance = behaviour::Registry::get().create(name);
+  behaviour_ =
+      instance ? instance.get() : behaviour::Registry::get().behaviour(name);
   applyCurrentBehaviour();
+  releaseOwnedBehaviour();
+  owned_behaviour_ = std::move(instance);
 }
 
 void Sim::setCurrentBehaviour(Behaviour *behaviour) {
   behaviour_ = behaviour;
   applyCurrentBehaviour();
+  if (owned_behaviour_.get() != behaviour) {
+    releaseOwnedBehaviour();
+  }
+}
+
+bool Sim::ownsBehaviour() const {
+  return owned_behaviour_ && owned_behaviour_.get() == behaviour_;
+}
+
+void Sim::releaseOwnedBehaviour() {
+  if (owned_behaviour_) {
+    // Lets the behaviour remove anything it added to the world.
+    owned_behaviour_->clean(drones_);
+    owned_behaviour_.reset();
+  }
+}
+
+b2Vec2 Sim::randomDroneVelocity(const DroneConfiguration &configuration) {
+  const int max_speed = std::max(1, static_cast<int>(configuration.maxSpeed));
+  const float angle = rng_.below(360) * (M_PI / 180.0);
+  const float speed = 1 + static_cast<int>(rng_.below(max_speed));
+  return {speed * std::cos(angle), speed * std::sin(angle)};
 }
 
 void Sim::createDrones(Behaviour &behaviour, DroneConfiguration &configuration,
                        SpawnType mode) {
   logger::get()->info("Creating {} drones", num_drones_);
-  switch (mode) {
-    case SpawnType::CIRCULAR:
-      createDronesCircular(behaviour, configuration);
-      break;
-    case SpawnType::RANDOM:
-    default:
-      createDronesRandom(behaviour, configuration);
+  const std::shared_ptr<const Layout> positions =
+      layout(droneSpawnSpec(configuration, mode));
+  createDrones(positions->data(), positions->size(), behaviour,
+               configuration);
+  if (mode == SpawnType::CIRCULAR) {
+    for (const auto &drone : drones_) {
+      drone->color(b2Color(0.7f, 0.5f, 0.5f));
+    }
   }
   logger::get()->info("Created {} drones", drones_.size());
 }
 
-void Sim::createDronesRandom(Behaviour &behaviour, const DroneConfiguration &config) {
-  for (int i = 0; i < num_drones_; i++) { constexpr float margin = 2.0f;
-    float x = (rand() % static_cast<int>(border_width_ - 2 * margin)) + margin;
-    float y = (rand() % static_cast<int>(border_height_ - 2 * margin)) + margin;
-    drones_.push_back(
-        DroneFactory::createDrone(world_, b2Vec2(x, y), behaviour, config));
+LayoutSpec Sim::droneSpawnSpec(const DroneConfiguration &config,
+                               const SpawnType mode) const {
+  LayoutSpec spec;
+  spec.map_name = map_name_;
+  spec.count = static_cast<std::size_t>(std::max(num_drones_, 0));
+  if (mode == SpawnType::RANDOM) {
+    constexpr float margin = 2.0f;
+    spec.placement = Placement::Uniform;
+    spec.lower.Set(margin, margin);
+    spec.upper.Set(border_width_ - margin, border_height_ - margin);
+    return spec;
   }
-  for (const auto &drone : drones_) {
-    drone->addObserver(std::shared_ptr<Logger>(&logger_, [](auto *) {}));
-  }
-}
-
-void Sim::createDronesCircular(Behaviour &behaviour,
-                               const DroneConfiguration &config) {
   // Calculate the total area needed for all drones
   float droneArea = M_PI * std::pow(config.radius, 2);
   float totalDroneArea = std::pow(num_drones_, 2) * droneArea;
 
   // Calculate the radius of the circle needed to fit all drones
   float requiredCircleRadius = sqrt(totalDroneArea / M_PI);
+  // Ensure drones fit within the required circle, leaving a margin equal to
+  // the drone's radius
+  const float spawnRadius =
+      std::max(0.0f, requiredCircleRadius - config.radius);
+
+  spec.placement = Placement::Disc;
+  spec.lower = drone_spawn_position_ - b2Vec2(spawnRadius, spawnRadius);
+  spec.upper = drone_spawn_position_ + b2Vec2(spawnRadius, spawnRadius);
+  return spec;
+}
 
-  // Adjust center of the circle to be the center of the map
-  float centerX = drone_spawn_position_.x;
-  float centerY = drone_spawn_position_.y;
-
-  for (int i = 0; i < num_drones_; i++) {
-    // generate random angle and radius within the required circle
-    const float theta = static_cast<float>(rand()) / RAND_MAX * 2.0f * M_PI;
-    // Ensure drones fit within the required circle, leaving a margin equal to
-    // the drone's radius
-    const float r = sqrt(static_cast<float>(rand()) / RAND_MAX) *
-              (requiredCircleRadius - config.radius);
-
-    // Convert polar coordinates (r, theta) to Cartesian coordinates (x, y)
-    const float x = centerX + r * cos(theta);
-    const float y = centerY + r * sin(theta);
+LayoutSpec Sim::targetSpec() const {
+  LayoutSpec spec;
+  spec.placement = target_placement_;
+  spec.map_name = map_name_;
+  spec.count = static_cast<std::size_t>(std::max(num_targets_, 0.0f));
+  spec.upper.Set(border_width_, border_height_);
+  return spec;
+}
 
-    drones_.push_back(
-        DroneFactory::createDrone(world_, b2Vec2(x, y), behaviour, config));
+std::shared_ptr<const Layout> Sim::layout(LayoutSpec spec) {
+  if (layout_seed_ >= 0) {
+    spec.seed = static_cast<uint64_t>(layout_seed_);
+    return LayoutCache::shared().get(spec);
   }
-  int current_id = 0;
-  for (const auto &drone : drones_) {
-    drone->color(b2Color(0.7f, 0.5f, 0.5f));
-    drone->id(current_id++);
-    drone->addObserver(std::shared_ptr<Logger>(&logger_, [](auto *) {}));
+  spec.seed = rng_();
+  return std::make_shared<const Layout>(generateLayout(spec));
+}
+
+void Sim::createDrones(const b2Vec2 *positions, const std::size_t count,
+                       Behaviour &behaviour, const DroneConfiguration &config) {
+  const auto memory =
+      MemoryAccount::scope(memory_.get(), MemoryCategory::Drones);
+  std::vector<b2Vec2> velocities;
+  velocities.reserve(count);
+  for (std::size_t i = 0; i < count; i++) {
+    velocities.push_back(randomDroneVelocity(config));
   }
+  auto drones = DroneFactory::createDrones(world_, positions,
+                                           velocities.data(), count, behaviour,
+                                           config,
+                                           static_cast<int>(drones_.size()));
+  drones_.insert(drones_.end(), std::make_move_iterator(drones.begin()),
+                 std::make_move_iterator(drones.end()));
 }
 
 void Sim::setDroneCount(const int count) { num_drones_ = count; }
@@ -264,42 +956,150 @@ void Sim::setDrones(std::vector<std::unique_ptr<salsa::Drone>> drones) {
 
 template <typename... Params>
 void Sim::createTargets(Params... params) {
-  int id = 0;
-  logger::get()->info("Creating {} targets", num_targets_);
-  for (int i = 0; i < num_targets_; i++) {
-    float x = (rand() % static_cast<int>(border_width_));
-    float y = (rand() % static_cast<int>(border_height_));
-    const b2Vec2 position(x, y);
-    auto target = TargetFactory::createTarget(
-        target_type_, world_, std::ref(position), id++, std::any());
-    targets_.push_back(target);
-  }
-  logger::get()->info("Created {} targets", targets_.size());
-  for (auto &target : targets_) {
-    if (target) {
-      target->color(b2Color(0.5f * 0.95294f, 0.5f * 0.50588f, 0.5f * 0.50588f,
-                            0.5f * 0.25f));
-    } else {
-      std::cout << "Target is null" << std::endl;
-    }
+  createTargetsAt(layout(targetSpec()));
+}
+
+void Sim::createTargetsAt(const std::shared_ptr<const Layout> &positions) {
+  const auto memory =
+      MemoryAccount::scope(memory_.get(), MemoryCategory::Targets);
+  const std::size_t first = std::min(target_pool_.size(), positions->size());
+  logger::get()->info("Creating {} targets", positions->size() - first);
+  // Targets in the store are created without a world, so they get no body.
+  b2World *target_world = use_target_store_ ? nullptr : world_;
+  // Ids carry on from the targets already in the pool, so that every
+  // target's id is its index in the pool.
+  TargetFactory::createTargets(target_type_, target_pool_, target_world,
+                               positions->data() + first,
+                               positions->size() - first,
+                               static_cast<int>(first));
+  target_layout_ = positions;
+  logger::get()->info("Created {} targets", target_pool_.size());
+  trackTargets();
+}
+
+void Sim::trackTargets() {
+  const std::vector<Target *> &targets = target_pool_.targets();
+  found_targets_.reset(targets.size());
+  targets_found_this_step_.clear();
+  targets_found_this_step_.reserve(targets.size());
+  for (Target *target : targets) {
+    target->trackFoundIn(&found_targets_);
+    target->color(b2Color(0.5f * 0.95294f, 0.5f * 0.50588f, 0.5f * 0.50588f,
+                          0.5f * 0.25f));
+  }
+  if (use_target_store_) {
+    target_store_.build(targets, drone_configuration_->cameraViewRange);
   }
-  logger::get()->info("Targets created");
 }
 
 void Sim::setTargetType(const std::string &type_name) { target_type_ = type_name; }
 
 void Sim::setTargetCount(const int count) { num_targets_ = count; }
 
-std::vector<std::shared_ptr<Target>> &Sim::getTargets() { return targets_; }
+void Sim::setTargetPlacement(const Placement placement) {
+  target_placement_ = placement;
+}
+
+Placement Sim::getTargetPlacement() const { return target_placement_; }
+
+void Sim::setLayoutSeed(const int64_t seed) { layout_seed_ = seed; }
+
+int64_t Sim::getLayoutSeed() const { return layout_seed_; }
+
+const std::vector<Target *> &Sim::getTargets() const {
+  return target_pool_.targets();
+}
+
+TargetPool &Sim::target_pool() { return target_pool_; }
+
+void Sim::setUseTargetStore(const bool use_target_store) {
+  use_target_store_ = use_target_store;
+}
+
+bool Sim::usesTargetStore() const { return use_target_store_; }
+
+const TargetStore &Sim::target_store() const { return target_store_; }
 
 void Sim::setContactListener(BaseContactListener &listener) {
   contact_listener_ = &listener;
-  world_->SetContactListener(contact_listener_);
+  attachContactListener();
 }
 
+void Sim::attachContactListener() {
+  contact_timer_.setListener(contact_listener_);
+  world_->SetContactListener(contact_listener_ ? &contact_timer_ : nullptr);
+}
+
+const StepProfile &Sim::profile() const { return profile_; }
+
+void Sim::enableTracing(const std::size_t steps) {
+  if (!tracer_ || tracer_->capacity() != std::max<std::size_t>(steps, 1)) {
+    tracer_ = std::make_unique<StepTracer>(steps);
+  }
+  contact_timer_.setTracer(tracer_.get());
+}
+
+void Sim::disableTracing() {
+  contact_timer_.setTracer(nullptr);
+  tracer_.reset();
+}
+
+const StepTracer *Sim::tracer() const { return tracer_.get(); }
+
+void Sim::stepWorld(const float time_step, const int velocity_iterations,
+                    const int position_iterations) {
+  const auto memory = MemoryAccount::scope(memory_.get(), MemoryCategory::Step);
+  if (!count_hardware_) {
+    world_->Step(time_step, velocity_iterations, position_iterations);
+    return;
+  }
+  const PerfCounters &counters = PerfCounters::forThisThread();
+  if (counters_.steps == 0) {
+    counters_.available = counters.available();
+    counters_.error = counters.error();
+  }
+  const CounterSample start = counters.read();
+  world_->Step(time_step, velocity_iterations, position_iterations);
+  counters_.world_step += counters.read() - start;
+  counters_.steps++;
+}
+
+void Sim::setHardwareCounters(const bool enabled) {
+  count_hardware_ = enabled;
+}
+
+bool Sim::hardwareCountersEnabled() const { return count_hardware_; }
+
+const StepCounters &Sim::counters() const { return counters_; }
+
+MemoryReport Sim::memoryReport() const {
+  MemoryReport report;
+  report.drones = static_cast<int>(drones_.size());
+  report.targets = static_cast<int>(target_pool_.size());
+  for (std::size_t i = 0; i < kMemoryCategoryCount; i++) {
+    report.box2d[i] = memory_->usage(static_cast<MemoryCategory>(i));
+  }
+  report.box2d_total = memory_->total();
+  report.drone_bytes =
+      drones_.capacity() * sizeof(std::unique_ptr<Drone>) +
+      drones_.size() * sizeof(Drone) + drone_rngs_.capacity() * sizeof(Rng) +
+      snapshot_.bytes() + neighbour_grid_.bytes();
+  report.target_bytes = target_pool_.bytes() + target_store_.bytes();
+  report.map_bytes = map_.obstacle_field ? map_.obstacle_field->bytes() : 0;
+  report.arena_bytes = memory_->reservedBytes();
+  return report;
+}
+
+WorldAllocationScope Sim::memoryScope(const MemoryCategory category) const {
+  return MemoryAccount::scope(memory_.get(), category);
+}
+
+bool Sim::ownsWorld() const { return owned_world_ != nullptr; }
+
 b2Vec2 &Sim::getDroneSpawnPosition() { return drone_spawn_position_; }
 
 void Sim::createBounds() {
+  const auto memory = MemoryAccount::scope(memory_.get(), MemoryCategory::Map);
   // Define the ground body.
   b2BodyDef groundBodyDef;
   groundBodyDef.position.Set(0.0f, 0.0f);
@@ -366,9 +1166,10 @@ std::vector<Target *> &Sim::getTargetsFoundThisStep() {
   return targets_found_this_step_;
 }
 
-int Sim::countFoundTargets() {
-  return std::count_if(targets_.begin(), targets_.end(),
-                       [](auto &target) { return target->isFound(); });
+int Sim::countFoundTargets() { return found_targets_.count(); }
+
+const std::vector<int> &Sim::getTargetIdsFoundThisStep() const {
+  return found_targets_.found_this_step();
 }
 
 void Sim::setCurrentDroneConfiguration(DroneConfiguration &configuration) {
@@ -378,14 +1179,13 @@ void Sim::setCurrentDroneConfiguration(DroneConfiguration &configuration) {
 
 void Sim::changeMap(std::string name) {
   logger::get()->info("Changing map to {}", name);
-  const map::Map map = map::load(name.c_str());
-  map_ = map;
-  world_ = map.world;
-  border_width_ = map.width;
-  border_height_ = map.height;
-  drone_spawn_position_ = map.drone_spawn_point;
+  loadMap(name);
   reset();
 }
 
 std::string &Sim::getCurrentLogFile() { return current_log_file_; }
+
+std::string &Sim::getCurrentTrajectoryFile() {
+  return current_trajectory_file_;
+}
 }  // namespace salsa
\ No newline at end of file
@@ -0,0 +1,336 @@
+#include "salsa/core/test_executor.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <exception>
+#include <memory>
+#include <utility>
+
+#include "salsa/behaviours/registry.h"
+#include "salsa/core/checkpoint.h"
+#include "salsa/core/logger.h"
+#include "salsa/core/map.h"
+#include "salsa/utils/thread_pool.h"
+
+namespace salsa {
+
+TestExecutor::TestExecutor(const int max_concurrent)
+    : max_concurrent_(std::max(max_concurrent, 0)) {}
+
+TestExecutor &TestExecutor::setMaxConcurrent(const int max_concurrent) {
+  max_concurrent_ = std::max(max_concurrent, 0);
+  return *this;
+}
+
+TestExecutor &TestExecutor::setProgressInterval(const double interval_ms) {
+  progress_interval_ms_ = interval_ms;
+  return *this;
+}
+
+TestExecutor &TestExecutor::onProgress(ProgressCallback callback) {
+  progress_callback_ = std::move(callback);
+  return *this;
+}
+
+TestExecutor &TestExecutor::onSetup(SetupCallback callback) {
+  setup_callback_ = std::move(callback);
+  return *this;
+}
+
+TestExecutor &TestExecutor::setCheckpointInterval(const float interval) {
+  checkpoint_interval_ = std::max(interval, 0.0f);
+  return *this;
+}
+
+TestExecutor &TestExecutor::setCheckpointDirectory(
+    std::filesystem::path directory) {
+  checkpoint_directory_ = std::move(directory);
+  return *this;
+}
+
+TestExecutor &TestExecutor::setMemoryBudget(const std::size_t bytes) {
+  memory_budget_ = bytes;
+  return *this;
+}
+
+std::size_t TestExecutor::estimateMemory(const TestConfig &config) {
+  std::lock_guard<std::mutex> lock(memory_mutex_);
+  const auto it = memory_by_map_.find(config.map_name);
+  if (it == memory_by_map_.end()) {
+    return 0;
+  }
+  return it->second.estimate(config.num_drones, config.num_targets);
+}
+
+std::size_t TestExecutor::reserveMemory(const TestConfig &config) {
+  if (memory_budget_ == 0) {
+    return 0;
+  }
+  std::size_t estimate = estimateMemory(config);
+  if (estimate == 0) {
+    estimate = memory_budget_;
+  }
+  std::unique_lock<std::mutex> lock(memory_mutex_);
+  memory_condition_.wait(lock, [&] {
+    return memory_holders_ == 0 ||
+           memory_reserved_ + estimate <= memory_budget_;
+  });
+  memory_reserved_ += estimate;
+  memory_holders_++;
+  return estimate;
+}
+
+void TestExecutor::releaseMemory(const std::size_t reserved,
+                                 const Result &result) {
+  if (memory_budget_ == 0) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(memory_mutex_);
+    memory_reserved_ -= reserved;
+    memory_holders_--;
+    if (result.ok()) {
+      memory_by_map_[result.config.map_name] = result.memory;
+    }
+  }
+  memory_condition_.notify_all();
+}
+
+std::filesystem::path TestExecutor::checkpointPath(
+    const std::size_t index, const TestConfig &config) const {
+  TestConfig settings = config;
+  settings.num_threads = 0;
+  const std::string text = json(settings).dump();
+  char key[17];
+  std::snprintf(key, sizeof(key), "%016llx",
+                static_cast<unsigned long long>(
+                    checkpointChecksum(text.data(), text.size())));
+  const std::filesystem::path directory =
+      checkpoint_directory_.empty() ? map::getExecutablePath() / ".." /
+                                          ".." / "testbed" / "checkpoints"
+                                    : checkpoint_directory_;
+  return directory /
+         ("test_" + std::to_string(index) + "_" + key + ".ckpt");
+}
+
+std::vector<TestExecutor::Result> TestExecutor::run(
+    const std::vector<TestConfig> &tests) {
+  std::vector<Result> results(tests.size());
+  if (tests.empty()) {
+    return results;
+  }
+  const std::size_t workers = std::min(
+      ThreadPool::resolveThreadCount(max_concurrent_), tests.size());
+  logger::get()->info("Running {} tests, {} at a time", tests.size(), workers);
+
+  ThreadPool pool(workers);
+  pool.parallelFor(tests.size(), [&](const std::size_t i) {
+    results[i] = runTest(i, tests.size(), tests[i]);
+  });
+  std::lock_guard<std::mutex> lock(idle_mutex_);
+  idle_sims_.clear();
+  return results;
+}
+
+std::vector<TestExecutor::Result> TestExecutor::runQueue() {
+  std::vector<TestConfig> tests;
+  while (!TestQueue::isEmpty()) {
+    tests.push_back(TestQueue::pop());
+  }
+  return run(tests);
+}
+
+TestExecutor::Result TestExecutor::runTest(const std::size_t index,
+                                           const std::size_t total,
+                                           const TestConfig &config) {
+  Result result;
+  result.index = index;
+  result.config = config;
+
+  std::unique_lock<std::mutex> shared_lock(shared_behaviour_mutex_,
+                                           std::defer_lock);
+  std::size_t reserved = 0;
+  try {
+    // A behaviour the registry cannot make new instances of is shared by
+    // every Sim that uses it.
+    auto &registry = behaviour::Registry::get();
+    if (registry.behaviour(config.behaviour_name) &&
+        !registry.createsInstances(config.behaviour_name)) {
+      shared_lock.lock();
+    }
+
+    reserved = reserveMemory(config);
+    std::unique_ptr<Sim> sim = acquireSim(result.config);
+    std::filesystem::path checkpoint;
+    if (checkpoint_interval_ > 0.0f) {
+      checkpoint = checkpointPath(index, config);
+    }
+    runSim(*sim, total, checkpoint, result);
+    releaseSim(std::move(sim));
+  } catch (const std::exception &e) {
+    logger::get()->error("Test {} ({}) failed: {}", index,
+                         config.behaviour_name, e.what());
+    result.error = e.what();
+  }
+  releaseMemory(reserved, result);
+
+  reportProgress({index, total, config, result.run.sim_time, true});
+  return result;
+}
+
+std::vector<TestExecutor::Result> TestExecutor::runSims(
+    const std::vector<std::unique_ptr<Sim>> &sims) {
+  std::vector<Result> results(sims.size());
+  if (sims.empty()) {
+    return results;
+  }
+  const std::size_t workers = std::min(
+      ThreadPool::resolveThreadCount(max_concurrent_), sims.size());
+  logger::get()->info("Running {} simulations, {} at a time", sims.size(),
+                      workers);
+
+  ThreadPool pool(workers);
+  pool.parallelFor(sims.size(), [&](const std::size_t i) {
+    Sim &sim = *sims[i];
+    Result &result = results[i];
+    result.index = i;
+    result.config = sim.test_config();
+    std::unique_lock<std::mutex> shared_lock(shared_behaviour_mutex_,
+                                             std::defer_lock);
+    if (!sim.ownsBehaviour()) {
+      shared_lock.lock();
+    }
+    try {
+      runSim(sim, sims.size(), {}, result);
+    } catch (const std::exception &e) {
+      logger::get()->error("Simulation {} ({}) failed: {}", i,
+                           result.config.behaviour_name, e.what());
+      result.error = e.what();
+    }
+    reportProgress(
+        {i, sims.size(), result.config, result.run.sim_time, true});
+  });
+  return results;
+}
+
+void TestExecutor::runSim(Sim &sim, const std::size_t total,
+                          const std::filesystem::path &checkpoint,
+                          Result &result) {
+  const std::size_t index = result.index;
+  const TestConfig &config = result.config;
+  Runner runner(sim);
+  runner.setTimeLimit(config.time_limit);
+  if (!checkpoint.empty()) {
+    result.resumed_at = resume(sim, checkpoint);
+    addCheckpoints(runner, checkpoint);
+  }
+
+  reportProgress({index, total, config, sim.current_time(), false});
+  if (progress_callback_) {
+    auto last_report = std::chrono::steady_clock::now();
+    runner.onStep([&](Sim &stepped) {
+      const auto now = std::chrono::steady_clock::now();
+      const std::chrono::duration<double, std::milli> elapsed =
+          now - last_report;
+      if (elapsed.count() >= progress_interval_ms_) {
+        last_report = now;
+        reportProgress({index, total, config, stepped.current_time(), false});
+      }
+    });
+  }
+  if (setup_callback_) {
+    setup_callback_(sim, runner);
+  }
+
+  result.run = runner.run();
+  if (!checkpoint.empty()) {
+    std::error_code error;
+    std::filesystem::remove(checkpoint, error);
+  }
+  result.targets_found = sim.countFoundTargets();
+  result.log_file = sim.getCurrentLogFile();
+  result.profile = sim.profile();
+  result.counters = sim.counters();
+  result.memory = sim.memoryReport();
+  // The log is complete by the time the result is handed back, even though
+  // the Sim lives on for another test.
+  sim.finishLog();
+}
+
+std::unique_ptr<Sim> TestExecutor::acquireSim(TestConfig &config) {
+  std::unique_ptr<Sim> sim;
+  {
+    std::lock_guard<std::mutex> lock(idle_mutex_);
+    if (!idle_sims_.empty()) {
+      auto it = std::find_if(
+          idle_sims_.begin(), idle_sims_.end(), [&](const auto &idle) {
+            return idle->test_config().map_name == config.map_name;
+          });
+      if (it == idle_sims_.end()) {
+        it = idle_sims_.begin();
+      }
+      sim = std::move(*it);
+      idle_sims_.erase(it);
+    }
+  }
+  if (!sim) {
+    return std::make_unique<Sim>(config);
+  }
+  sim->reconfigure(config);
+  return sim;
+}
+
+void TestExecutor::releaseSim(std::unique_ptr<Sim> sim) {
+  std::lock_guard<std::mutex> lock(idle_mutex_);
+  idle_sims_.push_back(std::move(sim));
+}
+
+float TestExecutor::resume(Sim &sim,
+                           const std::filesystem::path &checkpoint) const {
+  std::error_code error;
+  if (!std::filesystem::exists(checkpoint, error)) {
+    return 0.0f;
+  }
+  try {
+    sim.loadCheckpoint(checkpoint.string());
+  } catch (const std::exception &e) {
+    logger::get()->warn("Starting again instead of resuming: {}", e.what());
+    // A checkpoint that cannot be restored leaves the simulation as it was,
+    // or restarted, but start from a clean slate either way.
+    sim.reset();
+    return 0.0f;
+  }
+  return sim.current_time();
+}
+
+void TestExecutor::addCheckpoints(
+    Runner &runner, const std::filesystem::path &checkpoint) const {
+  const float interval = checkpoint_interval_;
+  auto next_checkpoint = [interval](const float time) {
+    return (std::floor(time / interval) + 1.0f) * interval;
+  };
+  runner.onStep([checkpoint, next_checkpoint,
+                 next = next_checkpoint(runner.sim().current_time())](
+                    Sim &stepped) mutable {
+    if (stepped.current_time() < next) {
+      return;
+    }
+    next = next_checkpoint(stepped.current_time());
+    try {
+      stepped.saveCheckpoint(checkpoint.string());
+    } catch (const std::exception &e) {
+      logger::get()->warn("Could not save checkpoint: {}", e.what());
+    }
+  });
+}
+
+void TestExecutor::reportProgress(const Progress &progress) {
+  if (!progress_callback_) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(progress_mutex_);
+  progress_callback_(progress);
+}
+
+}  // namespace salsa
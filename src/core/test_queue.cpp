@@ -21,7 +21,14 @@ void to_json(json& j, const TestConfig& config) {
             {"time_limit", config.time_limit},
             {"target_type", config.target_type},
             {"contact_listener_name", config.contact_listener_name},
-            {"keep", config.keep}});
+            {"keep", config.keep},
+            {"num_threads", config.num_threads},
+            {"use_target_store", config.use_target_store},
+            {"target_placement", config.target_placement},
+            {"layout_seed", config.layout_seed},
+            {"seed", config.seed},
+            {"trace_steps", config.trace_steps},
+            {"hardware_counters", config.hardware_counters}});
 }
 
 void from_json(const json& j, TestConfig& config) {
@@ -39,6 +46,27 @@ void from_json(const json& j, TestConfig& config) {
   j.at("target_type").get_to(config.target_type);
   j.at("contact_listener_name").get_to(config.contact_listener_name);
   j.at("keep").get_to(config.keep);
+  if (j.contains("num_threads")) {
+    j.at("num_threads").get_to(config.num_threads);
+  }
+  if (j.contains("use_target_store")) {
+    j.at("use_target_store").get_to(config.use_target_store);
+  }
+  if (j.contains("target_placement")) {
+    j.at("target_placement").get_to(config.target_placement);
+  }
+  if (j.contains("layout_seed")) {
+    j.at("layout_seed").get_to(config.layout_seed);
+  }
+  if (j.contains("seed")) {
+    j.at("seed").get_to(config.seed);
+  }
+  if (j.contains("trace_steps")) {
+    j.at("trace_steps").get_to(config.trace_steps);
+  }
+  if (j.contains("hardware_counters")) {
+    j.at("hardware_counters").get_to(config.hardware_counters);
+  }
 }
 
 void TestQueue::push(const TestConfig& test) { tests_.push_back(test); }
@@ -0,0 +1,144 @@
+#include "salsa/core/trace.h"
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+
+namespace salsa {
+
+StepTracer::StepTracer(const std::size_t steps,
+                       const std::size_t max_events_per_step)
+    : max_events_per_step_(max_events_per_step),
+      steps_(std::max<std::size_t>(steps, 1)) {}
+
+void StepTracer::record(const char *name, const uint32_t thread,
+                        const ProfileClock::time_point start,
+                        const ProfileClock::time_point end,
+                        const int32_t count) {
+  using std::chrono::duration_cast;
+  using std::chrono::nanoseconds;
+  TraceEvent event;
+  event.name = name;
+  event.start_ns = duration_cast<nanoseconds>(start - origin_).count();
+  event.duration_ns = duration_cast<nanoseconds>(end - start).count();
+  event.thread = thread;
+  event.count = count;
+
+  std::lock_guard lock(mutex_);
+  Step &step = steps_[step_ % steps_.size()];
+  if (step.events.size() >= max_events_per_step_) {
+    step.dropped++;
+    return;
+  }
+  event.step = step_;
+  step.events.push_back(event);
+}
+
+void StepTracer::recordWorld(const b2Profile &profile,
+                             const ProfileClock::time_point end) {
+  const auto ms = [](const float value) {
+    return std::chrono::duration_cast<ProfileClock::duration>(
+        std::chrono::duration<float, std::milli>(value));
+  };
+  const ProfileClock::time_point start = end - ms(profile.step);
+  const ProfileClock::time_point solve_start = start + ms(profile.collide);
+  const ProfileClock::time_point solve_end = solve_start + ms(profile.solve);
+  record("world_step", 0, start, end);
+  record("collide", 0, start, solve_start);
+  record("solve", 0, solve_start, solve_end);
+  record("broadphase", 0, solve_end - ms(profile.broadphase), solve_end);
+  record("solve_toi", 0, solve_end, solve_end + ms(profile.solveTOI));
+}
+
+void StepTracer::endStep() {
+  std::lock_guard lock(mutex_);
+  step_++;
+  // Clearing keeps the capacity, so a full ring records without allocating.
+  Step &next = steps_[step_ % steps_.size()];
+  next.events.clear();
+  next.dropped = 0;
+}
+
+void StepTracer::clear() {
+  std::lock_guard lock(mutex_);
+  for (Step &step : steps_) {
+    step.events.clear();
+    step.dropped = 0;
+  }
+  step_ = 0;
+}
+
+std::vector<TraceEvent> StepTracer::events() const {
+  std::lock_guard lock(mutex_);
+  std::vector<TraceEvent> events;
+  // The step being recorded is the newest, so the oldest kept is the one
+  // after it in the ring.
+  const uint64_t kept = std::min<uint64_t>(step_ + 1, steps_.size());
+  for (uint64_t step = step_ + 1 - kept; step <= step_; step++) {
+    const Step &slot = steps_[step % steps_.size()];
+    events.insert(events.end(), slot.events.begin(), slot.events.end());
+  }
+  return events;
+}
+
+uint64_t StepTracer::steps() const {
+  std::lock_guard lock(mutex_);
+  return step_;
+}
+
+std::size_t StepTracer::dropped() const {
+  std::lock_guard lock(mutex_);
+  std::size_t dropped = 0;
+  for (const Step &step : steps_) {
+    dropped += step.dropped;
+  }
+  return dropped;
+}
+
+nlohmann::json StepTracer::toJson() const {
+  const std::vector<TraceEvent> spans = events();
+  nlohmann::json trace_events = nlohmann::json::array();
+  uint32_t threads = 1;
+  for (const TraceEvent &event : spans) {
+    nlohmann::json args = {{"step", event.step}};
+    if (event.count >= 0) {
+      args["count"] = event.count;
+    }
+    // Trace viewers take times in microseconds.
+    const double start_us = static_cast<double>(event.start_ns) / 1e3;
+    const double duration_us = static_cast<double>(event.duration_ns) / 1e3;
+    trace_events.push_back({{"name", event.name},
+                            {"cat", "salsa"},
+                            {"ph", "X"},
+                            {"ts", start_us},
+                            {"dur", duration_us},
+                            {"pid", 0},
+                            {"tid", event.thread},
+                            {"args", args}});
+    threads = std::max(threads, event.thread + 1);
+  }
+  // Name the rows of the viewer after the threads.
+  for (uint32_t thread = 0; thread < threads; thread++) {
+    const std::string name =
+        thread == 0 ? "step" : "worker " + std::to_string(thread);
+    trace_events.push_back({{"name", "thread_name"},
+                            {"ph", "M"},
+                            {"pid", 0},
+                            {"tid", thread},
+                            {"args", {{"name", name}}}});
+  }
+  return {{"traceEvents", trace_events},
+          {"displayTimeUnit", "ms"},
+          {"otherData", {{"steps", steps()}, {"dropped", dropped()}}}};
+}
+
+bool StepTracer::write(const std::filesystem::path &path) const {
+  std::ofstream file(path);
+  if (!file.is_open()) {
+    return false;
+  }
+  file << toJson().dump();
+  return file.good();
+}
+
+}  // namespace salsa
@@ -1,17 +1,40 @@
 // Drone.cpp
 #include "salsa/entity/drone.h"
 
+#include <algorithm>
 #include <cmath>
+#include <random>
 #include <valarray>
 
 #include "salsa/utils/object_types.h"
+#include "salsa/utils/rng.h"
 
 #define SCREEN_WIDTH 800
 #define SCREEN_HEIGHT 600
 
 namespace salsa {
+namespace {
+// Random starting velocity for drones created without one. A `Sim` always
+// gives its drones a velocity drawn from its seed, so this is only used by
+// drones made on their own.
+b2Vec2 randomInitialVelocity(const float max_speed) {
+  thread_local Rng engine(Rng::randomSeed());
+  std::uniform_int_distribution<int> degrees(0, 359);
+  std::uniform_int_distribution<int> speeds(
+      1, std::max(1, static_cast<int>(max_speed)));
+  const float angle = degrees(engine) * (M_PI / 180.0);
+  const float speed = speeds(engine);
+  return {speed * std::cos(angle), speed * std::sin(angle)};
+}
+}  // namespace
+
 Drone::Drone(b2World *world, const b2Vec2 &position, Behaviour &behaviour,
              const DroneConfiguration &config)
+    : Drone(world, position, behaviour, config,
+            randomInitialVelocity(config.maxSpeed)) {}
+
+Drone::Drone(b2World *world, const b2Vec2 &position, Behaviour &behaviour,
+             const DroneConfiguration &config, const b2Vec2 &initial_velocity)
     : Entity(world, position, false, config.radius, salsa::get_type<Drone>()),
       behaviour_(&behaviour),
       camera_view_range_(config.cameraViewRange),
@@ -31,23 +54,17 @@ Drone::Drone(b2World *world, const b2Vec2 &position, Behaviour &behaviour,
   float density_box2d = mass_ / area_m2;
 
   fixtureDef.density = density_box2d;
-  auto *userData = new UserData();
-  userData->object = this;
   CollisionConfig c = CollisionManager::getCollisionConfig<Drone>();
   fixtureDef.filter.categoryBits = 0x0002;
   fixtureDef.filter.maskBits = 0x0001 | 0x0002;
-  fixtureDef.userData.pointer = reinterpret_cast<uintptr_t>(userData);
+  fixtureDef.userData.pointer = reinterpret_cast<uintptr_t>(&user_data_);
   // fixtureDef.filter.groupIndex = -1;
   body_->CreateFixture(&fixtureDef);
 
   // Create tree detecting sensor (downwards camera)
   create_fixture();
 
-  // Initialize random starting velocity
-  float angle = (rand() % 360) * (M_PI / 180.0);
-  float speed = (rand() % static_cast<int>(max_speed_)) + 1;
-  b2Vec2 velocity(speed * cos(angle), speed * sin(angle));
-  body_->SetLinearVelocity(velocity);
+  body_->SetLinearVelocity(initial_velocity);
 
   // CollisionManager::registerType(typeid(Drone), {typeid(Tree)});
 
@@ -67,10 +84,7 @@ void Drone::create_fixture() {
   auto [categoryBits, maskBits] = CollisionManager::getCollisionConfig<Drone>();
   fixtureDef.filter.categoryBits = categoryBits;
   fixtureDef.filter.maskBits = maskBits;
-  auto *userData = new UserData();
-  userData->object = this;
-
-  fixtureDef.userData.pointer = reinterpret_cast<uintptr_t>(userData);
+  fixtureDef.userData.pointer = reinterpret_cast<uintptr_t>(&user_data_);
 
   view_sensor_ = body_->CreateFixture(&fixtureDef);
 }
@@ -82,9 +96,42 @@ void Drone::updateSensorRange() {
 
 void Drone::clearLists() { targets_found_.clear(); }
 
+void Drone::respawn(const b2Vec2 &position, const b2Vec2 &velocity) {
+  restore(position, 0.0f, velocity, 0.0f);
+}
+
+void Drone::restore(const b2Vec2 &position, const float angle,
+                    const b2Vec2 &velocity, const float angular_velocity) {
+  body_->SetTransform(position, angle);
+  body_->SetLinearVelocity(velocity);
+  body_->SetAngularVelocity(angular_velocity);
+  body_->SetAwake(true);
+  targets_found_.clear();
+  velocity_command_.SetZero();
+  has_velocity_command_ = false;
+}
+
 void Drone::update(const std::vector<std::unique_ptr<Drone>> &drones) {
+  update(drones, behaviour::Context(drones));
+}
+
+void Drone::update(const std::vector<std::unique_ptr<Drone>> &drones,
+                   const behaviour::Context &context) {
+  computeCommand(drones, context);
+  applyCommand();
+}
+
+void Drone::computeCommand(const std::vector<std::unique_ptr<Drone>> &drones,
+                           const behaviour::Context &context) {
   if (behaviour_) {
-    behaviour_->execute(drones, *this);
+    behaviour_->execute(drones, *this, context);
+  }
+}
+
+void Drone::applyCommand() {
+  if (has_velocity_command_) {
+    body_->SetLinearVelocity(velocity_command_);
+    has_velocity_command_ = false;
   }
   const b2Vec2 position = body_->GetPosition();
 
@@ -0,0 +1,47 @@
+#include "salsa/entity/drone_snapshot.h"
+
+#include "salsa/entity/drone.h"
+
+namespace salsa {
+
+void DroneSnapshot::capture(const std::vector<std::unique_ptr<Drone>> &drones) {
+  const std::size_t count = drones.size();
+  x.resize(count);
+  y.resize(count);
+  vx.resize(count);
+  vy.resize(count);
+  id.resize(count);
+  max_speed.resize(count);
+  max_force.resize(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    const Drone &drone = *drones[i];
+    const b2Vec2 position = drone.position();
+    const b2Vec2 velocity = drone.velocity();
+    x[i] = position.x;
+    y[i] = position.y;
+    vx[i] = velocity.x;
+    vy[i] = velocity.y;
+    id[i] = drone.id();
+    max_speed[i] = drone.max_speed();
+    max_force[i] = drone.max_force();
+  }
+}
+
+void DroneSnapshot::clear() {
+  x.clear();
+  y.clear();
+  vx.clear();
+  vy.clear();
+  id.clear();
+  max_speed.clear();
+  max_force.clear();
+}
+
+std::size_t DroneSnapshot::bytes() const {
+  return (x.capacity() + y.capacity() + vx.capacity() + vy.capacity() +
+          max_speed.capacity() + max_force.capacity()) *
+             sizeof(float) +
+         id.capacity() * sizeof(int);
+}
+
+}  // namespace salsa
@@ -9,6 +9,11 @@ salsa::Entity::Entity(b2World *world, const b2Vec2 &position, const bool is_stat
       color_(b2Color(0.5, 0.5, 0.5)),
       type_name_(std::move(type_name)),
       log_interval_(log_interval) {
+  last_log_time = std::chrono::steady_clock::now();
+  if (!world_) {
+    position_ = position;
+    return;
+  }
   b2BodyDef bodyDef;
   if (is_static) {
     bodyDef.type = b2_staticBody;
@@ -17,7 +22,6 @@ salsa::Entity::Entity(b2World *world, const b2Vec2 &position, const bool is_stat
   }
   bodyDef.position = position;
   body_ = world_->CreateBody(&bodyDef);
-  last_log_time = std::chrono::steady_clock::now();
 }
 
 template <>
@@ -0,0 +1,41 @@
+#include "salsa/entity/found_targets.h"
+
+#include <algorithm>
+
+namespace salsa {
+
+void FoundTargets::reset(const std::size_t target_count) {
+  size_ = target_count;
+  words_.assign((target_count + 63) / 64, 0);
+  listed_words_.assign(words_.size(), 0);
+  count_.store(0, std::memory_order_relaxed);
+  // A target is listed at most once a step, so a step can find at most every
+  // target once.
+  found_since_step_.clear();
+  found_since_step_.reserve(target_count);
+  found_this_step_.clear();
+  found_this_step_.reserve(target_count);
+}
+
+void FoundTargets::beginStep() {
+  for (const int id : found_since_step_) {
+    listed_words_[id >> 6] &= ~(uint64_t{1} << (id & 63));
+  }
+  // A target found and then lost again during the step was not found in it.
+  found_since_step_.erase(
+      std::remove_if(found_since_step_.begin(), found_since_step_.end(),
+                     [this](const int id) { return !isFound(id); }),
+      found_since_step_.end());
+  found_this_step_.swap(found_since_step_);
+  found_since_step_.clear();
+}
+
+void FoundTargets::clearSteps() {
+  for (const int id : found_since_step_) {
+    listed_words_[id >> 6] &= ~(uint64_t{1} << (id & 63));
+  }
+  found_since_step_.clear();
+  found_this_step_.clear();
+}
+
+}  // namespace salsa
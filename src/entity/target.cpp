@@ -1,8 +1,20 @@
 #include "salsa/entity/target.h"
 
 #include "salsa/entity/drone.h"
+#include "salsa/entity/found_targets.h"
 
 namespace salsa {
 Target::Target(b2World *world, const b2Vec2 &position, const float radius)
     : Entity(world, position, true, radius, salsa::get_type<Target>()) {}
+
+void Target::setFound(const bool found) {
+  if (found_targets_ && found != found_) {
+    if (found) {
+      found_targets_->markFound(id_);
+    } else {
+      found_targets_->markNotFound(id_);
+    }
+  }
+  found_ = found;
+}
 }  // namespace salsa
\ No newline at end of file
@@ -2,6 +2,8 @@
 
 namespace salsa {
 std::map<std::string, TargetFactory::TargetCreateFunc> TargetFactory::registry;
+std::map<std::string, TargetFactory::TargetBulkCreateFunc>
+    TargetFactory::bulk_registry;
 
 std::vector<std::string> TargetFactory::getTargetNames() {
   std::vector<std::string> names;
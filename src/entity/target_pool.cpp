@@ -0,0 +1,47 @@
+#include "salsa/entity/target_pool.h"
+
+namespace salsa {
+
+void TargetPool::clear() {
+  targets_.clear();
+  // Later blocks may hold targets created with references to earlier ones,
+  // so blocks are destroyed newest first.
+  for (auto it = blocks_.rbegin(); it != blocks_.rend(); ++it) {
+    release(*it);
+  }
+  blocks_.clear();
+}
+
+void TargetPool::truncate(const std::size_t count) {
+  while (targets_.size() > count) {
+    Block &block = blocks_.back();
+    const std::size_t excess = targets_.size() - count;
+    if (excess >= block.count) {
+      targets_.resize(targets_.size() - block.count);
+      release(block);
+      blocks_.pop_back();
+    } else {
+      block.destroy(block.data, block.count - excess, block.count);
+      block.count -= excess;
+      targets_.resize(count);
+    }
+  }
+}
+
+std::size_t TargetPool::bytes() const {
+  std::size_t bytes = blocks_.capacity() * sizeof(Block) +
+                      targets_.capacity() * sizeof(Target *);
+  for (const Block &block : blocks_) {
+    bytes += block.bytes;
+  }
+  return bytes;
+}
+
+void TargetPool::release(Block &block) {
+  block.destroy(block.data, 0, block.count);
+  ::operator delete(block.data, std::align_val_t(block.alignment));
+  block.data = nullptr;
+  block.count = 0;
+}
+
+}  // namespace salsa
@@ -0,0 +1,136 @@
+#include "salsa/entity/target_store.h"
+
+#include <algorithm>
+#include <typeindex>
+#include <unordered_map>
+
+#include "salsa/utils/object_types.h"
+
+namespace salsa {
+
+void TargetStore::build(const std::vector<Target *> &targets,
+                        const float cell_size) {
+  clear();
+  targets_.reserve(targets.size());
+  positions_.reserve(targets.size());
+  radii_.reserve(targets.size());
+  target_types_.reserve(targets.size());
+
+  std::unordered_map<std::type_index, int> type_indices;
+  for (Target *target : targets) {
+    if (!target) {
+      continue;
+    }
+    targets_.push_back(target);
+    positions_.push_back(target->position());
+    radii_.push_back(target->radius());
+    max_radius_ = std::max(max_radius_, target->radius());
+
+    const std::type_index type_key(typeid(*target));
+    auto it = type_indices.find(type_key);
+    if (it == type_indices.end()) {
+      it = type_indices
+               .emplace(type_key, static_cast<int>(type_names_.size()))
+               .first;
+      type_names_.push_back(type(*target));
+    }
+    target_types_.push_back(it->second);
+  }
+  grid_.build(positions_, cell_size);
+}
+
+void TargetStore::detect(const std::vector<std::unique_ptr<Drone>> &drones,
+                         const BaseContactListener *listener) {
+  scan(drones, listener, true);
+}
+
+void TargetStore::observe(const std::vector<std::unique_ptr<Drone>> &drones) {
+  scan(drones, nullptr, false);
+}
+
+void TargetStore::scan(const std::vector<std::unique_ptr<Drone>> &drones,
+                       const BaseContactListener *listener,
+                       const bool report) {
+  if (targets_.empty()) {
+    return;
+  }
+  if (in_view_.size() != drones.size()) {
+    in_view_.resize(drones.size());
+  }
+  for (std::size_t d = 0; d < drones.size(); ++d) {
+    Drone &drone = *drones[d];
+    const b2Vec2 position = drone.position();
+    const float view_range = drone.camera_view_range();
+
+    // The grid only knows target centres, so query out to the largest
+    // target and then check each one against its own radius, as the sensor
+    // overlap would.
+    grid_.queryRadius(position, view_range + max_radius_, query_);
+    query_.erase(std::remove_if(query_.begin(), query_.end(),
+                                [&](const int target) {
+                                  const float reach =
+                                      view_range + radii_[target];
+                                  return b2DistanceSquared(positions_[target],
+                                                           position) >
+                                         reach * reach;
+                                }),
+                 query_.end());
+
+    // Both lists are in ascending order, so the targets that have just come
+    // into view are found in one pass.
+    if (report) {
+      const std::vector<int> &previous = in_view_[d];
+      auto seen = previous.begin();
+      for (const int target : query_) {
+        while (seen != previous.end() && *seen < target) {
+          ++seen;
+        }
+        if (seen == previous.end() || *seen != target) {
+          onDetected(drone, target, listener);
+        }
+      }
+    }
+    in_view_[d].swap(query_);
+  }
+}
+
+void TargetStore::clear() {
+  targets_.clear();
+  positions_.clear();
+  radii_.clear();
+  max_radius_ = 0.0f;
+  type_names_.clear();
+  target_types_.clear();
+  in_view_.clear();
+  grid_.clear();
+}
+
+std::size_t TargetStore::bytes() const {
+  std::size_t bytes = targets_.capacity() * sizeof(Target *) +
+                      positions_.capacity() * sizeof(b2Vec2) +
+                      radii_.capacity() * sizeof(float) +
+                      target_types_.capacity() * sizeof(int) +
+                      in_view_.capacity() * sizeof(std::vector<int>) +
+                      query_.capacity() * sizeof(int) + grid_.bytes();
+  for (const std::vector<int> &in_view : in_view_) {
+    bytes += in_view.capacity() * sizeof(int);
+  }
+  return bytes;
+}
+
+void TargetStore::onDetected(Drone &drone, const int target,
+                             const BaseContactListener *listener) {
+  Target &found = *targets_[target];
+  if (listener) {
+    const auto *handler =
+        listener->detectionHandler(type_names_[target_types_[target]]);
+    if (handler) {
+      (*handler)(drone, found);
+      return;
+    }
+  }
+  found.setFound(true);
+  drone.addTargetFound(&found);
+}
+
+}  // namespace salsa
@@ -41,6 +41,19 @@ void BaseContactListener::addCollisionHandler(
   }
 }
 
+void BaseContactListener::addDetectionHandler(
+    std::string target_type, const DetectionHandler &handler) {
+  logger::get()->info("Adding detection handler for target type: {}",
+                      target_type);
+  detection_handlers_[std::move(target_type)] = handler;
+}
+
+const BaseContactListener::DetectionHandler *
+BaseContactListener::detectionHandler(const std::string &target_type) const {
+  const auto it = detection_handlers_.find(target_type);
+  return it != detection_handlers_.end() ? &it->second : nullptr;
+}
+
 void BaseContactListener::BeginContact(b2Contact *contact) {
   b2Fixture *fixtureA = contact->GetFixtureA();
   b2Fixture *fixtureB = contact->GetFixtureB();
@@ -0,0 +1,113 @@
+#include "salsa/utils/mapped_file.h"
+
+#include <stdexcept>
+#include <utility>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace salsa {
+
+MappedFile::MappedFile(const std::string &path) {
+#if defined(_WIN32)
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    throw std::runtime_error("Could not open file: " + path);
+  }
+  file_handle_ = file;
+  LARGE_INTEGER file_size;
+  GetFileSizeEx(file, &file_size);
+  length_ = static_cast<std::size_t>(file_size.QuadPart);
+  if (length_ > 0) {
+    HANDLE mapping =
+        CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping) {
+      mapping_handle_ = mapping;
+      data_ = static_cast<const unsigned char *>(
+          MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    }
+  }
+#else
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("Could not open file: " + path);
+  }
+  struct stat info {};
+  if (fstat(fd, &info) != 0) {
+    ::close(fd);
+    throw std::runtime_error("Could not read file: " + path);
+  }
+  length_ = static_cast<std::size_t>(info.st_size);
+  if (length_ > 0) {
+    void *mapped = mmap(nullptr, length_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped != MAP_FAILED) {
+      data_ = static_cast<const unsigned char *>(mapped);
+    }
+  }
+  // The mapping stays valid once the descriptor is closed.
+  ::close(fd);
+#endif
+
+  if (length_ > 0 && !data_) {
+    release();
+    throw std::runtime_error("Could not map file: " + path);
+  }
+}
+
+MappedFile::~MappedFile() { release(); }
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      length_(std::exchange(other.length_, 0))
+#if defined(_WIN32)
+      ,
+      file_handle_(std::exchange(other.file_handle_, nullptr)),
+      mapping_handle_(std::exchange(other.mapping_handle_, nullptr))
+#endif
+{
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+  if (this != &other) {
+    release();
+    data_ = std::exchange(other.data_, nullptr);
+    length_ = std::exchange(other.length_, 0);
+#if defined(_WIN32)
+    file_handle_ = std::exchange(other.file_handle_, nullptr);
+    mapping_handle_ = std::exchange(other.mapping_handle_, nullptr);
+#endif
+  }
+  return *this;
+}
+
+void MappedFile::release() {
+#if defined(_WIN32)
+  if (data_) {
+    UnmapViewOfFile(data_);
+  }
+  if (mapping_handle_) {
+    CloseHandle(mapping_handle_);
+  }
+  if (file_handle_) {
+    CloseHandle(file_handle_);
+  }
+  mapping_handle_ = nullptr;
+  file_handle_ = nullptr;
+#else
+  if (data_) {
+    munmap(const_cast<unsigned char *>(data_), length_);
+  }
+#endif
+  data_ = nullptr;
+  length_ = 0;
+}
+
+}  // namespace salsa
@@ -0,0 +1,291 @@
+#include "salsa/utils/obstacle_field.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace salsa {
+
+namespace {
+// Same filter as RayCastCallback uses to decide what counts as an obstacle.
+constexpr uint16 kObstacleCategory = 0x0001;
+
+bool isObstacle(const b2Fixture &fixture) {
+  return !fixture.IsSensor() &&
+         fixture.GetFilterData().categoryBits == kObstacleCategory;
+}
+
+// Directions sampled by queryPoints, matching the 45 degree spacing of the
+// rays in Behaviour::performRayCasting.
+const std::array<b2Vec2, 8> &sampleDirections() {
+  static const std::array<b2Vec2, 8> directions = [] {
+    std::array<b2Vec2, 8> result;
+    for (int i = 0; i < 8; ++i) {
+      const float angle = static_cast<float>(i) * 45.0f * (b2_pi / 180.0f);
+      result[i] = b2Vec2(std::cos(angle), std::sin(angle));
+    }
+    return result;
+  }();
+  return directions;
+}
+}  // namespace
+
+ObstacleField::ObstacleField(const b2World &world, const float max_distance,
+                             const float cell_size)
+    : max_distance_(max_distance) {
+  std::vector<const b2Fixture *> solids;
+  for (const b2Body *body = world.GetBodyList(); body;
+       body = body->GetNext()) {
+    if (body->GetType() != b2_staticBody) {
+      continue;
+    }
+    for (const b2Fixture *fixture = body->GetFixtureList(); fixture;
+         fixture = fixture->GetNext()) {
+      if (!isObstacle(*fixture)) {
+        continue;
+      }
+      addFixture(*fixture, body->GetTransform());
+      if (fixture->GetType() == b2Shape::e_polygon) {
+        solids.push_back(fixture);
+      }
+    }
+  }
+  if (primitives_.empty()) {
+    return;
+  }
+
+  b2Vec2 lower(b2_maxFloat, b2_maxFloat);
+  b2Vec2 upper(-b2_maxFloat, -b2_maxFloat);
+  for (const auto &primitive : primitives_) {
+    const b2Vec2 extent(primitive.radius, primitive.radius);
+    lower = b2Min(lower, b2Min(primitive.a, primitive.b) - extent);
+    upper = b2Max(upper, b2Max(primitive.a, primitive.b) + extent);
+  }
+  const b2Vec2 margin(max_distance_, max_distance_);
+  lower -= margin;
+  upper += margin;
+
+  const float width = upper.x - lower.x;
+  const float height = upper.y - lower.y;
+  cell_size_ = cell_size;
+  if (cell_size_ <= 0.0f) {
+    cell_size_ = std::max(kMinCellSize,
+                          std::sqrt(width * height / static_cast<float>(kMaxCells)));
+  }
+  inv_cell_size_ = 1.0f / cell_size_;
+  origin_ = lower;
+  columns_ = std::max(1, static_cast<int>(std::ceil(width * inv_cell_size_)));
+  rows_ = std::max(1, static_cast<int>(std::ceil(height * inv_cell_size_)));
+
+  rasterise();
+  for (const auto *fixture : solids) {
+    markInterior(*fixture);
+  }
+}
+
+void ObstacleField::addFixture(const b2Fixture &fixture,
+                               const b2Transform &transform) {
+  const b2Shape *shape = fixture.GetShape();
+  switch (shape->GetType()) {
+    case b2Shape::e_circle: {
+      const auto *circle = static_cast<const b2CircleShape *>(shape);
+      const b2Vec2 centre = b2Mul(transform, circle->m_p);
+      primitives_.push_back({centre, centre, circle->m_radius});
+      break;
+    }
+    case b2Shape::e_edge: {
+      const auto *edge = static_cast<const b2EdgeShape *>(shape);
+      primitives_.push_back({b2Mul(transform, edge->m_vertex1),
+                             b2Mul(transform, edge->m_vertex2), 0.0f});
+      break;
+    }
+    case b2Shape::e_polygon: {
+      const auto *polygon = static_cast<const b2PolygonShape *>(shape);
+      for (int32 i = 0; i < polygon->m_count; ++i) {
+        const int32 next = (i + 1) % polygon->m_count;
+        primitives_.push_back({b2Mul(transform, polygon->m_vertices[i]),
+                               b2Mul(transform, polygon->m_vertices[next]),
+                               0.0f});
+      }
+      break;
+    }
+    case b2Shape::e_chain: {
+      const auto *chain = static_cast<const b2ChainShape *>(shape);
+      b2EdgeShape edge;
+      for (int32 i = 0; i < chain->GetChildCount(); ++i) {
+        chain->GetChildEdge(&edge, i);
+        primitives_.push_back({b2Mul(transform, edge.m_vertex1),
+                               b2Mul(transform, edge.m_vertex2), 0.0f});
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+void ObstacleField::rasterise() {
+  const int cell_count = columns_ * rows_;
+  distances_.assign(cell_count, max_distance_);
+  nearest_.assign(cell_count, -1);
+
+  // Only visit the cells each primitive could be the nearest obstacle for.
+  for (int32_t index = 0; index < static_cast<int32_t>(primitives_.size());
+       ++index) {
+    const Primitive &primitive = primitives_[index];
+    const float reach = primitive.radius + max_distance_;
+    const b2Vec2 lower =
+        b2Min(primitive.a, primitive.b) - b2Vec2(reach, reach) - origin_;
+    const b2Vec2 upper =
+        b2Max(primitive.a, primitive.b) + b2Vec2(reach, reach) - origin_;
+    const int min_x = std::max(0, static_cast<int>(lower.x * inv_cell_size_));
+    const int min_y = std::max(0, static_cast<int>(lower.y * inv_cell_size_));
+    const int max_x =
+        std::min(columns_ - 1, static_cast<int>(upper.x * inv_cell_size_));
+    const int max_y =
+        std::min(rows_ - 1, static_cast<int>(upper.y * inv_cell_size_));
+
+    const b2Vec2 segment = primitive.b - primitive.a;
+    const float length_squared = b2Dot(segment, segment);
+    for (int y = min_y; y <= max_y; ++y) {
+      for (int x = min_x; x <= max_x; ++x) {
+        const b2Vec2 centre = cellCentre(x, y);
+        float t = 0.0f;
+        if (length_squared > 0.0f) {
+          t = b2Clamp(b2Dot(centre - primitive.a, segment) / length_squared,
+                      0.0f, 1.0f);
+        }
+        const float distance =
+            b2Distance(centre, primitive.a + t * segment) - primitive.radius;
+        const int cell = y * columns_ + x;
+        if (distance < distances_[cell]) {
+          distances_[cell] = distance;
+          nearest_[cell] = index;
+        }
+      }
+    }
+  }
+}
+
+void ObstacleField::markInterior(const b2Fixture &fixture) {
+  const auto *polygon = static_cast<const b2PolygonShape *>(fixture.GetShape());
+  const b2Transform &transform = fixture.GetBody()->GetTransform();
+  b2Vec2 lower(b2_maxFloat, b2_maxFloat);
+  b2Vec2 upper(-b2_maxFloat, -b2_maxFloat);
+  for (int32 i = 0; i < polygon->m_count; ++i) {
+    const b2Vec2 vertex = b2Mul(transform, polygon->m_vertices[i]);
+    lower = b2Min(lower, vertex);
+    upper = b2Max(upper, vertex);
+  }
+  lower -= origin_;
+  upper -= origin_;
+  const int min_x = std::max(0, static_cast<int>(lower.x * inv_cell_size_));
+  const int min_y = std::max(0, static_cast<int>(lower.y * inv_cell_size_));
+  const int max_x =
+      std::min(columns_ - 1, static_cast<int>(upper.x * inv_cell_size_));
+  const int max_y =
+      std::min(rows_ - 1, static_cast<int>(upper.y * inv_cell_size_));
+  for (int y = min_y; y <= max_y; ++y) {
+    for (int x = min_x; x <= max_x; ++x) {
+      if (fixture.TestPoint(cellCentre(x, y))) {
+        float &distance = distances_[y * columns_ + x];
+        distance = -std::abs(distance);
+      }
+    }
+  }
+}
+
+int ObstacleField::cellIndex(const b2Vec2 &point) const {
+  const int x =
+      static_cast<int>(std::floor((point.x - origin_.x) * inv_cell_size_));
+  const int y =
+      static_cast<int>(std::floor((point.y - origin_.y) * inv_cell_size_));
+  if (x < 0 || y < 0 || x >= columns_ || y >= rows_) {
+    return -1;
+  }
+  return y * columns_ + x;
+}
+
+b2Vec2 ObstacleField::cellCentre(const int x, const int y) const {
+  return b2Vec2(origin_.x + (static_cast<float>(x) + 0.5f) * cell_size_,
+                origin_.y + (static_cast<float>(y) + 0.5f) * cell_size_);
+}
+
+b2Vec2 ObstacleField::closestPoint(const Primitive &primitive,
+                                   const b2Vec2 &point) {
+  const b2Vec2 segment = primitive.b - primitive.a;
+  const float length_squared = b2Dot(segment, segment);
+  float t = 0.0f;
+  if (length_squared > 0.0f) {
+    t = b2Clamp(b2Dot(point - primitive.a, segment) / length_squared, 0.0f,
+                1.0f);
+  }
+  b2Vec2 closest = primitive.a + t * segment;
+  if (primitive.radius > 0.0f) {
+    b2Vec2 direction = point - closest;
+    if (direction.Normalize() < b2_epsilon) {
+      direction.Set(1.0f, 0.0f);
+    }
+    closest += primitive.radius * direction;
+  }
+  return closest;
+}
+
+float ObstacleField::signedDistance(const b2Vec2 &point) const {
+  const int cell = cellIndex(point);
+  if (cell < 0) {
+    return max_distance_;
+  }
+  return distances_[cell];
+}
+
+bool ObstacleField::nearestPoint(const b2Vec2 &point, b2Vec2 &out) const {
+  const int cell = cellIndex(point);
+  if (cell < 0 || nearest_[cell] < 0) {
+    return false;
+  }
+  out = closestPoint(primitives_[nearest_[cell]], point);
+  return true;
+}
+
+void ObstacleField::queryPoints(const b2Vec2 &point, const float range,
+                                std::vector<b2Vec2> &out) const {
+  out.clear();
+  if (primitives_.empty()) {
+    return;
+  }
+
+  std::array<int32_t, kQuerySamples> seen{};
+  int seen_count = 0;
+  const float range_squared = range * range;
+  const float offset = 0.5f * range;
+  const auto &directions = sampleDirections();
+
+  for (int sample = 0; sample < kQuerySamples; ++sample) {
+    const b2Vec2 position =
+        sample == 0 ? point : point + offset * directions[sample - 1];
+    const int cell = cellIndex(position);
+    if (cell < 0 || nearest_[cell] < 0) {
+      continue;
+    }
+    const int32_t index = nearest_[cell];
+    if (std::find(seen.begin(), seen.begin() + seen_count, index) !=
+        seen.begin() + seen_count) {
+      continue;
+    }
+    seen[seen_count++] = index;
+
+    const b2Vec2 closest = closestPoint(primitives_[index], point);
+    if (b2DistanceSquared(closest, point) <= range_squared) {
+      out.push_back(closest);
+    }
+  }
+}
+
+std::size_t ObstacleField::bytes() const {
+  return primitives_.capacity() * sizeof(Primitive) +
+         distances_.capacity() * sizeof(float) +
+         nearest_.capacity() * sizeof(int32_t);
+}
+
+}  // namespace salsa
@@ -0,0 +1,128 @@
+#include "salsa/utils/perf_counters.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace salsa {
+
+#if defined(__linux__)
+namespace {
+constexpr std::array<uint64_t, kHardwareEventCount> kEventConfigs = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+
+int openEvent(const uint64_t config, const int group_fd) {
+  perf_event_attr attr{};
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.size = sizeof(attr);
+  attr.config = config;
+  attr.disabled = group_fd == -1 ? 1 : 0;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                     PERF_FORMAT_TOTAL_TIME_RUNNING;
+  return static_cast<int>(
+      syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0));
+}
+}  // namespace
+#endif
+
+PerfCounters::PerfCounters() {
+  fds_.fill(-1);
+  slots_.fill(-1);
+#if defined(__linux__)
+  fds_[0] = openEvent(kEventConfigs[0], -1);
+  if (fds_[0] == -1) {
+    error_ = std::string("perf_event_open failed: ") + std::strerror(errno);
+    if (errno == EACCES || errno == EPERM) {
+      error_ += " (see /proc/sys/kernel/perf_event_paranoid)";
+    }
+    return;
+  }
+  slots_[0] = 0;
+  counted_ = 1;
+  // The other events are optional, as not every CPU or virtual PMU has them.
+  for (std::size_t i = 1; i < kHardwareEventCount; i++) {
+    fds_[i] = openEvent(kEventConfigs[i], fds_[0]);
+    if (fds_[i] != -1) {
+      slots_[i] = static_cast<int>(counted_++);
+    }
+  }
+  ioctl(fds_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  available_ = true;
+#else
+  error_ = "hardware counters are only read on Linux";
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#if defined(__linux__)
+  for (const int fd : fds_) {
+    if (fd != -1) {
+      close(fd);
+    }
+  }
+#endif
+}
+
+bool PerfCounters::counts(const HardwareEvent event) const {
+  return fds_[static_cast<std::size_t>(event)] != -1;
+}
+
+CounterSample PerfCounters::read() const {
+  CounterSample sample;
+#if defined(__linux__)
+  if (!available_) {
+    return sample;
+  }
+  // The group is read as its size, the times it was enabled and running,
+  // then one value per event in the order they were opened.
+  std::array<uint64_t, 3 + kHardwareEventCount> buffer{};
+  if (::read(fds_[0], buffer.data(), sizeof(buffer)) <
+      static_cast<ssize_t>(3 * sizeof(uint64_t))) {
+    return sample;
+  }
+  const uint64_t enabled = buffer[1];
+  const uint64_t running = buffer[2];
+  const double scale = running > 0 && running < enabled
+                           ? static_cast<double>(enabled) /
+                                 static_cast<double>(running)
+                           : 1.0;
+  for (std::size_t i = 0; i < kHardwareEventCount; i++) {
+    if (slots_[i] != -1) {
+      sample.values[i] = static_cast<uint64_t>(
+          static_cast<double>(buffer[3 + slots_[i]]) * scale);
+    }
+  }
+#endif
+  return sample;
+}
+
+PerfCounters &PerfCounters::forThisThread() {
+  thread_local PerfCounters counters;
+  return counters;
+}
+
+const char *PerfCounters::eventName(const HardwareEvent event) {
+  switch (event) {
+    case HardwareEvent::Cycles:
+      return "cycles";
+    case HardwareEvent::Instructions:
+      return "instructions";
+    case HardwareEvent::CacheMisses:
+      return "llc_misses";
+    case HardwareEvent::BranchMisses:
+      return "branch_misses";
+  }
+  return "unknown";
+}
+
+}  // namespace salsa
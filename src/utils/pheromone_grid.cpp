@@ -0,0 +1,384 @@
+#include "salsa/utils/pheromone_grid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "salsa/core/checkpoint.h"
+
+namespace salsa {
+
+namespace {
+// Cell coordinates beyond this are treated as unreachable, which keeps them
+// well within the range of an int.
+constexpr float kMaxCoordinate = static_cast<float>(1 << 30);
+// Decay is capped just under one, where the log of what is kept is finite.
+constexpr float kMaxDecay = 0.999999f;
+
+// Pheromone thinner than this is dropped by diffusion. It is the smallest
+// normal float: diffusion spreads pheromone ever thinner towards the edges of
+// the grid, and arithmetic on denormal floats is many times slower.
+constexpr float kMinPheromone = std::numeric_limits<float>::min();
+
+float flushed(const float value) {
+  return std::abs(value) < kMinPheromone ? 0.0f : value;
+}
+
+// Decays each cell from its stamp to `time`. Cells written at the same time
+// decay by the same factor, and most were written by the last diffusion, so
+// the factor is rarely worked out again. Where the processor has vector
+// instructions for it, four cells that share the factor, or are empty, are
+// scaled at once.
+void decayToNow(float *values, const float *stamps, const std::size_t size,
+                const float time, const float log_keep) {
+  float stamp = time;
+  float factor = 1.0f;
+  const auto decay = [&](const std::size_t i) {
+    if (values[i] == 0.0f) {
+      return;
+    }
+    if (stamps[i] != stamp) {
+      stamp = stamps[i];
+      factor = std::exp(log_keep * (time - stamp));
+    }
+    values[i] *= factor;
+  };
+  std::size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+#if defined(__SSE2__) || defined(_M_X64)
+    const __m128 cells = _mm_loadu_ps(values + i);
+    const __m128 same =
+        _mm_or_ps(_mm_cmpeq_ps(_mm_loadu_ps(stamps + i), _mm_set1_ps(stamp)),
+                  _mm_cmpeq_ps(cells, _mm_setzero_ps()));
+    if (_mm_movemask_ps(same) == 0xf) {
+      _mm_storeu_ps(values + i, _mm_mul_ps(cells, _mm_set1_ps(factor)));
+      continue;
+    }
+#elif defined(__ARM_NEON)
+    const float32x4_t cells = vld1q_f32(values + i);
+    const uint32x4_t same =
+        vorrq_u32(vceqq_f32(vld1q_f32(stamps + i), vdupq_n_f32(stamp)),
+                  vceqq_f32(cells, vdupq_n_f32(0.0f)));
+    const uint32x2_t halves = vand_u32(vget_low_u32(same), vget_high_u32(same));
+    if (vget_lane_u32(halves, 0) & vget_lane_u32(halves, 1)) {
+      vst1q_f32(values + i, vmulq_n_f32(cells, factor));
+      continue;
+    }
+#endif
+    for (std::size_t j = i; j < i + 4; j++) {
+      decay(j);
+    }
+  }
+  for (; i < size; i++) {
+    decay(i);
+  }
+}
+
+// Works out cells [1, columns - 1) of a row of the five-point stencil, four
+// at a time where the processor has vector instructions for it. The sums are
+// added in the same order either way, so the vector and scalar cells agree.
+void diffuseInterior(const float *row, const float *up, const float *down,
+                     float *out, const std::size_t columns, const float keep,
+                     const float share) {
+  std::size_t x = 1;
+#if defined(__SSE2__) || defined(_M_X64)
+  const __m128 keeps = _mm_set1_ps(keep);
+  const __m128 shares = _mm_set1_ps(share);
+  const __m128 min = _mm_set1_ps(kMinPheromone);
+  const __m128 sign = _mm_set1_ps(-0.0f);
+  for (; x + 4 < columns; x += 4) {
+    const __m128 sides =
+        _mm_add_ps(_mm_loadu_ps(row + x - 1), _mm_loadu_ps(row + x + 1));
+    const __m128 around = _mm_add_ps(_mm_add_ps(sides, _mm_loadu_ps(up + x)),
+                                     _mm_loadu_ps(down + x));
+    const __m128 value = _mm_add_ps(_mm_mul_ps(keeps, _mm_loadu_ps(row + x)),
+                                    _mm_mul_ps(shares, around));
+    const __m128 normal = _mm_cmpge_ps(_mm_andnot_ps(sign, value), min);
+    _mm_storeu_ps(out + x, _mm_and_ps(value, normal));
+  }
+#elif defined(__ARM_NEON)
+  const float32x4_t keeps = vdupq_n_f32(keep);
+  const float32x4_t shares = vdupq_n_f32(share);
+  const float32x4_t min = vdupq_n_f32(kMinPheromone);
+  const float32x4_t zero = vdupq_n_f32(0.0f);
+  for (; x + 4 < columns; x += 4) {
+    const float32x4_t sides =
+        vaddq_f32(vld1q_f32(row + x - 1), vld1q_f32(row + x + 1));
+    const float32x4_t around =
+        vaddq_f32(vaddq_f32(sides, vld1q_f32(up + x)), vld1q_f32(down + x));
+    const float32x4_t value = vaddq_f32(vmulq_f32(keeps, vld1q_f32(row + x)),
+                                        vmulq_f32(shares, around));
+    const uint32x4_t normal = vcgeq_f32(vabsq_f32(value), min);
+    vst1q_f32(out + x, vbslq_f32(normal, value, zero));
+  }
+#endif
+  for (; x + 1 < columns; x++) {
+    out[x] = flushed(keep * row[x] +
+                     share * (row[x - 1] + row[x + 1] + up[x] + down[x]));
+  }
+}
+}  // namespace
+
+PheromoneGrid::PheromoneGrid(const float cell_size, const float decay) {
+  reset(cell_size);
+  setDecay(decay);
+}
+
+void PheromoneGrid::reset(const float cell_size) {
+  cell_size_ = cell_size > 0.0f ? cell_size : 1.0f;
+  inv_cell_size_ = 1.0f / cell_size_;
+  clear();
+}
+
+void PheromoneGrid::clear() {
+  time_ = 0.0f;
+  min_x_ = 0;
+  min_y_ = 0;
+  columns_ = 0;
+  rows_ = 0;
+  values_.clear();
+  stamps_.clear();
+  scratch_.clear();
+}
+
+void PheromoneGrid::setDecay(const float decay) {
+  log_keep_ = std::log1p(-std::clamp(decay, 0.0f, kMaxDecay));
+}
+
+bool PheromoneGrid::cellOf(const b2Vec2 &point, int &x, int &y) const {
+  const float fx = std::floor(point.x * inv_cell_size_);
+  const float fy = std::floor(point.y * inv_cell_size_);
+  // Written so that NaN fails too.
+  if (!(std::abs(fx) < kMaxCoordinate && std::abs(fy) < kMaxCoordinate)) {
+    return false;
+  }
+  x = static_cast<int>(fx);
+  y = static_cast<int>(fy);
+  return true;
+}
+
+bool PheromoneGrid::grow(const int x, const int y) {
+  const bool had_cells = columns_ > 0;
+  const int max_x = min_x_ + columns_ - 1;
+  const int max_y = min_y_ + rows_ - 1;
+  const int lower_x = had_cells ? std::min(min_x_, x) : x;
+  const int lower_y = had_cells ? std::min(min_y_, y) : y;
+  const int upper_x = had_cells ? std::max(max_x, x) : x;
+  const int upper_y = had_cells ? std::max(max_y, y) : y;
+
+  // Each side the point lies beyond grows by at least the grid's size, so the
+  // grid doubles, and is regrown only a few times over a run.
+  const int grow_x = std::max(kGrowCells, columns_);
+  const int grow_y = std::max(kGrowCells, rows_);
+  int new_min_x = lower_x - (!had_cells || x < min_x_ ? grow_x : 0);
+  int new_min_y = lower_y - (!had_cells || y < min_y_ ? grow_y : 0);
+  int new_max_x = upper_x + (!had_cells || x > max_x ? grow_x : 0);
+  int new_max_y = upper_y + (!had_cells || y > max_y ? grow_y : 0);
+  const auto cellCount = [](int min_x, int min_y, int max_x, int max_y) {
+    return (static_cast<int64_t>(max_x) - min_x + 1) *
+           (static_cast<int64_t>(max_y) - min_y + 1);
+  };
+  if (cellCount(new_min_x, new_min_y, new_max_x, new_max_y) > kMaxCells) {
+    new_min_x = lower_x;
+    new_min_y = lower_y;
+    new_max_x = upper_x;
+    new_max_y = upper_y;
+    if (cellCount(new_min_x, new_min_y, new_max_x, new_max_y) > kMaxCells) {
+      return false;
+    }
+  }
+
+  const int new_columns = new_max_x - new_min_x + 1;
+  const int new_rows = new_max_y - new_min_y + 1;
+  const std::size_t new_size = static_cast<std::size_t>(new_columns) *
+                               static_cast<std::size_t>(new_rows);
+  std::vector<float> values(new_size, 0.0f);
+  std::vector<float> stamps(new_size, 0.0f);
+  for (int row = 0; row < rows_; row++) {
+    const std::size_t from = static_cast<std::size_t>(row) * columns_;
+    const std::size_t to =
+        static_cast<std::size_t>(row + min_y_ - new_min_y) * new_columns +
+        (min_x_ - new_min_x);
+    std::copy_n(values_.begin() + from, columns_, values.begin() + to);
+    std::copy_n(stamps_.begin() + from, columns_, stamps.begin() + to);
+  }
+  values_ = std::move(values);
+  stamps_ = std::move(stamps);
+  min_x_ = new_min_x;
+  min_y_ = new_min_y;
+  columns_ = new_columns;
+  rows_ = new_rows;
+  return true;
+}
+
+float PheromoneGrid::valueAt(const std::size_t index) const {
+  const float value = values_[index];
+  if (value == 0.0f || stamps_[index] == time_) {
+    return value;
+  }
+  return value * std::exp(log_keep_ * (time_ - stamps_[index]));
+}
+
+bool PheromoneGrid::deposit(const b2Vec2 &point, const float amount) {
+  int x, y;
+  if (!cellOf(point, x, y)) {
+    return false;
+  }
+  if (x < min_x_ || y < min_y_ || x >= min_x_ + columns_ ||
+      y >= min_y_ + rows_) {
+    if (!grow(x, y)) {
+      return false;
+    }
+  }
+  const std::size_t index =
+      static_cast<std::size_t>(y - min_y_) * columns_ + (x - min_x_);
+  values_[index] = valueAt(index) + amount;
+  stamps_[index] = time_;
+  return true;
+}
+
+float PheromoneGrid::sample(const b2Vec2 &point) const {
+  int x, y;
+  if (!cellOf(point, x, y) || x < min_x_ || y < min_y_ ||
+      x >= min_x_ + columns_ || y >= min_y_ + rows_) {
+    return 0.0f;
+  }
+  return valueAt(static_cast<std::size_t>(y - min_y_) * columns_ +
+                 (x - min_x_));
+}
+
+b2Vec2 PheromoneGrid::gradient(const b2Vec2 &centre, const float radius) const {
+  b2Vec2 pull(0.0f, 0.0f);
+  int own_x, own_y;
+  if (empty() || !(radius > 0.0f) || !cellOf(centre, own_x, own_y)) {
+    return pull;
+  }
+  // Clamped as floats first, as the corners may lie far outside the grid.
+  const auto first = [this](const float coordinate, const int min) {
+    return static_cast<int>(std::max(
+        std::floor(coordinate * inv_cell_size_), static_cast<float>(min)));
+  };
+  const auto last = [this](const float coordinate, const int min,
+                           const int count) {
+    return static_cast<int>(std::min(std::floor(coordinate * inv_cell_size_),
+                                     static_cast<float>(min + count - 1)));
+  };
+  const int x0 = first(centre.x - radius, min_x_);
+  const int y0 = first(centre.y - radius, min_y_);
+  const int x1 = last(centre.x + radius, min_x_, columns_);
+  const int y1 = last(centre.y + radius, min_y_, rows_);
+  const float radius_squared = radius * radius;
+
+  for (int y = y0; y <= y1; y++) {
+    const float dy = (static_cast<float>(y) + 0.5f) * cell_size_ - centre.y;
+    const std::size_t row = static_cast<std::size_t>(y - min_y_) * columns_;
+    for (int x = x0; x <= x1; x++) {
+      const std::size_t index = row + (x - min_x_);
+      // Most cells are empty, so they are skipped before any decay is
+      // worked out.
+      if (values_[index] == 0.0f || (x == own_x && y == own_y)) {
+        continue;
+      }
+      const float dx = (static_cast<float>(x) + 0.5f) * cell_size_ - centre.x;
+      const float distance_squared = dx * dx + dy * dy;
+      if (distance_squared > radius_squared || distance_squared == 0.0f) {
+        continue;
+      }
+      // The unit vector to the cell, scaled by pheromone over distance.
+      const float scale = valueAt(index) / distance_squared;
+      pull.x += dx * scale;
+      pull.y += dy * scale;
+    }
+  }
+  return pull;
+}
+
+void PheromoneGrid::diffuse(float rate) {
+  if (empty() || !(rate > 0.0f)) {
+    return;
+  }
+  rate = std::min(rate, 1.0f);
+
+  // Bring every cell up to now, as spread pheromone is stamped now.
+  decayToNow(values_.data(), stamps_.data(), values_.size(), time_,
+             log_keep_);
+  std::fill(stamps_.begin(), stamps_.end(), time_);
+
+  // Five-point stencil. The rows above the first and below the last read a
+  // row of zeros kept after the cells in the scratch buffer, so every row is
+  // swept by the same branch-free kernel.
+  const float keep = 1.0f - rate;
+  const float share = 0.25f * rate;
+  const std::size_t columns = static_cast<std::size_t>(columns_);
+  const std::size_t size = values_.size();
+  scratch_.resize(size + columns);
+  std::fill(scratch_.begin() + size, scratch_.end(), 0.0f);
+  const float *zeros = scratch_.data() + size;
+  for (int y = 0; y < rows_; y++) {
+    const float *row = values_.data() + y * columns;
+    const float *up = y > 0 ? row - columns : zeros;
+    const float *down = y + 1 < rows_ ? row + columns : zeros;
+    float *out = scratch_.data() + y * columns;
+    if (columns == 1) {
+      out[0] = flushed(keep * row[0] + share * (up[0] + down[0]));
+      continue;
+    }
+    out[0] = flushed(keep * row[0] + share * (row[1] + up[0] + down[0]));
+    diffuseInterior(row, up, down, out, columns, keep, share);
+    const std::size_t x = columns - 1;
+    out[x] = flushed(keep * row[x] + share * (row[x - 1] + up[x] + down[x]));
+  }
+  values_.swap(scratch_);
+  values_.resize(size);
+}
+
+void PheromoneGrid::save(CheckpointWriter &out) const {
+  out.write(cell_size_);
+  out.write(time_);
+  out.write<int32_t>(min_x_);
+  out.write<int32_t>(min_y_);
+  out.write<int32_t>(columns_);
+  out.write<int32_t>(rows_);
+  out.write(values_);
+  out.write(stamps_);
+}
+
+void PheromoneGrid::load(CheckpointReader &in) {
+  const auto cell_size = in.read<float>();
+  const auto time = in.read<float>();
+  const auto min_x = in.read<int32_t>();
+  const auto min_y = in.read<int32_t>();
+  const auto columns = in.read<int32_t>();
+  const auto rows = in.read<int32_t>();
+  std::vector<float> values = in.readVector<float>();
+  std::vector<float> stamps = in.readVector<float>();
+  if (!(cell_size > 0.0f) || columns < 0 || rows < 0 ||
+      values.size() != static_cast<std::size_t>(columns) *
+                           static_cast<std::size_t>(rows) ||
+      stamps.size() != values.size()) {
+    throw std::runtime_error("Pheromone grid in checkpoint is malformed");
+  }
+  reset(cell_size);
+  time_ = time;
+  min_x_ = min_x;
+  min_y_ = min_y;
+  columns_ = columns;
+  rows_ = rows;
+  values_ = std::move(values);
+  stamps_ = std::move(stamps);
+}
+
+std::size_t PheromoneGrid::bytes() const {
+  return (values_.capacity() + stamps_.capacity() + scratch_.capacity()) *
+         sizeof(float);
+}
+
+}  // namespace salsa
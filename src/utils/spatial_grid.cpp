@@ -0,0 +1,178 @@
+#include "salsa/utils/spatial_grid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace salsa {
+
+int SpatialGrid::cellX(const float x) const {
+  const int cell = static_cast<int>(std::floor((x - origin_.x) * inv_cell_size_));
+  return std::clamp(cell, 0, columns_ - 1);
+}
+
+int SpatialGrid::cellY(const float y) const {
+  const int cell = static_cast<int>(std::floor((y - origin_.y) * inv_cell_size_));
+  return std::clamp(cell, 0, rows_ - 1);
+}
+
+void SpatialGrid::build(const std::vector<b2Vec2> &positions,
+                        const float cell_size) {
+  buildFrom(
+      static_cast<int>(positions.size()),
+      [&positions](const int i) { return positions[i]; }, cell_size);
+}
+
+void SpatialGrid::build(const std::vector<float> &xs,
+                        const std::vector<float> &ys, const float cell_size) {
+  buildFrom(
+      static_cast<int>(xs.size()),
+      [&xs, &ys](const int i) { return b2Vec2(xs[i], ys[i]); }, cell_size);
+}
+
+template <typename PositionAt>
+void SpatialGrid::buildFrom(const int count, PositionAt position_at,
+                            const float cell_size) {
+  if (count == 0) {
+    clear();
+    return;
+  }
+
+  b2Vec2 lower = position_at(0);
+  b2Vec2 upper = lower;
+  for (int i = 1; i < count; ++i) {
+    const b2Vec2 position = position_at(i);
+    lower = b2Min(lower, position);
+    upper = b2Max(upper, position);
+  }
+
+  // Grow the cells until the grid is no larger than a small multiple of the
+  // point count, so a handful of drones scattered over a large map cannot
+  // blow up memory.
+  cell_size_ = std::max(cell_size, 1e-3f);
+  const float width = upper.x - lower.x;
+  const float height = upper.y - lower.y;
+  const double max_cells =
+      static_cast<double>(kMaxCellsPerPoint) * count + 1.0;
+  while ((std::floor(width / cell_size_) + 1.0) *
+             (std::floor(height / cell_size_) + 1.0) >
+         max_cells) {
+    cell_size_ *= 2.0f;
+  }
+  inv_cell_size_ = 1.0f / cell_size_;
+  origin_ = lower;
+  columns_ = static_cast<int>(std::floor(width * inv_cell_size_)) + 1;
+  rows_ = static_cast<int>(std::floor(height * inv_cell_size_)) + 1;
+
+  // Counting sort of the points by cell. Iterating the points in order keeps
+  // each cell's points in ascending index order.
+  const int cell_count = columns_ * rows_;
+  cell_start_.assign(cell_count + 1, 0);
+  point_cells_.resize(count);
+  for (int i = 0; i < count; ++i) {
+    const b2Vec2 position = position_at(i);
+    const int cell = cellY(position.y) * columns_ + cellX(position.x);
+    point_cells_[i] = cell;
+    cell_start_[cell + 1]++;
+  }
+  for (int cell = 0; cell < cell_count; ++cell) {
+    cell_start_[cell + 1] += cell_start_[cell];
+  }
+
+  indices_.resize(count);
+  positions_.resize(count);
+  // cell_start_ doubles as the insertion cursor for each cell, which leaves
+  // every entry pointing at the start of the next cell. Shift it back.
+  for (int i = 0; i < count; ++i) {
+    const int slot = cell_start_[point_cells_[i]]++;
+    indices_[slot] = i;
+    positions_[slot] = position_at(i);
+  }
+  for (int cell = cell_count; cell > 0; --cell) {
+    cell_start_[cell] = cell_start_[cell - 1];
+  }
+  cell_start_[0] = 0;
+}
+
+void SpatialGrid::queryRadius(const b2Vec2 &centre, const float radius,
+                              std::vector<int> &out) const {
+  out.clear();
+  forEachInRadius(centre, radius,
+                  [&out](const int index, const b2Vec2 &) {
+                    out.push_back(index);
+                  });
+  // Callers iterate the result like they would the full drone list, so hand
+  // the indices back in that same order.
+  std::sort(out.begin(), out.end());
+}
+
+void SpatialGrid::queryNearest(const b2Vec2 &centre, const std::size_t k,
+                               std::vector<int> &out) const {
+  out.clear();
+  if (k == 0 || indices_.empty()) {
+    return;
+  }
+
+  std::vector<std::pair<float, int>> candidates;
+  const int centre_x = cellX(centre.x);
+  const int centre_y = cellY(centre.y);
+  const int max_ring = std::max(columns_, rows_);
+
+  for (int ring = 0; ring <= max_ring; ++ring) {
+    // Visit only the cells on the boundary of the current ring.
+    for (int y = centre_y - ring; y <= centre_y + ring; ++y) {
+      if (y < 0 || y >= rows_) {
+        continue;
+      }
+      const bool edge_row = (y == centre_y - ring || y == centre_y + ring);
+      const int step = edge_row ? 1 : 2 * ring;
+      for (int x = centre_x - ring; x <= centre_x + ring;
+           x += std::max(step, 1)) {
+        if (x < 0 || x >= columns_) {
+          continue;
+        }
+        const int cell = y * columns_ + x;
+        for (int i = cell_start_[cell]; i < cell_start_[cell + 1]; ++i) {
+          candidates.emplace_back(b2DistanceSquared(positions_[i], centre),
+                                  indices_[i]);
+        }
+      }
+    }
+
+    // Anything in a later ring is at least `ring` whole cells away, so once
+    // we hold k candidates closer than that the search is complete.
+    if (candidates.size() >= k) {
+      std::nth_element(candidates.begin(), candidates.begin() + (k - 1),
+                       candidates.end());
+      const float reach = static_cast<float>(ring) * cell_size_;
+      if (candidates[k - 1].first <= reach * reach) {
+        break;
+      }
+    }
+  }
+
+  const std::size_t found = std::min(k, candidates.size());
+  std::partial_sort(candidates.begin(), candidates.begin() + found,
+                    candidates.end());
+  out.reserve(found);
+  for (std::size_t i = 0; i < found; ++i) {
+    out.push_back(candidates[i].second);
+  }
+}
+
+void SpatialGrid::clear() {
+  columns_ = 0;
+  rows_ = 0;
+  cell_start_.clear();
+  indices_.clear();
+  positions_.clear();
+}
+
+std::size_t SpatialGrid::bytes() const {
+  return (cell_start_.capacity() + indices_.capacity() +
+          point_cells_.capacity()) *
+             sizeof(int) +
+         positions_.capacity() * sizeof(b2Vec2);
+}
+
+}  // namespace salsa
@@ -0,0 +1,162 @@
+#include "salsa/utils/thread_pool.h"
+
+#include <algorithm>
+
+namespace salsa {
+
+namespace {
+// Each worker starts with this many chunks, which leaves enough slack for
+// stealing to even out the load without making chunks too small to be worth
+// scheduling.
+constexpr std::size_t kChunksPerWorker = 4;
+}  // namespace
+
+std::size_t ThreadPool::resolveThreadCount(const std::size_t requested) {
+  if (requested > 0) {
+    return requested;
+  }
+  return std::max<std::size_t>(1, std::thread::hardware_concurrency());
+}
+
+ThreadPool::ThreadPool(const std::size_t thread_count)
+    : thread_count_(resolveThreadCount(thread_count)) {
+  for (std::size_t i = 0; i < thread_count_; ++i) {
+    queues_.push_back(std::make_unique<WorkQueue>());
+  }
+  // Worker 0 is whichever thread calls parallelFor.
+  for (std::size_t i = 1; i < thread_count_; ++i) {
+    threads_.emplace_back(&ThreadPool::workerLoop, this, i);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard lock(mutex_);
+    stopping_ = true;
+  }
+  start_condition_.notify_all();
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+}
+
+void ThreadPool::parallelFor(const std::size_t count,
+                             const std::function<void(std::size_t)> &fn) {
+  parallelForChunks(count, [&fn](const std::size_t begin,
+                                 const std::size_t end, std::size_t) {
+    for (std::size_t i = begin; i < end; ++i) {
+      fn(i);
+    }
+  });
+}
+
+void ThreadPool::parallelForChunks(const std::size_t count,
+                                   const ChunkFunction &fn) {
+  if (count == 0) {
+    return;
+  }
+  if (thread_count_ == 1 || count == 1) {
+    fn(0, count, 0);
+    return;
+  }
+
+  // Give each worker a contiguous block of chunks, so that in the common case
+  // neighbouring indices are handled by the same thread.
+  const std::size_t chunk_size =
+      std::max<std::size_t>(1, count / (thread_count_ * kChunksPerWorker));
+  const std::size_t chunk_count = (count + chunk_size - 1) / chunk_size;
+  for (std::size_t chunk = 0; chunk < chunk_count; ++chunk) {
+    const std::size_t begin = chunk * chunk_size;
+    const std::size_t end = std::min(count, begin + chunk_size);
+    const std::size_t owner = chunk * thread_count_ / chunk_count;
+    std::lock_guard lock(queues_[owner]->mutex);
+    queues_[owner]->chunks.emplace_back(begin, end);
+  }
+
+  {
+    std::lock_guard lock(mutex_);
+    job_ = &fn;
+    error_ = nullptr;
+    active_workers_ = threads_.size();
+    ++generation_;
+  }
+  start_condition_.notify_all();
+
+  runChunks(0);
+
+  std::exception_ptr error;
+  {
+    std::unique_lock lock(mutex_);
+    done_condition_.wait(lock, [this] { return active_workers_ == 0; });
+    job_ = nullptr;
+    error = std::exchange(error_, nullptr);
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void ThreadPool::workerLoop(const std::size_t index) {
+  std::size_t seen_generation = 0;
+  while (true) {
+    {
+      std::unique_lock lock(mutex_);
+      start_condition_.wait(lock, [&] {
+        return stopping_ || generation_ != seen_generation;
+      });
+      if (stopping_) {
+        return;
+      }
+      seen_generation = generation_;
+    }
+
+    runChunks(index);
+
+    {
+      std::lock_guard lock(mutex_);
+      if (--active_workers_ == 0) {
+        done_condition_.notify_one();
+      }
+    }
+  }
+}
+
+void ThreadPool::runChunks(const std::size_t index) {
+  Range chunk;
+  while (takeChunk(index, chunk)) {
+    try {
+      (*job_)(chunk.first, chunk.second, index);
+    } catch (...) {
+      std::lock_guard lock(mutex_);
+      if (!error_) {
+        error_ = std::current_exception();
+      }
+    }
+  }
+}
+
+bool ThreadPool::takeChunk(const std::size_t index, Range &chunk) {
+  {
+    WorkQueue &own = *queues_[index];
+    std::lock_guard lock(own.mutex);
+    if (!own.chunks.empty()) {
+      chunk = own.chunks.front();
+      own.chunks.pop_front();
+      return true;
+    }
+  }
+  // Steal from the back of the other queues, furthest from where their
+  // owners are working.
+  for (std::size_t offset = 1; offset < thread_count_; ++offset) {
+    WorkQueue &victim = *queues_[(index + offset) % thread_count_];
+    std::lock_guard lock(victim.mutex);
+    if (!victim.chunks.empty()) {
+      chunk = victim.chunks.back();
+      victim.chunks.pop_back();
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace salsa
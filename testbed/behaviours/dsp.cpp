@@ -69,7 +69,7 @@ class DSPPoint {
 
 class DSPBehaviour final : public Behaviour {
  private:
-  std::vector<DSPPoint *> dspPoints;
+  std::vector<std::unique_ptr<DSPPoint>> dspPoints;
   float firstRun = true;
 
   struct DroneInfo {
@@ -84,46 +84,61 @@ class DSPBehaviour final : public Behaviour {
     float elapsedTimeSinceLastForce = 0.0f;
     float randomTimeInterval = 1.0f;
     b2Vec2 desiredVelocity{};
-
-    DroneInfo() : randomTimeInterval(generateRandomTimeInterval()) {}
   };
 
   std::unordered_map<Drone *, DroneInfo> droneInformation;
 
+  /// A point and its drone's information, as written by `saveState`.
+  struct SavedPoint {
+    uint64_t drone;
+    b2Vec2 position;
+    float angle;
+    b2Vec2 velocity;
+    float angularVelocity;
+    DroneInfo info;
+  };
+
  public:
   DSPBehaviour() = default;
 
+  std::unique_ptr<Behaviour> clone() const override {
+    return std::make_unique<DSPBehaviour>();
+  }
+
   void execute(const std::vector<std::unique_ptr<Drone>> &drones,
                Drone &currentDrone) override {
+    execute(drones, currentDrone, behaviour::Context(drones));
+  }
+
+  void execute(const std::vector<std::unique_ptr<Drone>> &drones,
+               Drone &currentDrone,
+               const behaviour::Context &context) override {
+    Rng &rng = context.rng(currentDrone);
     if (droneInformation.find(&currentDrone) == droneInformation.end()) {
-      droneInformation[&currentDrone] = DroneInfo();
-      auto *dsp = new DSPPoint(currentDrone.body()->GetWorld(),
-                                   currentDrone.position());
+      droneInformation[&currentDrone].randomTimeInterval =
+          generateRandomTimeInterval(rng);
+      auto *dsp = dspPoints
+                      .emplace_back(std::make_unique<DSPPoint>(
+                          currentDrone.body()->GetWorld(),
+                          currentDrone.position()))
+                      .get();
       dsp->recalc(drones.size());
       droneInformation[&currentDrone].dsp = dsp;
-      dspPoints.push_back(dsp);
     }
-    RayCastCallback callback;
-    performRayCasting(currentDrone, callback);
-    std::vector<b2Body *> bodies;
+    std::vector<b2Vec2> obstaclePoints;
+    findObstaclePoints(context, currentDrone, obstaclePoints);
     // collect DSP points from other drones
     DroneInfo &droneInfo = droneInformation[&currentDrone];
 
-    bodies.reserve(drones.size());
-for (auto &drone : drones) {
-      bodies.push_back(drone->body());
-    }
-    std::vector<b2Body *> neighbours = bodies;
-    std::vector<b2Vec2> obstaclePoints = callback.obstaclePoints;
     const b2Vec2 obstacleAvoidance = avoidObstacles(obstaclePoints, currentDrone);
-    const b2Vec2 neighbourAvoidance = avoidDrones(neighbours, currentDrone);
+    const b2Vec2 neighbourAvoidance = avoidDrones(context, currentDrone);
 
     b2Vec2 bspPos = droneInfo.dsp->body->GetPosition();
     b2Vec2 force(0.0f, 0.0f);
     float forceMag = 0.0f;
     b2Vec2 overallDir(0.0f, 0.0f);
     for (auto &point : dspPoints) {
-      if (point != droneInfo.dsp) {
+      if (point.get() != droneInfo.dsp) {
         b2Vec2 pointPos = point->body->GetPosition();
         const float forceMagnitude = droneInfo.dsp->gravDSPForce(bspPos, pointPos);
         b2Vec2 direction = directionTo(bspPos, pointPos);
@@ -166,7 +181,7 @@ for (auto &drone : drones) {
         if (droneInfo.elapsedTimeSinceLastForce >=
             droneInfo.randomTimeInterval) {
           // Change direction at regular intervals
-          const float angle = static_cast<float>(std::rand()) / RAND_MAX * 2 * M_PI;
+          const float angle = rng.uniform(0.0f, 2 * M_PI);
           droneInfo.desiredVelocity =
               b2Vec2(std::cos(angle) * currentDrone.max_speed(),
                      std::sin(angle) * currentDrone.max_speed());
@@ -174,7 +189,7 @@ for (auto &drone : drones) {
           droneInfo.elapsedTimeSinceLastForce =
               0.0f;  // Reset the timer for force update
           droneInfo.randomTimeInterval =
-              generateRandomTimeInterval();  // Next interval
+              generateRandomTimeInterval(rng);  // Next interval
         }
 
         droneInfo.elapsedTimeSinceLastForce += (1.0 / 30.0f);
@@ -206,10 +221,74 @@ for (auto &drone : drones) {
     }
     velocity = b2Vec2(dir.x * speed, dir.y * speed);
 
-    currentDrone.body()->SetLinearVelocity(velocity);
+    currentDrone.commandVelocity(velocity);
     acceleration.SetZero();
   }
 
+  void saveState(const std::vector<std::unique_ptr<Drone>> &drones,
+                 CheckpointWriter &out) const override {
+    // Each point belongs to one drone, which is saved as its index. The
+    // points are saved in order, as the forces between them are summed in
+    // that order.
+    std::unordered_map<const DSPPoint *, uint64_t> owners;
+    for (std::size_t i = 0; i < drones.size(); i++) {
+      const auto it = droneInformation.find(drones[i].get());
+      if (it != droneInformation.end()) {
+        owners[it->second.dsp] = i;
+      }
+    }
+    out.write<uint64_t>(dspPoints.size());
+    for (const auto &point : dspPoints) {
+      const uint64_t index = owners.at(point.get());
+      out.write(index);
+      out.write(point->body->GetPosition());
+      out.write(point->body->GetAngle());
+      out.write(point->body->GetLinearVelocity());
+      out.write(point->body->GetAngularVelocity());
+      const DroneInfo &info = droneInformation.at(drones[index].get());
+      out.write(info.isAtDSPPoint);
+      out.write(info.dspPoint);
+      out.write(info.beginWalk);
+      out.write(info.elapsedTime);
+      out.write(info.timeToWalk);
+      out.write(info.elapsedTimeSinceLastForce);
+      out.write(info.randomTimeInterval);
+      out.write(info.desiredVelocity);
+    }
+  }
+
+  void loadState(const std::vector<std::unique_ptr<Drone>> &drones,
+                 CheckpointReader &in) override {
+    clean(drones);
+    const auto count = in.read<uint64_t>();
+    for (uint64_t i = 0; i < count; i++) {
+      const SavedPoint saved = readPoint(drones, in);
+      Drone *drone = drones[saved.drone].get();
+      auto *dsp = dspPoints
+                      .emplace_back(std::make_unique<DSPPoint>(
+                          drone->body()->GetWorld(), saved.position))
+                      .get();
+      dsp->body->SetTransform(saved.position, saved.angle);
+      dsp->body->SetLinearVelocity(saved.velocity);
+      dsp->body->SetAngularVelocity(saved.angularVelocity);
+      dsp->recalc(drones.size());
+
+      DroneInfo &info = droneInformation[drone];
+      info = saved.info;
+      info.dsp = dsp;
+    }
+  }
+
+  // Reads the points without making their bodies, which would be left in the
+  // world.
+  void checkState(const std::vector<std::unique_ptr<Drone>> &drones,
+                  CheckpointReader &in) const override {
+    const auto count = in.read<uint64_t>();
+    for (uint64_t i = 0; i < count; i++) {
+      readPoint(drones, in);
+    }
+  }
+
   void clean(const std::vector<std::unique_ptr<Drone>> &drones) override {
     for (const auto &point : dspPoints) {
       b2World *world = point->body->GetWorld();
@@ -225,12 +304,33 @@ for (auto &drone : drones) {
     const b2Vec2 direction(cos(angle), sin(angle));
     return direction;
   }
-  static float generateRandomTimeInterval() {
-    return static_cast<float>(std::rand()) / RAND_MAX * 15.0f;
+  static SavedPoint readPoint(
+      const std::vector<std::unique_ptr<Drone>> &drones, CheckpointReader &in) {
+    SavedPoint saved;
+    saved.drone = in.read<uint64_t>();
+    if (saved.drone >= drones.size()) {
+      throw std::runtime_error("DSP point of a drone that is not there");
+    }
+    saved.position = in.read<b2Vec2>();
+    saved.angle = in.read<float>();
+    saved.velocity = in.read<b2Vec2>();
+    saved.angularVelocity = in.read<float>();
+    DroneInfo &info = saved.info;
+    info.isAtDSPPoint = in.read<bool>();
+    info.dspPoint = in.read<b2Vec2>();
+    info.beginWalk = in.read<bool>();
+    info.elapsedTime = in.read<float>();
+    info.timeToWalk = in.read<float>();
+    info.elapsedTimeSinceLastForce = in.read<float>();
+    info.randomTimeInterval = in.read<float>();
+    info.desiredVelocity = in.read<b2Vec2>();
+    return saved;
+  }
+  static float generateRandomTimeInterval(Rng &rng) {
+    return rng.uniform(0.0f, 15.0f);
   }
 };
 
-auto d = std::make_unique<DSPBehaviour>();
-auto dsp_behaviour =
-    behaviour::Registry::get().add("DSPBehaviour", std::move(d));
+auto dsp_behaviour = behaviour::Registry::get().add(
+    "DSPBehaviour", [] { return std::make_unique<DSPBehaviour>(); });
 }  // namespace salsa
\ No newline at end of file
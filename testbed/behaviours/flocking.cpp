@@ -45,13 +45,25 @@ class FlockingBehaviour final : public Behaviour {
 
   void execute(const std::vector<std::unique_ptr<Drone>> &drones,
                Drone &currentDrone) override {
-    // Using ray casting to find neighbours and obstacles
+    execute(drones, currentDrone, behaviour::Context(drones));
+  }
+
+  bool supportsParallelExecution() const override { return true; }
+
+  std::unique_ptr<Behaviour> clone() const override {
+    return std::make_unique<FlockingBehaviour>(
+        separation_distance_, alignment_weight_, cohesion_weight_,
+        separation_weight_, obstacle_avoidance_weight_);
+  }
+
+  void execute(const std::vector<std::unique_ptr<Drone>> &drones,
+               Drone &currentDrone,
+               const behaviour::Context &context) override {
     // DroneQueryCallback queryCallback;
     // b2AABB aabb = currentDrone.getViewSensor()->GetAABB(0);
     // currentDrone.body()->GetWorld()->QueryAABB(&queryCallback, aabb);
-    RayCastCallback callback;
-    performRayCasting(currentDrone, callback);
-    std::vector<b2Vec2> obstaclePoints = callback.obstaclePoints;
+    thread_local std::vector<b2Vec2> obstaclePoints;
+    findObstaclePoints(context, currentDrone, obstaclePoints);
     b2Vec2 alignSteering(0, 0);
     b2Vec2 cohereSteering(0, 0);
     b2Vec2 separateSteering(0, 0);
@@ -63,20 +75,26 @@ class FlockingBehaviour final : public Behaviour {
     const float currentMaxSpeed = currentDrone.max_speed();
     const float currentMaxForce = currentDrone.max_force();
 
-    for (auto &drone : drones) {
-      const b2Body *body = drone->body();
-      b2Vec2 bodyPos = body->GetPosition();
-      if (body == currentDrone.body()) {
-        continue;
-      }
-      const float distance = b2Distance(currentDrone.position(), bodyPos);
-      if (distance > currentDrone.drone_detection_range()) {
+    // Read neighbours from the per-step snapshot when there is one, rather
+    // than through each drone's body.
+    const DroneSnapshot *snapshot = context.snapshot();
+    const b2Vec2 currentPosition = currentDrone.position();
+    thread_local std::vector<int> nearby;
+    context.queryRadius(currentPosition, currentDrone.drone_detection_range(),
+                        nearby);
+    for (const int i : nearby) {
+      if (drones[i].get() == &currentDrone) {
         continue;
       }
-      alignAvgVec += body->GetLinearVelocity();
+      const b2Vec2 bodyPos =
+          snapshot ? snapshot->position(i) : drones[i]->position();
+      const b2Vec2 bodyVel =
+          snapshot ? snapshot->velocity(i) : drones[i]->velocity();
+      const float distance = b2Distance(currentPosition, bodyPos);
+      alignAvgVec += bodyVel;
       centreOfMass += bodyPos;
       if (distance < separation_distance_ && distance > 0) {
-        b2Vec2 diff = currentDrone.position() - bodyPos;
+        b2Vec2 diff = currentPosition - bodyPos;
         diff.Normalize();
         diff.x /= distance;
         diff.y /= distance;
@@ -139,7 +157,7 @@ class FlockingBehaviour final : public Behaviour {
     }
     velocity = b2Vec2(dir.x * speed, dir.y * speed);
 
-    currentDrone.body()->SetLinearVelocity(velocity);
+    currentDrone.commandVelocity(velocity);
     acceleration.SetZero();
   }
 
@@ -225,7 +243,7 @@ class FlockingBehaviour final : public Behaviour {
   }
 };
 
-auto flocking = behaviour::Registry::get().add(
-    "Flocking",
-    std::make_unique<salsa::FlockingBehaviour>(250.0, 1.6, 1.0, 3.0, 4.0));
+auto flocking = behaviour::Registry::get().add("Flocking", [] {
+  return std::make_unique<salsa::FlockingBehaviour>(250.0, 1.6, 1.0, 3.0, 4.0);
+});
 }  // namespace salsa
\ No newline at end of file
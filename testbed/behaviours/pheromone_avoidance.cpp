@@ -2,71 +2,100 @@
 #include <box2d/box2d.h>
 #include <salsa/salsa.h>
 
-#include <map>
+#include <algorithm>
 #include <memory>
-#include <unordered_map>
+#include <vector>
+
 namespace salsa {
+/// Drones steer away from the pheromone laid by the swarm, which they lay
+/// wherever they go, so they spread out over ground not yet covered.
+///
+/// The pheromone is kept on a `PheromoneGrid` shared by the drones. "Decay
+/// Rate" is the percentage of pheromone lost per step, and "Diffusion Rate"
+/// how much of each cell spreads to its neighbours per step, if any.
 class PheromoneBehaviour final : public Behaviour {
  private:
-  struct Pheromone {
-    b2Vec2 position;
-    float intensity;
-  };
+  /// Pheromone laid by a drone each step.
+  static constexpr float kDeposit = 500.0f;
+  /// Cells across a drone's obstacle view range, which keeps a query to a
+  /// few dozen cells whatever the range.
+  static constexpr float kCellsPerRange = 4.0f;
 
-  std::map<int, Pheromone> pheromones;
-  int pheromoneCount = 0;
+  PheromoneGrid pheromones_;
   behaviour::Parameter decay_rate_;
   behaviour::Parameter obstacle_avoidance_weight_;
+  behaviour::Parameter diffusion_rate_;
 
  public:
-  PheromoneBehaviour(const float decayRate, const float obstacleAvoidanceWeight)
+  PheromoneBehaviour(const float decayRate, const float obstacleAvoidanceWeight,
+                     const float diffusionRate = 0.0f)
       : decay_rate_(decayRate, 0.0f, 50.0f),
-        obstacle_avoidance_weight_(obstacleAvoidanceWeight, 0.0f, 3.0f) {
+        obstacle_avoidance_weight_(obstacleAvoidanceWeight, 0.0f, 3.0f),
+        diffusion_rate_(diffusionRate, 0.0f, 1.0f) {
     // Register parameters in the map
     parameters_["Decay Rate"] = &decay_rate_;
     parameters_["Obstacle Avoidance Weight"] = &obstacle_avoidance_weight_;
+    parameters_["Diffusion Rate"] = &diffusion_rate_;
   }
 
-  void execute(const std::vector<std::unique_ptr<Drone>> &drones,
-               Drone &currentDrone) override {
-    // Perform ray casting to detect nearby drones and obstacles
-    RayCastCallback callback;
-    performRayCasting(currentDrone, callback);
+  std::unique_ptr<Behaviour> clone() const override {
+    return std::make_unique<PheromoneBehaviour>(
+        decay_rate_, obstacle_avoidance_weight_, diffusion_rate_);
+  }
 
-    std::vector<b2Vec2> obstaclePoints = callback.obstaclePoints;
-    std::vector<b2Body *> neighbours = callback.detectedDrones;
+  void clean(const std::vector<std::unique_ptr<Drone>> &drones) override {
+    pheromones_.clear();
+  }
 
-    layPheromone(currentDrone.position());
+  void saveState(const std::vector<std::unique_ptr<Drone>> &drones,
+                 CheckpointWriter &out) const override {
+    pheromones_.save(out);
+  }
 
-    updatePheromones();
-    b2Vec2 steering = obstacle_avoidance_weight_ *
-                      avoidObstacles(obstaclePoints, currentDrone);
+  void loadState(const std::vector<std::unique_ptr<Drone>> &drones,
+                 CheckpointReader &in) override {
+    pheromones_.load(in);
+  }
 
-    b2Vec2 avoidanceSteering(0, 0);
-    int32 count = 0;
-    // const auto & [fst, snd] : chosen_params
-    for (auto& [fst, snd] : pheromones) {
-      auto & [position, intensity] = snd;
+  /// Moves the pheromone's clock on a step, and spreads it if asked to.
+  void beginStep(const behaviour::Context &context) override {
+    if (pheromones_.empty() && !context.drones().empty()) {
+      pheromones_.reset(std::max(
+          context.drones().front()->obstacle_view_range() / kCellsPerRange,
+          0.5f));
+    }
+    pheromones_.setDecay(decay_rate_ / 100.0f);
+    pheromones_.advance();
+    pheromones_.diffuse(diffusion_rate_);
+  }
 
-      if (const float distance = b2Distance(currentDrone.position(), position); distance < currentDrone.obstacle_view_range() && distance > 0) {
-        b2Vec2 awayFromPheromone = currentDrone.position() - position;
-        awayFromPheromone.Normalize();
+  void execute(const std::vector<std::unique_ptr<Drone>> &drones,
+               Drone &currentDrone) override {
+    execute(drones, currentDrone, behaviour::Context(drones));
+  }
 
-        awayFromPheromone *= (1.0f / (distance)) * intensity;
+  void execute(const std::vector<std::unique_ptr<Drone>> &drones,
+               Drone &currentDrone,
+               const behaviour::Context &context) override {
+    // Detect nearby obstacles
+    std::vector<b2Vec2> obstaclePoints;
+    findObstaclePoints(context, currentDrone, obstaclePoints);
 
-        avoidanceSteering += awayFromPheromone;
-        count++;
-      }
-    }
-    if (count > 0) {
-      avoidanceSteering.x /= count;
-      avoidanceSteering.y /= count;
+    b2Vec2 steering = obstacle_avoidance_weight_ *
+                      avoidObstacles(obstaclePoints, currentDrone);
+
+    // Only the cells within view are read, however much pheromone the swarm
+    // has laid.
+    b2Vec2 avoidanceSteering = -pheromones_.gradient(
+        currentDrone.position(), currentDrone.obstacle_view_range());
+    if (avoidanceSteering.LengthSquared() > 0.0f) {
       avoidanceSteering.Normalize();
       avoidanceSteering *= currentDrone.max_speed();
 
       steering += avoidanceSteering - currentDrone.velocity();
       clampMagnitude(steering, currentDrone.max_force());
     }
+    pheromones_.deposit(currentDrone.position(), kDeposit);
 
     b2Vec2 acceleration =
         steering + (obstacle_avoidance_weight_ *
@@ -86,29 +115,12 @@ class PheromoneBehaviour final : public Behaviour {
     }
     velocity = b2Vec2(dir.x * speed, dir.y * speed);
 
-    currentDrone.body()->SetLinearVelocity(velocity);
+    currentDrone.commandVelocity(velocity);
     acceleration.SetZero();
   }
-
- private:
-  void updatePheromones() {
-    for (auto it = pheromones.begin(); it != pheromones.end();) {
-      it->second.intensity -= decay_rate_;
-      if (it->second.intensity <= 0) {
-        it = pheromones.erase(it);
-      } else {
-        ++it;
-      }
-    }
-  }
-  void layPheromone(const b2Vec2 &position) {
-    Pheromone pheromone = {position, 500.0f};
-    pheromones[pheromoneCount++] = pheromone;
-  }
 };
 
-auto p = std::make_unique<salsa::PheromoneBehaviour>(0.5f, 1.0f);
-
-auto pheromone =
-    behaviour::Registry::get().add("Pheromone Avoidance", std::move(p));
+auto pheromone = behaviour::Registry::get().add("Pheromone Avoidance", [] {
+  return std::make_unique<salsa::PheromoneBehaviour>(0.5f, 1.0f);
+});
 }  // namespace salsa
\ No newline at end of file
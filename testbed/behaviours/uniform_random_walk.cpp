@@ -2,8 +2,6 @@
 #include <salsa/salsa.h>
 
 #include <cmath>
-#include <cstdlib>
-#include <ctime>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -19,10 +17,8 @@ class UniformRandomWalkBehaviour final : public Behaviour {
   behaviour::Parameter delta_time_{1.0f / 60.0f, 0.0f, 1.0f};
   struct DroneTimerInfo {
     float elapsedTimeSinceLastForce = 0.0f;
-    float randomTimeInterval;
-    b2Vec2 desiredVelocity;
-
-    DroneTimerInfo() : randomTimeInterval(generateRandomTimeInterval()),desiredVelocity() {}
+    float randomTimeInterval = 0.0f;
+    b2Vec2 desiredVelocity{};
   };
 
   std::unordered_map<Drone *, DroneTimerInfo> droneTimers;
@@ -36,33 +32,77 @@ class UniformRandomWalkBehaviour final : public Behaviour {
     parameters_["Max Magnitude"] = &max_magnitude_;
     parameters_["Force Weight"] = &force_weight_;
     parameters_["Obstacle Avoidance Weight"] = &obstacle_avoidance_weight_;
-    std::srand(std::time(nullptr));
   }
 
   ~UniformRandomWalkBehaviour() override = default;
 
+  std::unique_ptr<Behaviour> clone() const override {
+    return std::make_unique<UniformRandomWalkBehaviour>(
+        max_magnitude_, force_weight_, obstacle_avoidance_weight_);
+  }
+
+  void clean(const std::vector<std::unique_ptr<Drone>> &drones) override {
+    droneTimers.clear();
+  }
+
+  void saveState(const std::vector<std::unique_ptr<Drone>> &drones,
+                 CheckpointWriter &out) const override {
+    // Timers are keyed by drone, which is saved as its index.
+    std::vector<std::pair<uint64_t, const DroneTimerInfo *>> timers;
+    for (std::size_t i = 0; i < drones.size(); i++) {
+      const auto it = droneTimers.find(drones[i].get());
+      if (it != droneTimers.end()) {
+        timers.emplace_back(i, &it->second);
+      }
+    }
+    out.write<uint64_t>(timers.size());
+    for (const auto &[index, timer] : timers) {
+      out.write(index);
+      out.write(timer->elapsedTimeSinceLastForce);
+      out.write(timer->randomTimeInterval);
+      out.write(timer->desiredVelocity);
+    }
+  }
+
+  void loadState(const std::vector<std::unique_ptr<Drone>> &drones,
+                 CheckpointReader &in) override {
+    const auto count = in.read<uint64_t>();
+    for (uint64_t i = 0; i < count; i++) {
+      const auto index = in.read<uint64_t>();
+      DroneTimerInfo &timer = droneTimers[drones.at(index).get()];
+      timer.elapsedTimeSinceLastForce = in.read<float>();
+      timer.randomTimeInterval = in.read<float>();
+      timer.desiredVelocity = in.read<b2Vec2>();
+    }
+  }
+
   void execute(const std::vector<std::unique_ptr<Drone>> &drones,
                Drone &currentDrone) override {
+    execute(drones, currentDrone, behaviour::Context(drones));
+  }
+
+  void execute(const std::vector<std::unique_ptr<Drone>> &drones,
+               Drone &currentDrone,
+               const behaviour::Context &context) override {
+    Rng &rng = context.rng(currentDrone);
     if (!droneTimers.contains(&currentDrone)  ) {
-      droneTimers[&currentDrone] = DroneTimerInfo();
-      droneTimers[&currentDrone].desiredVelocity = currentDrone.velocity();
+      DroneTimerInfo &timer = droneTimers[&currentDrone];
+      timer.randomTimeInterval = generateRandomTimeInterval(rng);
+      timer.desiredVelocity = currentDrone.velocity();
     }
-    RayCastCallback callback;
-    performRayCasting(currentDrone, callback);
-
-    std::vector<b2Vec2> obstaclePoints = callback.obstaclePoints;
-    std::vector<b2Body *> neighbours = callback.detectedDrones;
+    std::vector<b2Vec2> obstaclePoints;
+    findObstaclePoints(context, currentDrone, obstaclePoints);
 
     DroneTimerInfo &timerInfo = droneTimers[&currentDrone];
     timerInfo.elapsedTimeSinceLastForce += delta_time_;
     auto  force = b2Vec2(0, 0);
     auto  steer = b2Vec2(0, 0);
     const b2Vec2 obstacleAvoidance = avoidObstacles(obstaclePoints, currentDrone);
-    const b2Vec2 neighbourAvoidance = avoidDrones(neighbours, currentDrone);
+    const b2Vec2 neighbourAvoidance = avoidDrones(context, currentDrone);
 
     // Check if it's time to apply a new random force
     if (timerInfo.elapsedTimeSinceLastForce >= timerInfo.randomTimeInterval) {
-      const float angle = static_cast<float>(std::rand()) / RAND_MAX * 2 * M_PI;
+      const float angle = rng.uniform(0.0f, 2 * M_PI);
 
       // New desired velocity based on random angle
       timerInfo.desiredVelocity =
@@ -71,7 +111,7 @@ class UniformRandomWalkBehaviour final : public Behaviour {
 
       // Reset the timer and generate a new random time interval for this drone
       timerInfo.elapsedTimeSinceLastForce = 0.0f;
-      timerInfo.randomTimeInterval = generateRandomTimeInterval();
+      timerInfo.randomTimeInterval = generateRandomTimeInterval(rng);
     }
 
     steer = timerInfo.desiredVelocity - currentDrone.velocity();
@@ -95,18 +135,18 @@ class UniformRandomWalkBehaviour final : public Behaviour {
     }
     velocity = b2Vec2(dir.x * speed, dir.y * speed);
 
-    currentDrone.body()->SetLinearVelocity(velocity);
+    currentDrone.commandVelocity(velocity);
   }
 
  private:
-  static float generateRandomTimeInterval() {
-    return static_cast<float>(std::rand()) / RAND_MAX * 5.0f;
+  static float generateRandomTimeInterval(Rng &rng) {
+    return rng.uniform(0.0f, 5.0f);
   }
 };
 
-auto uniform_random_walk =
-    std::make_unique<salsa::UniformRandomWalkBehaviour>(10.0f, 1.0f, 1.0f);
-
-auto uniform_random_walk_behaviour = behaviour::Registry::get().add(
-    "Uniform Random Walk", std::move(uniform_random_walk));
+auto uniform_random_walk_behaviour =
+    behaviour::Registry::get().add("Uniform Random Walk", [] {
+      return std::make_unique<salsa::UniformRandomWalkBehaviour>(10.0f, 1.0f,
+                                                                 1.0f);
+    });
 }  // namespace salsa
\ No newline at end of file
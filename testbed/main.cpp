@@ -17,6 +17,18 @@ int main(int argc, char** argv) {
   bool verbose = false;
   bool no_plots = false;
   std::string queue_path = "none";
+  int threads = -1;
+  int jobs = 1;
+  float checkpoint_interval = 0.0f;
+  int trace_steps = 0;
+  bool hardware_counters = false;
+  float memory_budget_mb = 0.0f;
+  bool scaling = false;
+  std::string sweep_path;
+  std::string scaling_report_path = "scaling_report.json";
+  std::string baseline_path;
+  bool update_baseline = false;
+  salsa::ScalingTolerance tolerance;
 
   app.add_flag("--headless", headless, "Run in headless mode");
   app.add_flag("-v,--verbose", verbose, "Verbose output")->needs("--headless");
@@ -24,6 +36,62 @@ int main(int argc, char** argv) {
       ->needs("--headless");
   app.add_option("-q,--queue", queue_path, "Path to the queue file")
       ->needs("--headless");
+  app.add_option("-j,--threads", threads,
+                 "Threads per simulation step (0 for one per core), overrides "
+                 "the queue file")
+      ->check(CLI::NonNegativeNumber)
+      ->needs("--headless");
+  app.add_option("-J,--jobs", jobs,
+                 "Tests to run at once (0 for one per core)")
+      ->check(CLI::NonNegativeNumber)
+      ->needs("--headless");
+  app.add_option("--checkpoint-interval", checkpoint_interval,
+                 "Simulated seconds between checkpoints of each test (0 for "
+                 "none); unfinished tests resume from their last checkpoint")
+      ->check(CLI::NonNegativeNumber)
+      ->needs("--headless");
+  app.add_option("--trace-steps", trace_steps,
+                 "Write a Chrome trace of the last N steps of each test next "
+                 "to its log (0 for none), overrides the queue file")
+      ->check(CLI::NonNegativeNumber)
+      ->needs("--headless");
+  app.add_flag("--perf-counters", hardware_counters,
+               "Count cycles, instructions, cache and branch misses in the "
+               "world step and behaviours of each test, where perf allows it")
+      ->needs("--headless");
+  app.add_option("--memory-budget", memory_budget_mb,
+                 "Megabytes the tests running at once may use between them "
+                 "(0 for no limit)")
+      ->check(CLI::NonNegativeNumber)
+      ->needs("--headless");
+  app.add_flag("--scaling", scaling,
+               "Run the scaling suite instead of a queue, sweeping drone and "
+               "target counts over each behaviour and map")
+      ->needs("--headless");
+  app.add_option("--sweep", sweep_path,
+                 "Sweep file for the scaling suite (default: the built-in "
+                 "sweep)")
+      ->needs("--scaling");
+  app.add_option("--scaling-report", scaling_report_path,
+                 "Where to write the scaling report")
+      ->needs("--scaling");
+  app.add_option("--baseline", baseline_path,
+                 "Scaling report to compare with; exits with 1 on a "
+                 "regression")
+      ->needs("--scaling");
+  app.add_flag("--update-baseline", update_baseline,
+               "Keep this run's scaling report as the baseline")
+      ->needs("--baseline");
+  app.add_option("--tolerance", tolerance.time,
+                 "Fraction the RTF and step times may grow by before they "
+                 "count as a regression")
+      ->check(CLI::NonNegativeNumber)
+      ->needs("--baseline");
+  app.add_option("--memory-tolerance", tolerance.memory,
+                 "Fraction the peak memory may grow by before it counts as a "
+                 "regression")
+      ->check(CLI::NonNegativeNumber)
+      ->needs("--baseline");
   CLI11_PARSE(app, argc, argv);
 
   const auto testbed_console = spdlog::stdout_color_mt("testbed_console");
@@ -33,6 +101,15 @@ int main(int argc, char** argv) {
 
   salsa::map::loadAll();
   testbed::init_python();
+  if (headless && scaling) {
+    testbed::user();
+    testbed_console->set_level(spdlog::level::warn);
+    const int status =
+        testbed::run_scaling(sweep_path, scaling_report_path, baseline_path,
+                             tolerance, update_baseline, jobs);
+    testbed::finalize_python();
+    return status;
+  }
   if (headless) {
     // Run in headless mode
     testbed::user();
@@ -55,7 +132,9 @@ int main(int argc, char** argv) {
       testbed::plot_drone_trace = true;
       testbed::plot_targets_found = true;
     }
-    testbed::run_headless(verbose, queue_path);
+    testbed::run_headless(verbose, queue_path, threads, jobs,
+                          checkpoint_interval, trace_steps, hardware_counters,
+                          memory_budget_mb);
   } else {
     testbed::user();
     testbed::run();
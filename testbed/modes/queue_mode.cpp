@@ -73,6 +73,15 @@ class QueueSimulator final : public Test {
     auto behaviour_names = registry.behaviour_names();
     sim->setCurrentBehaviour(behaviour_names[0]);
   }
+  ~QueueSimulator() override {
+    // A world the simulation owns goes with it, so it is not deleted again
+    // with the test.
+    if (sim->ownsWorld()) {
+      m_world = nullptr;
+    }
+    delete sim;
+  }
+
   static std::unique_ptr<Test> Create() {
     return std::make_unique<QueueSimulator>();
   }
@@ -91,13 +100,18 @@ class QueueSimulator final : public Test {
 
   bool SetNextTestFromQueue() {
     auto config = salsa::TestQueue::pop();
-    const auto temp_sim = new salsa::Sim(config);
-    const auto old_sim = sim;
-    sim = temp_sim;
-    if (const std::string current_log_file = old_sim->getCurrentLogFile(); !current_log_file.empty() && !skipped_test)
-      testbed::plot(current_log_file);
-    delete old_sim;
-    sim->setCurrentBehaviour(sim->current_behaviour_name());
+    const std::string current_log_file = sim->getCurrentLogFile();
+    if (current_log_file.empty()) {
+      // The placeholder Sim made at start up has no test to carry on from.
+      const auto old_sim = sim;
+      sim = new salsa::Sim(config);
+      delete old_sim;
+    } else {
+      // Keeps the world when the next test is on the same map. Starting the
+      // next test's log finishes this one, so plot afterwards.
+      sim->reconfigure(config);
+      if (!skipped_test) testbed::plot(current_log_file);
+    }
     m_world = sim->getWorld();
 
     g_camera.m_center = sim->getMap().drone_spawn_point;
@@ -107,7 +121,7 @@ class QueueSimulator final : public Test {
     skipped_test = false;
     target_positions_.clear();
     target_colors_.clear();
-    const auto targets = sim->getTargets();
+    const auto &targets = sim->getTargets();
     const int size = targets.size();
     target_positions_.reserve(size);
     target_colors_.reserve(size);
@@ -189,7 +203,9 @@ class QueueSimulator final : public Test {
   }
 
   void Step(Settings &settings) override {
-    // Run simulation steps here
+    // Run simulation steps here. The world is stepped here as well as by the
+    // simulation, so its memory goes to the simulation either way.
+    const auto memory = sim->memoryScope();
     Test::Step(settings);
     pause = settings.m_pause;
     const std::vector<int> foundIds;
@@ -197,8 +213,8 @@ class QueueSimulator final : public Test {
       if (!pause) sim->update();
     }
 
-    for (const auto &target : sim->getTargetsFoundThisStep()) {
-      target_colors_[target->id()] = trueColour;
+    for (const int id : sim->getTargetIdsFoundThisStep()) {
+      target_colors_[id] = trueColour;
     }
     if (queue_empty) {
       pause = true;
@@ -73,6 +73,15 @@ public:
     // m_world->SetContactListener(contactListener_);
   }
 
+  ~SandboxSimulator() override {
+    // A world the simulation owns goes with it, so it is not deleted again
+    // with the test.
+    if (sim->ownsWorld()) {
+      m_world = nullptr;
+    }
+    delete sim;
+  }
+
   static std::unique_ptr<Test> Create() {
     return std::make_unique<SandboxSimulator>();
   }
@@ -91,11 +100,7 @@ public:
 
   bool SetNextTestFromQueue() {
     auto config = salsa::TestQueue::pop();
-    const auto temp_sim = new salsa::Sim(config);
-    const auto old_sim = sim;
-    sim = temp_sim;
-    delete old_sim;
-    sim->setCurrentBehaviour(sim->current_behaviour_name());
+    sim->reconfigure(config);
     m_world = sim->getWorld();
     pause = false;
     return true;
@@ -133,7 +138,9 @@ public:
   }
 
   void Step(Settings& settings) override {
-    // Run simulation steps here
+    // Run simulation steps here. The world is stepped here as well as by the
+    // simulation, so its memory goes to the simulation either way.
+    const auto memory = sim->memoryScope();
     Test::Step(settings);
     const float timeStep =
         settings.m_hertz > 0.0f ? 1.0f / settings.m_hertz : 0.0f;
@@ -6,6 +6,7 @@ import numpy as np
 from scipy.spatial import distance_matrix
 import os
 import json
+import struct
 
 matplotlib.use("Agg")
 
@@ -76,6 +77,44 @@ def set_output_path(path: str):
     output_path = path
 
 
+# Layout of the trajectory files written by salsa::TrajectoryWriter, see
+# include/salsa/core/data/trajectory.h.
+TRAJECTORY_MAGIC = b"SALSATRJ"
+TRAJECTORY_HEADER = struct.Struct("<8sIIQQ")
+TRAJECTORY_RECORD = np.dtype(
+    [
+        ("time", "<f4"),
+        ("id", "<i4"),
+        ("x", "<f4"),
+        ("y", "<f4"),
+        ("vx", "<f4"),
+        ("vy", "<f4"),
+    ]
+)
+
+
+def read_trajectory(file_path: str) -> np.memmap:
+    """Maps the records of a trajectory file without reading them."""
+    with open(file_path, "rb") as file:
+        magic, version, record_size, _, records_offset = TRAJECTORY_HEADER.unpack(
+            file.read(TRAJECTORY_HEADER.size)
+        )
+    if magic != TRAJECTORY_MAGIC or version != 1:
+        raise ValueError(f"{file_path} is not a trajectory file")
+    if record_size != TRAJECTORY_RECORD.itemsize:
+        raise ValueError(f"{file_path} has records of {record_size} bytes")
+    count = (os.path.getsize(file_path) - records_offset) // record_size
+    if count == 0:
+        return np.zeros(0, dtype=TRAJECTORY_RECORD)
+    return np.memmap(
+        file_path,
+        dtype=TRAJECTORY_RECORD,
+        mode="r",
+        offset=records_offset,
+        shape=(count,),
+    )
+
+
 def create_dataframe(file_path: str) -> pd.DataFrame:
     global df
 
@@ -83,6 +122,38 @@ def create_dataframe(file_path: str) -> pd.DataFrame:
     with open(file_path, "r") as file:
         data = file.read()
 
+    # Drone samples are in the trajectory file next to the log. Logs written
+    # before the trajectory format still have them inline.
+    trajectory_path = os.path.splitext(file_path)[0] + ".trj"
+    if os.path.exists(trajectory_path):
+        samples = read_trajectory(trajectory_path)
+        drones = pd.DataFrame(
+            {
+                "timestamp": samples["time"].astype(float),
+                "drone_id": samples["id"],
+                "position_x": samples["x"].astype(float),
+                "position_y": samples["y"].astype(float),
+                "velocity_x": samples["vx"].astype(float),
+                "velocity_y": samples["vy"].astype(float),
+                "targets_found": None,
+            }
+        )
+        pattern = re.compile(r'\[(\d+\.?\d*)\] \[Sim 0\] {"targets_found":(\d+)}')
+        matches = pattern.findall(data)
+        targets = pd.DataFrame(
+            {
+                "timestamp": [float(match[0]) for match in matches],
+                "drone_id": None,
+                "position_x": None,
+                "position_y": None,
+                "velocity_x": None,
+                "velocity_y": None,
+                "targets_found": [int(match[1]) for match in matches],
+            }
+        )
+        df = pd.concat([drones, targets], ignore_index=True)
+        return df
+
     pattern = re.compile(
         r'\[(\d+\.\d+)\] \[salsa::Drone (\d+)\] {"position":\[(.*?),(.*?)\],"velocity":\[(.*?),(.*?)\]}'
         r'|\[(\d+\.\d+)\] \[Sim 0\] {"targets_found":(\d+)}'
@@ -12,6 +12,12 @@ Tree::Tree(b2World *world, const b2Vec2 &position, int treeID, bool diseased,
       diseased(diseased),
       mapped(mapped),
       radius(radius) {
+  id_ = treeID;
+  // Trees kept in a salsa::TargetStore have no body, and are detected
+  // without a sensor.
+  if (!body_) {
+    return;
+  }
   // Create the sensor for the tree Target.
   b2CircleShape shape;
   shape.m_radius = radius_;
@@ -24,12 +30,8 @@ Tree::Tree(b2World *world, const b2Vec2 &position, int treeID, bool diseased,
   fixtureDef.filter.categoryBits = config.categoryBits;
   fixtureDef.filter.maskBits = config.maskBits;
 
-  salsa::UserData *userData = new salsa::UserData();
-  userData->object = this;
-
-  fixtureDef.userData.pointer = reinterpret_cast<uintptr_t>(userData);
+  fixtureDef.userData.pointer = reinterpret_cast<uintptr_t>(&user_data_);
   body_->CreateFixture(&fixtureDef);
-  id_ = treeID;
 }
 
 Tree::~Tree() {}
\ No newline at end of file
@@ -28,6 +28,9 @@
 
 #include <algorithm>
 #include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
 #include <thread>
 
 #include "backends/imgui_impl_glfw.h"
@@ -471,97 +474,106 @@ static void UpdateUI() {
   }
 }
 
-int run_headless(bool verbose, std::string queue_path) {
+int run_headless(bool verbose, std::string queue_path, int threads,
+                 int jobs, float checkpoint_interval, int trace_steps,
+                 bool hardware_counters, float memory_budget_mb) {
   s_settings.Load();
 
   s_settings.m_testIndex = b2Clamp(s_settings.m_testIndex, 0, g_testCount - 1);
   s_testSelection = s_settings.m_testIndex;
   s_test = std::move(g_testEntries[s_settings.m_testIndex].instance());
-  b2World *world;
   salsa::TestConfig test = salsa::TestQueue::pop();
   salsa::TestQueue::push(test);
 
-  bool init_testbed = true;
-  salsa::Sim *sim;
-  int count = 0;
-  int original_size = salsa::TestQueue::size();
-  while (salsa::TestQueue::size() > 0) {
-    try {
-      auto test = salsa::TestQueue::pop();
-      auto temp_sim = new salsa::Sim(test);
-      if (temp_sim == nullptr) {
-        return false;
-      }
-      if (init_testbed) {
-        init_testbed = false;
-        sim = temp_sim;
-        sim->setCurrentBehaviour(sim->current_behaviour_name());
-        world = sim->getWorld();
-      } else {
-        auto old_sim = sim;
-        sim = temp_sim;
-        delete old_sim;
-        sim->setCurrentBehaviour(sim->current_behaviour_name());
-        world = sim->getWorld();
-      }
-      std::cout << "(" << count << "/" << original_size << ")"
-                << " Running test: " << test.behaviour_name << std::endl;
-      std::cout << "Drones: " << test.num_drones
-                << " Targets: " << test.num_targets << std::endl;
-      bool first_run = true;
-      auto totalStart = std::chrono::high_resolution_clock::now();
-      auto updateStart = std::chrono::steady_clock::now();
-
-      while (sim->current_time() < test.time_limit) {
-        world->Step(1 / 60.0f, 8, 3);
-        sim->update();
-        sim->current_time() += (1.0f / 60.0f) * 1.0f;
-
-        // Display Progress
-        auto now = std::chrono::steady_clock::now();
-        auto elapsed =
-            std::chrono::duration_cast<std::chrono::seconds>(now - updateStart)
-                .count();
-        if (verbose && (elapsed >= 3 || first_run ||
-                        sim->current_time() >= test.time_limit)) {
-          updateStart = now;
-          const int cTotalLength = 20;
-          float lProgress = sim->current_time() / test.time_limit;
-          std::cout << "\r" << std::string(cTotalLength + 10, ' ') << "\r";
-          std::cout << "[" << std::string(int(cTotalLength * lProgress), '#')
-                    << std::string(int(cTotalLength * (1 - lProgress)), '-')
-                    << "] " << std::setprecision(3) << 100 * lProgress << "%"
-                    << std::flush;
-          std::cout << "\t" << sim->current_time() << "s / " << test.time_limit
-                    << "s" << std::endl;
-          first_run = false;
-        }
-      }
+  std::vector<salsa::TestConfig> tests;
+  while (!salsa::TestQueue::isEmpty()) {
+    auto next = salsa::TestQueue::pop();
+    if (threads >= 0) {
+      next.num_threads = threads;
+    }
+    if (trace_steps > 0) {
+      next.trace_steps = trace_steps;
+    }
+    if (hardware_counters) {
+      next.hardware_counters = true;
+    }
+    tests.push_back(next);
+  }
 
-      auto totalEnd = std::chrono::high_resolution_clock::now();
-      std::chrono::duration<double, std::milli> totalDuration =
-          totalEnd - totalStart;
-      double time_limit_milliseconds =
-          static_cast<double>(test.time_limit * 1000.0);
-      double time_taken_milliseconds = totalDuration.count();
-      std::cout << "Time taken: " << time_taken_milliseconds << "ms"
-                << " Time limit: " << time_limit_milliseconds << "ms"
+  salsa::TestExecutor executor(jobs);
+  executor.setProgressInterval(3000.0);
+  executor.setCheckpointInterval(checkpoint_interval);
+  executor.setMemoryBudget(
+      static_cast<std::size_t>(memory_budget_mb * 1024.0f * 1024.0f));
+  // Tests resumed from a checkpoint start part of the way through, so the
+  // first report of each test is told apart by its index.
+  std::vector<bool> started(tests.size(), false);
+  executor.onProgress([&](const salsa::TestExecutor::Progress &progress) {
+    const salsa::TestConfig &config = progress.config;
+    if (!started[progress.index] && !progress.finished) {
+      started[progress.index] = true;
+      std::cout << "(" << progress.index << "/" << progress.total << ")"
+                << " Running test: " << config.behaviour_name << std::endl;
+      std::cout << "Drones: " << config.num_drones
+                << " Targets: " << config.num_targets << std::endl;
+    }
+    if (verbose) {
+      // Display Progress
+      const int cTotalLength = 20;
+      float lProgress = progress.fraction();
+      std::cout << "(" << progress.index << "/" << progress.total << ") ";
+      std::cout << "[" << std::string(int(cTotalLength * lProgress), '#')
+                << std::string(int(cTotalLength * (1 - lProgress)), '-')
+                << "] " << std::setprecision(3) << 100 * lProgress << "%";
+      std::cout << "\t" << progress.sim_time << "s / " << config.time_limit
+                << "s" << std::endl;
+    }
+  });
+
+  // Results come back in queue order, so the plots and the RTF file are
+  // written in the same order as when the tests ran one at a time.
+  for (const auto &result : executor.run(tests)) {
+    if (!result.ok()) {
+      spdlog::error("Error: {}", result.error);
+      std::cerr << result.error << std::endl;
+      continue;
+    }
+    const salsa::TestConfig &config = result.config;
+    double time_limit_milliseconds =
+        static_cast<double>(config.time_limit * 1000.0);
+    double time_taken_milliseconds = result.run.wall_time_ms;
+    std::cout << "Time taken: " << time_taken_milliseconds << "ms"
+              << " Time limit: " << time_limit_milliseconds << "ms"
+              << std::endl;
+    double ratio = result.run.rtf();
+
+    std::cout << std::endl;
+    std::cout << "Finished test " << config.behaviour_name << " ";
+    std::cout << "(RTF: " << ratio << ")" << std::endl;
+    const salsa::MemoryReport &memory = result.memory;
+    std::cout << "Memory: " << memory.peakBytes() / (1024.0 * 1024.0)
+              << " MB peak, " << memory.bytes() / (1024.0 * 1024.0)
+              << " MB at the end (" << memory.bytesPerDrone() / 1024.0
+              << " KB per drone, " << memory.bytesPerTarget() / 1024.0
+              << " KB per target, " << memory.mapBytes() / (1024.0 * 1024.0)
+              << " MB for the map)" << std::endl;
+    if (config.hardware_counters) {
+      std::cout << "Hardware counters over " << result.counters.steps
+                << " steps:" << std::endl
+                << result.counters.table();
+    }
+    if (result.resumed_at > 0.0f) {
+      std::cout << "Resumed from a checkpoint at " << result.resumed_at << "s"
                 << std::endl;
-      // Calculate the ratio of time taken to the time limit
-      double ratio = time_taken_milliseconds / time_limit_milliseconds;
-
-      std::cout << std::endl;
-      std::cout << "Finished test " << test.behaviour_name << " ";
-      std::cout << "(RTF: " << ratio << ")" << std::endl;
-      if (verbose) {
-        testbed::add_rtf_to_csv(queue_path, test.num_drones, test.num_targets,
-                                ratio);
-      }
-      testbed::plot(sim->getCurrentLogFile());
-    } catch (const std::exception &e) {
-      spdlog::error("Error: {}", e.what());
-      std::cerr << e.what() << std::endl;
     }
+    std::cout << "Step profile over " << result.profile.steps()
+              << " steps:" << std::endl
+              << result.profile.table() << std::endl;
+    if (verbose) {
+      testbed::add_rtf_to_csv(queue_path, config.num_drones,
+                              config.num_targets, ratio);
+    }
+    testbed::plot(result.log_file);
   }
 
   s_test = nullptr;
@@ -571,6 +583,68 @@ int run_headless(bool verbose, std::string queue_path) {
   return 0;
 }
 
+int run_scaling(const std::string &sweep_path, const std::string &report_path,
+                const std::string &baseline_path,
+                const salsa::ScalingTolerance &tolerance,
+                const bool update_baseline, const int jobs) {
+  salsa::ScalingSweep sweep;
+  if (!sweep_path.empty()) {
+    std::ifstream file(sweep_path);
+    if (!file.is_open()) {
+      std::cerr << "Could not open sweep file " << sweep_path << std::endl;
+      return 1;
+    }
+    sweep = salsa::ScalingSweep::fromJson(nlohmann::json::parse(file));
+  }
+  const std::size_t total = sweep.tests().size();
+  std::cout << "Running " << total << " scaling tests" << std::endl;
+
+  salsa::TestExecutor executor(jobs);
+  executor.onProgress([](const salsa::TestExecutor::Progress &progress) {
+    if (progress.finished) {
+      const salsa::TestConfig &config = progress.config;
+      std::cout << "(" << progress.index + 1 << "/" << progress.total << ") "
+                << config.behaviour_name << " on " << config.map_name
+                << ": " << config.num_drones << " drones, "
+                << config.num_targets << " targets" << std::endl;
+    }
+  });
+  const salsa::ScalingReport report = salsa::runScalingSweep(sweep, executor);
+  std::cout << std::endl << report.table() << std::endl;
+  if (!report.save(report_path)) {
+    std::cerr << "Could not write the scaling report to " << report_path
+              << std::endl;
+    return 1;
+  }
+  std::cout << "Scaling report written to " << report_path << std::endl;
+
+  int status = 0;
+  if (!baseline_path.empty() && std::filesystem::exists(baseline_path)) {
+    const salsa::ScalingComparison comparison =
+        report.compare(salsa::ScalingReport::load(baseline_path), tolerance);
+    std::cout << "Against the baseline " << baseline_path << ":" << std::endl
+              << comparison.table();
+    if (!comparison.passed()) {
+      std::cout << "Scaling suite FAILED" << std::endl;
+      status = 1;
+    }
+  } else if (!baseline_path.empty() && !update_baseline) {
+    std::cout << "No baseline at " << baseline_path
+              << ", run with --update-baseline to keep this report as one"
+              << std::endl;
+  }
+  if (update_baseline && !baseline_path.empty()) {
+    if (report.save(baseline_path)) {
+      std::cout << "Baseline updated" << std::endl;
+    } else {
+      std::cerr << "Could not write the baseline to " << baseline_path
+                << std::endl;
+      status = 1;
+    }
+  }
+  return status;
+}
+
 //
 int run() {
 #if defined(_WIN32)
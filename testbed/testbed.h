@@ -5,6 +5,18 @@
 
 namespace testbed {
 int run();
-int run_headless(bool verbose, std::string queue_path);
+int run_headless(bool verbose, std::string queue_path, int threads = -1,
+                 int jobs = 1, float checkpoint_interval = 0.0f,
+                 int trace_steps = 0, bool hardware_counters = false,
+                 float memory_budget_mb = 0.0f);
+/// Runs the scaling suite described by the sweep file at `sweep_path`, or
+/// the default sweep if it is empty, and writes its report to
+/// `report_path`. If `baseline_path` names a report, the run is compared
+/// with it, and with `update_baseline` the run replaces it. Returns 1 if
+/// anything regressed, 0 otherwise.
+int run_scaling(const std::string &sweep_path, const std::string &report_path,
+                const std::string &baseline_path,
+                const salsa::ScalingTolerance &tolerance, bool update_baseline,
+                int jobs = 1);
 };  // namespace testbed
 #endif
\ No newline at end of file
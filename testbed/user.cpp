@@ -46,6 +46,13 @@ static void setupInteractions(salsa::BaseContactListener &listener) {
         drone->addTargetFound(tree);
         tree->addNumMapped();
       });
+  listener.addDetectionHandler(
+      "Tree", [](salsa::Drone &drone, salsa::Target &target) -> void {
+        Tree &tree = static_cast<Tree &>(target);
+        tree.setFound(true);
+        drone.addTargetFound(&tree);
+        tree.addNumMapped();
+      });
   listener.addCollisionHandler(
       "salsa::Drone", "salsa::Drone",
       [](b2Fixture *droneFixture1, b2Fixture *droneFixture2) -> void {
@@ -82,6 +89,8 @@ void user() {
   setupInteractions(*contactListener);
   salsa::TestConfig config = {"Flocking", flock_params, "Small", "tree_map", 10,
                               50000,      100.0f,       "Tree",  "Default"};
+  // Trees never move, so keep them out of Box2D.
+  config.use_target_store = true;
 
   // Load the test queue with our tree tests
   // 10, 100, 500, 1000
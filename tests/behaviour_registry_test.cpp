@@ -8,6 +8,22 @@
 using salsa::Behaviour;
 using salsa::behaviour::Registry;
 
+namespace {
+class WeightedBehaviour : public Behaviour {
+ public:
+  salsa::behaviour::Parameter weight_{1.0f, 0.0f, 10.0f};
+
+  WeightedBehaviour() { parameters_["Weight"] = &weight_; }
+
+  void execute(const std::vector<std::unique_ptr<salsa::Drone>> &,
+               salsa::Drone &) override {}
+};
+
+Registry::Factory weightedFactory() {
+  return [] { return std::make_unique<WeightedBehaviour>(); };
+}
+}  // namespace
+
 class RegistryTest : public ::testing::Test {
  protected:
   Registry& registry = Registry::get();  // Singleton instance for all tests
@@ -77,4 +93,39 @@ TEST_F(RegistryTest, ListBehaviourNames) {
   EXPECT_NE(std::find(names.begin(), names.end(), "Behaviour1"), names.end());
   EXPECT_NE(std::find(names.begin(), names.end(), "Behaviour2"), names.end());
   EXPECT_NE(std::find(names.begin(), names.end(), "Behaviour3"), names.end());
-}
\ No newline at end of file
+}
+TEST_F(RegistryTest, CreateReturnsFreshInstances) {
+  registry.add("Weighted", weightedFactory());
+
+  auto first = registry.create("Weighted");
+  auto second = registry.create("Weighted");
+  ASSERT_NE(first, nullptr);
+  ASSERT_NE(second, nullptr);
+  EXPECT_NE(first.get(), second.get());
+  EXPECT_NE(first.get(), registry.behaviour("Weighted"));
+}
+
+TEST_F(RegistryTest, CreateCopiesPrototypeParameters) {
+  registry.add("Weighted", weightedFactory());
+  registry.behaviour("Weighted")->getParameters()["Weight"]->value() = 4.0f;
+
+  auto instance = registry.create("Weighted");
+  EXPECT_FLOAT_EQ(4.0f, instance->getParameterValues()["Weight"]);
+}
+
+TEST_F(RegistryTest, CreateAppliesParametersByValue) {
+  registry.add("Weighted", weightedFactory());
+
+  auto instance = registry.create("Weighted", {{"Weight", 7.0f}});
+  EXPECT_FLOAT_EQ(7.0f, instance->getParameterValues()["Weight"]);
+  EXPECT_FLOAT_EQ(
+      1.0f, registry.behaviour("Weighted")->getParameterValues()["Weight"]);
+}
+
+TEST_F(RegistryTest, CreateWithoutFactoryOrClone) {
+  registry.add("TestBehaviour", std::make_unique<MockBehaviour>());
+
+  EXPECT_EQ(registry.create("TestBehaviour"), nullptr);
+  EXPECT_EQ(registry.create("NonExistent"), nullptr);
+  EXPECT_FALSE(registry.createsInstances("TestBehaviour"));
+}
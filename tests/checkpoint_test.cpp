@@ -0,0 +1,121 @@
+#include "salsa/core/checkpoint.h"
+
+#include <box2d/box2d.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using salsa::CheckpointReader;
+using salsa::CheckpointWriter;
+
+namespace {
+CheckpointWriter makeCheckpoint() {
+  CheckpointWriter out;
+  out.write<int32_t>(-7);
+  out.write(12.5f);
+  out.write(b2Vec2(1.0f, -2.0f));
+  out.write(std::string("Pheromone Avoidance"));
+  out.write(std::vector<uint64_t>{1, 2, 3});
+  out.write(std::vector<b2Vec2>{});
+  out.write(true);
+  return out;
+}
+
+void expectCheckpoint(CheckpointReader &in) {
+  EXPECT_EQ(-7, in.read<int32_t>());
+  EXPECT_EQ(12.5f, in.read<float>());
+  const auto position = in.read<b2Vec2>();
+  EXPECT_EQ(1.0f, position.x);
+  EXPECT_EQ(-2.0f, position.y);
+  EXPECT_EQ("Pheromone Avoidance", in.readString());
+  EXPECT_EQ((std::vector<uint64_t>{1, 2, 3}), in.readVector<uint64_t>());
+  EXPECT_TRUE(in.readVector<b2Vec2>().empty());
+  EXPECT_TRUE(in.read<bool>());
+  EXPECT_EQ(0u, in.remaining());
+}
+}  // namespace
+
+class CheckpointTest : public ::testing::Test {
+ protected:
+  std::filesystem::path path;
+
+  void SetUp() override {
+    path = std::filesystem::temp_directory_path() / "salsa_checkpoint_test" /
+           "test.ckpt";
+    std::filesystem::remove_all(path.parent_path());
+  }
+
+  void TearDown() override {
+    std::filesystem::remove_all(path.parent_path());
+  }
+
+  void overwrite(const std::size_t offset, const char byte) {
+    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(static_cast<std::streamoff>(offset));
+    file.put(byte);
+  }
+};
+
+TEST_F(CheckpointTest, ReadsBackInMemory) {
+  const CheckpointWriter out = makeCheckpoint();
+  CheckpointReader in(out.data().data(), out.size());
+  expectCheckpoint(in);
+}
+
+TEST_F(CheckpointTest, ReadsBackFromFile) {
+  makeCheckpoint().save(path);
+  CheckpointReader in(path);
+  expectCheckpoint(in);
+}
+
+TEST_F(CheckpointTest, ReplacesEarlierCheckpoint) {
+  CheckpointWriter first;
+  first.write<int32_t>(1);
+  first.save(path);
+  makeCheckpoint().save(path);
+  CheckpointReader in(path);
+  expectCheckpoint(in);
+  // Only the checkpoint itself is left, not a temporary file.
+  EXPECT_EQ(1, std::distance(
+                   std::filesystem::directory_iterator(path.parent_path()),
+                   std::filesystem::directory_iterator()));
+}
+
+TEST_F(CheckpointTest, ThrowsWhenReadingPastTheEnd) {
+  CheckpointWriter out;
+  out.write<int32_t>(3);
+  CheckpointReader in(out.data().data(), out.size());
+  EXPECT_THROW(in.read<uint64_t>(), std::runtime_error);
+  // A length past the end does not make the reader allocate.
+  CheckpointWriter long_array;
+  long_array.write<uint64_t>(uint64_t{1} << 40);
+  CheckpointReader again(long_array.data().data(), long_array.size());
+  EXPECT_THROW(again.readVector<b2Vec2>(), std::runtime_error);
+}
+
+TEST_F(CheckpointTest, RejectsCorruptFiles) {
+  makeCheckpoint().save(path);
+  overwrite(sizeof(salsa::CheckpointFileHeader) + 2, 'x');
+  EXPECT_THROW(CheckpointReader{path}, std::runtime_error);
+
+  makeCheckpoint().save(path);
+  overwrite(0, 'X');
+  EXPECT_THROW(CheckpointReader{path}, std::runtime_error);
+
+  std::filesystem::resize_file(path, sizeof(salsa::CheckpointFileHeader) - 1);
+  EXPECT_THROW(CheckpointReader{path}, std::runtime_error);
+  EXPECT_THROW(CheckpointReader{path.parent_path() / "missing.ckpt"},
+               std::runtime_error);
+}
+
+TEST_F(CheckpointTest, RejectsTruncatedFiles) {
+  makeCheckpoint().save(path);
+  std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+  EXPECT_THROW(CheckpointReader{path}, std::runtime_error);
+}
@@ -8,6 +8,7 @@
 #include "salsa/behaviours/behaviour.h"
 #include "salsa/entity/drone_configuration.h"
 #include "salsa/entity/drone_factory.h"
+#include "salsa/entity/drone_snapshot.h"
 
 using ::testing::_;
 // Test fixture for Drone tests
@@ -91,3 +92,28 @@ TEST_F(DroneTest, UpdateSensorRange) {
     fixture = fixture->GetNext();
   }
 }
+
+TEST_F(DroneTest, SnapshotCapturesDroneState) {
+  std::vector<std::unique_ptr<salsa::Drone>> drones;
+  for (int i = 0; i < 5; i++) {
+    drones.push_back(salsa::DroneFactory::createDrone(world, b2Vec2(i, 2 * i),
+                                                      behaviour, *config));
+    drones.back()->id(10 + i);
+  }
+  salsa::DroneSnapshot snapshot;
+  snapshot.capture(drones);
+  ASSERT_EQ(drones.size(), snapshot.size());
+  for (std::size_t i = 0; i < drones.size(); i++) {
+    EXPECT_EQ(drones[i]->position().x, snapshot.x[i]);
+    EXPECT_EQ(drones[i]->position().y, snapshot.y[i]);
+    EXPECT_EQ(drones[i]->velocity().x, snapshot.vx[i]);
+    EXPECT_EQ(drones[i]->velocity().y, snapshot.vy[i]);
+    EXPECT_EQ(drones[i]->id(), snapshot.id[i]);
+    EXPECT_EQ(drones[i]->max_speed(), snapshot.max_speed[i]);
+    EXPECT_EQ(drones[i]->max_force(), snapshot.max_force[i]);
+  }
+
+  drones.pop_back();
+  snapshot.capture(drones);
+  EXPECT_EQ(drones.size(), snapshot.size());
+}
@@ -0,0 +1,125 @@
+#include "salsa/entity/found_targets.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "salsa/entity/target.h"
+
+using salsa::FoundTargets;
+
+namespace {
+class PlainTarget : public salsa::Target {
+ public:
+  explicit PlainTarget(const int id) : Target(nullptr, b2Vec2(0, 0), 1.0f) {
+    id_ = id;
+  }
+
+  std::string getType() const override { return "PlainTarget"; }
+};
+}  // namespace
+
+TEST(FoundTargetsTest, CountsEachTargetOnce) {
+  FoundTargets found;
+  found.reset(200);
+  EXPECT_TRUE(found.markFound(3));
+  EXPECT_FALSE(found.markFound(3));
+  EXPECT_TRUE(found.markFound(64));
+  EXPECT_TRUE(found.markFound(199));
+  EXPECT_EQ(3, found.count());
+  EXPECT_TRUE(found.isFound(64));
+  EXPECT_FALSE(found.isFound(63));
+
+  EXPECT_TRUE(found.markNotFound(64));
+  EXPECT_FALSE(found.markNotFound(64));
+  EXPECT_EQ(2, found.count());
+}
+
+TEST(FoundTargetsTest, IgnoresIdsOutOfRange) {
+  FoundTargets found;
+  found.reset(10);
+  EXPECT_FALSE(found.markFound(-1));
+  EXPECT_FALSE(found.markFound(10));
+  EXPECT_FALSE(found.isFound(10));
+  EXPECT_EQ(0, found.count());
+}
+
+TEST(FoundTargetsTest, ListsTargetsFoundDuringTheLastStep) {
+  FoundTargets found;
+  found.reset(10);
+  found.markFound(4);
+  found.markFound(2);
+  found.beginStep();
+  EXPECT_EQ((std::vector<int>{4, 2}), found.found_this_step());
+
+  // Finding an already found target does not list it again.
+  found.markFound(2);
+  found.markFound(7);
+  found.beginStep();
+  EXPECT_EQ(std::vector<int>{7}, found.found_this_step());
+
+  found.beginStep();
+  EXPECT_TRUE(found.found_this_step().empty());
+}
+
+TEST(FoundTargetsTest, ListsATargetFoundAgainOnce) {
+  FoundTargets found;
+  found.reset(10);
+  found.markFound(3);
+  found.markNotFound(3);
+  found.markFound(3);
+  found.markFound(5);
+  found.markNotFound(5);
+  found.beginStep();
+  // Found twice, but listed once. Found and lost again, so not listed.
+  EXPECT_EQ(std::vector<int>{3}, found.found_this_step());
+
+  // The next step lists it again if it flips again.
+  found.markNotFound(3);
+  found.markFound(3);
+  found.beginStep();
+  EXPECT_EQ(std::vector<int>{3}, found.found_this_step());
+  EXPECT_EQ(1, found.count());
+}
+
+TEST(FoundTargetsTest, StepsReuseTheirLists) {
+  FoundTargets found;
+  found.reset(1000);
+  std::vector<const int *> lists;
+  for (int step = 0; step < 10; step++) {
+    for (int id = step * 100; id < (step + 1) * 100; id++) {
+      found.markFound(id);
+    }
+    found.beginStep();
+    lists.push_back(found.found_this_step().data());
+  }
+  // The two lists swap back and forth without being reallocated.
+  for (std::size_t i = 2; i < lists.size(); i++) {
+    EXPECT_EQ(lists[i - 2], lists[i]);
+  }
+  EXPECT_EQ(1000, found.count());
+}
+
+TEST(FoundTargetsTest, TrackedTargetsUpdateTheCount) {
+  FoundTargets found;
+  found.reset(3);
+  PlainTarget first(0);
+  PlainTarget second(2);
+  first.trackFoundIn(&found);
+  second.trackFoundIn(&found);
+
+  first.setFound(true);
+  first.setFound(true);
+  second.setFound(true);
+  EXPECT_EQ(2, found.count());
+  EXPECT_TRUE(found.isFound(2));
+
+  second.setFound(false);
+  EXPECT_EQ(1, found.count());
+  EXPECT_FALSE(second.isFound());
+
+  first.trackFoundIn(nullptr);
+  first.setFound(false);
+  EXPECT_EQ(1, found.count());
+}
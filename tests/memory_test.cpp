@@ -0,0 +1,172 @@
+#include "salsa/core/memory.h"
+
+#include <box2d/box2d.h>
+
+#include <thread>
+
+#include "gtest/gtest.h"
+
+using salsa::MemoryAccount;
+using salsa::MemoryBacking;
+using salsa::MemoryCategory;
+using salsa::MemoryReport;
+using salsa::WorldArena;
+
+TEST(MemoryAccountTest, CountsAllocationsByCategory) {
+  MemoryAccount::Handle account = MemoryAccount::create();
+  void *drone = nullptr;
+  void *contact = nullptr;
+  {
+    const auto scope =
+        MemoryAccount::scope(account.get(), MemoryCategory::Drones);
+    drone = b2Alloc(100);
+  }
+  {
+    const auto scope =
+        MemoryAccount::scope(account.get(), MemoryCategory::Step);
+    contact = b2Alloc(50);
+  }
+  // Outside a scope, allocations are not counted.
+  void *uncounted = b2Alloc(1000);
+
+  const auto drones = account->usage(MemoryCategory::Drones);
+  const auto step = account->usage(MemoryCategory::Step);
+  EXPECT_EQ(1u, drones.blocks);
+  EXPECT_GE(drones.bytes, 100u);
+  EXPECT_GE(step.bytes, 50u);
+  EXPECT_EQ(0u, account->usage(MemoryCategory::Map).bytes);
+  EXPECT_EQ(drones.bytes + step.bytes, account->total().bytes);
+
+  b2Free(drone);
+  b2Free(uncounted);
+  EXPECT_EQ(0u, account->usage(MemoryCategory::Drones).bytes);
+  EXPECT_EQ(drones.bytes, account->usage(MemoryCategory::Drones).peak_bytes);
+  EXPECT_EQ(step.bytes, account->total().bytes);
+  EXPECT_EQ(drones.bytes + step.bytes, account->total().peak_bytes);
+
+  account->resetPeaks();
+  EXPECT_EQ(0u, account->usage(MemoryCategory::Drones).peak_bytes);
+  EXPECT_EQ(step.bytes, account->total().peak_bytes);
+  b2Free(contact);
+  EXPECT_EQ(0u, account->total().blocks);
+}
+
+TEST(MemoryAccountTest, BlocksGoBackToTheirAccountFromAnyThread) {
+  MemoryAccount::Handle account = MemoryAccount::create();
+  void *block = nullptr;
+  {
+    const auto scope = MemoryAccount::scope(account.get(), MemoryCategory::Map);
+    block = b2Alloc(64);
+  }
+  std::thread([block] { b2Free(block); }).join();
+  EXPECT_EQ(0u, account->total().bytes);
+}
+
+TEST(MemoryAccountTest, OutlivesItsHandleWhileBlocksAreInUse) {
+  MemoryAccount::Handle account = MemoryAccount::create();
+  void *block = nullptr;
+  {
+    const auto scope = MemoryAccount::scope(account.get(), MemoryCategory::Map);
+    block = b2Alloc(64);
+  }
+  account.reset();
+  // Freeing the last block deletes the account; the sanitizers would catch
+  // a block given back to a deleted account.
+  b2Free(block);
+  b2Free(nullptr);
+}
+
+TEST(WorldArenaTest, SizeClassesWasteAtMostAnEighth) {
+  EXPECT_EQ(16u, WorldArena::classBytes(1));
+  EXPECT_EQ(128u, WorldArena::classBytes(128));
+  EXPECT_EQ(144u, WorldArena::classBytes(129));
+  EXPECT_EQ(18432u, WorldArena::classBytes(16400));
+  for (std::size_t bytes = 1; bytes < 1000000; bytes = bytes * 3 / 2 + 1) {
+    const std::size_t size = WorldArena::classBytes(bytes);
+    EXPECT_GE(size, bytes);
+    EXPECT_LE(size, bytes + bytes / 8 + 16);
+    EXPECT_EQ(0u, size % alignof(std::max_align_t));
+  }
+}
+
+TEST(WorldArenaTest, ReusesFreedBlocksOfTheSameClass) {
+  WorldArena arena;
+  void *first = arena.allocate(200);
+  void *second = arena.allocate(200);
+  EXPECT_NE(first, second);
+  EXPECT_EQ(1u, arena.chunkCount());
+
+  arena.deallocate(first, 200);
+  // 205 bytes fall in the same class as 200.
+  EXPECT_EQ(first, arena.allocate(205));
+
+  // Allocating and freeing the same sizes over and over takes nothing more
+  // from the system.
+  const std::size_t reserved = arena.reservedBytes();
+  for (int i = 0; i < 1000; i++) {
+    void *big = arena.allocate(300000);
+    void *small = arena.allocate(40);
+    arena.deallocate(small, 40);
+    arena.deallocate(big, 300000);
+  }
+  EXPECT_LE(arena.reservedBytes(), reserved + 2 * 300000 + 64 * 1024);
+
+  arena.release();
+  EXPECT_EQ(0u, arena.reservedBytes());
+  EXPECT_EQ(0u, arena.chunkCount());
+}
+
+TEST(MemoryAccountTest, ArenaReleasesEveryBlockAtOnce) {
+  MemoryAccount::Handle account = MemoryAccount::create(MemoryBacking::Arena);
+  EXPECT_EQ(MemoryBacking::Arena, account->backing());
+  {
+    const auto scope =
+        MemoryAccount::scope(account.get(), MemoryCategory::Targets);
+    for (int i = 0; i < 1000; i++) {
+      b2Alloc(100);
+    }
+  }
+  EXPECT_EQ(1000u, account->usage(MemoryCategory::Targets).blocks);
+  EXPECT_GT(account->reservedBytes(), 100000u);
+
+  account->release();
+  EXPECT_EQ(0u, account->total().bytes);
+  EXPECT_EQ(0u, account->total().blocks);
+  EXPECT_EQ(0u, account->reservedBytes());
+  // With its blocks gone, letting go of the handle deletes the account.
+  account.reset();
+
+  MemoryAccount::Handle heap = MemoryAccount::create();
+  EXPECT_EQ(MemoryBacking::Heap, heap->backing());
+  EXPECT_EQ(0u, heap->reservedBytes());
+}
+
+TEST(MemoryReportTest, SplitsMemoryBetweenDronesTargetsAndTheMap) {
+  MemoryReport report;
+  report.drones = 10;
+  report.targets = 4;
+  report.box2d[static_cast<std::size_t>(MemoryCategory::Map)].bytes = 1000;
+  report.box2d[static_cast<std::size_t>(MemoryCategory::Drones)].bytes = 2000;
+  report.box2d[static_cast<std::size_t>(MemoryCategory::Targets)].bytes = 400;
+  report.box2d[static_cast<std::size_t>(MemoryCategory::Step)].bytes = 500;
+  report.box2d_total.bytes = 3900;
+  report.box2d_total.peak_bytes = 5000;
+  report.drone_bytes = 1000;
+  report.target_bytes = 40;
+  report.map_bytes = 200;
+
+  EXPECT_EQ(5140u, report.bytes());
+  EXPECT_EQ(6240u, report.peakBytes());
+  EXPECT_DOUBLE_EQ(300.0, report.bytesPerDrone());
+  EXPECT_DOUBLE_EQ(110.0, report.bytesPerTarget());
+  EXPECT_EQ(1200u, report.mapBytes());
+  EXPECT_EQ(500u, report.stepBytes());
+  // The map, then 350 bytes a drone (with its share of the step) and 110 a
+  // target.
+  EXPECT_EQ(1200u + 350u * 20 + 110u * 2, report.estimate(20, 2));
+
+  const auto json = report.toJson();
+  EXPECT_EQ(10, json["drones"].get<int>());
+  EXPECT_EQ(2000u, json["box2d"]["drones"]["bytes"].get<std::size_t>());
+  EXPECT_DOUBLE_EQ(0.0, MemoryReport().bytesPerDrone());
+}
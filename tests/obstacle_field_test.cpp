@@ -0,0 +1,107 @@
+#include "salsa/utils/obstacle_field.h"
+
+#include <box2d/box2d.h>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using salsa::ObstacleField;
+
+class ObstacleFieldTest : public ::testing::Test {
+ protected:
+  b2World world{b2Vec2(0.0f, 0.0f)};
+
+  void addEdge(const b2Vec2 &start, const b2Vec2 &end) {
+    b2BodyDef body_def;
+    b2Body *body = world.CreateBody(&body_def);
+    b2EdgeShape edge;
+    edge.SetTwoSided(start, end);
+    body->CreateFixture(&edge, 0.0f);
+  }
+
+  void addBox(const b2Vec2 &centre, float half_width) {
+    b2BodyDef body_def;
+    body_def.position = centre;
+    b2Body *body = world.CreateBody(&body_def);
+    b2PolygonShape box;
+    box.SetAsBox(half_width, half_width);
+    body->CreateFixture(&box, 0.0f);
+  }
+};
+
+TEST_F(ObstacleFieldTest, EmptyWorldHasNoObstacles) {
+  ObstacleField field(world);
+  EXPECT_TRUE(field.empty());
+  std::vector<b2Vec2> points;
+  field.queryPoints(b2Vec2(0, 0), 10.0f, points);
+  EXPECT_TRUE(points.empty());
+  b2Vec2 nearest;
+  EXPECT_FALSE(field.nearestPoint(b2Vec2(0, 0), nearest));
+}
+
+TEST_F(ObstacleFieldTest, IgnoresDynamicBodiesAndSensors) {
+  b2BodyDef dynamic_def;
+  dynamic_def.type = b2_dynamicBody;
+  b2Body *dynamic_body = world.CreateBody(&dynamic_def);
+  b2CircleShape circle;
+  circle.m_radius = 1.0f;
+  dynamic_body->CreateFixture(&circle, 1.0f);
+
+  b2BodyDef static_def;
+  b2Body *static_body = world.CreateBody(&static_def);
+  b2FixtureDef sensor_def;
+  sensor_def.shape = &circle;
+  sensor_def.isSensor = true;
+  static_body->CreateFixture(&sensor_def);
+
+  ObstacleField field(world);
+  EXPECT_TRUE(field.empty());
+}
+
+TEST_F(ObstacleFieldTest, NearestPointOnEdge) {
+  addEdge(b2Vec2(0, 0), b2Vec2(100, 0));
+  ObstacleField field(world, 50.0f, 1.0f);
+  ASSERT_FALSE(field.empty());
+
+  b2Vec2 nearest;
+  ASSERT_TRUE(field.nearestPoint(b2Vec2(30, 10), nearest));
+  EXPECT_FLOAT_EQ(30.0f, nearest.x);
+  EXPECT_FLOAT_EQ(0.0f, nearest.y);
+  EXPECT_NEAR(10.5f, field.signedDistance(b2Vec2(30.5f, 10.5f)), 1e-4f);
+
+  // Beyond the maximum distance nothing is recorded.
+  EXPECT_FALSE(field.nearestPoint(b2Vec2(30, 80), nearest));
+  EXPECT_FLOAT_EQ(50.0f, field.signedDistance(b2Vec2(30, 80)));
+}
+
+TEST_F(ObstacleFieldTest, DistanceIsNegativeInsidePolygons) {
+  addBox(b2Vec2(50, 50), 10.0f);
+  ObstacleField field(world, 20.0f, 1.0f);
+  EXPECT_NEAR(-9.5f, field.signedDistance(b2Vec2(50.5f, 50.5f)), 1e-4f);
+  EXPECT_NEAR(4.5f, field.signedDistance(b2Vec2(64.5f, 50.5f)), 1e-4f);
+}
+
+TEST_F(ObstacleFieldTest, QueryPointsFindsEachWallOnce) {
+  // A corner made of two walls.
+  addEdge(b2Vec2(0, 0), b2Vec2(100, 0));
+  addEdge(b2Vec2(0, 0), b2Vec2(0, 100));
+  ObstacleField field(world, 50.0f, 1.0f);
+
+  std::vector<b2Vec2> points;
+  field.queryPoints(b2Vec2(10, 20), 30.0f, points);
+  ASSERT_EQ(2u, points.size());
+  bool found_floor = false;
+  bool found_wall = false;
+  for (const auto &point : points) {
+    found_floor |= b2Distance(point, b2Vec2(10, 0)) < 1e-4f;
+    found_wall |= b2Distance(point, b2Vec2(0, 20)) < 1e-4f;
+  }
+  EXPECT_TRUE(found_floor);
+  EXPECT_TRUE(found_wall);
+
+  // Walls outside the view range are not returned.
+  field.queryPoints(b2Vec2(40, 20), 30.0f, points);
+  ASSERT_EQ(1u, points.size());
+  EXPECT_FLOAT_EQ(0.0f, points[0].y);
+}
@@ -0,0 +1,53 @@
+#include "salsa/utils/perf_counters.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+using salsa::CounterSample;
+using salsa::HardwareEvent;
+using salsa::PerfCounters;
+
+TEST(PerfCountersTest, SamplesAddAndSubtract) {
+  CounterSample earlier;
+  earlier[HardwareEvent::Cycles] = 100;
+  earlier[HardwareEvent::Instructions] = 150;
+  CounterSample later = earlier;
+  later[HardwareEvent::Cycles] += 400;
+  later[HardwareEvent::Instructions] += 1000;
+  later[HardwareEvent::CacheMisses] = 7;
+
+  const CounterSample difference = later - earlier;
+  EXPECT_EQ(400u, difference[HardwareEvent::Cycles]);
+  EXPECT_EQ(1000u, difference[HardwareEvent::Instructions]);
+  EXPECT_EQ(7u, difference[HardwareEvent::CacheMisses]);
+  EXPECT_DOUBLE_EQ(2.5, difference.ipc());
+  // A counter never goes backwards, even if a scaled reading does.
+  EXPECT_EQ(0u, (earlier - later)[HardwareEvent::Cycles]);
+
+  CounterSample total;
+  total += difference;
+  total += difference;
+  EXPECT_EQ(800u, total[HardwareEvent::Cycles]);
+  EXPECT_DOUBLE_EQ(0.0, CounterSample().ipc());
+}
+
+TEST(PerfCountersTest, CountsOrSaysWhyNot) {
+  const PerfCounters &counters = PerfCounters::forThisThread();
+  EXPECT_EQ(&counters, &PerfCounters::forThisThread());
+  const CounterSample start = counters.read();
+  volatile double sum = 0.0;
+  for (int i = 0; i < 100000; i++) {
+    sum = sum + i;
+  }
+  const CounterSample counted = counters.read() - start;
+  if (counters.available()) {
+    EXPECT_TRUE(counters.error().empty());
+    EXPECT_GT(counted[HardwareEvent::Cycles], 0u);
+  } else {
+    // Containers and virtual machines often have no counters to read.
+    EXPECT_FALSE(counters.error().empty());
+    EXPECT_FALSE(counters.counts(HardwareEvent::Cycles));
+    EXPECT_EQ(0u, counted[HardwareEvent::Cycles]);
+  }
+}
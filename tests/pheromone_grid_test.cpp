@@ -0,0 +1,157 @@
+#include "salsa/utils/pheromone_grid.h"
+
+#include <box2d/box2d.h>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "salsa/core/checkpoint.h"
+
+using salsa::PheromoneGrid;
+
+TEST(PheromoneGridTest, DecaysOnRead) {
+  PheromoneGrid grid(1.0f, 0.5f);
+  EXPECT_TRUE(grid.empty());
+  EXPECT_FLOAT_EQ(grid.sample(b2Vec2(0.5f, 0.5f)), 0.0f);
+
+  ASSERT_TRUE(grid.deposit(b2Vec2(0.5f, 0.5f), 8.0f));
+  EXPECT_FLOAT_EQ(grid.sample(b2Vec2(0.2f, 0.9f)), 8.0f);
+  grid.advance(3.0f);
+  EXPECT_NEAR(grid.sample(b2Vec2(0.5f, 0.5f)), 1.0f, 1e-5f);
+
+  // A deposit adds to what is left, and starts the decay again from now.
+  ASSERT_TRUE(grid.deposit(b2Vec2(0.5f, 0.5f), 1.0f));
+  EXPECT_NEAR(grid.sample(b2Vec2(0.5f, 0.5f)), 2.0f, 1e-5f);
+  grid.advance();
+  EXPECT_NEAR(grid.sample(b2Vec2(0.5f, 0.5f)), 1.0f, 1e-5f);
+
+  grid.clear();
+  EXPECT_TRUE(grid.empty());
+  EXPECT_FLOAT_EQ(grid.time(), 0.0f);
+}
+
+TEST(PheromoneGridTest, GrowsWithoutMovingPheromone) {
+  PheromoneGrid grid(2.0f);
+  ASSERT_TRUE(grid.deposit(b2Vec2(1.0f, 1.0f), 1.0f));
+  ASSERT_TRUE(grid.deposit(b2Vec2(-100.0f, 250.0f), 2.0f));
+  ASSERT_TRUE(grid.deposit(b2Vec2(300.0f, -40.0f), 3.0f));
+  EXPECT_FLOAT_EQ(grid.sample(b2Vec2(1.0f, 1.0f)), 1.0f);
+  EXPECT_FLOAT_EQ(grid.sample(b2Vec2(-100.0f, 250.0f)), 2.0f);
+  EXPECT_FLOAT_EQ(grid.sample(b2Vec2(300.0f, -40.0f)), 3.0f);
+  EXPECT_FLOAT_EQ(grid.sample(b2Vec2(-97.0f, 250.0f)), 0.0f);
+  EXPECT_GE(grid.columns() * 2.0f, 400.0f);
+  EXPECT_GE(grid.rows() * 2.0f, 290.0f);
+
+  // Beyond the cell limit, or nowhere at all, nothing is laid.
+  EXPECT_FALSE(grid.deposit(b2Vec2(1e7f, 1e7f), 1.0f));
+  EXPECT_FALSE(grid.deposit(
+      b2Vec2(std::numeric_limits<float>::quiet_NaN(), 0.0f), 1.0f));
+  EXPECT_LE(grid.columns() * grid.rows(), PheromoneGrid::kMaxCells);
+}
+
+TEST(PheromoneGridTest, GradientPointsTowardsPheromoneInRange) {
+  PheromoneGrid grid(1.0f);
+  const b2Vec2 centre(0.5f, 0.5f);
+  ASSERT_TRUE(grid.deposit(b2Vec2(10.5f, 0.5f), 4.0f));
+  EXPECT_FLOAT_EQ(grid.gradient(centre, 5.0f).Length(), 0.0f);
+
+  const b2Vec2 pull = grid.gradient(centre, 20.0f);
+  EXPECT_NEAR(pull.x, 0.4f, 1e-5f);
+  EXPECT_NEAR(pull.y, 0.0f, 1e-5f);
+
+  // The cell the query is made from gives no direction.
+  ASSERT_TRUE(grid.deposit(centre, 100.0f));
+  EXPECT_NEAR(grid.gradient(centre, 20.0f).x, 0.4f, 1e-5f);
+
+  // Pheromone on both sides pulls towards the stronger.
+  ASSERT_TRUE(grid.deposit(b2Vec2(-9.5f, 0.5f), 8.0f));
+  EXPECT_LT(grid.gradient(centre, 20.0f).x, 0.0f);
+}
+
+TEST(PheromoneGridTest, DiffusionSpreadsToNeighbours) {
+  PheromoneGrid grid(1.0f, 0.5f);
+  ASSERT_TRUE(grid.deposit(b2Vec2(0.5f, 0.5f), 200.0f));
+  grid.advance();
+  grid.diffuse(0.4f);
+  EXPECT_NEAR(grid.sample(b2Vec2(0.5f, 0.5f)), 60.0f, 1e-3f);
+  EXPECT_NEAR(grid.sample(b2Vec2(1.5f, 0.5f)), 10.0f, 1e-3f);
+  EXPECT_NEAR(grid.sample(b2Vec2(-0.5f, 0.5f)), 10.0f, 1e-3f);
+  EXPECT_NEAR(grid.sample(b2Vec2(0.5f, 1.5f)), 10.0f, 1e-3f);
+  EXPECT_NEAR(grid.sample(b2Vec2(0.5f, -0.5f)), 10.0f, 1e-3f);
+  EXPECT_FLOAT_EQ(grid.sample(b2Vec2(1.5f, 1.5f)), 0.0f);
+
+  // Spread pheromone decays from the time it was spread.
+  grid.advance();
+  EXPECT_NEAR(grid.sample(b2Vec2(1.5f, 0.5f)), 5.0f, 1e-3f);
+}
+
+TEST(PheromoneGridTest, DiffusionMatchesTheStencilInEveryCell) {
+  PheromoneGrid grid(1.0f);
+  // Spread over an odd number of columns, so rows end part-way through a
+  // vector of cells.
+  for (int i = 0; i < 40; i++) {
+    ASSERT_TRUE(grid.deposit(
+        b2Vec2(static_cast<float>((i * 7) % 37), static_cast<float>(i % 5)),
+        1.0f + i));
+  }
+  ASSERT_EQ(1, grid.columns() % 2);
+  // The first deposit, at the origin, grew the grid this far to the left and
+  // below, and later ones only grew it to the right.
+  const float min_x = -static_cast<float>(PheromoneGrid::kGrowCells);
+  const float min_y = min_x;
+  const auto at = [&grid](const float x, const float y) {
+    return grid.sample(b2Vec2(x + 0.5f, y + 0.5f));
+  };
+  std::vector<float> expected;
+  for (float y = min_y; y < min_y + grid.rows(); y++) {
+    for (float x = min_x; x < min_x + grid.columns(); x++) {
+      expected.push_back(0.5f * at(x, y) +
+                         0.125f * (at(x - 1, y) + at(x + 1, y) +
+                                   at(x, y - 1) + at(x, y + 1)));
+    }
+  }
+  grid.diffuse(0.5f);
+  std::size_t i = 0;
+  for (float y = min_y; y < min_y + grid.rows(); y++) {
+    for (float x = min_x; x < min_x + grid.columns(); x++) {
+      EXPECT_NEAR(at(x, y), expected[i++], 1e-5f) << x << ", " << y;
+    }
+  }
+}
+
+TEST(PheromoneGridTest, DiffusionDropsPheromoneTooThinToHold) {
+  PheromoneGrid grid(1.0f);
+  const float thin = 2.0f * std::numeric_limits<float>::min();
+  ASSERT_TRUE(grid.deposit(b2Vec2(0.5f, 0.5f), thin));
+  grid.diffuse(0.5f);
+  // A quarter of half of it would be denormal in each neighbour.
+  EXPECT_FLOAT_EQ(grid.sample(b2Vec2(0.5f, 0.5f)), 0.5f * thin);
+  EXPECT_FLOAT_EQ(grid.sample(b2Vec2(1.5f, 0.5f)), 0.0f);
+  EXPECT_FLOAT_EQ(grid.sample(b2Vec2(-0.5f, 0.5f)), 0.0f);
+}
+
+TEST(PheromoneGridTest, RestoresFromCheckpoint) {
+  PheromoneGrid grid(2.0f, 0.25f);
+  ASSERT_TRUE(grid.deposit(b2Vec2(3.0f, -7.0f), 5.0f));
+  grid.advance(2.0f);
+  ASSERT_TRUE(grid.deposit(b2Vec2(-40.0f, 12.0f), 1.0f));
+
+  salsa::CheckpointWriter out;
+  grid.save(out);
+  salsa::CheckpointReader in(out.data().data(), out.size());
+  PheromoneGrid restored(1.0f, 0.25f);
+  restored.load(in);
+  EXPECT_EQ(in.remaining(), 0u);
+
+  EXPECT_FLOAT_EQ(restored.cell_size(), 2.0f);
+  EXPECT_FLOAT_EQ(restored.time(), 2.0f);
+  for (const b2Vec2 &point : {b2Vec2(3.0f, -7.0f), b2Vec2(-40.0f, 12.0f)}) {
+    EXPECT_FLOAT_EQ(restored.sample(point), grid.sample(point));
+  }
+  restored.advance();
+  grid.advance();
+  EXPECT_FLOAT_EQ(restored.sample(b2Vec2(3.0f, -7.0f)),
+                  grid.sample(b2Vec2(3.0f, -7.0f)));
+}
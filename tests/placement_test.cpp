@@ -0,0 +1,183 @@
+#include "salsa/core/placement.h"
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using salsa::generateLayout;
+using salsa::Layout;
+using salsa::LayoutCache;
+using salsa::LayoutSpec;
+using salsa::Placement;
+
+namespace {
+LayoutSpec makeSpec(Placement placement, std::size_t count,
+                    uint64_t seed = 7) {
+  LayoutSpec spec;
+  spec.placement = placement;
+  spec.seed = seed;
+  spec.map_name = "test_map";
+  spec.count = count;
+  spec.lower.Set(10.0f, 20.0f);
+  spec.upper.Set(110.0f, 70.0f);
+  return spec;
+}
+}  // namespace
+
+class PlacementTest : public ::testing::TestWithParam<Placement> {};
+
+TEST_P(PlacementTest, GeneratesEveryPointInsideTheRegion) {
+  const LayoutSpec spec = makeSpec(GetParam(), 5000);
+  const std::vector<b2Vec2> points = generateLayout(spec);
+  ASSERT_EQ(spec.count, points.size());
+  for (const b2Vec2 &point : points) {
+    EXPECT_GE(point.x, spec.lower.x);
+    EXPECT_LE(point.x, spec.upper.x);
+    EXPECT_GE(point.y, spec.lower.y);
+    EXPECT_LE(point.y, spec.upper.y);
+  }
+}
+
+TEST_P(PlacementTest, IsDeterminedBySeed) {
+  const std::vector<b2Vec2> first = generateLayout(makeSpec(GetParam(), 500));
+  const std::vector<b2Vec2> again = generateLayout(makeSpec(GetParam(), 500));
+  const std::vector<b2Vec2> other =
+      generateLayout(makeSpec(GetParam(), 500, 8));
+  bool differs = false;
+  for (std::size_t i = 0; i < first.size(); i++) {
+    EXPECT_EQ(first[i].x, again[i].x);
+    EXPECT_EQ(first[i].y, again[i].y);
+    differs |= first[i].x != other[i].x || first[i].y != other[i].y;
+  }
+  EXPECT_TRUE(differs);
+}
+
+INSTANTIATE_TEST_SUITE_P(AllPlacements, PlacementTest,
+                         ::testing::Values(Placement::Uniform,
+                                           Placement::Stratified,
+                                           Placement::PoissonDisk,
+                                           Placement::Clustered,
+                                           Placement::Disc));
+
+TEST(PlacementNameTest, RoundTripsNames) {
+  for (const Placement placement :
+       {Placement::Uniform, Placement::Stratified, Placement::PoissonDisk,
+        Placement::Clustered, Placement::Disc}) {
+    EXPECT_EQ(placement,
+              salsa::placementFromName(salsa::placementName(placement)));
+  }
+  EXPECT_THROW(salsa::placementFromName("scattered"), std::invalid_argument);
+}
+
+TEST(StratifiedPlacementTest, PutsOnePointInEachCell) {
+  LayoutSpec spec = makeSpec(Placement::Stratified, 100);
+  spec.lower.Set(0.0f, 0.0f);
+  spec.upper.Set(10.0f, 10.0f);
+  std::vector<int> cells(100, 0);
+  for (const b2Vec2 &point : generateLayout(spec)) {
+    const int x = std::min(9, static_cast<int>(point.x));
+    const int y = std::min(9, static_cast<int>(point.y));
+    cells[y * 10 + x]++;
+  }
+  for (const int points : cells) {
+    EXPECT_EQ(1, points);
+  }
+}
+
+TEST(PoissonDiskPlacementTest, KeepsPointsApart) {
+  LayoutSpec spec = makeSpec(Placement::PoissonDisk, 1000);
+  spec.min_distance = 1.5f;
+  const std::vector<b2Vec2> points = generateLayout(spec);
+  ASSERT_EQ(1000u, points.size());
+  for (std::size_t i = 0; i < points.size(); i++) {
+    for (std::size_t j = i + 1; j < points.size(); j++) {
+      ASSERT_GE(b2Distance(points[i], points[j]), spec.min_distance);
+    }
+  }
+}
+
+TEST(DiscPlacementTest, StaysInsideTheCircle) {
+  LayoutSpec spec = makeSpec(Placement::Disc, 1000);
+  spec.lower.Set(-5.0f, -5.0f);
+  spec.upper.Set(5.0f, 5.0f);
+  for (const b2Vec2 &point : generateLayout(spec)) {
+    EXPECT_LE(point.Length(), 5.0f + 1e-4f);
+  }
+}
+
+class LayoutCacheTest : public ::testing::Test {
+ protected:
+  std::filesystem::path directory;
+
+  void SetUp() override {
+    directory =
+        std::filesystem::temp_directory_path() / "salsa_layout_cache_test";
+    std::filesystem::remove_all(directory);
+  }
+
+  void TearDown() override { std::filesystem::remove_all(directory); }
+};
+
+TEST_F(LayoutCacheTest, GeneratesOnceAndSharesInMemory) {
+  LayoutCache cache(directory);
+  const LayoutSpec spec = makeSpec(Placement::Uniform, 1000);
+  const auto first = cache.get(spec);
+  const auto again = cache.get(spec);
+  EXPECT_EQ(first.get(), again.get());
+  EXPECT_EQ(1u, cache.generated());
+  EXPECT_TRUE(std::filesystem::exists(cache.pathFor(spec)));
+}
+
+TEST_F(LayoutCacheTest, MapsLayoutsWrittenByAnotherCache) {
+  const LayoutSpec spec = makeSpec(Placement::Clustered, 50000);
+  const std::vector<b2Vec2> expected = generateLayout(spec);
+  {
+    LayoutCache writer(directory);
+    writer.get(spec);
+  }
+  LayoutCache reader(directory);
+  const auto layout = reader.get(spec);
+  EXPECT_EQ(0u, reader.generated());
+  EXPECT_TRUE(layout->mapped());
+  ASSERT_EQ(expected.size(), layout->size());
+  for (std::size_t i = 0; i < expected.size(); i++) {
+    EXPECT_EQ(expected[i].x, (*layout)[i].x);
+    EXPECT_EQ(expected[i].y, (*layout)[i].y);
+  }
+}
+
+TEST_F(LayoutCacheTest, KeepsDifferentSpecsApart) {
+  LayoutCache cache(directory);
+  const LayoutSpec spec = makeSpec(Placement::Uniform, 100);
+  LayoutSpec other_map = spec;
+  other_map.map_name = "other_map";
+  LayoutSpec other_count = spec;
+  other_count.count = 101;
+  EXPECT_NE(cache.pathFor(spec), cache.pathFor(other_map));
+  EXPECT_NE(spec.key(), other_count.key());
+  cache.get(spec);
+  cache.get(other_map);
+  EXPECT_EQ(101u, cache.get(other_count)->size());
+  EXPECT_EQ(3u, cache.generated());
+}
+
+TEST_F(LayoutCacheTest, RegeneratesUnreadableFiles) {
+  const LayoutSpec spec = makeSpec(Placement::Stratified, 100);
+  LayoutCache cache(directory);
+  std::filesystem::create_directories(directory);
+  std::ofstream(cache.pathFor(spec), std::ios::binary) << "not a layout";
+
+  const auto layout = cache.get(spec);
+  EXPECT_EQ(1u, cache.generated());
+  EXPECT_EQ(100u, layout->size());
+
+  // The file was replaced, so a fresh cache can map it.
+  LayoutCache reader(directory);
+  EXPECT_TRUE(reader.get(spec)->mapped());
+  EXPECT_EQ(0u, reader.generated());
+}
@@ -0,0 +1,96 @@
+#include "salsa/core/profile.h"
+
+#include <box2d/box2d.h>
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+using salsa::PhaseStats;
+using salsa::StepPhase;
+using salsa::StepProfile;
+
+TEST(StepProfileTest, TakesPercentilesOfSamples) {
+  StepProfile profile;
+  for (int i = 1; i <= 100; i++) {
+    profile.record(StepPhase::Behaviours, static_cast<float>(i));
+  }
+  const PhaseStats stats = profile.stats(StepPhase::Behaviours);
+  EXPECT_EQ(100u, stats.samples);
+  EXPECT_DOUBLE_EQ(5050.0, stats.total_ms);
+  EXPECT_FLOAT_EQ(50.5f, stats.mean_ms);
+  EXPECT_FLOAT_EQ(100.0f, stats.max_ms);
+  EXPECT_FLOAT_EQ(50.0f, stats.p50_ms);
+  EXPECT_FLOAT_EQ(95.0f, stats.p95_ms);
+  EXPECT_FLOAT_EQ(99.0f, stats.p99_ms);
+  // Other phases have nothing recorded.
+  EXPECT_EQ(0u, profile.stats(StepPhase::Targets).samples);
+  EXPECT_FLOAT_EQ(0.0f, profile.stats(StepPhase::Targets).p99_ms);
+}
+
+TEST(StepProfileTest, KeepsPercentilesToTheWindowAndTotalsForEverything) {
+  StepProfile profile(10);
+  for (int i = 0; i < 10; i++) {
+    profile.record(StepPhase::Update, 100.0f);
+  }
+  for (int i = 0; i < 10; i++) {
+    profile.record(StepPhase::Update, 1.0f);
+  }
+  const PhaseStats stats = profile.stats(StepPhase::Update);
+  EXPECT_EQ(20u, stats.samples);
+  EXPECT_EQ(20u, profile.steps());
+  EXPECT_DOUBLE_EQ(1010.0, stats.total_ms);
+  EXPECT_FLOAT_EQ(100.0f, stats.max_ms);
+  EXPECT_FLOAT_EQ(1.0f, stats.p99_ms);
+
+  profile.clear();
+  EXPECT_EQ(0u, profile.steps());
+  EXPECT_FLOAT_EQ(0.0f, profile.stats(StepPhase::Update).max_ms);
+}
+
+TEST(StepProfileTest, RecordsTheWorldPhases) {
+  b2Profile world{};
+  world.step = 4.0f;
+  world.collide = 1.0f;
+  world.solve = 2.0f;
+  world.solveTOI = 0.5f;
+  world.broadphase = 0.25f;
+  StepProfile profile;
+  profile.recordWorld(world);
+  EXPECT_FLOAT_EQ(4.0f, profile.stats(StepPhase::WorldStep).max_ms);
+  EXPECT_FLOAT_EQ(1.0f, profile.stats(StepPhase::Collide).max_ms);
+  EXPECT_FLOAT_EQ(2.0f, profile.stats(StepPhase::Solve).max_ms);
+  EXPECT_FLOAT_EQ(0.5f, profile.stats(StepPhase::SolveTOI).max_ms);
+  EXPECT_FLOAT_EQ(0.25f, profile.stats(StepPhase::Broadphase).max_ms);
+}
+
+TEST(StepProfileTest, ReportsEveryPhase) {
+  StepProfile profile;
+  profile.record(StepPhase::Observers, 2.0f);
+  const nlohmann::json json = profile.toJson();
+  EXPECT_EQ(salsa::kStepPhaseCount, json["phases"].size());
+  EXPECT_FLOAT_EQ(2.0f, json["phases"]["observers"]["max_ms"].get<float>());
+
+  const std::string table = profile.table();
+  for (std::size_t i = 0; i < salsa::kStepPhaseCount; i++) {
+    EXPECT_NE(std::string::npos,
+              table.find(StepProfile::phaseName(static_cast<StepPhase>(i))));
+  }
+}
+
+TEST(StepCountersTest, ReportsBothPhasesOrWhyThereAreNone) {
+  salsa::StepCounters counters;
+  counters.error = "perf_event_open failed";
+  EXPECT_FALSE(counters.toJson()["available"].get<bool>());
+  EXPECT_NE(std::string::npos, counters.table().find(counters.error));
+
+  counters.available = true;
+  counters.steps = 10;
+  counters.world_step[salsa::HardwareEvent::Cycles] = 2000;
+  counters.world_step[salsa::HardwareEvent::Instructions] = 3000;
+  const nlohmann::json json = counters.toJson();
+  EXPECT_EQ(2000u, json["world_step"]["cycles"].get<uint64_t>());
+  EXPECT_DOUBLE_EQ(1.5, json["world_step"]["ipc"].get<double>());
+  EXPECT_EQ(0u, json["behaviours"]["llc_misses"].get<uint64_t>());
+  EXPECT_NE(std::string::npos, counters.table().find("behaviours"));
+}
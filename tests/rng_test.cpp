@@ -0,0 +1,100 @@
+#include "salsa/utils/rng.h"
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using salsa::Rng;
+
+TEST(RngTest, IsDeterminedBySeedAndStream) {
+  Rng first(42, 3);
+  Rng again(42, 3);
+  Rng other_stream(42, 4);
+  Rng other_seed(43, 3);
+  int same_stream = 0;
+  int same_seed = 0;
+  for (int i = 0; i < 1000; i++) {
+    const uint64_t value = first();
+    EXPECT_EQ(value, again());
+    same_stream += value == other_stream();
+    same_seed += value == other_seed();
+  }
+  EXPECT_EQ(0, same_stream);
+  EXPECT_EQ(0, same_seed);
+}
+
+TEST(RngTest, CanBeReadAtAnyCounter) {
+  Rng rng(5);
+  const Rng start = rng;
+  std::vector<uint64_t> values;
+  for (int i = 0; i < 100; i++) {
+    values.push_back(rng());
+  }
+  EXPECT_EQ(100u, rng.counter());
+  for (uint64_t i = 0; i < values.size(); i++) {
+    EXPECT_EQ(values[i], start.at(i));
+  }
+  Rng skipped = start;
+  skipped.discard(40);
+  EXPECT_EQ(values[40], skipped());
+  EXPECT_NE(start, rng);
+}
+
+TEST(RngTest, UniformStaysInRange) {
+  Rng rng(11);
+  double sum = 0.0;
+  constexpr int count = 100000;
+  for (int i = 0; i < count; i++) {
+    const float value = rng.uniform(-2.0f, 3.0f);
+    ASSERT_GE(value, -2.0f);
+    ASSERT_LT(value, 3.0f);
+    sum += value;
+  }
+  EXPECT_NEAR(0.5, sum / count, 0.05);
+}
+
+TEST(RngTest, BelowCoversItsRangeEvenly) {
+  Rng rng(5);
+  std::vector<int> counts(7, 0);
+  constexpr int count = 70000;
+  for (int i = 0; i < count; i++) {
+    const uint64_t value = rng.below(7);
+    ASSERT_LT(value, 7u);
+    counts[value]++;
+  }
+  for (const int hits : counts) {
+    EXPECT_NEAR(count / 7, hits, 500);
+  }
+  EXPECT_EQ(0u, rng.below(0));
+  EXPECT_EQ(0u, rng.below(1));
+}
+
+TEST(RngTest, NormalHasMeanAndDeviation) {
+  Rng rng(13);
+  double sum = 0.0;
+  double squares = 0.0;
+  constexpr int count = 100000;
+  for (int i = 0; i < count; i++) {
+    const float value = rng.normal(2.0f, 3.0f);
+    ASSERT_TRUE(std::isfinite(value));
+    sum += value;
+    squares += value * value;
+  }
+  const double mean = sum / count;
+  EXPECT_NEAR(2.0, mean, 0.05);
+  EXPECT_NEAR(3.0, std::sqrt(squares / count - mean * mean), 0.05);
+}
+
+TEST(RngTest, WorksWithStandardDistributions) {
+  Rng rng(3);
+  std::uniform_int_distribution<int> die(1, 6);
+  std::set<int> faces;
+  for (int i = 0; i < 1000; i++) {
+    faces.insert(die(rng));
+  }
+  EXPECT_EQ(6u, faces.size());
+}
@@ -0,0 +1,70 @@
+#include "salsa/core/runner.h"
+
+#include <memory>
+
+#include "gtest/gtest.h"
+#include "salsa/core/sim.h"
+#include "salsa/entity/drone_configuration.h"
+
+using salsa::DroneConfiguration;
+using salsa::Runner;
+using salsa::Sim;
+
+class RunnerTest : public ::testing::Test {
+ protected:
+  b2World world{b2Vec2(0.0f, 0.0f)};
+  std::unique_ptr<DroneConfiguration> config;
+  std::unique_ptr<Sim> sim;
+
+  void SetUp() override {
+    salsa::CollisionManager::registerType<salsa::Drone>({});
+    config = std::make_unique<DroneConfiguration>("test", 5.0f, 3.0f, 2.0f,
+                                                  1.0f, 0.5f, 1.0f, 10.0f);
+    sim = std::make_unique<Sim>(&world, 3, 0, config.get(), 100.0f, 100.0f,
+                                0.5f);
+  }
+};
+
+TEST_F(RunnerTest, DefaultsMatchTestbedLoop) {
+  Runner runner(*sim);
+  EXPECT_FLOAT_EQ(1.0f / 60.0f, runner.time_step());
+  EXPECT_EQ(8, runner.velocity_iterations());
+  EXPECT_EQ(3, runner.position_iterations());
+  EXPECT_FLOAT_EQ(0.5f, runner.time_limit());
+}
+
+TEST_F(RunnerTest, RunsUntilTimeLimit) {
+  Runner runner(*sim);
+  int callbacks = 0;
+  runner.onStep([&](Sim &) { callbacks++; });
+  const Runner::Result result = runner.run();
+  EXPECT_FALSE(result.stopped_early);
+  EXPECT_EQ(result.steps, callbacks);
+  EXPECT_GE(result.sim_time, 0.5f);
+  EXPECT_NEAR(0.5f, result.sim_time, 1.0f / 60.0f);
+  EXPECT_FLOAT_EQ(sim->current_time(), result.sim_time);
+}
+
+TEST_F(RunnerTest, SingleStepAdvancesClock) {
+  Runner runner(*sim);
+  runner.setTimeStep(0.1f);
+  runner.step();
+  EXPECT_FLOAT_EQ(0.1f, sim->current_time());
+}
+
+TEST_F(RunnerTest, StopConditionEndsRunEarly) {
+  Runner runner(*sim);
+  runner.setTimeLimit(10.0f).addStopCondition(
+      [](Sim &sim) { return sim.current_time() >= 0.25f; });
+  const Runner::Result result = runner.run();
+  EXPECT_TRUE(result.stopped_early);
+  EXPECT_NEAR(0.25f, result.sim_time, 1.0f / 60.0f);
+}
+
+TEST_F(RunnerTest, StopFromCallbackWithoutTimeLimit) {
+  Runner runner(*sim);
+  runner.setTimeLimit(-1.0f).onStep([&runner](Sim &) { runner.stop(); });
+  const Runner::Result result = runner.run();
+  EXPECT_EQ(1, result.steps);
+  EXPECT_TRUE(result.stopped_early);
+}
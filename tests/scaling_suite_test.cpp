@@ -0,0 +1,189 @@
+#include "salsa/core/scaling_suite.h"
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "salsa/behaviours/registry.h"
+#include "salsa/entity/drone_configuration.h"
+
+using salsa::ScalingCase;
+using salsa::ScalingReport;
+using salsa::ScalingSweep;
+using salsa::ScalingTolerance;
+
+namespace {
+class StillBehaviour final : public salsa::Behaviour {
+ public:
+  void execute(const std::vector<std::unique_ptr<salsa::Drone>> &,
+               salsa::Drone &currentDrone) override {
+    currentDrone.commandVelocity(b2Vec2(0.0f, 0.0f));
+  }
+
+  std::unique_ptr<Behaviour> clone() const override {
+    return std::make_unique<StillBehaviour>();
+  }
+};
+
+ScalingCase makeCase(const int drones, const double rtf,
+                     const float update_p95_ms, const std::size_t peak_bytes) {
+  ScalingCase c;
+  c.behaviour = "Flocking";
+  c.map = "tree_map";
+  c.drones = drones;
+  c.targets = 1000;
+  c.rtf = rtf;
+  c.update.p95_ms = update_p95_ms;
+  c.peak_bytes = peak_bytes;
+  return c;
+}
+}  // namespace
+
+TEST(ScalingSweepTest, CoversEveryCombinationWithTheSameSeed) {
+  ScalingSweep sweep;
+  sweep.behaviours = {"A", "B"};
+  sweep.maps = {"scatter"};
+  sweep.drone_counts = {10, 100, 1000};
+  sweep.target_counts = {100, 1000};
+  sweep.seed = 7;
+
+  const auto tests = sweep.tests();
+  ASSERT_EQ(12u, tests.size());
+  // The number of drones changes fastest, tracing one RTF curve at a time.
+  EXPECT_EQ("A", tests[0].behaviour_name);
+  EXPECT_EQ(10, tests[0].num_drones);
+  EXPECT_EQ(100, tests[1].num_drones);
+  EXPECT_EQ(100, tests[1].num_targets);
+  EXPECT_EQ(1000, tests[3].num_targets);
+  EXPECT_EQ("B", tests[6].behaviour_name);
+  for (const auto &test : tests) {
+    EXPECT_EQ(7, test.seed);
+    EXPECT_EQ(7, test.layout_seed);
+  }
+
+  const ScalingSweep read = ScalingSweep::fromJson(sweep.toJson());
+  EXPECT_EQ(sweep.drone_counts, read.drone_counts);
+  EXPECT_EQ(sweep.behaviours, read.behaviours);
+  // Keys that are left out keep their defaults.
+  const ScalingSweep partial =
+      ScalingSweep::fromJson({{"drone_counts", {5}}});
+  EXPECT_EQ(std::vector<int>{5}, partial.drone_counts);
+  EXPECT_EQ(ScalingSweep().target_counts, partial.target_counts);
+}
+
+TEST(ScalingReportTest, ComparesAgainstTheBaselineWithinTolerance) {
+  ScalingReport baseline;
+  baseline.cases = {makeCase(10, 0.01, 0.5f, 1000000),
+                    makeCase(100, 0.1, 2.0f, 4000000),
+                    makeCase(1000, 1.0, 20.0f, 30000000)};
+  ScalingReport current;
+  current.cases = {
+      // Within tolerance everywhere.
+      makeCase(10, 0.0105, 0.52f, 1020000),
+      // Slower and bigger.
+      makeCase(100, 0.2, 3.0f, 5000000),
+      // Faster.
+      makeCase(1000, 0.5, 20.0f, 30000000),
+      makeCase(10000, 10.0, 200.0f, 300000000)};
+
+  const auto comparison = current.compare(baseline);
+  EXPECT_FALSE(comparison.passed());
+  ASSERT_EQ(3u, comparison.regressions.size());
+  for (const auto &change : comparison.regressions) {
+    EXPECT_EQ("Flocking/tree_map/100x1000", change.key);
+  }
+  EXPECT_DOUBLE_EQ(1.0, comparison.regressions[0].change());
+  ASSERT_EQ(1u, comparison.improvements.size());
+  EXPECT_EQ("rtf", comparison.improvements[0].metric);
+  EXPECT_EQ(std::vector<std::string>{"Flocking/tree_map/10000x1000"},
+            comparison.added);
+  EXPECT_TRUE(comparison.missing.empty());
+  EXPECT_NE(std::string::npos, comparison.table().find("Regressions"));
+
+  // A wider tolerance lets the slower test through.
+  ScalingTolerance loose;
+  loose.time = 1.5;
+  loose.memory = 0.5;
+  EXPECT_TRUE(current.compare(baseline, loose).passed());
+
+  // A test of the baseline that did not run fails the comparison.
+  current.cases.erase(current.cases.begin());
+  const auto missing = current.compare(baseline, loose);
+  EXPECT_FALSE(missing.passed());
+  EXPECT_EQ(std::vector<std::string>{"Flocking/tree_map/10x1000"},
+            missing.missing);
+}
+
+TEST(ScalingReportTest, FailsAgainstASweepWithOtherSettings) {
+  ScalingReport baseline;
+  baseline.cases = {makeCase(10, 0.01, 0.5f, 1000000)};
+  ScalingReport current = baseline;
+  // Other numbers of drones and targets are fine.
+  current.sweep.drone_counts = {10};
+  current.sweep.target_counts = {1000};
+  EXPECT_TRUE(current.compare(baseline).passed());
+
+  current.sweep.seed = 2;
+  current.sweep.num_threads = 4;
+  const auto comparison = current.compare(baseline);
+  EXPECT_FALSE(comparison.passed());
+  EXPECT_EQ((std::vector<std::string>{"num_threads: 1 -> 4", "seed: 1 -> 2"}),
+            comparison.settings);
+  EXPECT_TRUE(comparison.regressions.empty());
+  EXPECT_NE(std::string::npos, comparison.table().find("seed: 1 -> 2"));
+  EXPECT_EQ(comparison.settings,
+            comparison.toJson()["settings"].get<std::vector<std::string>>());
+}
+
+TEST(ScalingReportTest, SavesAndLoads) {
+  ScalingReport report;
+  report.sweep.drone_counts = {10, 20};
+  report.cases = {makeCase(10, 0.01, 0.5f, 1000000)};
+  report.cases[0].world.p99_ms = 1.25f;
+  const auto path =
+      std::filesystem::temp_directory_path() / "salsa_scaling_report.json";
+  ASSERT_TRUE(report.save(path));
+
+  const ScalingReport read = ScalingReport::load(path);
+  ASSERT_EQ(1u, read.cases.size());
+  EXPECT_EQ(report.cases[0].key(), read.cases[0].key());
+  EXPECT_DOUBLE_EQ(0.01, read.cases[0].rtf);
+  EXPECT_FLOAT_EQ(1.25f, read.cases[0].world.p99_ms);
+  EXPECT_EQ(1000000u, read.cases[0].peak_bytes);
+  EXPECT_EQ(report.sweep.drone_counts, read.sweep.drone_counts);
+  EXPECT_TRUE(read.compare(report).passed());
+  std::filesystem::remove(path);
+
+  EXPECT_THROW(ScalingReport::load(path), std::runtime_error);
+}
+
+TEST(ScalingSuiteTest, RunsEveryTestOfTheSweep) {
+  salsa::CollisionManager::registerType<salsa::Drone>({});
+  static salsa::DroneConfiguration config("scaling_test", 5.0f, 3.0f, 2.0f,
+                                          1.0f, 0.5f, 1.0f, 10.0f);
+  salsa::behaviour::Registry::get().add("ScalingStill",
+                                        std::make_unique<StillBehaviour>());
+  ScalingSweep sweep;
+  sweep.behaviours = {"ScalingStill"};
+  sweep.maps = {"scatter"};
+  sweep.drone_counts = {2, 8};
+  sweep.target_counts = {0};
+  sweep.time_limit = 0.25f;
+  sweep.drone_config_name = "scaling_test";
+  sweep.contact_listener_name = "null";
+
+  salsa::TestExecutor executor(1);
+  const ScalingReport report = salsa::runScalingSweep(sweep, executor);
+  ASSERT_EQ(2u, report.cases.size());
+  for (const ScalingCase &c : report.cases) {
+    EXPECT_TRUE(c.ok()) << c.error;
+    EXPECT_GT(c.steps, 0u);
+    EXPECT_GT(c.rtf, 0.0);
+    EXPECT_GT(c.peak_bytes, 0u);
+  }
+  EXPECT_EQ(8, report.cases[1].drones);
+  EXPECT_NE(std::string::npos, report.table().find("ScalingStill/scatter/8x0"));
+  salsa::behaviour::Registry::get().remove("ScalingStill");
+}
@@ -1,14 +1,23 @@
 #include "salsa/core/sim.h"
 
+#include <atomic>
+#include <cmath>
+#include <filesystem>
 #include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "mock_behaviour.h"
 #include "mock_drone.h"
 #include "salsa/behaviours/registry.h"
+#include "salsa/core/checkpoint.h"
+#include "salsa/core/runner.h"
 #include "salsa/core/test_queue.h"
 #include "salsa/entity/drone_configuration.h"
+#include "salsa/entity/target_factory.h"
 
 using salsa::DroneConfiguration;
 using salsa::Sim;
@@ -66,4 +75,712 @@ TEST_F(SimTest, UpdateTest) { ASSERT_NO_THROW(sim->update()); }
 TEST_F(SimTest, ResetTest) {
   sim->reset();
   EXPECT_EQ(5, sim->getDroneCount());
-}
\ No newline at end of file
+}
+
+TEST_F(SimTest, ResetKeepsDronesAndRepositionsThem) {
+  std::vector<salsa::Drone*> before;
+  for (const auto& drone : sim->getDrones()) {
+    before.push_back(drone.get());
+  }
+  sim->current_time() = 10.0f;
+  sim->reset(42);
+  std::vector<b2Vec2> first;
+  for (std::size_t i = 0; i < before.size(); i++) {
+    EXPECT_EQ(before[i], sim->getDrones()[i].get());
+    first.push_back(sim->getDrones()[i]->position());
+  }
+  EXPECT_EQ(0.0f, sim->current_time());
+
+  sim->reset(42);
+  for (std::size_t i = 0; i < first.size(); i++) {
+    EXPECT_EQ(first[i].x, sim->getDrones()[i]->position().x);
+    EXPECT_EQ(first[i].y, sim->getDrones()[i]->position().y);
+  }
+}
+
+TEST_F(SimTest, ProfilesEachStep) {
+  salsa::Runner runner(*sim);
+  // The first step's update happens at time zero, when nothing is done.
+  for (int step = 0; step < 5; step++) {
+    runner.step();
+  }
+  const salsa::StepProfile& profile = sim->profile();
+  EXPECT_EQ(4u, profile.steps());
+  EXPECT_EQ(4u, profile.stats(salsa::StepPhase::WorldStep).samples);
+  EXPECT_EQ(4u, profile.stats(salsa::StepPhase::Behaviours).samples);
+  EXPECT_GE(profile.stats(salsa::StepPhase::Update).total_ms,
+            profile.stats(salsa::StepPhase::Behaviours).total_ms);
+
+  sim->reset();
+  EXPECT_EQ(0u, sim->profile().steps());
+}
+
+TEST_F(SimTest, TracesTheLastSteps) {
+  EXPECT_EQ(nullptr, sim->tracer());
+  sim->enableTracing(2);
+  salsa::Runner runner(*sim);
+  for (int step = 0; step < 5; step++) {
+    runner.step();
+  }
+  const salsa::StepTracer* tracer = sim->tracer();
+  ASSERT_NE(nullptr, tracer);
+  EXPECT_EQ(4u, tracer->steps());
+  // Only the last two steps are kept, with one update in each.
+  int updates = 0;
+  bool batch = false;
+  for (const salsa::TraceEvent& event : tracer->events()) {
+    EXPECT_GE(event.step, 2u);
+    updates += std::string(event.name) == "update";
+    batch |= std::string(event.name) == "behaviour_batch";
+  }
+  EXPECT_EQ(2, updates);
+  EXPECT_TRUE(batch);
+
+  sim->disableTracing();
+  EXPECT_EQ(nullptr, sim->tracer());
+}
+
+TEST_F(SimTest, CountsHardwareEventsWhenAsked) {
+  salsa::Runner runner(*sim);
+  runner.step();
+  EXPECT_EQ(0u, sim->counters().steps);
+
+  sim->setHardwareCounters(true);
+  for (int step = 0; step < 3; step++) {
+    runner.step();
+  }
+  const salsa::StepCounters& counters = sim->counters();
+  EXPECT_EQ(3u, counters.steps);
+  // Where perf is not allowed the steps still run, with nothing counted.
+  EXPECT_NE(counters.available, !counters.error.empty());
+  if (!counters.available) {
+    EXPECT_EQ(0u, counters.world_step[salsa::HardwareEvent::Cycles]);
+  }
+
+  sim->reset();
+  EXPECT_EQ(0u, sim->counters().steps);
+}
+
+TEST_F(SimTest, AccountsForTheMemoryOfItsDrones) {
+  sim->setDroneCount(2);
+  sim->reset();
+  const salsa::MemoryReport two = sim->memoryReport();
+  EXPECT_EQ(2, two.drones);
+  EXPECT_GT(two.bytesPerDrone(), 0.0);
+
+  sim->setDroneCount(20);
+  sim->reset();
+  const salsa::MemoryReport twenty = sim->memoryReport();
+  EXPECT_EQ(20, twenty.drones);
+  const auto drones = static_cast<std::size_t>(salsa::MemoryCategory::Drones);
+  EXPECT_GT(twenty.box2d[drones].bytes, two.box2d[drones].bytes);
+  EXPECT_GE(twenty.peakBytes(), twenty.bytes());
+}
+
+TEST_F(SimTest, ResetResizesDrones) {
+  sim->setDroneCount(8);
+  sim->reset();
+  ASSERT_EQ(8u, sim->getDrones().size());
+  for (int i = 0; i < 8; i++) {
+    EXPECT_EQ(i, sim->getDrones()[i]->id());
+  }
+  const int bodies = world.GetBodyCount();
+  sim->setDroneCount(2);
+  sim->reset();
+  EXPECT_EQ(2u, sim->getDrones().size());
+  // The bodies of the drones that went are destroyed with them.
+  EXPECT_EQ(bodies - 6, world.GetBodyCount());
+}
+namespace {
+// Steers each drone away from its neighbours using only the start-of-step
+// snapshot, so that it can run across threads.
+class SpreadBehaviour final : public salsa::Behaviour {
+ public:
+  void execute(const std::vector<std::unique_ptr<salsa::Drone>>& drones,
+               salsa::Drone& currentDrone) override {
+    execute(drones, currentDrone, salsa::behaviour::Context(drones));
+  }
+
+  void execute(const std::vector<std::unique_ptr<salsa::Drone>>& drones,
+               salsa::Drone& currentDrone,
+               const salsa::behaviour::Context& context) override {
+    currentDrone.commandVelocity(currentDrone.velocity() +
+                                 avoidDrones(context, currentDrone));
+  }
+
+  bool supportsParallelExecution() const override { return true; }
+
+  std::unique_ptr<Behaviour> clone() const override {
+    return std::make_unique<SpreadBehaviour>();
+  }
+};
+
+std::vector<b2Vec2> runSteps(const int threads) {
+  b2World world(b2Vec2(0.0f, 0.0f));
+  DroneConfiguration config("test", 5.0f, 3.0f, 2.0f, 1.0f, 0.5f, 1.0f,
+                            10.0f);
+  SpreadBehaviour behaviour;
+  Sim sim(&world, 60, 0, &config, 100.0f, 100.0f, 120.0f);
+  sim.setCurrentBehaviour(&behaviour);
+  // Every Sim draws its own spawn positions, so lay the drones out the same
+  // way for both runs.
+  auto& drones = sim.getDrones();
+  for (std::size_t i = 0; i < drones.size(); i++) {
+    const b2Vec2 position(45.0f + 1.5f * (i % 8), 45.0f + 1.5f * (i / 8));
+    drones[i]->body()->SetTransform(position, 0.0f);
+    drones[i]->body()->SetLinearVelocity(
+        b2Vec2(std::cos(0.1f * i), std::sin(0.1f * i)));
+  }
+  sim.setThreadCount(threads);
+  sim.current_time() = 1.0f / 60.0f;
+  for (int step = 0; step < 30; step++) {
+    world.Step(1.0f / 60.0f, 8, 3);
+    sim.update();
+    sim.current_time() += 1.0f / 60.0f;
+  }
+  std::vector<b2Vec2> state;
+  for (const auto& drone : sim.getDrones()) {
+    state.push_back(drone->position());
+    state.push_back(drone->velocity());
+  }
+  return state;
+}
+}  // namespace
+
+TEST(SimThreadingTest, ParallelUpdateMatchesSerial) {
+  const std::vector<b2Vec2> serial = runSteps(1);
+  const std::vector<b2Vec2> parallel = runSteps(4);
+  ASSERT_EQ(serial.size(), parallel.size());
+  for (std::size_t i = 0; i < serial.size(); i++) {
+    EXPECT_EQ(serial[i].x, parallel[i].x);
+    EXPECT_EQ(serial[i].y, parallel[i].y);
+  }
+}
+
+namespace {
+class StepCountingBehaviour final : public salsa::Behaviour {
+ public:
+  int steps = 0;
+  std::atomic<int> executions{0};
+  int executions_before_step = -1;
+
+  void beginStep(const salsa::behaviour::Context& context) override {
+    steps++;
+    executions_before_step = executions;
+    EXPECT_EQ(5u, context.drones().size());
+  }
+
+  void execute(const std::vector<std::unique_ptr<salsa::Drone>>& drones,
+               salsa::Drone& currentDrone) override {
+    executions++;
+  }
+
+  bool supportsParallelExecution() const override { return true; }
+};
+}  // namespace
+
+TEST(SimBehaviourTest, BeginsEachStepOnceBeforeAnyDroneRuns) {
+  for (const int threads : {1, 4}) {
+    b2World world(b2Vec2(0.0f, 0.0f));
+    DroneConfiguration config("test", 5.0f, 3.0f, 2.0f, 1.0f, 0.5f, 1.0f,
+                              10.0f);
+    StepCountingBehaviour behaviour;
+    Sim sim(&world, 5, 0, &config, 100.0f, 100.0f, 120.0f);
+    sim.setCurrentBehaviour(&behaviour);
+    sim.setThreadCount(threads);
+    sim.current_time() = 1.0f / 60.0f;
+    for (int step = 0; step < 3; step++) {
+      sim.update();
+      EXPECT_EQ(step + 1, behaviour.steps);
+      EXPECT_EQ(5 * step, behaviour.executions_before_step);
+      sim.current_time() += 1.0f / 60.0f;
+    }
+    EXPECT_EQ(15, behaviour.executions);
+  }
+}
+
+namespace {
+// Nudges each drone in a random direction drawn from its own stream.
+class JitterBehaviour final : public salsa::Behaviour {
+ public:
+  void execute(const std::vector<std::unique_ptr<salsa::Drone>>& drones,
+               salsa::Drone& currentDrone) override {
+    execute(drones, currentDrone, salsa::behaviour::Context(drones));
+  }
+
+  void execute(const std::vector<std::unique_ptr<salsa::Drone>>& drones,
+               salsa::Drone& currentDrone,
+               const salsa::behaviour::Context& context) override {
+    salsa::Rng& rng = context.rng(currentDrone);
+    const b2Vec2 nudge(rng.uniform(-1.0f, 1.0f), rng.uniform(-1.0f, 1.0f));
+    currentDrone.commandVelocity(currentDrone.velocity() + nudge);
+  }
+
+  bool supportsParallelExecution() const override { return true; }
+};
+
+std::vector<b2Vec2> runJitter(const int threads, const uint64_t seed) {
+  b2World world(b2Vec2(0.0f, 0.0f));
+  DroneConfiguration config("test", 5.0f, 3.0f, 2.0f, 1.0f, 0.5f, 1.0f,
+                            10.0f);
+  JitterBehaviour behaviour;
+  Sim sim(&world, 60, 0, &config, 100.0f, 100.0f, 120.0f);
+  sim.setCurrentBehaviour(&behaviour);
+  sim.setThreadCount(threads);
+  sim.reset(seed);
+  sim.current_time() = 1.0f / 60.0f;
+  for (int step = 0; step < 30; step++) {
+    world.Step(1.0f / 60.0f, 8, 3);
+    sim.update();
+    sim.current_time() += 1.0f / 60.0f;
+  }
+  std::vector<b2Vec2> state;
+  for (const auto& drone : sim.getDrones()) {
+    state.push_back(drone->position());
+    state.push_back(drone->velocity());
+  }
+  return state;
+}
+}  // namespace
+
+TEST(SimRandomTest, RunsTheSameFromASeedOnAnyNumberOfThreads) {
+  const std::vector<b2Vec2> serial = runJitter(1, 7);
+  const std::vector<b2Vec2> parallel = runJitter(4, 7);
+  const std::vector<b2Vec2> other_seed = runJitter(1, 8);
+  ASSERT_EQ(serial.size(), parallel.size());
+  bool differs = false;
+  for (std::size_t i = 0; i < serial.size(); i++) {
+    EXPECT_EQ(serial[i].x, parallel[i].x);
+    EXPECT_EQ(serial[i].y, parallel[i].y);
+    differs |= serial[i].x != other_seed[i].x;
+  }
+  EXPECT_TRUE(differs);
+}
+
+TEST(SimBehaviourTest, SimsOwnClonesOfRegisteredBehaviours) {
+  b2World world(b2Vec2(0.0f, 0.0f));
+  DroneConfiguration config("test", 5.0f, 3.0f, 2.0f, 1.0f, 0.5f, 1.0f,
+                            10.0f);
+  Registry::get().add("Spread", std::make_unique<SpreadBehaviour>());
+  Sim first(&world, 4, 0, &config, 100.0f, 100.0f, 120.0f);
+  Sim second(&world, 4, 0, &config, 100.0f, 100.0f, 120.0f);
+  first.setCurrentBehaviour("Spread");
+  second.setCurrentBehaviour("Spread");
+
+  EXPECT_TRUE(first.ownsBehaviour());
+  EXPECT_TRUE(second.ownsBehaviour());
+  salsa::Behaviour* registered = Registry::get().behaviour("Spread");
+  salsa::Behaviour* first_behaviour = first.getDrones().front()->behaviour();
+  salsa::Behaviour* second_behaviour = second.getDrones().front()->behaviour();
+  EXPECT_NE(registered, first_behaviour);
+  EXPECT_NE(registered, second_behaviour);
+  EXPECT_NE(first_behaviour, second_behaviour);
+  Registry::get().remove("Spread");
+}
+
+namespace {
+// Turns each drone a little further every step, keeping a step count per
+// drone that has to survive a checkpoint.
+class TurningBehaviour final : public salsa::Behaviour {
+ public:
+  void execute(const std::vector<std::unique_ptr<salsa::Drone>>& drones,
+               salsa::Drone& currentDrone) override {
+    execute(drones, currentDrone, salsa::behaviour::Context(drones));
+  }
+
+  void execute(const std::vector<std::unique_ptr<salsa::Drone>>& drones,
+               salsa::Drone& currentDrone,
+               const salsa::behaviour::Context& context) override {
+    const float angle = 0.05f * static_cast<float>(steps_[&currentDrone]++);
+    currentDrone.commandVelocity(2.0f * b2Vec2(std::cos(angle),
+                                               std::sin(angle)) +
+                                 avoidDrones(context, currentDrone));
+  }
+
+  void clean(const std::vector<std::unique_ptr<salsa::Drone>>&) override {
+    steps_.clear();
+  }
+
+  std::unique_ptr<Behaviour> clone() const override {
+    return std::make_unique<TurningBehaviour>();
+  }
+
+  void saveState(const std::vector<std::unique_ptr<salsa::Drone>>& drones,
+                 salsa::CheckpointWriter& out) const override {
+    for (const auto& drone : drones) {
+      const auto it = steps_.find(drone.get());
+      out.write<int32_t>(it == steps_.end() ? 0 : it->second);
+    }
+  }
+
+  void loadState(const std::vector<std::unique_ptr<salsa::Drone>>& drones,
+                 salsa::CheckpointReader& in) override {
+    for (const auto& drone : drones) {
+      steps_[drone.get()] = in.read<int32_t>();
+    }
+  }
+
+ private:
+  std::unordered_map<const salsa::Drone*, int> steps_;
+};
+
+void layOutDrones(Sim& sim) {
+  auto& drones = sim.getDrones();
+  for (std::size_t i = 0; i < drones.size(); i++) {
+    drones[i]->body()->SetTransform(
+        b2Vec2(30.0f + 4.0f * (i % 5), 30.0f + 4.0f * (i / 5)), 0.0f);
+  }
+}
+
+std::vector<b2Vec2> droneState(Sim& sim) {
+  std::vector<b2Vec2> state;
+  for (const auto& drone : sim.getDrones()) {
+    state.push_back(drone->position());
+    state.push_back(drone->velocity());
+  }
+  return state;
+}
+}  // namespace
+
+TEST(SimCheckpointTest, RestoredRunContinuesIdentically) {
+  const std::filesystem::path path =
+      std::filesystem::temp_directory_path() / "salsa_sim_checkpoint.ckpt";
+  DroneConfiguration config("test", 5.0f, 3.0f, 2.0f, 1.0f, 0.5f, 1.0f,
+                            10.0f);
+
+  b2World world(b2Vec2(0.0f, 0.0f));
+  TurningBehaviour behaviour;
+  Sim sim(&world, 20, 0, &config, 100.0f, 100.0f, 120.0f);
+  sim.setCurrentBehaviour(&behaviour);
+  layOutDrones(sim);
+  salsa::Runner runner(sim);
+  sim.current_time() = runner.time_step();
+  for (int step = 0; step < 30; step++) {
+    runner.step();
+  }
+  sim.saveCheckpoint(path.string());
+  for (int step = 0; step < 30; step++) {
+    runner.step();
+  }
+
+  b2World other_world(b2Vec2(0.0f, 0.0f));
+  TurningBehaviour other_behaviour;
+  Sim restored(&other_world, 20, 0, &config, 100.0f, 100.0f, 120.0f);
+  restored.setCurrentBehaviour(&other_behaviour);
+  restored.loadCheckpoint(path.string());
+  salsa::Runner other_runner(restored);
+  for (int step = 0; step < 30; step++) {
+    other_runner.step();
+  }
+
+  EXPECT_EQ(sim.current_time(), restored.current_time());
+  const std::vector<b2Vec2> expected = droneState(sim);
+  const std::vector<b2Vec2> actual = droneState(restored);
+  ASSERT_EQ(expected.size(), actual.size());
+  for (std::size_t i = 0; i < expected.size(); i++) {
+    EXPECT_EQ(expected[i].x, actual[i].x);
+    EXPECT_EQ(expected[i].y, actual[i].y);
+  }
+  std::filesystem::remove(path);
+}
+
+namespace {
+// Writes less state than it reads back, so its state never restores.
+class ShortStateBehaviour final : public salsa::Behaviour {
+ public:
+  void execute(const std::vector<std::unique_ptr<salsa::Drone>>& drones,
+               salsa::Drone& currentDrone) override {
+    currentDrone.commandVelocity(b2Vec2(1.0f, 0.5f));
+  }
+
+  std::unique_ptr<Behaviour> clone() const override {
+    return std::make_unique<ShortStateBehaviour>();
+  }
+
+  void saveState(const std::vector<std::unique_ptr<salsa::Drone>>& drones,
+                 salsa::CheckpointWriter& out) const override {
+    out.write<int32_t>(1);
+  }
+
+  void loadState(const std::vector<std::unique_ptr<salsa::Drone>>& drones,
+                 salsa::CheckpointReader& in) override {
+    in.read<int64_t>();
+  }
+};
+}  // namespace
+
+TEST(SimCheckpointTest, UnreadableBehaviourStateChangesNothing) {
+  const std::filesystem::path path =
+      std::filesystem::temp_directory_path() / "salsa_sim_short.ckpt";
+  DroneConfiguration config("test", 5.0f, 3.0f, 2.0f, 1.0f, 0.5f, 1.0f,
+                            10.0f);
+  b2World world(b2Vec2(0.0f, 0.0f));
+  ShortStateBehaviour behaviour;
+  Sim sim(&world, 10, 0, &config, 100.0f, 100.0f, 120.0f);
+  sim.setCurrentBehaviour(&behaviour);
+  layOutDrones(sim);
+  salsa::Runner runner(sim);
+  sim.current_time() = runner.time_step();
+  for (int step = 0; step < 10; step++) {
+    runner.step();
+  }
+  sim.saveCheckpoint(path.string());
+  for (int step = 0; step < 10; step++) {
+    runner.step();
+  }
+
+  const float time = sim.current_time();
+  const std::vector<b2Vec2> state = droneState(sim);
+  EXPECT_THROW(sim.loadCheckpoint(path.string()), std::runtime_error);
+  EXPECT_EQ(time, sim.current_time());
+  const std::vector<b2Vec2> after = droneState(sim);
+  ASSERT_EQ(state.size(), after.size());
+  for (std::size_t i = 0; i < state.size(); i++) {
+    EXPECT_EQ(state[i].x, after[i].x);
+    EXPECT_EQ(state[i].y, after[i].y);
+  }
+  std::filesystem::remove(path);
+}
+
+TEST(SimCheckpointTest, RejectsCheckpointOfAnotherSimulation) {
+  const std::filesystem::path path =
+      std::filesystem::temp_directory_path() / "salsa_sim_mismatch.ckpt";
+  DroneConfiguration config("test", 5.0f, 3.0f, 2.0f, 1.0f, 0.5f, 1.0f,
+                            10.0f);
+  b2World world(b2Vec2(0.0f, 0.0f));
+  TurningBehaviour behaviour;
+  Sim sim(&world, 6, 0, &config, 100.0f, 100.0f, 120.0f);
+  sim.setCurrentBehaviour(&behaviour);
+  sim.current_time() = 5.0f;
+  sim.saveCheckpoint(path.string());
+
+  Sim smaller(&world, 5, 0, &config, 100.0f, 100.0f, 120.0f);
+  smaller.setCurrentBehaviour(&behaviour);
+  EXPECT_THROW(smaller.loadCheckpoint(path.string()), std::runtime_error);
+  EXPECT_EQ(0.0f, smaller.current_time());
+  std::filesystem::remove(path);
+}
+
+TEST(SimForkTest, ForkCarriesOnExactlyInAWorldOfItsOwn) {
+  salsa::CollisionManager::registerType<salsa::Drone>({});
+  static DroneConfiguration config("fork_test", 5.0f, 3.0f, 2.0f, 1.0f, 0.5f,
+                                   1.0f, 10.0f);
+  Registry::get().add("ForkTurning", std::make_unique<TurningBehaviour>());
+  salsa::TestConfig test{"ForkTurning",
+                         salsa::TestConfig::FloatParameters{},
+                         "fork_test",
+                         "scatter",
+                         12,
+                         0,
+                         10.0f,
+                         "null",
+                         ""};
+  Sim sim(test);
+  salsa::Runner runner(sim);
+  for (int step = 0; step < 30; step++) {
+    runner.step();
+  }
+
+  std::unique_ptr<Sim> fork = sim.fork();
+  EXPECT_NE(sim.getWorld(), fork->getWorld());
+  EXPECT_EQ(sim.getWorld()->GetBodyCount(), fork->getWorld()->GetBodyCount());
+  EXPECT_EQ(sim.current_time(), fork->current_time());
+  EXPECT_NE(sim.getDrones().front()->behaviour(),
+            fork->getDrones().front()->behaviour());
+
+  salsa::Runner fork_runner(*fork);
+  for (int step = 0; step < 30; step++) {
+    runner.step();
+    fork_runner.step();
+  }
+  const std::vector<b2Vec2> expected = droneState(sim);
+  const std::vector<b2Vec2> actual = droneState(*fork);
+  ASSERT_EQ(expected.size(), actual.size());
+  for (std::size_t i = 0; i < expected.size(); i++) {
+    EXPECT_EQ(expected[i].x, actual[i].x);
+    EXPECT_EQ(expected[i].y, actual[i].y);
+  }
+
+  // The fork takes its world with it, leaving the original to carry on.
+  fork.reset();
+  runner.step();
+  EXPECT_EQ(12u, sim.getDrones().size());
+  Registry::get().remove("ForkTurning");
+}
+
+namespace {
+// The registry tests empty the registry, so the DSP behaviour the testbed
+// registers is copied before any test runs, to be registered again.
+std::unique_ptr<salsa::Behaviour>& dspPrototype() {
+  static std::unique_ptr<salsa::Behaviour> prototype;
+  return prototype;
+}
+
+class DspEnvironment final : public ::testing::Environment {
+ public:
+  void SetUp() override {
+    if (salsa::Behaviour* dsp = Registry::get().behaviour("DSPBehaviour")) {
+      dspPrototype() = dsp->clone();
+    }
+  }
+};
+
+const auto* const dsp_environment =
+    ::testing::AddGlobalTestEnvironment(new DspEnvironment);
+
+// A test of the testbed's DSP behaviour, which gives every drone a body of
+// its own in the world to steer by.
+salsa::TestConfig dspTest() {
+  salsa::CollisionManager::registerType<salsa::Drone>({});
+  if (!Registry::get().behaviour("DSPBehaviour")) {
+    Registry::get().add("DSPBehaviour", [] { return dspPrototype()->clone(); });
+  }
+  static DroneConfiguration config("dsp_test", 5.0f, 3.0f, 2.0f, 1.0f, 0.5f,
+                                   1.0f, 10.0f);
+  return {"DSPBehaviour", salsa::TestConfig::FloatParameters{},
+          "dsp_test",     "scatter",
+          8,              0,
+          10.0f,          "null",
+          ""};
+}
+}  // namespace
+
+TEST(SimCheckpointTest, BehaviourBodiesAreRestoredNotAdded) {
+  const std::filesystem::path path =
+      std::filesystem::temp_directory_path() / "salsa_sim_dsp.ckpt";
+  salsa::TestConfig test = dspTest();
+  Sim sim(test);
+  salsa::Runner runner(sim);
+  for (int step = 0; step < 10; step++) {
+    runner.step();
+  }
+  const int bodies = sim.getWorld()->GetBodyCount();
+  sim.saveCheckpoint(path.string());
+  sim.loadCheckpoint(path.string());
+  EXPECT_EQ(bodies, sim.getWorld()->GetBodyCount());
+
+  // The same again, into a simulation whose behaviour has no bodies yet.
+  Sim other(test);
+  const int empty_bodies = other.getWorld()->GetBodyCount();
+  other.loadCheckpoint(path.string());
+  EXPECT_EQ(empty_bodies + 8, other.getWorld()->GetBodyCount());
+  EXPECT_EQ(bodies, other.getWorld()->GetBodyCount());
+  std::filesystem::remove(path);
+}
+
+TEST(SimForkTest, ForkHasNoMoreBodiesThanItsOriginal) {
+  salsa::TestConfig test = dspTest();
+  Sim sim(test);
+  salsa::Runner runner(sim);
+  for (int step = 0; step < 10; step++) {
+    runner.step();
+  }
+  const int bodies = sim.getWorld()->GetBodyCount();
+  std::unique_ptr<Sim> fork = sim.fork();
+  EXPECT_EQ(bodies, sim.getWorld()->GetBodyCount());
+  EXPECT_EQ(bodies, fork->getWorld()->GetBodyCount());
+
+  salsa::Runner fork_runner(*fork);
+  runner.step();
+  fork_runner.step();
+  EXPECT_EQ(sim.getWorld()->GetBodyCount(), fork->getWorld()->GetBodyCount());
+}
+
+TEST(SimArenaTest, OwnedWorldLivesInAnArenaFreedAtOnce) {
+  salsa::CollisionManager::registerType<salsa::Drone>({});
+  static DroneConfiguration config("arena_test", 5.0f, 3.0f, 2.0f, 1.0f, 0.5f,
+                                   1.0f, 10.0f);
+  Registry::get().add("ArenaTurning", std::make_unique<TurningBehaviour>());
+  salsa::TestConfig test{"ArenaTurning",
+                         salsa::TestConfig::FloatParameters{},
+                         "arena_test",
+                         "scatter",
+                         50,
+                         0,
+                         10.0f,
+                         "null",
+                         ""};
+  auto sim = std::make_unique<Sim>(test);
+  EXPECT_TRUE(sim->ownsWorld());
+  salsa::Runner runner(*sim);
+  for (int step = 0; step < 20; step++) {
+    runner.step();
+  }
+  const salsa::MemoryReport report = sim->memoryReport();
+  // Everything Box2D holds for the world comes out of the arena.
+  EXPECT_GT(report.arena_bytes, 0u);
+  EXPECT_GE(report.arena_bytes, report.box2d_total.bytes);
+
+  // Loading the map again frees the old world with its arena, without
+  // destroying its drones' bodies one at a time, and starts a new one.
+  const int bodies = sim->getWorld()->GetBodyCount();
+  sim->changeMap("scatter");
+  EXPECT_TRUE(sim->ownsWorld());
+  EXPECT_EQ(50u, sim->getDrones().size());
+  EXPECT_EQ(bodies, sim->getWorld()->GetBodyCount());
+  EXPECT_GT(sim->memoryReport().arena_bytes, 0u);
+  runner.step();
+
+  // A world the simulation was given is not its own.
+  b2World world(b2Vec2(0.0f, 0.0f));
+  Sim given(&world, 2, 0, &config, 100.0f, 100.0f, 120.0f);
+  EXPECT_FALSE(given.ownsWorld());
+  EXPECT_EQ(0u, given.memoryReport().arena_bytes);
+
+  sim.reset();
+  Registry::get().remove("ArenaTurning");
+}
+
+namespace {
+class CountedTarget : public salsa::Target {
+ public:
+  CountedTarget(b2World* world, const b2Vec2& position, const int id)
+      : Target(world, position, 1.0f) {
+    id_ = id;
+  }
+
+  std::string getType() const override { return "CountedTarget"; }
+};
+}  // namespace
+
+TEST(SimTargetTest, ResetKeepsTargetsWhenTheirCountChanges) {
+  salsa::CollisionManager::registerType<salsa::Drone>({});
+  static DroneConfiguration config("target_test", 5.0f, 3.0f, 2.0f, 1.0f,
+                                   0.5f, 1.0f, 10.0f);
+  Registry::get().add("TargetTurning", std::make_unique<TurningBehaviour>());
+  salsa::TargetFactory::registerTarget<CountedTarget>("CountedTarget");
+  salsa::TestConfig test{"TargetTurning",
+                         salsa::TestConfig::FloatParameters{},
+                         "target_test",
+                         "scatter",
+                         5,
+                         20,
+                         10.0f,
+                         "CountedTarget",
+                         ""};
+  Sim sim(test);
+  const std::vector<salsa::Target*> before = sim.getTargets();
+  ASSERT_EQ(20u, before.size());
+
+  // Growing keeps every target and adds the rest after them.
+  sim.setTargetCount(25);
+  sim.reset();
+  ASSERT_EQ(25u, sim.getTargets().size());
+  for (std::size_t i = 0; i < sim.getTargets().size(); i++) {
+    if (i < before.size()) {
+      EXPECT_EQ(before[i], sim.getTargets()[i]);
+    }
+    EXPECT_EQ(static_cast<int>(i), sim.getTargets()[i]->id());
+  }
+
+  // Shrinking keeps the first targets and destroys only the rest.
+  sim.setTargetCount(8);
+  sim.reset();
+  ASSERT_EQ(8u, sim.getTargets().size());
+  for (std::size_t i = 0; i < sim.getTargets().size(); i++) {
+    EXPECT_EQ(before[i], sim.getTargets()[i]);
+  }
+  salsa::Runner runner(sim);
+  runner.step();
+  Registry::get().remove("TargetTurning");
+}
@@ -0,0 +1,101 @@
+#include "salsa/utils/spatial_grid.h"
+
+#include <box2d/box2d.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using salsa::SpatialGrid;
+
+class SpatialGridTest : public ::testing::Test {
+ protected:
+  std::vector<b2Vec2> positions;
+  SpatialGrid grid;
+
+  void SetUp() override {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> coordinate(0.0f, 500.0f);
+    for (int i = 0; i < 400; i++) {
+      positions.emplace_back(coordinate(rng), coordinate(rng));
+    }
+    grid.build(positions, 25.0f);
+  }
+
+  std::vector<int> bruteForceRadius(const b2Vec2 &centre, float radius) const {
+    std::vector<int> result;
+    for (int i = 0; i < static_cast<int>(positions.size()); i++) {
+      if (b2DistanceSquared(positions[i], centre) <= radius * radius) {
+        result.push_back(i);
+      }
+    }
+    return result;
+  }
+};
+
+TEST_F(SpatialGridTest, EmptyGridReturnsNothing) {
+  SpatialGrid empty;
+  empty.build({}, 10.0f);
+  std::vector<int> out = {1, 2, 3};
+  empty.queryRadius(b2Vec2(0, 0), 100.0f, out);
+  EXPECT_TRUE(out.empty());
+  empty.queryNearest(b2Vec2(0, 0), 5, out);
+  EXPECT_TRUE(out.empty());
+}
+
+TEST_F(SpatialGridTest, RadiusQueryMatchesBruteForce) {
+  std::vector<int> out;
+  for (const float radius : {0.0f, 10.0f, 25.0f, 60.0f, 1000.0f}) {
+    for (const auto &centre : {b2Vec2(250, 250), b2Vec2(0, 0),
+                               b2Vec2(499, 10), b2Vec2(-50, 600)}) {
+      grid.queryRadius(centre, radius, out);
+      EXPECT_EQ(out, bruteForceRadius(centre, radius));
+    }
+  }
+}
+
+TEST_F(SpatialGridTest, RadiusQueryIncludesPointsOnBoundary) {
+  SpatialGrid small;
+  small.build({b2Vec2(0, 0), b2Vec2(10, 0), b2Vec2(10.5f, 0)}, 5.0f);
+  std::vector<int> out;
+  small.queryRadius(b2Vec2(0, 0), 10.0f, out);
+  EXPECT_EQ(out, (std::vector<int>{0, 1}));
+}
+
+TEST_F(SpatialGridTest, NearestQueryMatchesBruteForce) {
+  std::vector<int> out;
+  for (const auto &centre :
+       {b2Vec2(250, 250), b2Vec2(3, 490), b2Vec2(-100, -100)}) {
+    grid.queryNearest(centre, 7, out);
+    ASSERT_EQ(out.size(), 7u);
+
+    std::vector<int> expected(positions.size());
+    for (int i = 0; i < static_cast<int>(expected.size()); i++) {
+      expected[i] = i;
+    }
+    std::sort(expected.begin(), expected.end(), [&](int a, int b) {
+      return b2DistanceSquared(positions[a], centre) <
+             b2DistanceSquared(positions[b], centre);
+    });
+    expected.resize(7);
+    EXPECT_EQ(out, expected);
+  }
+}
+
+TEST_F(SpatialGridTest, NearestQueryReturnsAllPointsWhenKIsLarge) {
+  std::vector<int> out;
+  grid.queryNearest(b2Vec2(100, 100), positions.size() + 10, out);
+  EXPECT_EQ(out.size(), positions.size());
+}
+
+TEST_F(SpatialGridTest, SparsePointsLimitCellCount) {
+  SpatialGrid sparse;
+  sparse.build({b2Vec2(0, 0), b2Vec2(100000, 100000)}, 1.0f);
+  EXPECT_LE(sparse.columns() * sparse.rows(),
+            SpatialGrid::kMaxCellsPerPoint * 2 + 1);
+  std::vector<int> out;
+  sparse.queryRadius(b2Vec2(100000, 100000), 1.0f, out);
+  EXPECT_EQ(out, (std::vector<int>{1}));
+}
@@ -0,0 +1,75 @@
+#include "salsa/utils/spsc_ring.h"
+
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using salsa::SpscRing;
+
+TEST(SpscRingTest, RoundsCapacityUpToPowerOfTwo) {
+  SpscRing<int> ring(100);
+  EXPECT_EQ(128u, ring.capacity());
+  EXPECT_TRUE(ring.empty());
+}
+
+TEST(SpscRingTest, RefusesToPushWhenFull) {
+  SpscRing<int> ring(4);
+  for (int i = 0; i < 4; i++) {
+    EXPECT_TRUE(ring.try_push(i));
+  }
+  EXPECT_FALSE(ring.try_push(4));
+
+  int value = -1;
+  ASSERT_TRUE(ring.try_pop(value));
+  EXPECT_EQ(0, value);
+  EXPECT_TRUE(ring.try_push(4));
+  EXPECT_EQ(4u, ring.size());
+}
+
+TEST(SpscRingTest, PopsInOrderAcrossTheWrap) {
+  SpscRing<int> ring(8);
+  int out[8];
+  int next = 0;
+  int expected = 0;
+  for (int round = 0; round < 10; round++) {
+    for (int i = 0; i < 5; i++) {
+      ASSERT_TRUE(ring.try_push(next++));
+    }
+    const std::size_t count = ring.pop(out, 8);
+    ASSERT_EQ(5u, count);
+    for (std::size_t i = 0; i < count; i++) {
+      EXPECT_EQ(expected++, out[i]);
+    }
+  }
+  EXPECT_EQ(0u, ring.pop(out, 8));
+}
+
+TEST(SpscRingTest, HandsEveryValueAcrossThreads) {
+  constexpr int kCount = 200000;
+  SpscRing<int> ring(64);
+  std::thread producer([&] {
+    for (int i = 0; i < kCount; i++) {
+      while (!ring.try_push(i)) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  std::vector<int> received;
+  received.reserve(kCount);
+  int batch[16];
+  while (received.size() < static_cast<std::size_t>(kCount)) {
+    const std::size_t count = ring.pop(batch, 16);
+    if (count == 0) {
+      std::this_thread::yield();
+    }
+    received.insert(received.end(), batch, batch + count);
+  }
+  producer.join();
+
+  for (int i = 0; i < kCount; i++) {
+    ASSERT_EQ(i, received[i]);
+  }
+}
@@ -0,0 +1,155 @@
+#include "salsa/entity/target_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "salsa/entity/target_factory.h"
+
+namespace {
+// Counts live instances, so that tests can check every target is destroyed.
+class PooledTarget : public salsa::Target {
+ public:
+  static int alive;
+
+  PooledTarget(b2World *world, const b2Vec2 &position, const int id,
+               const float radius = 1.0f, const bool fail = false)
+      : Target(world, position, radius) {
+    if (fail) {
+      throw std::runtime_error("construction failed");
+    }
+    id_ = id;
+    alive++;
+  }
+  ~PooledTarget() override { alive--; }
+
+  std::string getType() const override { return "PooledTarget"; }
+};
+
+int PooledTarget::alive = 0;
+
+class TargetPoolTest : public ::testing::Test {
+ protected:
+  void SetUp() override { PooledTarget::alive = 0; }
+};
+}  // namespace
+
+TEST_F(TargetPoolTest, ConstructsABlockInOneAllocation) {
+  salsa::TargetPool pool;
+  const auto first = pool.createMany<PooledTarget>(100, [](std::size_t i) {
+    return std::make_tuple(nullptr, b2Vec2(1.0f * i, 0.0f),
+                           static_cast<int>(i));
+  });
+
+  EXPECT_EQ(0u, first.index);
+  EXPECT_EQ(100u, pool.size());
+  EXPECT_EQ(1u, pool.block_count());
+  EXPECT_EQ(100, PooledTarget::alive);
+  // The targets sit next to each other, in creation order.
+  const auto *base = static_cast<PooledTarget *>(pool[0]);
+  for (std::size_t i = 0; i < pool.size(); i++) {
+    EXPECT_EQ(base + i, pool[i]);
+    EXPECT_EQ(static_cast<int>(i), pool[i]->id());
+    EXPECT_FLOAT_EQ(1.0f * i, pool[i]->position().x);
+  }
+}
+
+TEST_F(TargetPoolTest, HandlesStayValidAsThePoolGrows) {
+  salsa::TargetPool pool;
+  const auto single = pool.create<PooledTarget>(nullptr, b2Vec2(5.0f, 5.0f), 7);
+  salsa::Target *target = pool.get(single);
+  const auto block = pool.createMany<PooledTarget>(1000, [](std::size_t i) {
+    return std::make_tuple(nullptr, b2Vec2(0.0f, 0.0f), static_cast<int>(i));
+  });
+
+  EXPECT_EQ(target, pool.get(single));
+  EXPECT_EQ(7, pool.get(single)->id());
+  EXPECT_EQ(1u, block.index);
+  EXPECT_EQ(999, pool.get({block.index + 999})->id());
+  EXPECT_EQ(nullptr, pool.get({}));
+  EXPECT_EQ(2u, pool.block_count());
+}
+
+TEST_F(TargetPoolTest, ClearDestroysEveryTarget) {
+  {
+    salsa::TargetPool pool;
+    pool.createMany<PooledTarget>(10, [](std::size_t i) {
+      return std::make_tuple(nullptr, b2Vec2(0.0f, 0.0f), static_cast<int>(i));
+    });
+    pool.clear();
+    EXPECT_EQ(0, PooledTarget::alive);
+    EXPECT_TRUE(pool.empty());
+    EXPECT_EQ(0u, pool.block_count());
+
+    pool.createMany<PooledTarget>(5, [](std::size_t i) {
+      return std::make_tuple(nullptr, b2Vec2(0.0f, 0.0f), static_cast<int>(i));
+    });
+    EXPECT_EQ(5, PooledTarget::alive);
+  }
+  EXPECT_EQ(0, PooledTarget::alive);
+}
+
+TEST_F(TargetPoolTest, TruncateDestroysOnlyTheTail) {
+  salsa::TargetPool pool;
+  const auto make = [](std::size_t i) {
+    return std::make_tuple(nullptr, b2Vec2(0.0f, 0.0f), static_cast<int>(i));
+  };
+  pool.createMany<PooledTarget>(6, make);
+  pool.createMany<PooledTarget>(4, make);
+  const std::vector<salsa::Target *> before = pool.targets();
+
+  // The second block goes whole; the first loses its last two targets.
+  pool.truncate(4);
+  EXPECT_EQ(4, PooledTarget::alive);
+  EXPECT_EQ(1u, pool.block_count());
+  EXPECT_EQ(std::vector<salsa::Target *>(before.begin(), before.begin() + 4),
+            pool.targets());
+
+  pool.truncate(10);
+  EXPECT_EQ(4u, pool.size());
+  pool.createMany<PooledTarget>(3, make);
+  EXPECT_EQ(7, PooledTarget::alive);
+  pool.clear();
+  EXPECT_EQ(0, PooledTarget::alive);
+}
+
+TEST_F(TargetPoolTest, FailedBlockLeavesPoolUnchanged) {
+  salsa::TargetPool pool;
+  pool.create<PooledTarget>(nullptr, b2Vec2(0.0f, 0.0f), 0);
+  EXPECT_THROW(pool.createMany<PooledTarget>(10,
+                                             [](std::size_t i) {
+                                               return std::make_tuple(
+                                                   nullptr, b2Vec2(0.0f, 0.0f),
+                                                   static_cast<int>(i), 1.0f,
+                                                   i == 6);
+                                             }),
+               std::runtime_error);
+
+  EXPECT_EQ(1u, pool.size());
+  EXPECT_EQ(1u, pool.block_count());
+  EXPECT_EQ(1, PooledTarget::alive);
+}
+
+TEST_F(TargetPoolTest, FactoryCreatesRegisteredTypesInBulk) {
+  salsa::TargetFactory::registerTarget<PooledTarget, float, bool>(
+      "PooledTarget", 3.0f, false);
+  const std::vector<b2Vec2> positions = {{1.0f, 2.0f}, {3.0f, 4.0f}};
+
+  salsa::TargetPool pool;
+  const auto first = salsa::TargetFactory::createTargets(
+      "PooledTarget", pool, nullptr, positions, 10);
+
+  ASSERT_EQ(2u, pool.size());
+  EXPECT_EQ(1u, pool.block_count());
+  EXPECT_EQ(10, pool.get(first)->id());
+  EXPECT_EQ(11, pool[1]->id());
+  EXPECT_FLOAT_EQ(3.0f, pool[1]->radius());
+  EXPECT_FLOAT_EQ(4.0f, pool[1]->position().y);
+
+  EXPECT_FALSE(salsa::TargetFactory::createTargets("NoSuchTarget", pool,
+                                                   nullptr, positions, 0)
+                   .valid());
+  EXPECT_EQ(2u, pool.size());
+}
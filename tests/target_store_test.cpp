@@ -0,0 +1,153 @@
+#include "salsa/entity/target_store.h"
+
+#include <box2d/box2d.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "mock_behaviour.h"
+#include "salsa/entity/drone_configuration.h"
+#include "salsa/entity/drone_factory.h"
+#include "salsa/entity/target_pool.h"
+#include "salsa/utils/base_contact_listener.h"
+
+// Declared outside any namespace, so that its type name is "StoreTarget".
+class StoreTarget : public salsa::Target {
+ public:
+  StoreTarget(const b2Vec2 &position, const float radius, const int id)
+      : Target(nullptr, position, radius) {
+    id_ = id;
+  }
+
+  std::string getType() const override { return "StoreTarget"; }
+};
+
+class TargetStoreTest : public ::testing::Test {
+ protected:
+  b2World *world;
+  MockBehaviour behaviour;
+  salsa::DroneConfiguration *config;
+  std::vector<std::unique_ptr<salsa::Drone>> drones;
+  salsa::TargetPool pool;
+  salsa::TargetStore store;
+
+  void SetUp() override {
+    world = new b2World(b2Vec2(0.0f, 0.0f));
+    // Camera view range of 5.
+    config = new salsa::DroneConfiguration("target_store_test", 5.0f, 3.0f,
+                                           2.0f, 1.0f, 0.5f, 1.0f, 10.0f);
+    salsa::CollisionManager::registerType<salsa::Drone>({});
+  }
+
+  void TearDown() override {
+    store.clear();
+    pool.clear();
+    drones.clear();
+    delete world;
+    delete config;
+  }
+
+  salsa::Drone &addDrone(const b2Vec2 &position) {
+    drones.push_back(salsa::DroneFactory::createDrone(
+        world, position, behaviour, *config, b2Vec2(0.0f, 0.0f)));
+    return *drones.back();
+  }
+
+  void addTarget(const b2Vec2 &position, const float radius = 1.0f) {
+    pool.create<StoreTarget>(position, radius, static_cast<int>(pool.size()));
+  }
+
+  salsa::Target *target(const std::size_t index) const { return pool[index]; }
+
+  static void moveTo(salsa::Drone &drone, const b2Vec2 &position) {
+    drone.body()->SetTransform(position, 0.0f);
+  }
+};
+
+TEST_F(TargetStoreTest, TargetsHaveNoBody) {
+  addDrone(b2Vec2(0.0f, 0.0f));
+  addTarget(b2Vec2(3.0f, 4.0f));
+  store.build(pool.targets(), 5.0f);
+
+  EXPECT_EQ(1, world->GetBodyCount());
+  EXPECT_EQ(1u, store.size());
+  EXPECT_FLOAT_EQ(3.0f, target(0)->position().x);
+  EXPECT_FLOAT_EQ(4.0f, target(0)->position().y);
+}
+
+TEST_F(TargetStoreTest, DetectsTargetOnceWhileInView) {
+  salsa::Drone &drone = addDrone(b2Vec2(0.0f, 0.0f));
+  addTarget(b2Vec2(3.0f, 0.0f));
+  addTarget(b2Vec2(50.0f, 0.0f));
+  store.build(pool.targets(), 5.0f);
+
+  store.detect(drones, nullptr);
+  ASSERT_EQ(1u, drone.targets_found().size());
+  EXPECT_EQ(target(0), drone.targets_found()[0]);
+  EXPECT_TRUE(target(0)->isFound());
+  EXPECT_FALSE(target(1)->isFound());
+  drone.clearLists();
+
+  // Still in view, so it is not detected again.
+  store.detect(drones, nullptr);
+  EXPECT_TRUE(drone.targets_found().empty());
+
+  // Leaving and coming back into view detects it again.
+  moveTo(drone, b2Vec2(20.0f, 0.0f));
+  store.detect(drones, nullptr);
+  EXPECT_TRUE(drone.targets_found().empty());
+  moveTo(drone, b2Vec2(1.0f, 0.0f));
+  store.detect(drones, nullptr);
+  EXPECT_EQ(1u, drone.targets_found().size());
+}
+
+TEST_F(TargetStoreTest, TargetRadiusExtendsTheView) {
+  salsa::Drone &drone = addDrone(b2Vec2(0.0f, 0.0f));
+  addTarget(b2Vec2(5.5f, 0.0f), 1.0f);
+  addTarget(b2Vec2(0.0f, 6.5f), 1.0f);
+  addTarget(b2Vec2(-9.0f, 0.0f), 5.0f);
+  store.build(pool.targets(), 5.0f);
+
+  store.detect(drones, nullptr);
+  EXPECT_EQ(2u, drone.targets_found().size());
+  EXPECT_TRUE(target(0)->isFound());
+  EXPECT_FALSE(target(1)->isFound());
+  EXPECT_TRUE(target(2)->isFound());
+}
+
+TEST_F(TargetStoreTest, EachDroneDetectsSeparately) {
+  salsa::Drone &first = addDrone(b2Vec2(0.0f, 0.0f));
+  salsa::Drone &second = addDrone(b2Vec2(100.0f, 0.0f));
+  addTarget(b2Vec2(2.0f, 0.0f));
+  store.build(pool.targets(), 5.0f);
+
+  store.detect(drones, nullptr);
+  EXPECT_EQ(1u, first.targets_found().size());
+  EXPECT_TRUE(second.targets_found().empty());
+
+  moveTo(second, b2Vec2(2.0f, 1.0f));
+  store.detect(drones, nullptr);
+  EXPECT_EQ(1u, second.targets_found().size());
+}
+
+TEST_F(TargetStoreTest, CallsListenerDetectionHandler) {
+  salsa::Drone &drone = addDrone(b2Vec2(0.0f, 0.0f));
+  addTarget(b2Vec2(1.0f, 1.0f));
+  store.build(pool.targets(), 5.0f);
+
+  salsa::BaseContactListener listener("TargetStoreTest");
+  int detections = 0;
+  listener.addDetectionHandler(
+      "StoreTarget", [&](salsa::Drone &detector, salsa::Target &detected) {
+        EXPECT_EQ(&drone, &detector);
+        EXPECT_EQ(target(0), &detected);
+        detections++;
+      });
+
+  store.detect(drones, &listener);
+  EXPECT_EQ(1, detections);
+  // The handler replaces the default handling.
+  EXPECT_FALSE(target(0)->isFound());
+  EXPECT_TRUE(drone.targets_found().empty());
+}
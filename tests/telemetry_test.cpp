@@ -0,0 +1,141 @@
+#include "salsa/core/data/telemetry.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using salsa::TelemetrySink;
+using salsa::TrajectoryReader;
+using salsa::TrajectoryRecord;
+
+namespace {
+// Counts heap allocations made by the current thread while `counting` is
+// set, through the replacement operator new below.
+thread_local bool counting = false;
+thread_local std::size_t allocations = 0;
+
+class AllocationCounter {
+ public:
+  AllocationCounter() {
+    allocations = 0;
+    counting = true;
+  }
+  ~AllocationCounter() { counting = false; }
+  std::size_t count() const { return allocations; }
+};
+}  // namespace
+
+void *operator new(const std::size_t size) {
+  if (counting) {
+    allocations++;
+  }
+  if (void *memory = std::malloc(size ? size : 1)) {
+    return memory;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept { std::free(memory); }
+void operator delete(void *memory, std::size_t) noexcept { std::free(memory); }
+
+namespace {
+class RecordingObserver final : public salsa::Observer {
+ public:
+  std::mutex mutex;
+  std::vector<nlohmann::json> messages;
+
+  void update(const nlohmann::json &message) override {
+    std::lock_guard<std::mutex> lock(mutex);
+    messages.push_back(message);
+  }
+};
+
+class TelemetryTest : public ::testing::Test {
+ protected:
+  std::filesystem::path path;
+
+  void SetUp() override {
+    path = std::filesystem::temp_directory_path() / "salsa_telemetry_test" /
+           "result.trj";
+  }
+
+  void TearDown() override {
+    std::filesystem::remove_all(path.parent_path());
+  }
+
+  static TrajectoryRecord sample(const int i) {
+    return {0.1f * i, i % 100, 1.0f * i, -1.0f * i, 0.5f, -0.5f};
+  }
+};
+}  // namespace
+
+TEST_F(TelemetryTest, WritesEverySampleInOrder) {
+  constexpr int kSamples = 50000;
+  {
+    // A small ring makes the producer outrun the writer.
+    TelemetrySink sink(256);
+    sink.open(path.string(), "{}");
+    for (int i = 0; i < kSamples; i++) {
+      sink.record(sample(i));
+    }
+    sink.close();
+    EXPECT_EQ(static_cast<uint64_t>(kSamples), sink.records_written());
+  }
+
+  TrajectoryReader reader(path.string());
+  ASSERT_EQ(static_cast<std::size_t>(kSamples), reader.size());
+  for (int i = 0; i < kSamples; i++) {
+    ASSERT_EQ(i % 100, reader[i].id);
+    ASSERT_FLOAT_EQ(1.0f * i, reader[i].x);
+  }
+}
+
+TEST_F(TelemetryTest, RecordingDoesNotAllocate) {
+  TelemetrySink sink(1024);
+  sink.open(path.string(), "{}");
+  {
+    AllocationCounter counter;
+    // Enough samples to wrap the ring many times, and to fill it at least
+    // once, so waiting for the writer is covered as well.
+    for (int i = 0; i < 200000; i++) {
+      sink.record(sample(i));
+    }
+    EXPECT_EQ(0u, counter.count());
+  }
+  sink.close();
+  EXPECT_EQ(200000u, sink.records_written());
+}
+
+TEST_F(TelemetryTest, ClosedSinkIgnoresSamples) {
+  TelemetrySink sink;
+  sink.record(sample(1));
+  EXPECT_FALSE(sink.is_open());
+  EXPECT_EQ(0u, sink.records_written());
+}
+
+TEST_F(TelemetryTest, ObserverAdapterReceivesJsonMessages) {
+  auto observer = std::make_shared<RecordingObserver>();
+  {
+    TelemetrySink sink;
+    sink.addObserver(observer);
+    sink.open(path.string(), "{}");
+    sink.record({2.0f, 7, 1.5f, 2.5f, 3.0f, 4.0f});
+  }
+
+  ASSERT_EQ(1u, observer->messages.size());
+  const nlohmann::json &message = observer->messages.front();
+  EXPECT_EQ(7, message["id"]);
+  EXPECT_FLOAT_EQ(2.0f, message["time"].get<float>());
+  EXPECT_EQ("salsa::Drone", message["caller_type"]);
+  const auto sample_message =
+      nlohmann::json::parse(message["message"].get<std::string>());
+  EXPECT_FLOAT_EQ(1.5f, sample_message["position"][0].get<float>());
+  EXPECT_FLOAT_EQ(4.0f, sample_message["velocity"][1].get<float>());
+}
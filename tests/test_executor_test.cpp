@@ -0,0 +1,224 @@
+#include "salsa/core/test_executor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "salsa/behaviours/registry.h"
+#include "salsa/entity/drone_configuration.h"
+
+using salsa::TestConfig;
+using salsa::TestExecutor;
+using salsa::behaviour::Registry;
+
+namespace {
+// Keeps every drone still, and counts how many drones each instance has seen
+// so that shared instances would show up.
+class CountingBehaviour final : public salsa::Behaviour {
+ public:
+  std::set<salsa::Drone *> seen;
+
+  void execute(const std::vector<std::unique_ptr<salsa::Drone>> &,
+               salsa::Drone &currentDrone) override {
+    seen.insert(&currentDrone);
+    currentDrone.commandVelocity(b2Vec2(0.0f, 0.0f));
+  }
+
+  std::unique_ptr<Behaviour> clone() const override {
+    return std::make_unique<CountingBehaviour>();
+  }
+};
+
+class TestExecutorTest : public ::testing::Test {
+ protected:
+  const std::string behaviour_name = "ExecutorCounting";
+
+  void SetUp() override {
+    salsa::CollisionManager::registerType<salsa::Drone>({});
+    static salsa::DroneConfiguration config("executor_test", 5.0f, 3.0f, 2.0f,
+                                            1.0f, 0.5f, 1.0f, 10.0f);
+    Registry::get().add(behaviour_name, std::make_unique<CountingBehaviour>());
+  }
+
+  void TearDown() override { Registry::get().remove(behaviour_name); }
+
+  TestConfig makeTest(const int drones) const {
+    return {behaviour_name,
+            TestConfig::FloatParameters{},
+            "executor_test",
+            "scatter",
+            drones,
+            0,
+            0.25f,
+            "null",
+            ""};
+  }
+};
+}  // namespace
+
+TEST_F(TestExecutorTest, ReturnsResultsInOrder) {
+  std::vector<TestConfig> tests;
+  for (int i = 1; i <= 6; i++) {
+    tests.push_back(makeTest(i));
+  }
+
+  std::atomic<int> running{0};
+  std::atomic<int> most_running{0};
+  std::vector<std::size_t> finished;
+  TestExecutor executor(3);
+  executor.onSetup([&](salsa::Sim &, salsa::Runner &) {
+    const int now = ++running;
+    int seen = most_running;
+    while (now > seen && !most_running.compare_exchange_weak(seen, now)) {
+    }
+  });
+  executor.onProgress([&](const TestExecutor::Progress &progress) {
+    if (progress.finished) {
+      --running;
+      finished.push_back(progress.index);
+    }
+  });
+  const auto results = executor.run(tests);
+
+  ASSERT_EQ(tests.size(), results.size());
+  for (std::size_t i = 0; i < results.size(); i++) {
+    EXPECT_TRUE(results[i].ok()) << results[i].error;
+    EXPECT_EQ(i, results[i].index);
+    EXPECT_EQ(tests[i].num_drones, results[i].config.num_drones);
+    EXPECT_GE(results[i].run.sim_time, 0.25f);
+    EXPECT_FALSE(results[i].log_file.empty());
+  }
+  EXPECT_EQ(tests.size(), finished.size());
+  EXPECT_LE(most_running.load(), 3);
+}
+
+TEST_F(TestExecutorTest, EachSimGetsItsOwnBehaviour) {
+  std::mutex mutex;
+  std::vector<std::size_t> drones_seen;
+  TestExecutor executor(2);
+  executor.onSetup([&](salsa::Sim &sim, salsa::Runner &runner) {
+    EXPECT_TRUE(sim.ownsBehaviour());
+    runner.onStep([&](salsa::Sim &stepped) {
+      if (stepped.current_time() >= 0.25f) {
+        const auto *behaviour = static_cast<const CountingBehaviour *>(
+            stepped.getDrones().front()->behaviour());
+        std::lock_guard<std::mutex> lock(mutex);
+        drones_seen.push_back(behaviour->seen.size());
+      }
+    });
+  });
+  const auto results = executor.run({makeTest(3), makeTest(5)});
+
+  ASSERT_EQ(2u, drones_seen.size());
+  std::sort(drones_seen.begin(), drones_seen.end());
+  EXPECT_EQ(3u, drones_seen[0]);
+  EXPECT_EQ(5u, drones_seen[1]);
+}
+
+TEST_F(TestExecutorTest, FailedTestDoesNotStopOthers) {
+  TestConfig missing = makeTest(2);
+  missing.behaviour_name = "NoSuchBehaviour";
+  TestExecutor executor(2);
+  const auto results = executor.run({makeTest(2), missing, makeTest(2)});
+
+  ASSERT_EQ(3u, results.size());
+  EXPECT_TRUE(results[0].ok());
+  EXPECT_FALSE(results[1].ok());
+  EXPECT_TRUE(results[2].ok());
+}
+
+TEST_F(TestExecutorTest, MemoryBudgetStillRunsEveryTest) {
+  TestExecutor executor(4);
+  // Far too small for any test, so they run one at a time.
+  executor.setMemoryBudget(1);
+  EXPECT_EQ(0u, executor.estimateMemory(makeTest(4)));
+  const auto results = executor.run({makeTest(4), makeTest(4), makeTest(8)});
+
+  ASSERT_EQ(3u, results.size());
+  for (const auto &result : results) {
+    EXPECT_TRUE(result.ok()) << result.error;
+    EXPECT_GT(result.memory.bytes(), 0u);
+  }
+  EXPECT_GT(executor.estimateMemory(makeTest(8)),
+            executor.estimateMemory(makeTest(1)));
+}
+
+TEST_F(TestExecutorTest, CheckpointPathDependsOnTheTestButNotItsThreads) {
+  TestExecutor executor;
+  executor.setCheckpointDirectory("checkpoints");
+  TestConfig test = makeTest(3);
+  TestConfig threaded = test;
+  threaded.num_threads = 4;
+  TestConfig other = makeTest(4);
+  EXPECT_EQ(executor.checkpointPath(0, test),
+            executor.checkpointPath(0, threaded));
+  EXPECT_NE(executor.checkpointPath(0, test), executor.checkpointPath(1, test));
+  EXPECT_NE(executor.checkpointPath(0, test),
+            executor.checkpointPath(0, other));
+  EXPECT_EQ(std::filesystem::path("checkpoints"),
+            executor.checkpointPath(0, test).parent_path());
+}
+
+TEST_F(TestExecutorTest, ResumesFromCheckpointAndRemovesIt) {
+  const std::filesystem::path directory =
+      std::filesystem::temp_directory_path() / "salsa_executor_checkpoints";
+  std::filesystem::remove_all(directory);
+  TestExecutor executor(1);
+  executor.setCheckpointDirectory(directory).setCheckpointInterval(0.1f);
+  TestConfig test = makeTest(3);
+  const std::filesystem::path checkpoint = executor.checkpointPath(0, test);
+  {
+    // Stands in for an earlier run that stopped part of the way through.
+    salsa::Sim sim(test);
+    salsa::Runner runner(sim);
+    runner.setTimeLimit(0.1f).run();
+    sim.saveCheckpoint(checkpoint.string());
+    sim.finishLog();
+  }
+
+  std::vector<float> start_times;
+  executor.onSetup([&](salsa::Sim &sim, salsa::Runner &) {
+    start_times.push_back(sim.current_time());
+  });
+  const auto results = executor.run({test});
+
+  ASSERT_EQ(1u, results.size());
+  EXPECT_TRUE(results[0].ok()) << results[0].error;
+  EXPECT_GE(results[0].resumed_at, 0.1f);
+  ASSERT_EQ(1u, start_times.size());
+  EXPECT_EQ(results[0].resumed_at, start_times[0]);
+  EXPECT_GE(results[0].run.sim_time, 0.25f);
+  EXPECT_FALSE(std::filesystem::exists(checkpoint));
+  std::filesystem::remove_all(directory);
+}
+
+TEST_F(TestExecutorTest, RunsForksFromWhereTheyAre) {
+  TestConfig test = makeTest(3);
+  test.time_limit = 0.5f;
+  salsa::Sim sim(test);
+  salsa::Runner warm_up(sim);
+  warm_up.setTimeLimit(0.25f).run();
+  std::vector<std::unique_ptr<salsa::Sim>> forks;
+  for (int i = 0; i < 3; i++) {
+    forks.push_back(sim.fork());
+  }
+
+  TestExecutor executor(2);
+  const auto results = executor.runSims(forks);
+
+  ASSERT_EQ(forks.size(), results.size());
+  for (std::size_t i = 0; i < results.size(); i++) {
+    EXPECT_TRUE(results[i].ok()) << results[i].error;
+    EXPECT_EQ(i, results[i].index);
+    EXPECT_GE(results[i].run.sim_time, 0.5f);
+    // Only the steps after the warm-up are run again.
+    EXPECT_LT(results[i].run.steps, 20);
+    EXPECT_GE(forks[i]->current_time(), 0.5f);
+  }
+  EXPECT_LT(sim.current_time(), 0.5f);
+}
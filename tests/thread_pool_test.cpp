@@ -0,0 +1,70 @@
+#include "salsa/utils/thread_pool.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using salsa::ThreadPool;
+
+TEST(ThreadPoolTest, ZeroThreadsUsesHardwareConcurrency) {
+  ThreadPool pool(0);
+  EXPECT_GE(pool.size(), 1u);
+}
+
+TEST(ThreadPoolTest, ParallelForVisitsEveryIndexOnce) {
+  ThreadPool pool(4);
+  for (const std::size_t count : {0u, 1u, 3u, 100u, 10007u}) {
+    std::vector<std::atomic<int>> visits(count);
+    pool.parallelFor(count, [&](std::size_t i) { visits[i]++; });
+    for (std::size_t i = 0; i < count; i++) {
+      EXPECT_EQ(1, visits[i].load()) << "index " << i << " of " << count;
+    }
+  }
+}
+
+TEST(ThreadPoolTest, ParallelForChunksCoversTheRangeOnKnownWorkers) {
+  ThreadPool pool(4);
+  std::vector<std::atomic<int>> visits(1000);
+  pool.parallelForChunks(visits.size(), [&](const std::size_t begin,
+                                            const std::size_t end,
+                                            const std::size_t worker) {
+    EXPECT_LT(begin, end);
+    EXPECT_LT(worker, pool.size());
+    for (std::size_t i = begin; i < end; i++) {
+      visits[i]++;
+    }
+  });
+  for (std::size_t i = 0; i < visits.size(); i++) {
+    EXPECT_EQ(1, visits[i].load()) << "index " << i;
+  }
+}
+
+TEST(ThreadPoolTest, RepeatedRunsComplete) {
+  ThreadPool pool(3);
+  std::atomic<long> total = 0;
+  for (int run = 0; run < 200; run++) {
+    pool.parallelFor(64, [&](std::size_t i) { total += i; });
+  }
+  EXPECT_EQ(200L * (63 * 64 / 2), total.load());
+}
+
+TEST(ThreadPoolTest, ExceptionIsRethrownOnCaller) {
+  ThreadPool pool(4);
+  std::atomic<int> visited = 0;
+  EXPECT_THROW(pool.parallelFor(1000,
+                                [&](std::size_t i) {
+                                  if (i == 500) {
+                                    throw std::runtime_error("failure");
+                                  }
+                                  visited++;
+                                }),
+               std::runtime_error);
+  EXPECT_GT(visited.load(), 0);
+
+  // The pool is still usable afterwards.
+  std::atomic<int> after = 0;
+  pool.parallelFor(10, [&](std::size_t) { after++; });
+  EXPECT_EQ(10, after.load());
+}
@@ -0,0 +1,100 @@
+#include "salsa/core/trace.h"
+
+#include <box2d/box2d.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using salsa::ProfileClock;
+using salsa::StepTracer;
+using salsa::TraceEvent;
+
+TEST(StepTracerTest, KeepsOnlyTheLastSteps) {
+  StepTracer tracer(3);
+  const auto start = ProfileClock::now();
+  for (int step = 0; step < 10; step++) {
+    tracer.record("update", 0, start, start + std::chrono::microseconds(5));
+    tracer.endStep();
+  }
+  tracer.record("update", 0, start, start + std::chrono::microseconds(5));
+  EXPECT_EQ(10u, tracer.steps());
+  // The step being recorded and the two before it.
+  const std::vector<TraceEvent> events = tracer.events();
+  ASSERT_EQ(3u, events.size());
+  EXPECT_EQ(8u, events[0].step);
+  EXPECT_EQ(9u, events[1].step);
+  EXPECT_EQ(10u, events[2].step);
+  EXPECT_EQ(5000, events[0].duration_ns);
+
+  tracer.clear();
+  EXPECT_EQ(0u, tracer.steps());
+  EXPECT_TRUE(tracer.events().empty());
+}
+
+TEST(StepTracerTest, DropsSpansBeyondTheLimitOfAStep) {
+  StepTracer tracer(2, 4);
+  const auto now = ProfileClock::now();
+  for (int i = 0; i < 6; i++) {
+    tracer.record("begin_contact", 0, now, now);
+  }
+  EXPECT_EQ(4u, tracer.events().size());
+  EXPECT_EQ(2u, tracer.dropped());
+  // Spans dropped from a step are forgotten with it.
+  tracer.endStep();
+  tracer.endStep();
+  EXPECT_EQ(0u, tracer.dropped());
+}
+
+TEST(StepTracerTest, LaysTheWorldStepOutFromItsProfile) {
+  StepTracer tracer;
+  b2Profile profile{};
+  profile.step = 3.0f;
+  profile.collide = 1.0f;
+  profile.solve = 1.5f;
+  profile.broadphase = 0.5f;
+  profile.solveTOI = 0.5f;
+  const auto end = ProfileClock::now();
+  tracer.recordWorld(profile, end);
+  const std::vector<TraceEvent> events = tracer.events();
+  ASSERT_EQ(5u, events.size());
+  const auto find = [&](const std::string &name) {
+    for (const TraceEvent &event : events) {
+      if (name == event.name) {
+        return event;
+      }
+    }
+    return TraceEvent();
+  };
+  const TraceEvent world = find("world_step");
+  EXPECT_NEAR(3e6, world.duration_ns, 1e3);
+  EXPECT_EQ(world.start_ns, find("collide").start_ns);
+  EXPECT_NEAR(world.start_ns + 1e6, find("solve").start_ns, 1e3);
+  EXPECT_NEAR(find("solve").start_ns + find("solve").duration_ns,
+              find("broadphase").start_ns + find("broadphase").duration_ns,
+              1e3);
+  EXPECT_NEAR(world.start_ns + 2.5e6, find("solve_toi").start_ns, 1e3);
+}
+
+TEST(StepTracerTest, WritesChromeTraceEvents) {
+  StepTracer tracer;
+  const auto start = ProfileClock::now();
+  tracer.record("behaviour_batch", 2, start,
+                start + std::chrono::microseconds(250), 16);
+  const nlohmann::json trace = tracer.toJson();
+  ASSERT_TRUE(trace.contains("traceEvents"));
+  const nlohmann::json &event = trace["traceEvents"][0];
+  EXPECT_EQ("behaviour_batch", event["name"]);
+  EXPECT_EQ("X", event["ph"]);
+  EXPECT_EQ(2, event["tid"]);
+  EXPECT_DOUBLE_EQ(250.0, event["dur"].get<double>());
+  EXPECT_EQ(16, event["args"]["count"]);
+  // Every thread up to the highest one seen gets its row named.
+  int names = 0;
+  for (const nlohmann::json &e : trace["traceEvents"]) {
+    names += e["ph"] == "M";
+  }
+  EXPECT_EQ(3, names);
+}
@@ -0,0 +1,109 @@
+#include "salsa/core/data/trajectory.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "salsa/entity/drone_snapshot.h"
+
+using salsa::TrajectoryReader;
+using salsa::TrajectoryRecord;
+using salsa::TrajectoryWriter;
+
+class TrajectoryTest : public ::testing::Test {
+ protected:
+  std::filesystem::path path;
+
+  void SetUp() override {
+    path = std::filesystem::temp_directory_path() / "salsa_trajectory_test" /
+           "result.trj";
+  }
+
+  void TearDown() override {
+    std::filesystem::remove_all(path.parent_path());
+  }
+};
+
+TEST_F(TrajectoryTest, RoundTripsRecordsAndMetadata) {
+  const std::string metadata = R"({"behaviour":"Flocking","num_drones":3})";
+  {
+    TrajectoryWriter writer(path.string(), metadata);
+    // Enough records to span several buffer flushes.
+    for (int i = 0; i < 10000; i++) {
+      writer.write({0.5f * i, i % 3, 1.0f * i, 2.0f * i, -1.0f, 1.0f});
+    }
+    EXPECT_EQ(10000u, writer.records_written());
+  }
+
+  TrajectoryReader reader(path.string());
+  EXPECT_EQ(metadata, reader.metadata());
+  ASSERT_EQ(10000u, reader.size());
+  EXPECT_EQ(0u, reader.header().records_offset % 8);
+  for (int i = 0; i < 10000; i++) {
+    const TrajectoryRecord &record = reader[i];
+    EXPECT_FLOAT_EQ(0.5f * i, record.time);
+    EXPECT_EQ(i % 3, record.id);
+    EXPECT_FLOAT_EQ(1.0f * i, record.x);
+    EXPECT_FLOAT_EQ(2.0f * i, record.y);
+  }
+}
+
+TEST_F(TrajectoryTest, WritesOneRecordPerSnapshotDrone) {
+  salsa::DroneSnapshot snapshot;
+  snapshot.x = {1.0f, 2.0f};
+  snapshot.y = {3.0f, 4.0f};
+  snapshot.vx = {5.0f, 6.0f};
+  snapshot.vy = {7.0f, 8.0f};
+  snapshot.id = {10, 11};
+  {
+    TrajectoryWriter writer(path.string(), "{}");
+    writer.write(2.5f, snapshot);
+  }
+
+  TrajectoryReader reader(path.string());
+  ASSERT_EQ(2u, reader.size());
+  EXPECT_FLOAT_EQ(2.5f, reader[1].time);
+  EXPECT_EQ(11, reader[1].id);
+  EXPECT_FLOAT_EQ(2.0f, reader[1].x);
+  EXPECT_FLOAT_EQ(4.0f, reader[1].y);
+  EXPECT_FLOAT_EQ(6.0f, reader[1].vx);
+  EXPECT_FLOAT_EQ(8.0f, reader[1].vy);
+}
+
+TEST_F(TrajectoryTest, IgnoresTrailingPartialRecord) {
+  {
+    TrajectoryWriter writer(path.string(), "{}");
+    writer.write({1.0f, 0, 0.0f, 0.0f, 0.0f, 0.0f});
+  }
+  std::ofstream(path, std::ios::binary | std::ios::app) << "abc";
+
+  TrajectoryReader reader(path.string());
+  EXPECT_EQ(1u, reader.size());
+}
+
+TEST_F(TrajectoryTest, RejectsOtherFiles) {
+  std::filesystem::create_directories(path.parent_path());
+  std::ofstream(path) << "[0.0] [Sim 0] {\"targets_found\":0}\n";
+  EXPECT_THROW(TrajectoryReader reader(path.string()), std::runtime_error);
+}
+
+TEST_F(TrajectoryTest, ReportsRecordsThatDidNotReachTheFile) {
+  TrajectoryWriter writer(path.string(), "{}");
+  writer.write({1.0f, 0, 0.0f, 0.0f, 0.0f, 0.0f});
+  writer.close();
+  EXPECT_TRUE(writer.good());
+
+  // Every write to /dev/full fails with no space left on the device.
+  if (!std::filesystem::exists("/dev/full")) {
+    GTEST_SKIP() << "No /dev/full to fill";
+  }
+  writer.open("/dev/full", "{}");
+  for (std::size_t i = 0; i < 2 * TrajectoryWriter::kBufferRecords; i++) {
+    writer.write({1.0f, 0, 0.0f, 0.0f, 0.0f, 0.0f});
+  }
+  writer.close();
+  EXPECT_FALSE(writer.good());
+}